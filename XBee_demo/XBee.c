@@ -27,6 +27,9 @@
 //! connected to the XBEE. This version is set up to write characters one by 
 //! one, but that is not necessary. 
 //!
+//! Each command queues a response handler (XBeeResp.c) before it is sent,
+//! so the XBee's answer is decoded and returned to the command that asked.
+//!
 //! 
 //!
 //!
@@ -39,6 +42,7 @@
 #include <cstdlib>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
@@ -55,8 +59,91 @@
 #include "utils/uartstdio.h"
 #include "inc/lm4f120h5qr.h"
 #include "rgb.h"
+#include "XBeeTick.h"
+#include "XBeeSched.h"
+#include "XBeeResp.h"
+#include "XBeeNode.h"
+#include "XBeeBoot.h"
+#include "XBeeIc.h"
 #include "XBee.h"
 
+//*****************************************************************************
+//
+// Most AT text a command sends besides its argument: "ATxx", a parameter
+// character, a space, the argument's terminator and the carriage return.
+//
+//*****************************************************************************
+#define XBEE_CMD_TEXT           8
+
+//*****************************************************************************
+//
+// Quiet on the UART before and after +++, in ms: the XBee's guard time
+// (GT, 1 s by default) with a margin.
+//
+//*****************************************************************************
+#define XBEE_GUARD_BEFORE_MS    2000
+#define XBEE_GUARD_AFTER_MS     1000
+
+//*****************************************************************************
+//
+// Get ready to send a command of at most ui32Len bytes: room for all of it
+// in the control queue, then pfnHandler waiting for the answer. Prints the
+// error and returns false if either is not to be had, before anything is
+// written, so a command never goes out cut short.
+//
+//*****************************************************************************
+static bool
+XBeeCmdStart(tXBeeRespHandler pfnHandler, void *pvArg, uint32_t ui32TimeoutMs,
+             uint32_t ui32Len)
+{
+	if(!XBeeSchedReserve(ui32Len))
+	{
+		UARTprintf("Error: busy, no room to queue the command\n");
+		return false;
+	}
+	if(!XBeeRespExpect(pfnHandler, pvArg, ui32TimeoutMs))
+	{
+		UARTprintf("Error: busy, commands still waiting for a response\n");
+		return false;
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Wait ui32Ms on the ms tick, which keeps time whatever the governor has
+// set the system clock to.
+//
+//*****************************************************************************
+static void
+XBeeGuardWait(uint32_t ui32Ms)
+{
+	uint32_t ui32End;
+
+	ui32End = XBeeTickGet() + ui32Ms;
+	while(!XBEE_TICK_REACHED(XBeeTickGet(), ui32End))
+	{
+	}
+}
+
+//*****************************************************************************
+//
+// Response handler for +++, prints the answer and notes that the XBee is in
+// command mode if it was OK.
+//
+//*****************************************************************************
+static bool
+XBeeCmdModeResp(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_OK)
+	{
+		XBeeBootCmdModeSet(true);
+	}
+
+	return XBeeRespPrint(pvArg, psResp);
+}
+
 //*****************************************************************************
 //
 // Enter AT Command Mode Command
@@ -70,22 +157,38 @@
 //*****************************************************************************
 int Cmd_EnterCmdMode(int argc, char *argv[])
 {
+	//
+	// Nothing to do if the XBee is in command mode already (e.g. left there
+	// by the boot probe). Nothing is sent to find out: in transparent mode
+	// it would go out on air.
+	//
+	if(XBeeBootCmdModeCheck())
+	{
+		UARTprintf("+++: OK\n");
+		return 0;
+	}
+
 	//
 	// Required wait 
 	//
-	SysCtlDelay(SysCtlClockGet()*2);
+	XBeeGuardWait(XBEE_GUARD_BEFORE_MS);
 	
 	//
-	// Send "+++" command to XBee to "Enter AT Command Mode"
+	// Send "+++" command to XBee to "Enter AT Command Mode", the 'OK' comes
+	// back after the guard time
 	//
-	UARTCharPut(UART1_BASE,'+');
-	UARTCharPut(UART1_BASE,'+');
-	UARTCharPut(UART1_BASE,'+');
+	if(!XBeeCmdStart(XBeeCmdModeResp, "+++", 5000, 3))
+	{
+		return 1;
+	}
+	XBEEWRITE('+');
+	XBEEWRITE('+');
+	XBEEWRITE('+');
 	
 	//
 	// Requird wait 
 	//
-	SysCtlDelay(SysCtlClockGet());
+	XBeeGuardWait(XBEE_GUARD_AFTER_MS);
 	
 	//
 	// Assumed Success
@@ -104,9 +207,13 @@ int Cmd_EnterCmdMode(int argc, char *argv[])
 //*****************************************************************************
 int Cmd_AT(int argc, char *argv[])
 {
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespPrint, "AT", XBEE_RESP_TIMEOUT_MS, XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
@@ -137,11 +244,15 @@ int Cmd_ATID(int argc, char *argv[])
 		//
 		// most common case, just return PAN ID
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPanId, 0, XBEE_RESP_TIMEOUT_MS, XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('D');
+		XBEEWRITE('\r');
 		
 	}
 	else if( argc > 3 )
@@ -157,11 +268,16 @@ int Cmd_ATID(int argc, char *argv[])
 		//
 		// If address is given set it
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPanId, 0, XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('D');
+		XBEEWRITE(' ');
 		
 		//
 		// Send address
@@ -176,13 +292,13 @@ int Cmd_ATID(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	
@@ -204,11 +320,16 @@ int Cmd_ATSH(int argc, char *argv[])
 	//
 	// Send ATSH
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'S');
-	UARTCharPut(UART1_BASE,'H');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespSerialHigh, 0, XBEE_RESP_TIMEOUT_MS,
+	                 XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('S');
+	XBEEWRITE('H');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
@@ -231,11 +352,15 @@ int Cmd_ATSL(int argc, char *argv[])
 	//
 	// Send 'ATSL'
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'S');
-	UARTCharPut(UART1_BASE,'L');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespSerialLow, 0, XBEE_RESP_TIMEOUT_MS, XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('S');
+	XBEEWRITE('L');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
@@ -268,11 +393,16 @@ int Cmd_ATDH(int argc, char *argv[])
 		//
 		// Most common case, just return Destination Address
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'H');
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATDH", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE('H');
+		XBEEWRITE('\r');
 		
 	}
 	else if( argc > 3 )
@@ -288,11 +418,16 @@ int Cmd_ATDH(int argc, char *argv[])
 		//
 		// If address is given set it
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'H');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATDH", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE('H');
+		XBEEWRITE(' ');
 		
 		//
 		// Send address
@@ -307,13 +442,13 @@ int Cmd_ATDH(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -344,11 +479,16 @@ int Cmd_ATDL(int argc, char *argv[])
 		//
 		// most common case, just return destination address
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'L');
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATDL", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE('L');
+		XBEEWRITE('\r');
 		
 	}
 	else if( argc > 3 )
@@ -364,11 +504,16 @@ int Cmd_ATDL(int argc, char *argv[])
 		//
 		// If address is given set it
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'L');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATDL", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE('L');
+		XBEEWRITE(' ');
 		
 		//
 		// Send address
@@ -383,13 +528,13 @@ int Cmd_ATDL(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -408,11 +553,17 @@ int Cmd_ATCN(int argc, char *argv[])
 	//
 	// Send 'ATCN'
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'C');
-	UARTCharPut(UART1_BASE,'N');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespPrint, "ATCN", XBEE_RESP_TIMEOUT_MS,
+	                 XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('C');
+	XBEEWRITE('N');
+	XBEEWRITE('\r');
+	XBeeBootCmdModeSet(false);
 	
 	//
 	// Assumed success
@@ -434,11 +585,16 @@ int Cmd_ATWR(int argc, char *argv[])
 	//
 	// Send 'ATWR'
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'W');
-	UARTCharPut(UART1_BASE,'R');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespPrint, "ATWR", XBEE_RESP_TIMEOUT_MS,
+	                 XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('W');
+	XBEEWRITE('R');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
@@ -467,11 +623,15 @@ int Cmd_ATMY(int argc, char *argv[])
 		//
 		// Send basic command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'M');
-		UARTCharPut(UART1_BASE,'Y');
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespMy, 0, XBEE_RESP_TIMEOUT_MS, XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('M');
+		XBEEWRITE('Y');
+		XBEEWRITE('\r');
 		
 	}
 	else if( argc > 3 )
@@ -487,11 +647,16 @@ int Cmd_ATMY(int argc, char *argv[])
 		//
 		// If sample rate is given set it
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'M');
-		UARTCharPut(UART1_BASE,'Y');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespMy, 0, XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('M');
+		XBEEWRITE('Y');
+		XBEEWRITE(' ');
 		
 		//
 		// Send sample rate
@@ -506,13 +671,13 @@ int Cmd_ATMY(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -554,13 +719,18 @@ int Cmd_ATD(int argc, char *argv[])
 		//
 		// Send Base command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,argv[1][0]);
-		UARTCharPut(UART1_BASE,' ');
-		UARTCharPut(UART1_BASE,argv[2][0]);
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATD", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE(argv[1][0]);
+		XBEEWRITE(' ');
+		XBEEWRITE(argv[2][0]);
+		XBEEWRITE('\r');
 
 		return 0;
 	}
@@ -604,11 +774,16 @@ int Cmd_ATP(int argc, char *argv[])
 		//
 		// Send Base command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'P');
-		UARTCharPut(UART1_BASE,argv[1][0]);
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATP", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('P');
+		XBEEWRITE(argv[1][0]);
+		XBEEWRITE(' ');
 		
 		//
 		// Send specific command
@@ -623,13 +798,13 @@ int Cmd_ATP(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -657,11 +832,16 @@ int Cmd_ATIR(int argc, char *argv[])
 		//
 		// Send basic command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'R');
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATIR", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('R');
+		XBEEWRITE('\r');
 		
 	}
 	else if( argc > 3 )
@@ -677,11 +857,16 @@ int Cmd_ATIR(int argc, char *argv[])
 		//
 		// If sample rate is given set it
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'R');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATIR", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('R');
+		XBEEWRITE(' ');
 		
 		//
 		// Send sample rate
@@ -696,13 +881,69 @@ int Cmd_ATIR(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
+	}
+	
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Change Detect Command (series 1)
+// Input: hex mask of the DIO lines (bit 0 = D0) to watch, 0 turns off
+// Response: ??
+// Use: the XBee sends a sample as soon as a watched digital line changes,
+//		so ATIR can be slow or off for switch and door inputs.
+//
+//*****************************************************************************
+int Cmd_ATIC(int argc, char *argv[])
+{
+	char *ppcArgv[3];
+	
+	//
+	// Process commands
+	//
+	if( 1 == argc )
+	{
+		//
+		// Send basic command
+		//
+		if(!XBeeCmdStart(XBeeRespPrint, "ATIC", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('C');
+		XBEEWRITE('\r');
+		
+	}
+	else if( argc > 2 )
+	{
+		//
+		// Error check: too many arguements, 
+		//
+		UARTprintf("Error: too many arguements, try again\n");
+		return 1;
+	}
+	else
+	{
+		//
+		// If a mask is given set it, the same as 'ic local <mask>' which
+		// checks the mask and also works in API mode
+		//
+		ppcArgv[0] = "ic";
+		ppcArgv[1] = "local";
+		ppcArgv[2] = argv[1];
+		return Cmd_ic(3, ppcArgv);
 	}
 	
 	return 0;
@@ -735,11 +976,16 @@ int Cmd_ATIT(int argc, char *argv[])
 		//
 		// Send base command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATIT", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('T');
+		XBEEWRITE(' ');
 		
 		//
 		// Send sample rate
@@ -754,13 +1000,13 @@ int Cmd_ATIT(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -795,11 +1041,16 @@ int Cmd_ATIA(int argc, char *argv[])
 		//
 		// Send base command
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'I');
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,' ');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATIA", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT + strlen(argv[1])))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('I');
+		XBEEWRITE('A');
+		XBEEWRITE(' ');
 		
 		//
 		// Send sample rate
@@ -814,13 +1065,13 @@ int Cmd_ATIA(int argc, char *argv[])
 				//
 				// Send character to XBee
 				//
-				UARTCharPut(UART1_BASE,y);
+				XBEEWRITE(y);
 			}
 		
 		//
 		// End of command character
 		//
-		UARTCharPut(UART1_BASE,'\r');
+		XBEEWRITE('\r');
 	}
 	
 	return 0;
@@ -839,11 +1090,15 @@ int Cmd_ATV(int argc, char *argv[])
 	//
 	// Send 'AT%V'
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'%');
-	UARTCharPut(UART1_BASE,'V');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespVoltage, 0, XBEE_RESP_TIMEOUT_MS, XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('%');
+	XBEEWRITE('V');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
@@ -882,13 +1137,18 @@ int Cmd_ATPR(int argc, char *argv[])
 		//
 		// Send the ATDH command 
 		//
-		UARTCharPut(UART1_BASE,'A');
-		UARTCharPut(UART1_BASE,'T');
-		UARTCharPut(UART1_BASE,'D');
-		UARTCharPut(UART1_BASE,'H');
-		UARTCharPut(UART1_BASE,' ');
-		UARTCharPut(UART1_BASE,argv[1][0]);
-		UARTCharPut(UART1_BASE,'\r');
+		if(!XBeeCmdStart(XBeeRespPrint, "ATPR", XBEE_RESP_TIMEOUT_MS,
+		                 XBEE_CMD_TEXT))
+		{
+			return 1;
+		}
+		XBEEWRITE('A');
+		XBEEWRITE('T');
+		XBEEWRITE('D');
+		XBEEWRITE('H');
+		XBEEWRITE(' ');
+		XBEEWRITE(argv[1][0]);
+		XBEEWRITE('\r');
 		
 	}
 	
@@ -908,14 +1168,81 @@ int Cmd_ATRE(int argc, char *argv[])
 	//
 	// Send 'ATRE'
 	//
-	UARTCharPut(UART1_BASE,'A');
-	UARTCharPut(UART1_BASE,'T');
-	UARTCharPut(UART1_BASE,'R');
-	UARTCharPut(UART1_BASE,'E');
-	UARTCharPut(UART1_BASE,'\r');
+	if(!XBeeCmdStart(XBeeRespPrint, "ATRE", XBEE_RESP_TIMEOUT_MS,
+	                 XBEE_CMD_TEXT))
+	{
+		return 1;
+	}
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('R');
+	XBEEWRITE('E');
+	XBEEWRITE('\r');
 	
 	//
 	// Assumed Success
 	//
 	return 0;
 }
+
+
+//*****************************************************************************
+//
+// Node Discover Command
+// Input: none / node identifier (NI) of a single node to find
+// Response: one block of MY, SH, SL, ... per node, then an empty line
+// Use: to find the nodes on the PAN. Records are parsed as they arrive
+//		into the neighbour table (XBeeNode.c), see the 'nodes' command.
+//
+// NOTE: takes up to ATNT x 100ms to complete
+//
+//*****************************************************************************
+int Cmd_ATND(int argc, char *argv[])
+{
+	int x;
+	char y = 'a'; //dummy value, default 0 is a check case
+	
+	//
+	// Validate Input
+	//
+	if( argc > 2 )
+	{
+		UARTprintf("Error: too many arguements, try again\n");
+		return 1;
+	}
+	
+	//
+	// Send base command. A new round only once it is sure to go out, a
+	// busy error leaves the table and a round under way alone.
+	//
+	if(!XBeeCmdStart(XBeeRespNodeDiscover, 0, XBEE_ND_TIMEOUT_MS,
+	                 XBEE_CMD_TEXT + ((2 == argc) ? strlen(argv[1]) : 0)))
+	{
+		return 1;
+	}
+	XBeeNodeDiscoverStart();
+	XBEEWRITE('A');
+	XBEEWRITE('T');
+	XBEEWRITE('N');
+	XBEEWRITE('D');
+	
+	if( 2 == argc )
+	{
+		//
+		// Send node identifier
+		//
+		XBEEWRITE(' ');
+		for(x=0;argv[1][x]!=0 ;x++ )
+			{
+				y= argv[1][x];
+				XBEEWRITE(y);
+			}
+	}
+	
+	//
+	// End of command character
+	//
+	XBEEWRITE('\r');
+	
+	return 0;
+}
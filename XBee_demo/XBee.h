@@ -17,6 +17,15 @@
 #ifndef __XBEE_H__
 #define __XBEE_H__
 
+//*****************************************************************************
+//
+// Write one character to the XBee. Goes out in the control class of the
+// transmit scheduler (XBeeSched.c) ahead of any queued bulk data, replace
+// to port the command set to another UART.
+//
+//*****************************************************************************
+#define XBEEWRITE(c) XBeeSchedPut(c)
+
 //*****************************************************************************
 //
 // XBee AT Command function deffinitions
@@ -39,10 +48,12 @@ extern int Cmd_ATD(int argc, char *argv[]);
 extern int Cmd_ATP(int argc, char *argv[]);
 extern int Cmd_ATIR(int argc, char *argv[]);
 extern int Cmd_ATIT(int argc, char *argv[]);
+extern int Cmd_ATIC(int argc, char *argv[]);
 extern int Cmd_ATIA(int argc, char *argv[]);
 extern int Cmd_ATV(int argc, char *argv[]);
 extern int Cmd_ATPR(int argc, char *argv[]);
 extern int Cmd_ATRE(int argc, char *argv[]);
+extern int Cmd_ATND(int argc, char *argv[]);
 
 //*****************************************************************************
 //
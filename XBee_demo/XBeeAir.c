@@ -0,0 +1,382 @@
+//*****************************************************************************
+//
+// XBeeAir.c - Airtime budget for duty cycle limited bands
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! The 868MHz XBee variants may only be on the air for a share of the time
+//! (the duty cycle). Past it the radio holds frames back on its own and
+//! nothing says so, which shows up as seconds of latency. So the scheduler
+//! keeps its own account here and does not hand the radio more than it may
+//! send.
+//!
+//! The account is a token bucket in microseconds of air time. It fills at
+//! the duty cycle (90 per mille gives 90us per ms) up to
+//! XBEE_AIR_WINDOW_DEFAULT seconds worth. Each frame costs the air time of
+//! its RF payload plus the packet overhead at the RF data rate, taken
+//! before it goes to the UART. Retries the XBee reports in API mode are
+//! charged afterwards, which can run the bucket below zero.
+//!
+//! A frame that does not fit stays at the head of its class in XBeeSched.c
+//! while the other classes go ahead: API commands to the local XBee cost
+//! nothing, and a small control frame can fit where a bulk fragment does
+//! not. The loop sleeps until the bucket has filled enough.
+//!
+//! The estimate is kept even with the budget off, so 'air' shows the duty
+//! cycle the traffic would need.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeBoot.h"
+#include "XBeeSched.h"
+#include "XBeeAir.h"
+
+//*****************************************************************************
+//
+// Settings and the bucket, microseconds of air time in hand
+//
+//*****************************************************************************
+static bool g_bAirOn;
+static uint32_t g_ui32AirRate = XBEE_AIR_RATE_DEFAULT;
+static uint32_t g_ui32AirDuty = XBEE_AIR_DUTY_DEFAULT;
+static uint32_t g_ui32AirWindow = XBEE_AIR_WINDOW_DEFAULT;
+static int32_t g_i32AirTokens;
+static uint32_t g_ui32AirTick;
+static tXBeeAirStats g_sAirStats;
+
+//*****************************************************************************
+//
+// Bucket size in us of air time.
+//
+//*****************************************************************************
+static int32_t
+XBeeAirCapacity(void)
+{
+	return (int32_t)(g_ui32AirWindow * g_ui32AirDuty * 1000);
+}
+
+//*****************************************************************************
+//
+// Add the air time earned since the last call.
+//
+//*****************************************************************************
+static void
+XBeeAirRefill(void)
+{
+	uint32_t ui32Now;
+	uint32_t ui32Ms;
+	int32_t i32Cap;
+
+	ui32Now = XBeeTickGet();
+	ui32Ms = ui32Now - g_ui32AirTick;
+	g_ui32AirTick = ui32Now;
+	i32Cap = XBeeAirCapacity();
+
+	if((ui32Ms >= (g_ui32AirWindow * 2000)) ||
+	   ((int32_t)(ui32Ms * g_ui32AirDuty) >= (i32Cap - g_i32AirTokens)))
+	{
+		g_i32AirTokens = i32Cap;
+	}
+	else
+	{
+		g_i32AirTokens += ui32Ms * g_ui32AirDuty;
+	}
+}
+
+//*****************************************************************************
+//
+// Add ui32Us to the air time spent.
+//
+//*****************************************************************************
+static void
+XBeeAirSpend(uint32_t ui32Us)
+{
+	g_sAirStats.ui32AirUs += ui32Us;
+	g_sAirStats.ui32AirMs += g_sAirStats.ui32AirUs / 1000;
+	g_sAirStats.ui32AirUs %= 1000;
+
+	if(g_bAirOn)
+	{
+		g_i32AirTokens -= ui32Us;
+		if(g_i32AirTokens < -XBeeAirCapacity())
+		{
+			g_i32AirTokens = -XBeeAirCapacity();
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// RF payload bytes of a frame about to be queued, 0 if it stays with the
+// local XBee. ui32Encoded is its length on the UART. In transparent mode
+// every byte goes out; in API mode only the data of transmit requests.
+//
+//*****************************************************************************
+uint32_t
+XBeeAirBytes(const uint8_t *pui8Data, uint32_t ui32Len, uint32_t ui32Encoded)
+{
+	if(!XBeeLinkApi())
+	{
+		return ui32Encoded;
+	}
+	if((pui8Data[0] == XBEE_API_TX_64) && (ui32Len > 11))
+	{
+		return ui32Len - 11;
+	}
+	if((pui8Data[0] == XBEE_API_TX_16) && (ui32Len > 5))
+	{
+		return ui32Len - 5;
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Air time of one packet with ui32Bytes of payload, in us.
+//
+//*****************************************************************************
+uint32_t
+XBeeAirUs(uint32_t ui32Bytes)
+{
+	return ((ui32Bytes + XBEE_AIR_PACKET_OVERHEAD) * 8000000) / g_ui32AirRate;
+}
+
+//*****************************************************************************
+//
+// Charge a packet of ui32Bytes about to be sent. Returns false, charging
+// nothing, if the budget is on and does not have it yet. A packet bigger
+// than the whole bucket goes when the bucket is full.
+//
+//*****************************************************************************
+bool
+XBeeAirTake(uint32_t ui32Bytes)
+{
+	uint32_t ui32Us;
+
+	ui32Us = XBeeAirUs(ui32Bytes);
+	if(g_bAirOn)
+	{
+		XBeeAirRefill();
+		if((g_i32AirTokens < (int32_t)ui32Us) &&
+		   (g_i32AirTokens < XBeeAirCapacity()))
+		{
+			return false;
+		}
+	}
+
+	g_sAirStats.ui32Frames++;
+	XBeeAirSpend(ui32Us);
+	return true;
+}
+
+//*****************************************************************************
+//
+// ms until XBeeAirTake(ui32Bytes) would succeed.
+//
+//*****************************************************************************
+uint32_t
+XBeeAirWait(uint32_t ui32Bytes)
+{
+	int32_t i32Need;
+
+	if(!g_bAirOn)
+	{
+		return 0;
+	}
+
+	i32Need = (int32_t)XBeeAirUs(ui32Bytes);
+	if(i32Need > XBeeAirCapacity())
+	{
+		i32Need = XBeeAirCapacity();
+	}
+	if(g_i32AirTokens >= i32Need)
+	{
+		return 0;
+	}
+
+	return (uint32_t)(i32Need - g_i32AirTokens + g_ui32AirDuty - 1) /
+	       g_ui32AirDuty;
+}
+
+//*****************************************************************************
+//
+// The XBee reported ui32Retries extra tries of a packet of ui32Bytes.
+//
+//*****************************************************************************
+void
+XBeeAirRetries(uint32_t ui32Bytes, uint32_t ui32Retries)
+{
+	if(g_bAirOn)
+	{
+		XBeeAirRefill();
+	}
+	g_sAirStats.ui32Retries += ui32Retries;
+	XBeeAirSpend(XBeeAirUs(ui32Bytes) * ui32Retries);
+}
+
+void
+XBeeAirStatsGet(tXBeeAirStats *psStats)
+{
+	*psStats = g_sAirStats;
+}
+
+//*****************************************************************************
+//
+// Air Command
+// Input: none / 'on' / 'off' / 'clear' / 'rate <bit/s | br>' /
+//		'duty <per mille>' / 'window <s>'
+// Response: budget settings, air time in hand, the duty cycle used since
+//		the last clear and frames held back per class
+// Use: for the 868MHz XBees, to stay under the band's duty cycle. 'rate br'
+//		reads the RF data rate from ATBR (868LP: 0 is 10kbit/s, 1 is
+//		80kbit/s). 'on' starts with a full bucket.
+//
+//*****************************************************************************
+int
+Cmd_air(int argc, char *argv[])
+{
+	tXBeeSchedStats psSched[XBEE_SCHED_CLASSES];
+	uint64_t ui64Value;
+	uint32_t ui32Value;
+	uint32_t ui32Total;
+	uint32_t ui32Share;
+	uint32_t ui32Class;
+	int32_t i32Hand;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "on")))
+	{
+		g_bAirOn = true;
+		g_i32AirTokens = XBeeAirCapacity();
+		g_ui32AirTick = XBeeTickGet();
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "off")))
+	{
+		g_bAirOn = false;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sAirStats, 0, sizeof(g_sAirStats));
+		g_sAirStats.ui32StartTick = XBeeTickGet();
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "rate")))
+	{
+		if(0 == strcmp(argv[2], "br"))
+		{
+			if(XBeeBootGet("BR", &ui64Value) || (ui64Value > 1))
+			{
+				UARTprintf("Error: no usable answer to ATBR\n");
+				return 1;
+			}
+			ui32Value = ui64Value ? 80000 : 10000;
+		}
+		else
+		{
+			ui32Value = strtoul(argv[2], 0, 10);
+		}
+		if((ui32Value < 1000) || (ui32Value > 1000000))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		g_ui32AirRate = ui32Value;
+		return 0;
+	}
+	else if((3 == argc) && ((0 == strcmp(argv[1], "duty")) ||
+	                        (0 == strcmp(argv[1], "window"))))
+	{
+		ui32Value = strtoul(argv[2], 0, 10);
+		if(0 == strcmp(argv[1], "duty"))
+		{
+			ui32Total = g_ui32AirWindow * ui32Value;
+		}
+		else
+		{
+			ui32Total = g_ui32AirDuty * ui32Value;
+		}
+
+		//
+		// The bucket, and as much again below zero, must fit in an
+		// int32_t of us
+		//
+		if((ui32Value == 0) || (ui32Value > 3600) || (ui32Total > 1000000))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		if(0 == strcmp(argv[1], "duty"))
+		{
+			g_ui32AirDuty = ui32Value;
+		}
+		else
+		{
+			g_ui32AirWindow = ui32Value;
+		}
+		if(g_i32AirTokens > XBeeAirCapacity())
+		{
+			g_i32AirTokens = XBeeAirCapacity();
+		}
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	if(g_bAirOn)
+	{
+		XBeeAirRefill();
+	}
+	i32Hand = g_i32AirTokens / 1000;
+	ui32Total = XBeeTickGet() - g_sAirStats.ui32StartTick;
+	ui32Share = ui32Total ?
+	            (uint32_t)(((uint64_t)g_sAirStats.ui32AirMs * 1000) /
+	                       ui32Total) : 0;
+
+	UARTprintf("budget %s, %u bit/s, duty %u.%u%%, bucket %u ms\n",
+	           g_bAirOn ? "on" : "off", g_ui32AirRate, g_ui32AirDuty / 10,
+	           g_ui32AirDuty % 10, XBeeAirCapacity() / 1000);
+	if(g_bAirOn)
+	{
+		UARTprintf("in hand %d ms\n", i32Hand);
+	}
+	UARTprintf("air time %u ms of %u ms (%u.%u%%), %u packets, %u retries\n",
+	           g_sAirStats.ui32AirMs, ui32Total, ui32Share / 10,
+	           ui32Share % 10, g_sAirStats.ui32Frames,
+	           g_sAirStats.ui32Retries);
+
+	for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+	{
+		XBeeSchedStatsGet(ui32Class, &psSched[ui32Class]);
+	}
+	UARTprintf("held for budget: control %u, data %u, bulk %u\n",
+	           psSched[XBEE_SCHED_CONTROL].ui32Deferred,
+	           psSched[XBEE_SCHED_DATA].ui32Deferred,
+	           psSched[XBEE_SCHED_BULK].ui32Deferred);
+
+	return 0;
+}
@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// XBeeAir.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEAIR_H__
+#define __XBEEAIR_H__
+
+//*****************************************************************************
+//
+// Defaults: the XBee 868 RF data rate, and a duty cycle a little under the
+// 10% of the 869.4-869.65MHz sub band, so a full bucket spent on top of an
+// hour at the steady rate still stays inside what the radio allows per
+// hour. The bucket holds XBEE_AIR_WINDOW_S seconds worth of the duty cycle.
+//
+//*****************************************************************************
+#define XBEE_AIR_RATE_DEFAULT   24000
+#define XBEE_AIR_DUTY_DEFAULT   90          // per mille
+#define XBEE_AIR_WINDOW_DEFAULT 60          // s
+
+//*****************************************************************************
+//
+// Bytes on air per RF packet besides the payload: preamble, sync word,
+// PHY and MAC headers and CRC.
+//
+//*****************************************************************************
+#define XBEE_AIR_PACKET_OVERHEAD 30
+
+//*****************************************************************************
+//
+// Counters
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Frames;                // RF packets charged
+	uint32_t ui32Retries;               // extra tries charged after the fact
+	uint32_t ui32AirMs;                 // estimated air time spent
+	uint32_t ui32AirUs;                 // and the part of a ms
+	uint32_t ui32StartTick;             // counting since
+}
+tXBeeAirStats;
+
+//*****************************************************************************
+//
+// Airtime budget functions
+//
+//*****************************************************************************
+extern uint32_t XBeeAirBytes(const uint8_t *pui8Data, uint32_t ui32Len,
+                             uint32_t ui32Encoded);
+extern uint32_t XBeeAirUs(uint32_t ui32Bytes);
+extern bool XBeeAirTake(uint32_t ui32Bytes);
+extern uint32_t XBeeAirWait(uint32_t ui32Bytes);
+extern void XBeeAirRetries(uint32_t ui32Bytes, uint32_t ui32Retries);
+extern void XBeeAirStatsGet(tXBeeAirStats *psStats);
+extern int Cmd_air(int argc, char *argv[]);
+
+#endif //__XBEEAIR_H__
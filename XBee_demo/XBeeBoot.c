@@ -0,0 +1,406 @@
+//*****************************************************************************
+//
+// XBeeBoot.c - Boot time probe of the radio's mode and baud rate
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! In transparent mode anything written to the radio that is not +++ with
+//! its guard times goes out on air to the other nodes. So +++ is the only
+//! probe, tried at every baud rate the XBee supports, most common first.
+//! Only once it is answered, and the radio is in command mode, is ATAP read
+//! to tell API mode from transparent. An API mode radio is sent back with
+//! ATCN, a transparent one is left in command mode.
+//!
+//! Once the mode is known the values the firmware uses (serial number, MY,
+//! PAN ID) are read into g_sXBeeParams so nothing has to ask for them later.
+//!
+//! Whether the radio is still in command mode is tracked rather than asked:
+//! it is after +++ is answered, until ATCN or ATCT (XBEE_BOOT_CMD_MODE_MS)
+//! after the last answer. Cmd_EnterCmdMode() uses that to skip the guard
+//! times.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeSched.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeResp.h"
+#include "XBeeLink.h"
+#include "XBeeIdle.h"
+#include "XBeeChan.h"
+#include "XBeeIc.h"
+#include "XBeeBoot.h"
+
+#define BOOT_NO_ANSWER          0xFFFFFFFF
+
+//*****************************************************************************
+//
+// ATBD rates, 9600 (the factory setting) first
+//
+//*****************************************************************************
+static const uint32_t g_pui32BootBauds[] =
+{
+	9600, 115200, 57600, 38400, 19200, 4800, 2400, 1200
+};
+
+static tXBeeBootInfo g_sBootInfo;
+
+//*****************************************************************************
+//
+// Last API AT response, written by XBeeBootApiFrame()
+//
+//*****************************************************************************
+static volatile uint8_t g_ui8BootApiId;
+static volatile uint8_t g_ui8BootApiStatus;
+static volatile uint64_t g_ui64BootApiValue;
+static uint8_t g_ui8BootFrameId;
+
+static bool g_bBootCmdMode;
+
+//*****************************************************************************
+//
+// Keep the link serviced for ui32Ms.
+//
+//*****************************************************************************
+static void
+XBeeBootWait(uint32_t ui32Ms)
+{
+	uint32_t ui32Deadline;
+
+	ui32Deadline = XBeeTickGet() + ui32Ms;
+	while(!XBEE_TICK_REACHED(XBeeTickGet(), ui32Deadline))
+	{
+		XBeeLinkPoll();
+		XBeeIdleDeadline(ui32Deadline);
+		XBeeIdleEnter();
+	}
+}
+
+//*****************************************************************************
+//
+// Change rate and throw away whatever arrived at the old one.
+//
+//*****************************************************************************
+static void
+XBeeBootBaudSet(uint32_t ui32Baud)
+{
+	uint8_t pui8Junk[16];
+
+	XBeeUartBaudSet(ui32Baud);
+	while(XBeeUartRead(pui8Junk, sizeof(pui8Junk)))
+	{
+	}
+}
+
+//*****************************************************************************
+//
+// Response handler, stores the line type in *pvArg.
+//
+//*****************************************************************************
+static bool
+XBeeBootCapture(void *pvArg, const tXBeeResp *psResp)
+{
+	*(volatile uint32_t *)pvArg = psResp->ui32Type;
+	return true;
+}
+
+//*****************************************************************************
+//
+// Send pcText and wait up to ui32Ms for the reply. True if it was OK.
+//
+//*****************************************************************************
+static bool
+XBeeBootExpectOK(const char *pcText, uint32_t ui32Ms)
+{
+	volatile uint32_t ui32Type;
+
+	ui32Type = BOOT_NO_ANSWER;
+	if(!XBeeRespExpect(XBeeBootCapture, (void *)&ui32Type, ui32Ms))
+	{
+		return false;
+	}
+	XBeeSchedWrite(XBEE_SCHED_CONTROL, (const uint8_t *)pcText,
+	               strlen(pcText));
+
+	while(ui32Type == BOOT_NO_ANSWER)
+	{
+		XBeeLinkPoll();
+		XBeeIdleEnter();
+	}
+
+	return ui32Type == XBEE_RESP_OK;
+}
+
+//*****************************************************************************
+//
+// Link handler for AT command response frames. Those to a channel scan
+// go to XBeeChan.c.
+//
+//*****************************************************************************
+void
+XBeeBootApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint64_t ui64Value;
+	uint32_t ui32Index;
+
+	if((ui32Len < 5) || XBeeChanApiFrame(pui8Msg, ui32Len) ||
+	   XBeeIcApiFrame(pui8Msg, ui32Len))
+	{
+		return;
+	}
+
+	ui64Value = 0;
+	for(ui32Index = 5; (ui32Index < ui32Len) && (ui32Index < 13); ui32Index++)
+	{
+		ui64Value = (ui64Value << 8) | pui8Msg[ui32Index];
+	}
+
+	g_ui64BootApiValue = ui64Value;
+	g_ui8BootApiStatus = pui8Msg[4];
+	g_ui8BootApiId = pui8Msg[1];
+}
+
+//*****************************************************************************
+//
+// Read a parameter with an API AT command frame. Returns 0 with *pui64Value
+// set, 1 on error or no answer within ui32Ms.
+//
+//*****************************************************************************
+static int
+XBeeBootApiGet(const char *pcCmd, uint64_t *pui64Value, uint32_t ui32Ms)
+{
+	uint8_t pui8Msg[4];
+	uint32_t ui32Deadline;
+
+	if(++g_ui8BootFrameId == 0)
+	{
+		g_ui8BootFrameId = 1;
+	}
+	g_ui8BootApiId = 0;
+
+	pui8Msg[0] = XBEE_API_AT;
+	pui8Msg[1] = g_ui8BootFrameId;
+	pui8Msg[2] = pcCmd[0];
+	pui8Msg[3] = pcCmd[1];
+	XBeeFrameSend(pui8Msg, sizeof(pui8Msg));
+
+	ui32Deadline = XBeeTickGet() + ui32Ms;
+	while(g_ui8BootApiId != g_ui8BootFrameId)
+	{
+		if(XBEE_TICK_REACHED(XBeeTickGet(), ui32Deadline))
+		{
+			return 1;
+		}
+		XBeeLinkPoll();
+		XBeeIdleDeadline(ui32Deadline);
+		XBeeIdleEnter();
+	}
+
+	if(g_ui8BootApiStatus != 0)
+	{
+		return 1;
+	}
+
+	*pui64Value = g_ui64BootApiValue;
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Read a parameter in whichever mode the radio is in. Transparent mode
+// needs command mode entered first. Returns 0 on success.
+//
+//*****************************************************************************
+int
+XBeeBootGet(const char *pcCmd, uint64_t *pui64Value)
+{
+	if(g_sBootInfo.ui32Mode == XBEE_MODE_API)
+	{
+		return XBeeBootApiGet(pcCmd, pui64Value, XBEE_RESP_TIMEOUT_MS);
+	}
+
+	return XBeeATGet(pcCmd, pui64Value);
+}
+
+//*****************************************************************************
+//
+// Read the values the rest of the firmware needs into g_sXBeeParams.
+//
+//*****************************************************************************
+static void
+XBeeBootWarm(void)
+{
+	uint64_t ui64High;
+	uint64_t ui64Low;
+	uint64_t ui64Value;
+
+	if(!XBeeBootGet("SH", &ui64High) && !XBeeBootGet("SL", &ui64Low))
+	{
+		g_sXBeeParams.ui64Serial = (ui64High << 32) | (ui64Low & 0xFFFFFFFF);
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_SERIAL;
+	}
+	if(!XBeeBootGet("MY", &ui64Value))
+	{
+		g_sXBeeParams.ui16My = (uint16_t)ui64Value;
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_MY;
+	}
+	if(!XBeeBootGet("ID", &ui64Value))
+	{
+		g_sXBeeParams.ui16PanId = (uint16_t)ui64Value;
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_ID;
+	}
+}
+
+//*****************************************************************************
+//
+// Find the radio's mode and baud rate, leave UART1 at that rate and read the
+// basic parameters. Call once at boot, after XBeeLinkInit().
+//
+//*****************************************************************************
+void
+XBeeBootProbe(void)
+{
+	uint64_t ui64Value;
+	uint32_t ui32Start;
+	uint32_t ui32Index;
+
+	ui32Start = XBeeTickGet();
+	g_sBootInfo.ui32Mode = XBEE_MODE_UNKNOWN;
+	g_bBootCmdMode = false;
+
+	//
+	// +++ first, nothing else is safe to send before the radio answers
+	//
+	for(ui32Index = 0;
+	    (ui32Index < (sizeof(g_pui32BootBauds) / sizeof(uint32_t))) &&
+	    (g_sBootInfo.ui32Mode == XBEE_MODE_UNKNOWN); ui32Index++)
+	{
+		XBeeBootBaudSet(g_pui32BootBauds[ui32Index]);
+		XBeeBootWait(XBEE_BOOT_GUARD_MS);
+		if(!XBeeBootExpectOK("+++", XBEE_BOOT_GUARD_MS + 200))
+		{
+			continue;
+		}
+
+		//
+		// In command mode now, ask which mode the radio runs in
+		//
+		if(!XBeeATGet("AP", &ui64Value) && (ui64Value != 0))
+		{
+			XBeeBootExpectOK("ATCN\r", XBEE_RESP_TIMEOUT_MS);
+			g_sBootInfo.ui32Mode = XBEE_MODE_API;
+		}
+		else
+		{
+			g_sBootInfo.ui32Mode = XBEE_MODE_TRANSPARENT;
+			g_bBootCmdMode = true;
+		}
+	}
+
+	if(g_sBootInfo.ui32Mode == XBEE_MODE_UNKNOWN)
+	{
+		XBeeBootBaudSet(g_pui32BootBauds[0]);
+	}
+	else
+	{
+		XBeeBootWarm();
+	}
+
+	g_sBootInfo.ui32Baud = XBeeUartBaudGet();
+	g_sBootInfo.ui32ReadyMs = XBeeTickGet();
+	g_sBootInfo.ui32ProbeMs = g_sBootInfo.ui32ReadyMs - ui32Start;
+
+	Cmd_boot(0, 0);
+}
+
+//*****************************************************************************
+//
+// True if the radio is still in command mode: +++ was answered, no ATCN
+// since, and it has answered a command within XBEE_BOOT_CMD_MODE_MS. Used
+// to skip the +++ guard times. Nothing is sent to find out.
+//
+//*****************************************************************************
+bool
+XBeeBootCmdModeCheck(void)
+{
+	return g_bBootCmdMode &&
+	       !XBEE_TICK_REACHED(XBeeTickGet(),
+	                          XBeeRespLastTick() + XBEE_BOOT_CMD_MODE_MS);
+}
+
+//*****************************************************************************
+//
+// Note that the radio has entered (+++ answered OK) or left (ATCN) command
+// mode.
+//
+//*****************************************************************************
+void
+XBeeBootCmdModeSet(bool bCmdMode)
+{
+	g_bBootCmdMode = bCmdMode;
+}
+
+void
+XBeeBootInfoGet(tXBeeBootInfo *psInfo)
+{
+	*psInfo = g_sBootInfo;
+}
+
+//*****************************************************************************
+//
+// Boot Command
+// Input: none / 'probe'
+// Response: radio mode and baud rate found at boot, time to radio ready
+// Use: to see what the boot probe found, or to run it again after the
+//		radio has been reconfigured
+//
+//*****************************************************************************
+int
+Cmd_boot(int argc, char *argv[])
+{
+	static const char * const ppcModes[] =
+	{
+		"no answer", "transparent (now in command mode)", "API"
+	};
+
+	if((2 == argc) && (0 == strcmp(argv[1], "probe")))
+	{
+		XBeeBootProbe();
+		return 0;
+	}
+	else if(argc > 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("XBee %s at %d baud, ready %d ms after reset (probe %d ms)\n",
+	           ppcModes[g_sBootInfo.ui32Mode], g_sBootInfo.ui32Baud,
+	           g_sBootInfo.ui32ReadyMs, g_sBootInfo.ui32ProbeMs);
+	if(g_sXBeeParams.ui32Valid & XBEE_PARAM_SERIAL)
+	{
+		UARTprintf("serial %08x%08x, MY %04x, ID %04x\n",
+		           (uint32_t)(g_sXBeeParams.ui64Serial >> 32),
+		           (uint32_t)g_sXBeeParams.ui64Serial, g_sXBeeParams.ui16My,
+		           g_sXBeeParams.ui16PanId);
+	}
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+//*****************************************************************************
+//
+// XBeeBoot.h - Headers for use with XBeeBoot.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEBOOT_H__
+#define __XBEEBOOT_H__
+
+//*****************************************************************************
+//
+// Radio modes found by the boot probe
+//
+//*****************************************************************************
+#define XBEE_MODE_UNKNOWN       0
+#define XBEE_MODE_TRANSPARENT   1   // found with +++, left in command mode
+#define XBEE_MODE_API           2
+
+//*****************************************************************************
+//
+// Probe timing. +++ needs the guard time (ATGT, 1s by default) of silence
+// either side. The radio leaves command mode ATCT (10s by default) after
+// the last command; XBEE_BOOT_CMD_MODE_MS is kept a little under that.
+//
+//*****************************************************************************
+#define XBEE_BOOT_GUARD_MS      1100
+#define XBEE_BOOT_CMD_MODE_MS   9000
+
+//*****************************************************************************
+//
+// Outcome of the last probe
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Mode;
+	uint32_t ui32Baud;
+	uint32_t ui32ReadyMs;               // from XBeeTickInit() to radio ready
+	uint32_t ui32ProbeMs;               // time the probe itself took
+}
+tXBeeBootInfo;
+
+//*****************************************************************************
+//
+// Boot probe functions
+//
+//*****************************************************************************
+extern void XBeeBootProbe(void);
+extern bool XBeeBootCmdModeCheck(void);
+extern void XBeeBootCmdModeSet(bool bCmdMode);
+extern int XBeeBootGet(const char *pcCmd, uint64_t *pui64Value);
+extern void XBeeBootApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeBootInfoGet(tXBeeBootInfo *psInfo);
+extern int Cmd_boot(int argc, char *argv[]);
+
+#endif //__XBEEBOOT_H__
@@ -0,0 +1,452 @@
+//*****************************************************************************
+//
+// XBeeBridge.c - Transparent serial bridge between UART0 and UART1
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! 'bridge' turns the Launchpad into a plain serial cable between the PC
+//! (UART0) and the XBee (UART1), for X-CTU and the like, until the escape
+//! sequence in XBeeBridge.h comes from the PC.
+//!
+//! Each direction has two buffers. The receive interrupt of one UART
+//! fills one of them straight from the hardware FIFO, nothing else per
+//! byte; the bridge loop empties the other into the transmit FIFO of the
+//! other UART, and swaps the two once it has finished its buffer and the
+//! interrupt has something waiting. Neither side ever waits on the other
+//! while a buffer is free.
+//!
+//! If both buffers towards the PC are full, the UART1 interrupt stops
+//! reading and, with flow control on, RTS holds the XBee off until the
+//! loop catches up, so nothing is lost. UART0 has no flow control, so
+//! bytes from the PC that find both buffers full are dropped and counted;
+//! at the same baud rate on both sides that cannot happen, the loop
+//! empties a buffer faster than the line fills one.
+//!
+//! The link stack (frames, responses, timers) is paused meanwhile. Bytes
+//! the XBee sent before the bridge started are passed on first.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/uart.h"
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeIdle.h"
+#include "XBeeBridge.h"
+
+//*****************************************************************************
+//
+// One direction. The interrupt owns pui8Buf[ui32Fill], the loop the other
+// one, sending it from ui32Pos. Only the loop changes ui32Fill.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint8_t pui8Buf[2][XBEE_BRIDGE_BUF_SIZE];
+	volatile uint32_t pui32Len[2];
+	volatile uint32_t ui32Fill;
+	uint32_t ui32Pos;
+	uint32_t ui32RxBase;
+	uint32_t ui32TxBase;
+	volatile bool bThrottled;
+	tXBeeBridgeStats sStats;
+}
+tXBeeBridgePipe;
+
+static tXBeeBridgePipe g_psBridgePipes[XBEE_BRIDGE_DIRS];
+
+//*****************************************************************************
+//
+// Escape detection: when the PC last sent anything, and whether it had
+// been quiet for the guard time when the buffer now filling was started.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32BridgePcTick;
+static bool g_bBridgeArmed;
+
+//*****************************************************************************
+//
+// Empty the receive FIFO of a pipe into its fill buffer. Returns with the
+// FIFO not empty only if both buffers are full; then flow control holds
+// the sender off, or the rest is dropped.
+//
+//*****************************************************************************
+static void
+XBeeBridgeFill(tXBeeBridgePipe *psPipe, bool bFlowControl)
+{
+	uint8_t *pui8Buf;
+	uint32_t ui32Len;
+	uint32_t ui32Fill;
+
+	ui32Fill = psPipe->ui32Fill;
+	pui8Buf = psPipe->pui8Buf[ui32Fill];
+	ui32Len = psPipe->pui32Len[ui32Fill];
+
+	while((ui32Len < XBEE_BRIDGE_BUF_SIZE) &&
+	      ROM_UARTCharsAvail(psPipe->ui32RxBase))
+	{
+		pui8Buf[ui32Len++] =
+		        (uint8_t)ROM_UARTCharGetNonBlocking(psPipe->ui32RxBase);
+	}
+	psPipe->pui32Len[ui32Fill] = ui32Len;
+
+	if((ui32Len == XBEE_BRIDGE_BUF_SIZE) &&
+	   ROM_UARTCharsAvail(psPipe->ui32RxBase))
+	{
+		if(bFlowControl)
+		{
+			ROM_UARTIntDisable(psPipe->ui32RxBase, UART_INT_RX | UART_INT_RT);
+			psPipe->bThrottled = true;
+			psPipe->sStats.ui32Throttled++;
+		}
+		else
+		{
+			while(ROM_UARTCharsAvail(psPipe->ui32RxBase))
+			{
+				ROM_UARTCharGetNonBlocking(psPipe->ui32RxBase);
+				psPipe->sStats.ui32Dropped++;
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// UART0 interrupt while bridging: bytes from the PC.
+//
+//*****************************************************************************
+static void
+XBeeBridgeUart0Isr(void)
+{
+	uint32_t ui32Status;
+
+	ui32Status = ROM_UARTIntStatus(UART0_BASE, true);
+	ROM_UARTIntClear(UART0_BASE, ui32Status);
+	if(ui32Status & UART_INT_OE)
+	{
+		g_psBridgePipes[XBEE_BRIDGE_TO_XBEE].sStats.ui32Overruns++;
+	}
+
+	g_ui32BridgePcTick = XBeeTickGet();
+	XBeeBridgeFill(&g_psBridgePipes[XBEE_BRIDGE_TO_XBEE], false);
+}
+
+//*****************************************************************************
+//
+// UART1 interrupt while bridging: bytes from the XBee.
+//
+//*****************************************************************************
+static void
+XBeeBridgeUart1Isr(void)
+{
+	uint32_t ui32Status;
+
+	ui32Status = ROM_UARTIntStatus(UART1_BASE, true);
+	ROM_UARTIntClear(UART1_BASE, ui32Status);
+	if(ui32Status & UART_INT_OE)
+	{
+		g_psBridgePipes[XBEE_BRIDGE_TO_PC].sStats.ui32Overruns++;
+	}
+
+	if(!g_psBridgePipes[XBEE_BRIDGE_TO_PC].bThrottled)
+	{
+		XBeeBridgeFill(&g_psBridgePipes[XBEE_BRIDGE_TO_PC],
+		               XBeeUartFlowControlGet());
+	}
+}
+
+//*****************************************************************************
+//
+// Send what fits of the loop's buffer. Returns true once it is empty.
+//
+//*****************************************************************************
+static bool
+XBeeBridgeDrain(tXBeeBridgePipe *psPipe)
+{
+	uint8_t *pui8Buf;
+	uint32_t ui32Drain;
+	uint32_t ui32Len;
+	uint32_t ui32Pos;
+
+	ui32Drain = psPipe->ui32Fill ^ 1;
+	pui8Buf = psPipe->pui8Buf[ui32Drain];
+	ui32Len = psPipe->pui32Len[ui32Drain];
+	ui32Pos = psPipe->ui32Pos;
+
+	while((ui32Pos < ui32Len) && ROM_UARTSpaceAvail(psPipe->ui32TxBase))
+	{
+		ROM_UARTCharPutNonBlocking(psPipe->ui32TxBase, pui8Buf[ui32Pos++]);
+	}
+	psPipe->sStats.ui32Bytes += ui32Pos - psPipe->ui32Pos;
+
+	if(ui32Pos < ui32Len)
+	{
+		psPipe->ui32Pos = ui32Pos;
+		return false;
+	}
+
+	psPipe->pui32Len[ui32Drain] = 0;
+	psPipe->ui32Pos = 0;
+	return true;
+}
+
+//*****************************************************************************
+//
+// Take the interrupt's buffer, giving it the empty one, and let a held off
+// sender go again.
+//
+//*****************************************************************************
+static void
+XBeeBridgeSwap(tXBeeBridgePipe *psPipe, uint32_t ui32Int)
+{
+	ROM_IntMasterDisable();
+	psPipe->ui32Fill ^= 1;
+	ROM_IntMasterEnable();
+	psPipe->sStats.ui32Swaps++;
+
+	if(psPipe->bThrottled)
+	{
+		psPipe->bThrottled = false;
+		ROM_UARTIntEnable(psPipe->ui32RxBase, UART_INT_RX | UART_INT_RT);
+		ROM_IntPendSet(ui32Int);
+	}
+}
+
+//*****************************************************************************
+//
+// True if the n bytes are all the escape character, n no more than the
+// escape sequence.
+//
+//*****************************************************************************
+static bool
+XBeeBridgeEscapeHeld(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+	uint32_t ui32Index;
+
+	if(ui32Len > XBEE_BRIDGE_ESCAPE_COUNT)
+	{
+		return false;
+	}
+	for(ui32Index = 0; ui32Index < ui32Len; ui32Index++)
+	{
+		if(pui8Buf[ui32Index] != XBEE_BRIDGE_ESCAPE_CHAR)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Take UART0 and UART1 over from the console and the link.
+//
+//*****************************************************************************
+void
+XBeeBridgeStart(void)
+{
+	uint8_t pui8Buf[32];
+	uint32_t ui32Count;
+	uint32_t ui32Index;
+
+	while(!XBeeUartTxIdle())
+	{
+	}
+	while((ui32Count = XBeeUartRead(pui8Buf, sizeof(pui8Buf))) != 0)
+	{
+		for(ui32Index = 0; ui32Index < ui32Count; ui32Index++)
+		{
+			ROM_UARTCharPut(UART0_BASE, pui8Buf[ui32Index]);
+		}
+	}
+
+	memset(g_psBridgePipes, 0, sizeof(g_psBridgePipes));
+	g_psBridgePipes[XBEE_BRIDGE_TO_XBEE].ui32RxBase = UART0_BASE;
+	g_psBridgePipes[XBEE_BRIDGE_TO_XBEE].ui32TxBase = UART1_BASE;
+	g_psBridgePipes[XBEE_BRIDGE_TO_PC].ui32RxBase = UART1_BASE;
+	g_psBridgePipes[XBEE_BRIDGE_TO_PC].ui32TxBase = UART0_BASE;
+	g_ui32BridgePcTick = XBeeTickGet();
+	g_bBridgeArmed = false;
+
+	//
+	// Interrupt at half a FIFO, the timeout catches the tail of a burst
+	//
+	XBeeIdleUart0IsrSet(XBeeBridgeUart0Isr);
+	ROM_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+	ROM_UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+
+	XBeeUartIsrSet(XBeeBridgeUart1Isr);
+	ROM_UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+	ROM_IntPendSet(INT_UART1);
+}
+
+//*****************************************************************************
+//
+// Move data both ways. Returns false once the PC has sent the escape
+// sequence. Call in a tight loop.
+//
+//*****************************************************************************
+bool
+XBeeBridgePoll(void)
+{
+	tXBeeBridgePipe *psPipe;
+	uint32_t ui32Len;
+
+	psPipe = &g_psBridgePipes[XBEE_BRIDGE_TO_PC];
+	if(XBeeBridgeDrain(psPipe) && psPipe->pui32Len[psPipe->ui32Fill])
+	{
+		XBeeBridgeSwap(psPipe, INT_UART1);
+	}
+
+	//
+	// Towards the XBee, a buffer that could still become the escape
+	// sequence is held back
+	//
+	psPipe = &g_psBridgePipes[XBEE_BRIDGE_TO_XBEE];
+	ui32Len = psPipe->pui32Len[psPipe->ui32Fill];
+	if(ui32Len == 0)
+	{
+		g_bBridgeArmed = XBEE_TICK_REACHED(XBeeTickGet(), g_ui32BridgePcTick +
+		                                                  XBEE_BRIDGE_GUARD_MS);
+	}
+	if(XBeeBridgeDrain(psPipe) && ui32Len)
+	{
+		if(g_bBridgeArmed &&
+		   XBeeBridgeEscapeHeld(psPipe->pui8Buf[psPipe->ui32Fill], ui32Len))
+		{
+			if((ui32Len == XBEE_BRIDGE_ESCAPE_COUNT) &&
+			   XBEE_TICK_REACHED(XBeeTickGet(), g_ui32BridgePcTick +
+			                                    XBEE_BRIDGE_GUARD_MS))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			g_bBridgeArmed = false;
+			XBeeBridgeSwap(psPipe, INT_UART0);
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Finish what is buffered and give the UARTs back. The escape sequence
+// itself is thrown away.
+//
+//*****************************************************************************
+void
+XBeeBridgeStop(void)
+{
+	tXBeeBridgePipe *psPipe;
+
+	XBeeIdleUart0IsrSet(0);
+
+	psPipe = &g_psBridgePipes[XBEE_BRIDGE_TO_XBEE];
+	while(!XBeeBridgeDrain(psPipe))
+	{
+	}
+
+	//
+	// Towards the PC, both buffers in order, then the driver takes over
+	//
+	ROM_UARTIntDisable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+	psPipe = &g_psBridgePipes[XBEE_BRIDGE_TO_PC];
+	while(!XBeeBridgeDrain(psPipe))
+	{
+	}
+	psPipe->ui32Fill ^= 1;
+	while(!XBeeBridgeDrain(psPipe))
+	{
+	}
+	XBeeUartIsrSet(0);
+}
+
+void
+XBeeBridgeStatsGet(uint32_t ui32Dir, tXBeeBridgeStats *psStats)
+{
+	*psStats = g_psBridgePipes[ui32Dir].sStats;
+}
+
+//*****************************************************************************
+//
+// Print the counters of one direction.
+//
+//*****************************************************************************
+static void
+XBeeBridgeReport(const char *pcName, uint32_t ui32Dir)
+{
+	tXBeeBridgeStats *psStats;
+
+	psStats = &g_psBridgePipes[ui32Dir].sStats;
+	UARTprintf("%s: %u bytes, %u buffers, dropped %u, throttled %u, "
+	           "overruns %u\n", pcName, psStats->ui32Bytes,
+	           psStats->ui32Swaps, psStats->ui32Dropped,
+	           psStats->ui32Throttled, psStats->ui32Overruns);
+}
+
+//*****************************************************************************
+//
+// Bridge Command
+// Input: none / 'stats'
+// Response: counters for each direction once the bridge is left
+// Use: to let a PC tool talk to the XBee straight through UART0. Send
+//		Ctrl-] three times, with a second of silence before and after, to
+//		get the console back. 'stats' shows the last session again.
+//
+//*****************************************************************************
+int
+Cmd_bridge(int argc, char *argv[])
+{
+	if((2 == argc) && (0 == strcmp(argv[1], "stats")))
+	{
+		XBeeBridgeReport("pc -> xbee", XBEE_BRIDGE_TO_XBEE);
+		XBeeBridgeReport("xbee -> pc", XBEE_BRIDGE_TO_PC);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("bridge to the XBee at %u baud, ^]^]^] with 1s guard "
+	           "to return\n", XBeeUartBaudGet());
+	while(!XBeeUartTxIdle())
+	{
+	}
+
+	XBeeBridgeStart();
+	while(XBeeBridgePoll())
+	{
+	}
+	XBeeBridgeStop();
+
+	UARTprintf("\nbridge closed\n");
+	XBeeBridgeReport("pc -> xbee", XBEE_BRIDGE_TO_XBEE);
+	XBeeBridgeReport("xbee -> pc", XBEE_BRIDGE_TO_PC);
+
+	return 0;
+}
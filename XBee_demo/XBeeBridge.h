@@ -0,0 +1,75 @@
+//*****************************************************************************
+//
+// XBeeBridge.h - Headers for use with XBeeBridge.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEBRIDGE_H__
+#define __XBEEBRIDGE_H__
+
+//*****************************************************************************
+//
+// Size of each of the two buffers per direction
+//
+//*****************************************************************************
+#define XBEE_BRIDGE_BUF_SIZE    256
+
+//*****************************************************************************
+//
+// Escape back to the console: XBEE_BRIDGE_ESCAPE_COUNT of
+// XBEE_BRIDGE_ESCAPE_CHAR (Ctrl-]) from the PC with XBEE_BRIDGE_GUARD_MS of
+// silence before and after, the same shape as the XBee's own +++ so a
+// binary stream will not contain it by accident. The escape characters
+// are not passed on.
+//
+//*****************************************************************************
+#define XBEE_BRIDGE_ESCAPE_CHAR 0x1D
+#define XBEE_BRIDGE_ESCAPE_COUNT 3
+#define XBEE_BRIDGE_GUARD_MS    1000
+
+//*****************************************************************************
+//
+// Directions
+//
+//*****************************************************************************
+#define XBEE_BRIDGE_TO_XBEE     0   // UART0 -> UART1
+#define XBEE_BRIDGE_TO_PC       1   // UART1 -> UART0
+#define XBEE_BRIDGE_DIRS        2
+
+//*****************************************************************************
+//
+// Counters per direction
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Bytes;                 // passed on
+	uint32_t ui32Swaps;                 // buffers handed from ISR to loop
+	uint32_t ui32Dropped;               // both buffers full, no flow control
+	uint32_t ui32Throttled;             // both buffers full, held off by RTS
+	uint32_t ui32Overruns;              // hardware FIFO overruns
+}
+tXBeeBridgeStats;
+
+//*****************************************************************************
+//
+// Bridge functions
+//
+//*****************************************************************************
+extern void XBeeBridgeStart(void);
+extern bool XBeeBridgePoll(void);
+extern void XBeeBridgeStop(void);
+extern void XBeeBridgeStatsGet(uint32_t ui32Dir, tXBeeBridgeStats *psStats);
+extern int Cmd_bridge(int argc, char *argv[]);
+
+#endif //__XBEEBRIDGE_H__
@@ -0,0 +1,838 @@
+//*****************************************************************************
+//
+// XBeeBulk.c - Windowed bulk data transfer between two nodes
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! A transfer opens with START (length, fragment size, CRC-16 of the whole
+//! payload) which the receiver must acknowledge. The sender then keeps up to
+//! XBEE_BULK_WINDOW DATA fragments in flight. Each ACK carries the first
+//! fragment not yet received plus a bitmap of the 32 fragments after it, so
+//! the sender only resends the fragments that are really missing once their
+//! timer runs out.
+//!
+//! Fragments are read straight out of the caller's buffer on every
+//! (re)transmit and written straight into the receiver's buffer at their
+//! offset, no copy of the payload is kept anywhere else.
+//!
+//! Messages:
+//!   START  type, flags, session, length (4), fragment size (2), crc (2)
+//!   DATA   type, flags, session, fragment number (2), payload
+//!   ACK    type, flags, session, next expected fragment (2), bitmap (4)
+//!   NAK    type, flags, session, reason
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeQual.h"
+#include "XBeeIdle.h"
+#include "XBeeBulk.h"
+
+//*****************************************************************************
+//
+// Transfer states
+//
+//*****************************************************************************
+#define BULK_IDLE               0
+#define BULK_STARTING           1
+#define BULK_SENDING            2
+#define BULK_ARMED              3
+#define BULK_RECEIVING          4
+#define BULK_DONE               5
+
+#define BULK_START_SIZE         11
+#define BULK_DATA_HDR_SIZE      5
+#define BULK_ACK_SIZE           9
+#define BULK_NAK_SIZE           4
+
+//*****************************************************************************
+//
+// Sender. ui32Acked bit i is set once fragment ui16Base + i is acknowledged.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32State;
+	const uint8_t *pui8Data;
+	uint32_t ui32Len;
+	uint32_t ui32FragSize;
+	uint32_t ui32Rto;
+	uint16_t ui16Frags;
+	uint16_t ui16Base;
+	uint16_t ui16Next;
+	uint16_t ui16Crc;
+	uint32_t ui32Acked;
+	uint32_t pui32SentAt[XBEE_BULK_WINDOW];
+	uint8_t ui8Session;
+	uint8_t ui8Tries;
+	uint32_t ui32StartTick;
+	uint32_t ui32ProgressTick;
+	uint32_t ui32Sent;
+	uint32_t ui32Retransmits;
+}
+tXBeeBulkTx;
+
+//*****************************************************************************
+//
+// Receiver. ui32Bitmap bit i is set once fragment ui16Base + 1 + i is in.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32State;
+	uint8_t *pui8Buf;
+	uint32_t ui32Size;
+	uint32_t ui32Len;
+	uint32_t ui32FragSize;
+	uint16_t ui16Frags;
+	uint16_t ui16Base;
+	uint16_t ui16Crc;
+	uint32_t ui32Bitmap;
+	uint8_t ui8Session;
+	uint8_t ui8Unacked;
+	uint32_t ui32AckDue;
+	uint32_t ui32StartTick;
+	uint32_t ui32LastTick;
+	uint32_t ui32Bytes;
+	uint32_t ui32Duplicates;
+}
+tXBeeBulkRx;
+
+static tXBeeBulkTx g_sBulkTx;
+static tXBeeBulkRx g_sBulkRx;
+
+//*****************************************************************************
+//
+// Session number of the last transfer sent. Kept apart from g_sBulkTx, which
+// is cleared for each transfer, and started from the tick count so a
+// receiver still answering for the last session before a reset is not
+// taken in by the first one after it.
+//
+//*****************************************************************************
+static uint8_t g_ui8BulkSession;
+static bool g_bBulkSessionSet;
+static uint8_t g_pui8BulkDemoBuf[XBEE_BULK_DEMO_BUF_SIZE];
+
+//*****************************************************************************
+//
+// Print the outcome of a transfer against the best the link can do.
+//
+//*****************************************************************************
+static void
+XBeeBulkReport(const char *pcName, uint32_t ui32Bytes, uint32_t ui32StartTick)
+{
+	uint32_t ui32Ms;
+	uint32_t ui32Rate;
+
+	ui32Ms = XBeeTickGet() - ui32StartTick;
+	if(ui32Ms == 0)
+	{
+		ui32Ms = 1;
+	}
+	ui32Rate = (uint32_t)(((uint64_t)ui32Bytes * 1000) / ui32Ms);
+
+	UARTprintf("%s: %u bytes in %u ms, %u bytes/s, %u%% of %u bytes/s link\n",
+	           pcName, ui32Bytes, ui32Ms, ui32Rate,
+	           (ui32Rate * 100) / XBeeLinkRate(), XBeeLinkRate());
+}
+
+//*****************************************************************************
+//
+// Sender messages
+//
+//*****************************************************************************
+static void
+XBeeBulkSendStart(void)
+{
+	uint8_t pui8Msg[BULK_START_SIZE];
+
+	pui8Msg[0] = XBEE_MSG_BULK_START;
+	pui8Msg[1] = 0;
+	pui8Msg[2] = g_sBulkTx.ui8Session;
+	XBEE_PUT32(&pui8Msg[3], g_sBulkTx.ui32Len);
+	XBEE_PUT16(&pui8Msg[7], g_sBulkTx.ui32FragSize);
+	XBEE_PUT16(&pui8Msg[9], g_sBulkTx.ui16Crc);
+	XBeeLinkSend(pui8Msg, BULK_START_SIZE);
+
+	g_sBulkTx.pui32SentAt[0] = XBeeTickGet();
+	g_sBulkTx.ui8Tries++;
+}
+
+static void
+XBeeBulkSendData(uint16_t ui16Seq)
+{
+	uint8_t pui8Msg[BULK_DATA_HDR_SIZE + XBEE_BULK_FRAG_MAX];
+	uint32_t ui32Offset;
+	uint32_t ui32Count;
+
+	ui32Offset = ui16Seq * g_sBulkTx.ui32FragSize;
+	ui32Count = g_sBulkTx.ui32Len - ui32Offset;
+	if(ui32Count > g_sBulkTx.ui32FragSize)
+	{
+		ui32Count = g_sBulkTx.ui32FragSize;
+	}
+
+	pui8Msg[0] = XBEE_MSG_BULK_DATA;
+	pui8Msg[1] = 0;
+	pui8Msg[2] = g_sBulkTx.ui8Session;
+	XBEE_PUT16(&pui8Msg[3], ui16Seq);
+	memcpy(&pui8Msg[BULK_DATA_HDR_SIZE], g_sBulkTx.pui8Data + ui32Offset,
+	       ui32Count);
+	XBeeLinkSend(pui8Msg, BULK_DATA_HDR_SIZE + ui32Count);
+
+	g_sBulkTx.pui32SentAt[ui16Seq % XBEE_BULK_WINDOW] = XBeeTickGet();
+	g_sBulkTx.ui32Sent++;
+}
+
+static void
+XBeeBulkTxEnd(const char *pcError)
+{
+	if(pcError)
+	{
+		UARTprintf("send: failed, %s\n", pcError);
+	}
+	else
+	{
+		XBeeBulkReport("send", g_sBulkTx.ui32Len, g_sBulkTx.ui32StartTick);
+	}
+	UARTprintf("send: %u fragments of %u bytes, %u retransmitted\n",
+	           g_sBulkTx.ui32Sent, g_sBulkTx.ui32FragSize,
+	           g_sBulkTx.ui32Retransmits);
+
+	g_sBulkTx.ui32State = BULK_IDLE;
+}
+
+//*****************************************************************************
+//
+// Start sending ui32Len bytes from pui8Data, which must stay valid until the
+// transfer ends. Returns non zero if a transfer is already running or the
+// arguments are out of range. Progress is made by XBeeBulkPoll().
+//
+//*****************************************************************************
+int
+XBeeBulkSend(const uint8_t *pui8Data, uint32_t ui32Len, uint32_t ui32FragSize)
+{
+	if((g_sBulkTx.ui32State != BULK_IDLE) || (ui32Len == 0) ||
+	   (ui32FragSize < XBEE_BULK_FRAG_MIN) ||
+	   (ui32FragSize > XBEE_BULK_FRAG_MAX) ||
+	   (((ui32Len + ui32FragSize - 1) / ui32FragSize) > 0xFFFF))
+	{
+		return 1;
+	}
+
+	memset(&g_sBulkTx, 0, sizeof(g_sBulkTx));
+	g_sBulkTx.pui8Data = pui8Data;
+	g_sBulkTx.ui32Len = ui32Len;
+	g_sBulkTx.ui32FragSize = ui32FragSize;
+	g_sBulkTx.ui16Frags = (ui32Len + ui32FragSize - 1) / ui32FragSize;
+	g_sBulkTx.ui16Crc = XBeeCrc16(0xFFFF, pui8Data, ui32Len);
+	g_sBulkTx.ui32Rto = XBEE_BULK_RTO_MIN_MS +
+	                    ((2000 * XBEE_BULK_WINDOW * (ui32FragSize + 10)) /
+	                     XBeeLinkRate());
+	if(!g_bBulkSessionSet)
+	{
+		g_ui8BulkSession = (uint8_t)XBeeTickGet();
+		g_bBulkSessionSet = true;
+	}
+	g_sBulkTx.ui8Session = ++g_ui8BulkSession;
+	g_sBulkTx.ui32StartTick = XBeeTickGet();
+	g_sBulkTx.ui32ProgressTick = g_sBulkTx.ui32StartTick;
+	g_sBulkTx.ui32State = BULK_STARTING;
+
+	XBeeBulkSendStart();
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Receiver messages
+//
+//*****************************************************************************
+static void
+XBeeBulkSendAck(void)
+{
+	uint8_t pui8Msg[BULK_ACK_SIZE];
+
+	pui8Msg[0] = XBEE_MSG_BULK_ACK;
+	pui8Msg[1] = 0;
+	pui8Msg[2] = g_sBulkRx.ui8Session;
+	XBEE_PUT16(&pui8Msg[3], g_sBulkRx.ui16Base);
+	XBEE_PUT32(&pui8Msg[5], g_sBulkRx.ui32Bitmap);
+	XBeeLinkSend(pui8Msg, BULK_ACK_SIZE);
+
+	g_sBulkRx.ui8Unacked = 0;
+}
+
+static void
+XBeeBulkSendNak(uint8_t ui8Session, uint8_t ui8Reason)
+{
+	uint8_t pui8Msg[BULK_NAK_SIZE];
+
+	pui8Msg[0] = XBEE_MSG_BULK_NAK;
+	pui8Msg[1] = 0;
+	pui8Msg[2] = ui8Session;
+	pui8Msg[3] = ui8Reason;
+	XBeeLinkSend(pui8Msg, BULK_NAK_SIZE);
+}
+
+static void
+XBeeBulkRxEnd(const char *pcError)
+{
+	if(pcError)
+	{
+		UARTprintf("recv: failed, %s\n", pcError);
+		g_sBulkRx.ui32State = BULK_IDLE;
+		return;
+	}
+
+	XBeeBulkReport("recv", g_sBulkRx.ui32Bytes, g_sBulkRx.ui32StartTick);
+	UARTprintf("recv: %u duplicates", g_sBulkRx.ui32Duplicates);
+	if(g_sBulkRx.pui8Buf)
+	{
+		UARTprintf(", CRC %s",
+		           (XBeeCrc16(0xFFFF, g_sBulkRx.pui8Buf, g_sBulkRx.ui32Len) ==
+		            g_sBulkRx.ui16Crc) ? "good" : "BAD");
+	}
+	UARTprintf("\n");
+
+	//
+	// Keep answering for this session in case the last ACK was lost
+	//
+	g_sBulkRx.ui32State = BULK_DONE;
+}
+
+//*****************************************************************************
+//
+// Get ready to receive one transfer into pui8Buf (ui32Size bytes), or
+// discard the data if pui8Buf is 0. Returns non zero if a transfer is in
+// progress.
+//
+//*****************************************************************************
+int
+XBeeBulkRecv(uint8_t *pui8Buf, uint32_t ui32Size)
+{
+	if(g_sBulkRx.ui32State == BULK_RECEIVING)
+	{
+		return 1;
+	}
+
+	memset(&g_sBulkRx, 0, sizeof(g_sBulkRx));
+	g_sBulkRx.pui8Buf = pui8Buf;
+	g_sBulkRx.ui32Size = ui32Size;
+	g_sBulkRx.ui32State = BULK_ARMED;
+
+	return 0;
+}
+
+bool
+XBeeBulkTxBusy(void)
+{
+	return g_sBulkTx.ui32State != BULK_IDLE;
+}
+
+bool
+XBeeBulkRxBusy(void)
+{
+	return g_sBulkRx.ui32State == BULK_RECEIVING;
+}
+
+//*****************************************************************************
+//
+// Handle START at the receiver.
+//
+//*****************************************************************************
+static void
+XBeeBulkRxStart(const uint8_t *pui8Msg)
+{
+	uint32_t ui32Len;
+	uint32_t ui32FragSize;
+
+	//
+	// Repeated START, our ACK was lost. Only if it describes the same
+	// transfer: a session number that wrapped or came after a reset of the
+	// sender must not be answered with the last transfer's ACK.
+	//
+	if(((g_sBulkRx.ui32State == BULK_RECEIVING) ||
+	    (g_sBulkRx.ui32State == BULK_DONE)) &&
+	   (g_sBulkRx.ui8Session == pui8Msg[2]) &&
+	   (g_sBulkRx.ui32Len == XBEE_GET32(&pui8Msg[3])) &&
+	   (g_sBulkRx.ui32FragSize == XBEE_GET16(&pui8Msg[7])) &&
+	   (g_sBulkRx.ui16Crc == XBEE_GET16(&pui8Msg[9])))
+	{
+		XBeeBulkSendAck();
+		return;
+	}
+
+	if((g_sBulkRx.ui32State != BULK_ARMED) &&
+	   (g_sBulkRx.ui32State != BULK_RECEIVING))
+	{
+		XBeeBulkSendNak(pui8Msg[2], XBEE_BULK_NAK_NOT_READY);
+		return;
+	}
+
+	ui32Len = XBEE_GET32(&pui8Msg[3]);
+	ui32FragSize = XBEE_GET16(&pui8Msg[7]);
+	if((ui32FragSize < XBEE_BULK_FRAG_MIN) ||
+	   (ui32FragSize > XBEE_BULK_FRAG_MAX))
+	{
+		XBeeBulkSendNak(pui8Msg[2], XBEE_BULK_NAK_FRAG_SIZE);
+		return;
+	}
+	if(g_sBulkRx.pui8Buf && (ui32Len > g_sBulkRx.ui32Size))
+	{
+		XBeeBulkSendNak(pui8Msg[2], XBEE_BULK_NAK_TOO_BIG);
+		return;
+	}
+
+	g_sBulkRx.ui8Session = pui8Msg[2];
+	g_sBulkRx.ui32Len = ui32Len;
+	g_sBulkRx.ui32FragSize = ui32FragSize;
+	g_sBulkRx.ui16Frags = (ui32Len + ui32FragSize - 1) / ui32FragSize;
+	g_sBulkRx.ui16Crc = XBEE_GET16(&pui8Msg[9]);
+	g_sBulkRx.ui16Base = 0;
+	g_sBulkRx.ui32Bitmap = 0;
+	g_sBulkRx.ui32Bytes = 0;
+	g_sBulkRx.ui32Duplicates = 0;
+	g_sBulkRx.ui32StartTick = XBeeTickGet();
+	g_sBulkRx.ui32LastTick = g_sBulkRx.ui32StartTick;
+	g_sBulkRx.ui32State = BULK_RECEIVING;
+
+	XBeeBulkSendAck();
+}
+
+//*****************************************************************************
+//
+// Handle DATA at the receiver.
+//
+//*****************************************************************************
+static void
+XBeeBulkRxData(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Offset;
+	uint32_t ui32Count;
+	uint16_t ui16Seq;
+	bool bAckNow;
+
+	if((g_sBulkRx.ui8Session != pui8Msg[2]) ||
+	   ((g_sBulkRx.ui32State != BULK_RECEIVING) &&
+	    (g_sBulkRx.ui32State != BULK_DONE)))
+	{
+		return;
+	}
+
+	ui16Seq = XBEE_GET16(&pui8Msg[3]);
+	ui32Count = ui32Len - BULK_DATA_HDR_SIZE;
+	ui32Offset = ui16Seq * g_sBulkRx.ui32FragSize;
+	if((ui16Seq >= g_sBulkRx.ui16Frags) ||
+	   (ui32Count != (((g_sBulkRx.ui32Len - ui32Offset) <
+	                   g_sBulkRx.ui32FragSize) ?
+	                  (g_sBulkRx.ui32Len - ui32Offset) :
+	                  g_sBulkRx.ui32FragSize)))
+	{
+		return;
+	}
+
+	//
+	// A fragment of the finished transfer, the sender missed the last ACK
+	//
+	if(g_sBulkRx.ui32State == BULK_DONE)
+	{
+		XBeeBulkSendAck();
+		return;
+	}
+
+	g_sBulkRx.ui32LastTick = XBeeTickGet();
+	bAckNow = false;
+
+	if(ui16Seq < g_sBulkRx.ui16Base)
+	{
+		//
+		// Already have it, the sender missed an ACK
+		//
+		g_sBulkRx.ui32Duplicates++;
+		XBeeBulkSendAck();
+		return;
+	}
+	else if(ui16Seq == g_sBulkRx.ui16Base)
+	{
+		//
+		// In order, slide past it and anything already held after it
+		//
+		g_sBulkRx.ui16Base++;
+		while(g_sBulkRx.ui32Bitmap & 1)
+		{
+			g_sBulkRx.ui16Base++;
+			g_sBulkRx.ui32Bitmap >>= 1;
+		}
+		g_sBulkRx.ui32Bitmap >>= 1;
+	}
+	else if((ui16Seq - g_sBulkRx.ui16Base) <= 32)
+	{
+		//
+		// Out of order, something before it went missing
+		//
+		if(g_sBulkRx.ui32Bitmap & (1UL << (ui16Seq - g_sBulkRx.ui16Base - 1)))
+		{
+			g_sBulkRx.ui32Duplicates++;
+			XBeeBulkSendAck();
+			return;
+		}
+		g_sBulkRx.ui32Bitmap |= 1UL << (ui16Seq - g_sBulkRx.ui16Base - 1);
+		bAckNow = true;
+	}
+	else
+	{
+		return;
+	}
+
+	if(g_sBulkRx.pui8Buf)
+	{
+		memcpy(g_sBulkRx.pui8Buf + ui32Offset, &pui8Msg[BULK_DATA_HDR_SIZE],
+		       ui32Count);
+	}
+	g_sBulkRx.ui32Bytes += ui32Count;
+
+	if(g_sBulkRx.ui8Unacked++ == 0)
+	{
+		g_sBulkRx.ui32AckDue = XBeeTickGet() + XBEE_BULK_ACK_DELAY_MS;
+	}
+
+	if(g_sBulkRx.ui16Base == g_sBulkRx.ui16Frags)
+	{
+		XBeeBulkSendAck();
+		XBeeBulkRxEnd(0);
+	}
+	else if(bAckNow || (g_sBulkRx.ui8Unacked >= XBEE_BULK_ACK_EVERY))
+	{
+		XBeeBulkSendAck();
+	}
+}
+
+//*****************************************************************************
+//
+// Handle ACK at the sender.
+//
+//*****************************************************************************
+static void
+XBeeBulkTxAck(const uint8_t *pui8Msg)
+{
+	uint16_t ui16Base;
+	uint16_t ui16Seq;
+	uint32_t ui32Shift;
+
+	if(g_sBulkTx.ui8Session != pui8Msg[2])
+	{
+		return;
+	}
+
+	if(g_sBulkTx.ui32State == BULK_STARTING)
+	{
+		g_sBulkTx.ui32State = BULK_SENDING;
+		g_sBulkTx.ui32ProgressTick = XBeeTickGet();
+	}
+	if(g_sBulkTx.ui32State != BULK_SENDING)
+	{
+		return;
+	}
+
+	ui16Base = XBEE_GET16(&pui8Msg[3]);
+	if((ui16Base < g_sBulkTx.ui16Base) || (ui16Base > g_sBulkTx.ui16Next))
+	{
+		return;
+	}
+
+	if(ui16Base > g_sBulkTx.ui16Base)
+	{
+		ui32Shift = ui16Base - g_sBulkTx.ui16Base;
+
+		//
+		// Transparent mode has no transmit status, link quality learns
+		// from fragments acknowledged and retransmitted instead
+		//
+		if(!XBeeLinkApi())
+		{
+			for(ui16Seq = g_sBulkTx.ui16Base; ui16Seq != ui16Base; ui16Seq++)
+			{
+				XBeeQualResult(XBeeLinkDestGet(), true,
+				               g_sBulkTx.ui32FragSize);
+			}
+		}
+		g_sBulkTx.ui32Acked = (ui32Shift >= 32) ? 0 :
+		                      (g_sBulkTx.ui32Acked >> ui32Shift);
+		g_sBulkTx.ui16Base = ui16Base;
+		g_sBulkTx.ui32ProgressTick = XBeeTickGet();
+	}
+	g_sBulkTx.ui32Acked |= XBEE_GET32(&pui8Msg[5]) << 1;
+
+	if(g_sBulkTx.ui16Base == g_sBulkTx.ui16Frags)
+	{
+		XBeeBulkTxEnd(0);
+	}
+}
+
+//*****************************************************************************
+//
+// Link handler for all bulk transfer messages.
+//
+//*****************************************************************************
+void
+XBeeBulkMsg(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	switch(pui8Msg[0])
+	{
+		case XBEE_MSG_BULK_START:
+		{
+			if(ui32Len >= BULK_START_SIZE)
+			{
+				XBeeBulkRxStart(pui8Msg);
+			}
+			break;
+		}
+
+		case XBEE_MSG_BULK_DATA:
+		{
+			if(ui32Len > BULK_DATA_HDR_SIZE)
+			{
+				XBeeBulkRxData(pui8Msg, ui32Len);
+			}
+			break;
+		}
+
+		case XBEE_MSG_BULK_ACK:
+		{
+			if(ui32Len >= BULK_ACK_SIZE)
+			{
+				XBeeBulkTxAck(pui8Msg);
+			}
+			break;
+		}
+
+		case XBEE_MSG_BULK_NAK:
+		{
+			if((ui32Len >= BULK_NAK_SIZE) &&
+			   (g_sBulkTx.ui32State != BULK_IDLE) &&
+			   (g_sBulkTx.ui8Session == pui8Msg[2]))
+			{
+				XBeeBulkTxEnd((pui8Msg[3] == XBEE_BULK_NAK_TOO_BIG) ?
+				              "too big for receiver" :
+				              (pui8Msg[3] == XBEE_BULK_NAK_FRAG_SIZE) ?
+				              "fragment size refused" :
+				              "receiver not ready (recv)");
+			}
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Run the transfer timers, send new fragments while the window allows and
+// resend any whose timer has run out. Called from XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeBulkPoll(void)
+{
+	uint32_t ui32Now;
+	uint16_t ui16Seq;
+
+	ui32Now = XBeeTickGet();
+
+	if(g_sBulkTx.ui32State == BULK_STARTING)
+	{
+		XBeeIdleDeadline(g_sBulkTx.pui32SentAt[0] + g_sBulkTx.ui32Rto);
+		if(XBEE_TICK_REACHED(ui32Now, g_sBulkTx.pui32SentAt[0] +
+		                              g_sBulkTx.ui32Rto))
+		{
+			if(g_sBulkTx.ui8Tries >= XBEE_BULK_START_TRIES)
+			{
+				XBeeBulkTxEnd("no answer from receiver");
+			}
+			else
+			{
+				XBeeBulkSendStart();
+			}
+		}
+	}
+	else if(g_sBulkTx.ui32State == BULK_SENDING)
+	{
+		//
+		// Selective retransmit, only unacknowledged fragments whose timer
+		// has run out
+		//
+		for(ui16Seq = g_sBulkTx.ui16Base; ui16Seq != g_sBulkTx.ui16Next;
+		    ui16Seq++)
+		{
+			if(!(g_sBulkTx.ui32Acked & (1UL << (ui16Seq -
+			                                    g_sBulkTx.ui16Base))) &&
+			   XBEE_TICK_REACHED(ui32Now,
+			        g_sBulkTx.pui32SentAt[ui16Seq % XBEE_BULK_WINDOW] +
+			        g_sBulkTx.ui32Rto))
+			{
+				g_sBulkTx.ui32Retransmits++;
+				if(!XBeeLinkApi())
+				{
+					XBeeQualResult(XBeeLinkDestGet(), false,
+					               g_sBulkTx.ui32FragSize);
+				}
+				XBeeBulkSendData(ui16Seq);
+			}
+			if(!(g_sBulkTx.ui32Acked & (1UL << (ui16Seq -
+			                                    g_sBulkTx.ui16Base))))
+			{
+				XBeeIdleDeadline(g_sBulkTx.pui32SentAt[ui16Seq %
+				                                       XBEE_BULK_WINDOW] +
+				                 g_sBulkTx.ui32Rto);
+			}
+		}
+
+		//
+		// Fill the window
+		//
+		while((g_sBulkTx.ui16Next < g_sBulkTx.ui16Frags) &&
+		      ((g_sBulkTx.ui16Next - g_sBulkTx.ui16Base) < XBEE_BULK_WINDOW) &&
+		      XBeeLinkSendReady())
+		{
+			XBeeBulkSendData(g_sBulkTx.ui16Next++);
+		}
+
+		XBeeIdleDeadline(g_sBulkTx.ui32ProgressTick + XBEE_BULK_GIVEUP_MS);
+		if(XBEE_TICK_REACHED(ui32Now, g_sBulkTx.ui32ProgressTick +
+		                              XBEE_BULK_GIVEUP_MS))
+		{
+			XBeeBulkTxEnd("no progress");
+		}
+	}
+
+	if(g_sBulkRx.ui32State == BULK_RECEIVING)
+	{
+		if(g_sBulkRx.ui8Unacked)
+		{
+			XBeeIdleDeadline(g_sBulkRx.ui32AckDue);
+		}
+		if(g_sBulkRx.ui8Unacked &&
+		   XBEE_TICK_REACHED(ui32Now, g_sBulkRx.ui32AckDue))
+		{
+			XBeeBulkSendAck();
+		}
+		XBeeIdleDeadline(g_sBulkRx.ui32LastTick + XBEE_BULK_GIVEUP_MS);
+		if(XBEE_TICK_REACHED(ui32Now, g_sBulkRx.ui32LastTick +
+		                              XBEE_BULK_GIVEUP_MS))
+		{
+			XBeeBulkRxEnd("sender went quiet");
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Send Command
+// Input: none for status / number of bytes [fragment size]
+// Response: throughput once the transfer completes
+// Use: to send part of the firmware image to a node that has run 'recv'.
+//		Fragment size defaults to what suits the link to the destination
+//		(see 'qual'), 16-95 allowed.
+//
+//*****************************************************************************
+int
+Cmd_send(int argc, char *argv[])
+{
+	uint32_t ui32Len;
+	uint32_t ui32FragSize;
+
+	if(1 == argc)
+	{
+		if(g_sBulkTx.ui32State == BULK_IDLE)
+		{
+			UARTprintf("send: idle\n");
+		}
+		else
+		{
+			UARTprintf("send: %u/%u fragments acknowledged, %u in flight, "
+			           "%u retransmitted\n", g_sBulkTx.ui16Base,
+			           g_sBulkTx.ui16Frags,
+			           g_sBulkTx.ui16Next - g_sBulkTx.ui16Base,
+			           g_sBulkTx.ui32Retransmits);
+		}
+		return 0;
+	}
+	else if(argc > 3)
+	{
+		UARTprintf("Error: too many arguements, try again\n");
+		return 1;
+	}
+
+	ui32Len = strtoul(argv[1], 0, 0);
+	ui32FragSize = (3 == argc) ? strtoul(argv[2], 0, 0) :
+	               XBeeQualFragSize(XBeeLinkDestGet());
+	if((ui32Len > XBEE_BULK_IMAGE_SIZE) ||
+	   XBeeBulkSend((const uint8_t *)XBEE_BULK_IMAGE_BASE, ui32Len,
+	                ui32FragSize))
+	{
+		UARTprintf("Error: invalid input or transfer running, try again\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Receive Command
+// Input: none / 'sink' / 'stop'
+// Response: throughput and CRC check once the transfer completes
+// Use: to get ready for one transfer from 'send'. Data goes to a 512 byte
+//		buffer, or is thrown away with 'sink' to test larger transfers.
+//
+//*****************************************************************************
+int
+Cmd_recv(int argc, char *argv[])
+{
+	if((2 == argc) && (0 == strcmp(argv[1], "stop")))
+	{
+		g_sBulkRx.ui32State = BULK_IDLE;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "sink")))
+	{
+		return XBeeBulkRecv(0, 0);
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	if(XBeeBulkRecv(g_pui8BulkDemoBuf, sizeof(g_pui8BulkDemoBuf)))
+	{
+		UARTprintf("Error: transfer running\n");
+		return 1;
+	}
+
+	return 0;
+}
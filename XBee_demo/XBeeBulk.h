@@ -0,0 +1,85 @@
+//*****************************************************************************
+//
+// XBeeBulk.h - Headers for use with XBeeBulk.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEBULK_H__
+#define __XBEEBULK_H__
+
+//*****************************************************************************
+//
+// Fragment sizes. The default keeps a framed fragment inside one Series 1
+// RF packet (100 bytes) so a lost packet only costs one fragment. The
+// largest still fits one API mode transmit request with its 5 byte header.
+//
+//*****************************************************************************
+#define XBEE_BULK_FRAG_DEFAULT  64
+#define XBEE_BULK_FRAG_MAX      95
+#define XBEE_BULK_FRAG_MIN      16
+
+//*****************************************************************************
+//
+// Fragments in flight without an acknowledgment (at most 32).
+//
+//*****************************************************************************
+#define XBEE_BULK_WINDOW        8
+
+//*****************************************************************************
+//
+// Timing. The retransmit timeout is XBEE_BULK_RTO_MIN_MS plus twice the
+// time a full window takes on the serial link.
+//
+//*****************************************************************************
+#define XBEE_BULK_RTO_MIN_MS    200
+#define XBEE_BULK_ACK_EVERY     4
+#define XBEE_BULK_ACK_DELAY_MS  50
+#define XBEE_BULK_START_TRIES   5
+#define XBEE_BULK_GIVEUP_MS     10000
+
+//*****************************************************************************
+//
+// Reasons sent in a NAK
+//
+//*****************************************************************************
+#define XBEE_BULK_NAK_NOT_READY 1
+#define XBEE_BULK_NAK_TOO_BIG   2
+#define XBEE_BULK_NAK_FRAG_SIZE 3
+
+//*****************************************************************************
+//
+// Demo receive buffer, and where 'send' reads from (the firmware image).
+//
+//*****************************************************************************
+#define XBEE_BULK_DEMO_BUF_SIZE 512
+#define XBEE_BULK_IMAGE_BASE    0x00000000
+#define XBEE_BULK_IMAGE_SIZE    0x00040000
+
+//*****************************************************************************
+//
+// Bulk transfer functions. XBeeBulkSend() reads the caller's buffer until the
+// transfer is over, XBeeBulkRecv() writes fragments straight into the
+// caller's buffer (0 to discard them).
+//
+//*****************************************************************************
+extern int XBeeBulkSend(const uint8_t *pui8Data, uint32_t ui32Len,
+                        uint32_t ui32FragSize);
+extern int XBeeBulkRecv(uint8_t *pui8Buf, uint32_t ui32Size);
+extern bool XBeeBulkTxBusy(void);
+extern bool XBeeBulkRxBusy(void);
+extern void XBeeBulkMsg(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeBulkPoll(void);
+extern int Cmd_send(int argc, char *argv[]);
+extern int Cmd_recv(int argc, char *argv[]);
+
+#endif //__XBEEBULK_H__
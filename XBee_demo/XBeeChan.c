@@ -0,0 +1,801 @@
+//*****************************************************************************
+//
+// XBeeChan.c - Quietest channel selection from energy detect scans
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! A scan reads the current channel (ATCH), has the radio measure the
+//! energy on every channel (ATED), scores them and, if a channel in the
+//! allowed mask is clearly quieter, moves there and saves it in one go:
+//! "ATCH <ch>,WR" in command mode, CH and WR frames in API mode.
+//!
+//! ATED answers with the peak energy seen on each channel in -dBm, as a
+//! comma separated line in command mode and one byte per channel in the
+//! AT response frame in API mode. Energy leaks into the neighbouring
+//! channels (a Wi-Fi channel covers four of them), so each channel is
+//! scored with its neighbours.
+//!
+//! Scans run as a sequence of steps from XBeeChanPoll(), so the link keeps
+//! running while the radio measures. A scan can also be started by the
+//! rescan interval or by transmit loss; those only run in API mode (or on
+//! the simulated channels) since command mode needs +++ and its guard
+//! times. The other nodes of the PAN have to be moved to the new channel
+//! as well; on 802.15.4 firmware nothing does that by itself.
+//!
+//! 'chan sim on' replaces the radio with synthetic per channel noise set
+//! by 'chan noise', which also raises the loss of the 'tx sim' radio on a
+//! noisy channel, so the loss triggered rescans can be tried out.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeSched.h"
+#include "XBeeResp.h"
+#include "XBeeBoot.h"
+#include "XBeeTx.h"
+#include "XBeeIdle.h"
+#include "XBeeChan.h"
+
+//*****************************************************************************
+//
+// Scan steps
+//
+//*****************************************************************************
+#define CHAN_IDLE               0
+#define CHAN_CH_WAIT            1   // current channel asked for
+#define CHAN_ED_SEND            2
+#define CHAN_ED_WAIT            3
+#define CHAN_PICK               4
+#define CHAN_SET_WAIT           5   // new channel and WR sent
+
+//*****************************************************************************
+//
+// Frame ID of the AT command frames sent in API mode
+//
+//*****************************************************************************
+#define CHAN_FRAME_ID           0xCE
+
+//*****************************************************************************
+//
+// Scan state and results. Energies are -dBm by channel, 0 if not measured.
+//
+//*****************************************************************************
+static uint32_t g_ui32ChanState;
+static uint32_t g_ui32ChanDeadline;
+static bool g_bChanApi;
+static uint8_t g_pui8ChanEnergy[XBEE_CHAN_COUNT];
+static uint32_t g_ui32ChanRead;
+static uint32_t g_ui32ChanOk;
+static uint8_t g_ui8ChanCurrent;        // 0 until read
+static uint8_t g_ui8ChanTarget;
+static uint16_t g_ui16ChanMask = 0xFFFF;
+static tXBeeChanStats g_sChanStats;
+
+//*****************************************************************************
+//
+// Rescans: interval (0 off), loss share in per mille (0 off) and the
+// transmit results at the last check
+//
+//*****************************************************************************
+static uint32_t g_ui32ChanIntervalMs;
+static uint32_t g_ui32ChanLoss;
+static uint32_t g_ui32ChanLastScan;
+static uint32_t g_ui32ChanCheckTick;
+static uint32_t g_ui32ChanTxDone;
+static uint32_t g_ui32ChanTxFailed;
+
+//*****************************************************************************
+//
+// Simulated channels: noise in dBm by channel (0 is the floor) and the
+// channel the simulated radio is on
+//
+//*****************************************************************************
+static bool g_bChanSim;
+static int8_t g_pi8ChanNoise[XBEE_CHAN_COUNT];
+static uint8_t g_ui8ChanSimCurrent = XBEE_CHAN_FIRST + 1;
+static uint32_t g_ui32ChanSimRand = 1;
+
+static bool XBeeChanResp(void *pvArg, const tXBeeResp *psResp);
+
+//*****************************************************************************
+//
+// Give up on the scan.
+//
+//*****************************************************************************
+static void
+XBeeChanFail(void)
+{
+	g_sChanStats.ui32Failed++;
+	g_ui32ChanState = CHAN_IDLE;
+	UARTprintf("chan: no answer from the radio, scan abandoned\n");
+}
+
+//*****************************************************************************
+//
+// Send AT command pcCmd, with ui32Param if bParam, as a frame in API mode
+// or a line in command mode, and allow a step's time for the answer. In
+// command mode a value is followed by WR on the same line.
+//
+//*****************************************************************************
+static void
+XBeeChanSend(const char *pcCmd, bool bParam, uint32_t ui32Param)
+{
+	uint8_t pui8Msg[5];
+	char pcLine[12];
+
+	g_ui32ChanDeadline = XBeeTickGet() + XBEE_CHAN_STEP_MS;
+
+	if(g_bChanApi)
+	{
+		pui8Msg[0] = XBEE_API_AT;
+		pui8Msg[1] = CHAN_FRAME_ID;
+		pui8Msg[2] = pcCmd[0];
+		pui8Msg[3] = pcCmd[1];
+		pui8Msg[4] = (uint8_t)ui32Param;
+		XBeeFrameSend(pui8Msg, bParam ? 5 : 4);
+		return;
+	}
+
+	if(!XBeeRespExpect(XBeeChanResp, 0, XBEE_CHAN_STEP_MS))
+	{
+		XBeeChanFail();
+		return;
+	}
+	if(bParam)
+	{
+		//
+		// Only CH is sent with a value, together with WR; the radio answers
+		// OK to each
+		//
+		usnprintf(pcLine, sizeof(pcLine), "AT%s%x,WR\r", pcCmd, ui32Param);
+	}
+	else
+	{
+		usnprintf(pcLine, sizeof(pcLine), "AT%s\r", pcCmd);
+	}
+	XBeeSchedWrite(XBEE_SCHED_CONTROL, (const uint8_t *)pcLine,
+	               strlen(pcLine));
+}
+
+//*****************************************************************************
+//
+// Store one energy reading, in the order the radio scans.
+//
+//*****************************************************************************
+static void
+XBeeChanEnergy(uint32_t ui32Value)
+{
+	if(g_ui32ChanRead < XBEE_CHAN_COUNT)
+	{
+		g_pui8ChanEnergy[g_ui32ChanRead++] = (uint8_t)ui32Value;
+	}
+}
+
+//*****************************************************************************
+//
+// All readings are in. A PRO radio only scans its 12 channels from 0x0C,
+// move those into place.
+//
+//*****************************************************************************
+static void
+XBeeChanScanned(void)
+{
+	if(g_ui32ChanRead == XBEE_CHAN_PRO_COUNT)
+	{
+		memmove(&g_pui8ChanEnergy[XBEE_CHAN_PRO_FIRST - XBEE_CHAN_FIRST],
+		        g_pui8ChanEnergy, XBEE_CHAN_PRO_COUNT);
+		memset(g_pui8ChanEnergy, 0, XBEE_CHAN_PRO_FIRST - XBEE_CHAN_FIRST);
+	}
+	else if(g_ui32ChanRead != XBEE_CHAN_COUNT)
+	{
+		XBeeChanFail();
+		return;
+	}
+
+	g_ui32ChanState = CHAN_PICK;
+}
+
+//*****************************************************************************
+//
+// Response handler for the command mode steps.
+//
+//*****************************************************************************
+static bool
+XBeeChanResp(void *pvArg, const tXBeeResp *psResp)
+{
+	const char *pcText;
+	const char *pcComma;
+	uint64_t ui64Value;
+	uint32_t ui32Len;
+
+	if(g_ui32ChanState == CHAN_IDLE)
+	{
+		return true;
+	}
+	if((psResp->ui32Type == XBEE_RESP_ERROR) ||
+	   (psResp->ui32Type == XBEE_RESP_TIMEOUT))
+	{
+		XBeeChanFail();
+		return true;
+	}
+
+	switch(g_ui32ChanState)
+	{
+		case CHAN_CH_WAIT:
+		{
+			if(psResp->ui32Type != XBEE_RESP_HEX)
+			{
+				XBeeChanFail();
+				return true;
+			}
+			g_ui8ChanCurrent = (uint8_t)psResp->ui64Value;
+			g_ui32ChanState = CHAN_ED_SEND;
+			return true;
+		}
+
+		case CHAN_ED_WAIT:
+		{
+			//
+			// One line of "44,4F,...", or one reading per line up to a
+			// blank line
+			//
+			if(psResp->ui32Type == XBEE_RESP_EMPTY)
+			{
+				XBeeChanScanned();
+				return true;
+			}
+			if(psResp->ui32Type == XBEE_RESP_HEX)
+			{
+				XBeeChanEnergy((uint32_t)psResp->ui64Value);
+				if(g_ui32ChanRead < XBEE_CHAN_COUNT)
+				{
+					return false;
+				}
+				XBeeChanScanned();
+				return true;
+			}
+
+			pcText = psResp->pcText;
+			ui32Len = psResp->ui32Len;
+			while(ui32Len)
+			{
+				pcComma = memchr(pcText, ',', ui32Len);
+				if(pcComma == 0)
+				{
+					pcComma = pcText + ui32Len;
+				}
+				if((pcComma != pcText) &&
+				   XBeeHexDecode(pcText, pcComma - pcText, &ui64Value))
+				{
+					XBeeChanEnergy((uint32_t)ui64Value);
+				}
+				ui32Len -= pcComma - pcText;
+				pcText = pcComma;
+				if(ui32Len)
+				{
+					pcText++;
+					ui32Len--;
+				}
+			}
+			XBeeChanScanned();
+			return true;
+		}
+
+		case CHAN_SET_WAIT:
+		{
+			//
+			// OK for CH, then OK for WR
+			//
+			if(psResp->ui32Type != XBEE_RESP_OK)
+			{
+				XBeeChanFail();
+				return true;
+			}
+			if(++g_ui32ChanOk < 2)
+			{
+				return false;
+			}
+			g_ui8ChanCurrent = g_ui8ChanTarget;
+			g_sChanStats.ui32Moves++;
+			g_ui32ChanState = CHAN_IDLE;
+			UARTprintf("chan: moved to channel 0x%02x\n", g_ui8ChanCurrent);
+			return true;
+		}
+
+		default:
+		{
+			return true;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// AT command response frame, from XBeeBootApiFrame(). Returns true if it
+// was the answer to a scan step.
+//
+//*****************************************************************************
+bool
+XBeeChanApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Index;
+
+	if((g_ui32ChanState == CHAN_IDLE) || (ui32Len < 5) ||
+	   (pui8Msg[1] != CHAN_FRAME_ID))
+	{
+		return false;
+	}
+	if(pui8Msg[4] != 0)
+	{
+		XBeeChanFail();
+		return true;
+	}
+
+	if((g_ui32ChanState == CHAN_CH_WAIT) && (pui8Msg[2] == 'C') &&
+	   (ui32Len > 5))
+	{
+		g_ui8ChanCurrent = pui8Msg[ui32Len - 1];
+		g_ui32ChanState = CHAN_ED_SEND;
+	}
+	else if((g_ui32ChanState == CHAN_ED_WAIT) && (pui8Msg[2] == 'E'))
+	{
+		for(ui32Index = 5; ui32Index < ui32Len; ui32Index++)
+		{
+			XBeeChanEnergy(pui8Msg[ui32Index]);
+		}
+		XBeeChanScanned();
+	}
+	else if((g_ui32ChanState == CHAN_SET_WAIT) && (pui8Msg[2] == 'W'))
+	{
+		g_ui8ChanCurrent = g_ui8ChanTarget;
+		g_sChanStats.ui32Moves++;
+		g_ui32ChanState = CHAN_IDLE;
+		UARTprintf("chan: moved to channel 0x%02x\n", g_ui8ChanCurrent);
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Score of channel index ui32Index: its energy twice and its neighbours',
+// a neighbour not measured counting as the channel itself. In 1/4 -dBm,
+// higher is quieter. 0 if the channel was not measured.
+//
+//*****************************************************************************
+static uint32_t
+XBeeChanScore(uint32_t ui32Index)
+{
+	uint32_t ui32Own;
+	uint32_t ui32Score;
+
+	ui32Own = g_pui8ChanEnergy[ui32Index];
+	if(ui32Own == 0)
+	{
+		return 0;
+	}
+
+	ui32Score = ui32Own * 2;
+	ui32Score += ((ui32Index > 0) && g_pui8ChanEnergy[ui32Index - 1]) ?
+	             g_pui8ChanEnergy[ui32Index - 1] : ui32Own;
+	ui32Score += ((ui32Index < (XBEE_CHAN_COUNT - 1)) &&
+	              g_pui8ChanEnergy[ui32Index + 1]) ?
+	             g_pui8ChanEnergy[ui32Index + 1] : ui32Own;
+
+	return ui32Score;
+}
+
+//*****************************************************************************
+//
+// Pick the quietest allowed channel and move there if it is worth it.
+//
+//*****************************************************************************
+static void
+XBeeChanPick(void)
+{
+	uint32_t ui32Index;
+	uint32_t ui32Best;
+	uint32_t ui32BestScore;
+	uint32_t ui32Current;
+	uint32_t ui32Score;
+
+	ui32Best = XBEE_CHAN_COUNT;
+	ui32BestScore = 0;
+	for(ui32Index = 0; ui32Index < XBEE_CHAN_COUNT; ui32Index++)
+	{
+		ui32Score = XBeeChanScore(ui32Index);
+		if((g_ui16ChanMask & (1 << ui32Index)) && (ui32Score > ui32BestScore))
+		{
+			ui32Best = ui32Index;
+			ui32BestScore = ui32Score;
+		}
+	}
+
+	g_ui32ChanState = CHAN_IDLE;
+	if(ui32Best == XBEE_CHAN_COUNT)
+	{
+		UARTprintf("chan: no allowed channel measured\n");
+		return;
+	}
+
+	ui32Current = g_ui8ChanCurrent - XBEE_CHAN_FIRST;
+	ui32Score = ((ui32Current < XBEE_CHAN_COUNT) &&
+	             (g_ui16ChanMask & (1 << ui32Current))) ?
+	            XBeeChanScore(ui32Current) : 0;
+	UARTprintf("chan: quietest 0x%02x at -%u dBm, current 0x%02x at -%u dBm\n",
+	           ui32Best + XBEE_CHAN_FIRST, ui32BestScore / 4, g_ui8ChanCurrent,
+	           ui32Score / 4);
+
+	if((ui32Best == ui32Current) || (ui32Score &&
+	   ((ui32BestScore - ui32Score) < (XBEE_CHAN_HYST_DB * 4))))
+	{
+		return;
+	}
+
+	g_ui8ChanTarget = ui32Best + XBEE_CHAN_FIRST;
+	if(g_bChanSim)
+	{
+		g_ui8ChanSimCurrent = g_ui8ChanTarget;
+		g_ui8ChanCurrent = g_ui8ChanTarget;
+		g_sChanStats.ui32Moves++;
+		UARTprintf("chan: moved to channel 0x%02x\n", g_ui8ChanCurrent);
+		return;
+	}
+
+	g_ui32ChanState = CHAN_SET_WAIT;
+	g_ui32ChanOk = 0;
+	XBeeChanSend("CH", true, g_ui8ChanTarget);
+	if(g_bChanApi)
+	{
+		XBeeChanSend("WR", false, 0);
+	}
+}
+
+//*****************************************************************************
+//
+// Fill in a scan from the simulated noise.
+//
+//*****************************************************************************
+static void
+XBeeChanSimScan(void)
+{
+	uint32_t ui32Index;
+	int32_t i32Noise;
+
+	for(ui32Index = 0; ui32Index < XBEE_CHAN_COUNT; ui32Index++)
+	{
+		g_ui32ChanSimRand = (g_ui32ChanSimRand * 1664525) + 1013904223;
+		i32Noise = g_pi8ChanNoise[ui32Index] ? g_pi8ChanNoise[ui32Index] :
+		           XBEE_CHAN_SIM_FLOOR;
+		i32Noise += (int32_t)((g_ui32ChanSimRand >> 16) %
+		                      ((XBEE_CHAN_SIM_JITTER * 2) + 1)) -
+		            XBEE_CHAN_SIM_JITTER;
+		XBeeChanEnergy(-i32Noise);
+	}
+	g_ui8ChanCurrent = g_ui8ChanSimCurrent;
+	XBeeChanScanned();
+}
+
+//*****************************************************************************
+//
+// Start a scan. Returns false if one is already running or the response
+// queue is full. In command mode the radio must be in command mode.
+//
+//*****************************************************************************
+bool
+XBeeChanScan(void)
+{
+	tXBeeBootInfo sInfo;
+
+	if(g_ui32ChanState != CHAN_IDLE)
+	{
+		return false;
+	}
+
+	g_sChanStats.ui32Scans++;
+	g_ui32ChanLastScan = XBeeTickGet();
+	g_ui32ChanRead = 0;
+	memset(g_pui8ChanEnergy, 0, sizeof(g_pui8ChanEnergy));
+
+	if(g_bChanSim)
+	{
+		XBeeChanSimScan();
+		return true;
+	}
+
+	XBeeBootInfoGet(&sInfo);
+	g_bChanApi = (sInfo.ui32Mode == XBEE_MODE_API);
+	g_ui32ChanState = CHAN_CH_WAIT;
+	XBeeChanSend("CH", false, 0);
+
+	return g_ui32ChanState != CHAN_IDLE;
+}
+
+//*****************************************************************************
+//
+// Start a scan if the transmit results since the last check lost too much.
+//
+//*****************************************************************************
+static bool
+XBeeChanLossCheck(uint32_t ui32Now)
+{
+	tXBeeTxStats sTx;
+	uint32_t ui32Done;
+	uint32_t ui32Failed;
+	bool bScan;
+
+	if(!XBEE_TICK_REACHED(ui32Now, g_ui32ChanCheckTick))
+	{
+		return false;
+	}
+	g_ui32ChanCheckTick = ui32Now + XBEE_CHAN_CHECK_MS;
+
+	XBeeTxStatsGet(&sTx);
+	ui32Failed = sTx.pui32Result[XBEE_TX_NO_ACK] +
+	             sTx.pui32Result[XBEE_TX_CCA_FAILURE] + sTx.ui32TimedOut;
+	ui32Done = ui32Failed + sTx.pui32Result[XBEE_TX_SUCCESS];
+
+	bScan = ((ui32Done - g_ui32ChanTxDone) >= XBEE_CHAN_MIN_FRAMES) &&
+	        (((ui32Failed - g_ui32ChanTxFailed) * 1000) >=
+	         ((ui32Done - g_ui32ChanTxDone) * g_ui32ChanLoss)) &&
+	        XBEE_TICK_REACHED(ui32Now,
+	                          g_ui32ChanLastScan + XBEE_CHAN_HOLDOFF_MS);
+
+	g_ui32ChanTxDone = ui32Done;
+	g_ui32ChanTxFailed = ui32Failed;
+
+	return bScan;
+}
+
+//*****************************************************************************
+//
+// Run the scan steps and the automatic rescans. Called from XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeChanPoll(void)
+{
+	tXBeeBootInfo sInfo;
+	uint32_t ui32Now;
+
+	ui32Now = XBeeTickGet();
+
+	switch(g_ui32ChanState)
+	{
+		case CHAN_IDLE:
+		{
+			if(!g_ui32ChanIntervalMs && !g_ui32ChanLoss)
+			{
+				break;
+			}
+			XBeeBootInfoGet(&sInfo);
+			if(!g_bChanSim && (sInfo.ui32Mode != XBEE_MODE_API))
+			{
+				break;
+			}
+
+			if(g_ui32ChanIntervalMs &&
+			   XBEE_TICK_REACHED(ui32Now,
+			                     g_ui32ChanLastScan + g_ui32ChanIntervalMs))
+			{
+				g_sChanStats.ui32TimedScans++;
+				XBeeChanScan();
+			}
+			else if(g_ui32ChanLoss && XBeeChanLossCheck(ui32Now))
+			{
+				g_sChanStats.ui32LossScans++;
+				XBeeChanScan();
+			}
+			else if(g_ui32ChanIntervalMs)
+			{
+				XBeeIdleDeadline(g_ui32ChanLastScan + g_ui32ChanIntervalMs);
+			}
+			break;
+		}
+
+		case CHAN_ED_SEND:
+		{
+			g_ui32ChanState = CHAN_ED_WAIT;
+			XBeeChanSend("ED", false, 0);
+			break;
+		}
+
+		case CHAN_PICK:
+		{
+			XBeeChanPick();
+			break;
+		}
+
+		default:
+		{
+			if(XBEE_TICK_REACHED(ui32Now, g_ui32ChanDeadline))
+			{
+				XBeeChanFail();
+			}
+			else
+			{
+				XBeeIdleDeadline(g_ui32ChanDeadline);
+			}
+			break;
+		}
+	}
+
+	if((g_ui32ChanState == CHAN_ED_SEND) || (g_ui32ChanState == CHAN_PICK))
+	{
+		XBeeIdleBusy();
+	}
+}
+
+//*****************************************************************************
+//
+// Extra byte loss of the simulated radio from the noise on its channel.
+//
+//*****************************************************************************
+uint32_t
+XBeeChanSimErrorPpm(void)
+{
+	int32_t i32Noise;
+
+	if(!g_bChanSim)
+	{
+		return 0;
+	}
+
+	i32Noise = g_pi8ChanNoise[g_ui8ChanSimCurrent - XBEE_CHAN_FIRST];
+	if((i32Noise == 0) || (i32Noise <= XBEE_CHAN_SIM_FLOOR))
+	{
+		return 0;
+	}
+
+	return (i32Noise - XBEE_CHAN_SIM_FLOOR) * XBEE_CHAN_SIM_PPM_PER_DB;
+}
+
+void
+XBeeChanStatsGet(tXBeeChanStats *psStats)
+{
+	*psStats = g_sChanStats;
+}
+
+//*****************************************************************************
+//
+// Chan Command
+// Input: none / 'scan' / 'mask <hex>' / 'auto <minutes | off>' /
+//		'loss <per mille | off>' / 'sim <on | off>' / 'noise <ch> <dBm>'
+// Response: energy and score of each channel from the last scan, the
+//		current channel, rescan settings and counters
+// Use: 'scan' finds the quietest channel in the mask and moves the radio
+//		there if it is XBEE_CHAN_HYST_DB better than the current one; in
+//		command mode enter it (+++) first. 'auto' rescans every so many
+//		minutes, 'loss' when that share of transmits fails (API mode).
+//		'sim on' scans synthetic noise set with 'noise' instead of the radio.
+//
+//*****************************************************************************
+int
+Cmd_chan(int argc, char *argv[])
+{
+	uint32_t ui32Index;
+	uint32_t ui32Value;
+	int32_t i32Noise;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "scan")))
+	{
+		if(!XBeeChanScan())
+		{
+			UARTprintf("Error: a scan is running, try again\n");
+			return 1;
+		}
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "mask")))
+	{
+		ui32Value = strtoul(argv[2], 0, 16);
+		if((ui32Value == 0) || (ui32Value > 0xFFFF))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		g_ui16ChanMask = (uint16_t)ui32Value;
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "auto")))
+	{
+		ui32Value = (0 == strcmp(argv[2], "off")) ? 0 :
+		            strtoul(argv[2], 0, 10);
+		if(ui32Value > (24 * 60))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		g_ui32ChanIntervalMs = ui32Value * 60000;
+		g_ui32ChanLastScan = XBeeTickGet();
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "loss")))
+	{
+		ui32Value = (0 == strcmp(argv[2], "off")) ? 0 :
+		            strtoul(argv[2], 0, 10);
+		if(ui32Value > 1000)
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		g_ui32ChanLoss = ui32Value;
+
+		//
+		// Count from here, not from whatever was lost before
+		//
+		g_ui32ChanCheckTick = XBeeTickGet();
+		XBeeChanLossCheck(g_ui32ChanCheckTick);
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "sim")))
+	{
+		g_bChanSim = (0 == strcmp(argv[2], "on"));
+		return 0;
+	}
+	else if((4 == argc) && (0 == strcmp(argv[1], "noise")))
+	{
+		ui32Index = strtoul(argv[2], 0, 16) - XBEE_CHAN_FIRST;
+		i32Noise = strtol(argv[3], 0, 10);
+		if((ui32Index >= XBEE_CHAN_COUNT) || (i32Noise < -100) ||
+		   (i32Noise > -10))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		g_pi8ChanNoise[ui32Index] = (int8_t)i32Noise;
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("chan  energy  score\n");
+	for(ui32Index = 0; ui32Index < XBEE_CHAN_COUNT; ui32Index++)
+	{
+		if(g_pui8ChanEnergy[ui32Index] == 0)
+		{
+			continue;
+		}
+		UARTprintf("%c%c0x%02x %4d %6d\n",
+		           ((ui32Index + XBEE_CHAN_FIRST) == g_ui8ChanCurrent) ?
+		           '*' : ' ',
+		           (g_ui16ChanMask & (1 << ui32Index)) ? ' ' : 'x',
+		           ui32Index + XBEE_CHAN_FIRST,
+		           -(int32_t)g_pui8ChanEnergy[ui32Index],
+		           -(int32_t)(XBeeChanScore(ui32Index) / 4));
+	}
+
+	UARTprintf("channel 0x%02x, mask %04x, rescan every %u min, on loss "
+	           "%u/1000, sim %s\n", g_ui8ChanCurrent, g_ui16ChanMask,
+	           g_ui32ChanIntervalMs / 60000, g_ui32ChanLoss,
+	           g_bChanSim ? "on" : "off");
+	UARTprintf("scans %u (%u on loss, %u timed), moves %u, failed %u%s\n",
+	           g_sChanStats.ui32Scans, g_sChanStats.ui32LossScans,
+	           g_sChanStats.ui32TimedScans, g_sChanStats.ui32Moves,
+	           g_sChanStats.ui32Failed,
+	           (g_ui32ChanState != CHAN_IDLE) ? ", scan running" : "");
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+//*****************************************************************************
+//
+// XBeeChan.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEECHAN_H__
+#define __XBEECHAN_H__
+
+//*****************************************************************************
+//
+// 802.15.4 channels 0x0B-0x1A, bit n of the allowed mask is channel
+// XBEE_CHAN_FIRST + n (as ATSC). XBee-PRO S1 radios only have 0x0C-0x17 and
+// return 12 energy readings starting at 0x0C.
+//
+//*****************************************************************************
+#define XBEE_CHAN_FIRST         0x0B
+#define XBEE_CHAN_COUNT         16
+#define XBEE_CHAN_PRO_FIRST     0x0C
+#define XBEE_CHAN_PRO_COUNT     12
+
+//*****************************************************************************
+//
+// A channel's score is its own energy counted twice plus that of each
+// neighbour, so a channel at the edge of a Wi-Fi channel loses out to one
+// clear of it. The radio only moves if the best channel scores at least
+// XBEE_CHAN_HYST_DB better than the current one.
+//
+//*****************************************************************************
+#define XBEE_CHAN_HYST_DB       6
+
+//*****************************************************************************
+//
+// Rescans on loss: the transmit results are looked at every
+// XBEE_CHAN_CHECK_MS and a window of at least XBEE_CHAN_MIN_FRAMES with
+// the set share or more failed starts a scan, no sooner than
+// XBEE_CHAN_HOLDOFF_MS after the last one. Each step of a scan gets
+// XBEE_CHAN_STEP_MS to answer.
+//
+//*****************************************************************************
+#define XBEE_CHAN_CHECK_MS      10000
+#define XBEE_CHAN_MIN_FRAMES    20
+#define XBEE_CHAN_HOLDOFF_MS    60000
+#define XBEE_CHAN_STEP_MS       5000
+
+//*****************************************************************************
+//
+// Simulated noise: channels read XBEE_CHAN_SIM_FLOOR dBm unless set, with
+// up to +-XBEE_CHAN_SIM_JITTER dB on each scan. Each dB above the floor on
+// the current channel loses XBEE_CHAN_SIM_PPM_PER_DB bytes in a million on
+// the simulated radio of 'tx sim'.
+//
+//*****************************************************************************
+#define XBEE_CHAN_SIM_FLOOR     (-95)
+#define XBEE_CHAN_SIM_JITTER    3
+#define XBEE_CHAN_SIM_PPM_PER_DB 200
+
+//*****************************************************************************
+//
+// Counters
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Scans;
+	uint32_t ui32LossScans;             // started by the transmit loss
+	uint32_t ui32TimedScans;            // started by the rescan interval
+	uint32_t ui32Moves;
+	uint32_t ui32Failed;                // no or bad answer from the radio
+}
+tXBeeChanStats;
+
+//*****************************************************************************
+//
+// Channel selection functions
+//
+//*****************************************************************************
+extern bool XBeeChanScan(void);
+extern bool XBeeChanApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeChanPoll(void);
+extern uint32_t XBeeChanSimErrorPpm(void);
+extern void XBeeChanStatsGet(tXBeeChanStats *psStats);
+extern int Cmd_chan(int argc, char *argv[]);
+
+#endif //__XBEECHAN_H__
@@ -0,0 +1,277 @@
+//*****************************************************************************
+//
+// XBeeClock.c - Load driven switching between 16MHz and 80MHz
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! The core idles at 16MHz from the crystal. Work on the link (received
+//! bytes being routed, a bulk transfer running) moves it to 80MHz from the
+//! PLL, and XBEE_CLOCK_IDLE_MS without work moves it back.
+//!
+//! What depends on the clock after a switch:
+//!   SysTick  period reloaded, so every tick based timeout stays in ms
+//!   UART0    nothing, it runs from PIOSC (see ConfigureUART())
+//!   UART1    nothing, it runs from PIOSC too (see XBeeUartInit())
+//!   delays   the +++ guard times wait on the tick, not on cycles
+//!
+//! Neither UART is touched, so bytes keep moving through the switch at the
+//! same divisors and none are lost.
+//!
+//! Busy time is the cycles XBeeLinkPoll() spends on received data, so the
+//! load at each level shows how much headroom is left.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeBulk.h"
+#include "XBeeSched.h"
+#include "XBeeIdle.h"
+#include "XBeeClock.h"
+
+static const uint32_t g_pui32ClockConfig[XBEE_CLOCK_LEVELS] =
+{
+	SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ,
+	SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ
+};
+
+static const uint32_t g_pui32ClockMhz[XBEE_CLOCK_LEVELS] = { 16, 80 };
+static const uint32_t g_pui32ClockMa[XBEE_CLOCK_LEVELS] =
+{
+	XBEE_CLOCK_MA_LOW, XBEE_CLOCK_MA_HIGH
+};
+
+static tXBeeClockStats g_sClockStats;
+static uint32_t g_ui32ClockMode;
+static uint32_t g_ui32ClockLevelTick;
+static uint32_t g_ui32ClockWorkTick;
+
+//*****************************************************************************
+//
+// Charge the time since the last switch to the current level.
+//
+//*****************************************************************************
+static void
+XBeeClockAccount(void)
+{
+	uint32_t ui32Now;
+
+	ui32Now = XBeeTickGet();
+	g_sClockStats.pui32Ms[g_sClockStats.ui32Level] +=
+		ui32Now - g_ui32ClockLevelTick;
+	g_ui32ClockLevelTick = ui32Now;
+}
+
+//*****************************************************************************
+//
+// Change the system clock and everything derived from it.
+//
+//*****************************************************************************
+static void
+XBeeClockLevelSet(uint32_t ui32Level)
+{
+	if(ui32Level == g_sClockStats.ui32Level)
+	{
+		return;
+	}
+
+	XBeeClockAccount();
+	ROM_SysCtlClockSet(g_pui32ClockConfig[ui32Level]);
+	XBeeTickClockUpdate();
+
+	g_sClockStats.ui32Level = ui32Level;
+	g_sClockStats.ui32Switches++;
+}
+
+//*****************************************************************************
+//
+// Start accounting at the clock main() set up (16MHz).
+//
+//*****************************************************************************
+void
+XBeeClockInit(void)
+{
+	XBeeCycleCountEnable();
+	memset(&g_sClockStats, 0, sizeof(g_sClockStats));
+	g_sClockStats.ui32Level = XBEE_CLOCK_LOW;
+	g_ui32ClockLevelTick = XBeeTickGet();
+}
+
+//*****************************************************************************
+//
+// Called by XBeeLinkPoll() with the cycles it spent on received data.
+//
+//*****************************************************************************
+void
+XBeeClockWork(uint32_t ui32Cycles)
+{
+	g_sClockStats.pui64BusyCycles[g_sClockStats.ui32Level] += ui32Cycles;
+	g_ui32ClockWorkTick = XBeeTickGet();
+
+	if(g_ui32ClockMode == XBEE_CLOCK_AUTO)
+	{
+		XBeeClockLevelSet(XBEE_CLOCK_HIGH);
+	}
+}
+
+//*****************************************************************************
+//
+// Decide the clock level. Called from XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeClockPoll(void)
+{
+	if(g_ui32ClockMode != XBEE_CLOCK_AUTO)
+	{
+		return;
+	}
+
+	if(XBeeBulkTxBusy() || XBeeBulkRxBusy())
+	{
+		g_ui32ClockWorkTick = XBeeTickGet();
+		XBeeClockLevelSet(XBEE_CLOCK_HIGH);
+	}
+	else if((g_sClockStats.ui32Level == XBEE_CLOCK_HIGH) &&
+	        XBEE_TICK_REACHED(XBeeTickGet(), g_ui32ClockWorkTick +
+	                                         XBEE_CLOCK_IDLE_MS) &&
+	        (XBeeUartRxAvail() == 0) && XBeeSchedIdle() && XBeeUartTxIdle())
+	{
+		XBeeClockLevelSet(XBEE_CLOCK_LOW);
+	}
+	else if(g_sClockStats.ui32Level == XBEE_CLOCK_HIGH)
+	{
+		XBeeIdleDeadline(g_ui32ClockWorkTick + XBEE_CLOCK_IDLE_MS);
+	}
+}
+
+//*****************************************************************************
+//
+// Let the governor decide, or hold one level.
+//
+//*****************************************************************************
+void
+XBeeClockModeSet(uint32_t ui32Mode)
+{
+	g_ui32ClockMode = ui32Mode;
+
+	if(ui32Mode == XBEE_CLOCK_FIXED_LOW)
+	{
+		XBeeClockLevelSet(XBEE_CLOCK_LOW);
+	}
+	else if(ui32Mode == XBEE_CLOCK_FIXED_HIGH)
+	{
+		XBeeClockLevelSet(XBEE_CLOCK_HIGH);
+	}
+}
+
+void
+XBeeClockStatsGet(tXBeeClockStats *psStats)
+{
+	XBeeClockAccount();
+	*psStats = g_sClockStats;
+}
+
+//*****************************************************************************
+//
+// Clock Command
+// Input: none / 'auto' / '16' / '80' / 'clear'
+// Response: time, load and estimated energy at each clock level
+// Use: to see how much headroom the link work leaves and what running at
+//		16MHz when idle saves over staying at 80MHz
+//
+//*****************************************************************************
+int
+Cmd_clock(int argc, char *argv[])
+{
+	uint32_t ui32Level;
+	uint32_t ui32Load;
+	uint64_t ui64Available;
+	uint64_t ui64Energy;
+	uint64_t ui64Saved;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "auto")))
+	{
+		XBeeClockModeSet(XBEE_CLOCK_AUTO);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "16")))
+	{
+		XBeeClockModeSet(XBEE_CLOCK_FIXED_LOW);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "80")))
+	{
+		XBeeClockModeSet(XBEE_CLOCK_FIXED_HIGH);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		ui32Level = g_sClockStats.ui32Level;
+		memset(&g_sClockStats, 0, sizeof(g_sClockStats));
+		g_sClockStats.ui32Level = ui32Level;
+		g_ui32ClockLevelTick = XBeeTickGet();
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	XBeeClockAccount();
+
+	UARTprintf("%s, now %d MHz, %d switches\n",
+	           (g_ui32ClockMode == XBEE_CLOCK_AUTO) ? "auto" : "fixed",
+	           g_pui32ClockMhz[g_sClockStats.ui32Level],
+	           g_sClockStats.ui32Switches);
+
+	ui64Energy = 0;
+	for(ui32Level = 0; ui32Level < XBEE_CLOCK_LEVELS; ui32Level++)
+	{
+		//
+		// Busy cycles over the cycles available in the time spent here
+		//
+		ui64Available = (uint64_t)g_sClockStats.pui32Ms[ui32Level] *
+		                g_pui32ClockMhz[ui32Level] * 1000;
+		ui32Load = ui64Available ?
+		           (uint32_t)((g_sClockStats.pui64BusyCycles[ui32Level] *
+		                       100) / ui64Available) : 0;
+		ui64Energy += (uint64_t)g_sClockStats.pui32Ms[ui32Level] *
+		              g_pui32ClockMa[ui32Level];
+		UARTprintf("%2d MHz: %d ms, link load %d%% (%d%% headroom)\n",
+		           g_pui32ClockMhz[ui32Level], g_sClockStats.pui32Ms[ui32Level],
+		           ui32Load, 100 - ui32Load);
+	}
+
+	//
+	// ms x mA x mV = nJ. Saving is the time spent at 16MHz priced at the
+	// difference in current.
+	//
+	ui64Saved = (uint64_t)g_sClockStats.pui32Ms[XBEE_CLOCK_LOW] *
+	            (XBEE_CLOCK_MA_HIGH - XBEE_CLOCK_MA_LOW);
+	UARTprintf("core energy ~%d mJ, ~%d mJ less than fixed 80 MHz "
+	           "(typical datasheet currents)\n",
+	           (uint32_t)((ui64Energy * XBEE_CLOCK_SUPPLY_MV) / 1000000),
+	           (uint32_t)((ui64Saved * XBEE_CLOCK_SUPPLY_MV) / 1000000));
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+//*****************************************************************************
+//
+// XBeeClock.h - Headers for use with XBeeClock.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEECLOCK_H__
+#define __XBEECLOCK_H__
+
+//*****************************************************************************
+//
+// Clock levels: 16MHz straight from the crystal, or 80MHz from the PLL
+//
+//*****************************************************************************
+#define XBEE_CLOCK_LOW          0
+#define XBEE_CLOCK_HIGH         1
+#define XBEE_CLOCK_LEVELS       2
+
+//*****************************************************************************
+//
+// Governor modes
+//
+//*****************************************************************************
+#define XBEE_CLOCK_AUTO         0
+#define XBEE_CLOCK_FIXED_LOW    1
+#define XBEE_CLOCK_FIXED_HIGH   2
+
+//*****************************************************************************
+//
+// Drop back to 16MHz after this long without work
+//
+//*****************************************************************************
+#define XBEE_CLOCK_IDLE_MS      250
+
+//*****************************************************************************
+//
+// Typical run mode supply current (mA, peripherals off) from the LM4F120
+// datasheet, used for the energy estimate. Measure your own board and
+// adjust.
+//
+//*****************************************************************************
+#define XBEE_CLOCK_MA_LOW       12
+#define XBEE_CLOCK_MA_HIGH      32
+#define XBEE_CLOCK_SUPPLY_MV    3300
+
+//*****************************************************************************
+//
+// Time and load at each level
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Level;
+	uint32_t ui32Switches;
+	uint32_t pui32Ms[XBEE_CLOCK_LEVELS];
+	uint64_t pui64BusyCycles[XBEE_CLOCK_LEVELS];
+}
+tXBeeClockStats;
+
+//*****************************************************************************
+//
+// Clock governor functions
+//
+//*****************************************************************************
+extern void XBeeClockInit(void);
+extern void XBeeClockWork(uint32_t ui32Cycles);
+extern void XBeeClockPoll(void);
+extern void XBeeClockModeSet(uint32_t ui32Mode);
+extern void XBeeClockStatsGet(tXBeeClockStats *psStats);
+extern int Cmd_clock(int argc, char *argv[]);
+
+#endif //__XBEECLOCK_H__
@@ -0,0 +1,682 @@
+//*****************************************************************************
+//
+// XBeeConc.c - Per node state for a coordinator with hundreds of nodes
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! A coordinator collecting from hundreds of nodes keeps a little state for
+//! each: where it is, when it was last heard, its last sample, the RSSI and
+//! a frame count. Every receive frame (link messages and I/O samples) in API
+//! mode updates it.
+//!
+//! The fields are kept in one array each (struct of arrays) rather than an
+//! array of structs. A lookup reads only the address array, the summary
+//! only the times and RSSIs, so neither walks over the bytes it does not
+//! need, and the narrow fields pack without padding: 12 bytes per node.
+//!
+//! Nodes are found through an open addressing index on the 64-bit address:
+//! 2^XBEE_CONC_SLOT_BITS 16-bit slots, each 0 or a node number + 1, probed
+//! linearly from a Fibonacci hash. The index is never more than half full,
+//! so an update is a hash and one or two compares whatever the fleet size.
+//! Once the table is full a new node takes over the number of the node
+//! heard from longest ago, if that is gone (XBEE_CONC_QUIET_S), and its
+//! index slot is closed up behind it. While every node is still around new
+//! ones are turned away, and counted.
+//!
+//! The node number is the key of everything else kept per node: duplicate
+//! windows (XBeeDup.c), discovery results (XBeeNode.c), I/O line state
+//! (XBeeIo.c) and delivery history (XBeeQual.c) are columns indexed by it,
+//! or small tables holding it, instead of tables of their own searched by
+//! address. Clearing the nodes clears those too, and a number taken over
+//! is forgotten in each of them first.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeResp.h"
+#include "XBeeLink.h"
+#include "XBeeDup.h"
+#include "XBeeNode.h"
+#include "XBeeIo.h"
+#include "XBeeQual.h"
+#include "XBeeConc.h"
+
+//*****************************************************************************
+//
+// Node tables, one field per array, and the hash index
+//
+//*****************************************************************************
+static uint32_t g_pui32ConcAddrLo[XBEE_CONC_NODES];
+static uint8_t g_pui8ConcAddrHi[XBEE_CONC_NODES];   // into g_pui32ConcHigh
+static uint16_t g_pui16ConcSeen[XBEE_CONC_NODES];   // seconds
+static uint16_t g_pui16ConcSample[XBEE_CONC_NODES];
+static uint16_t g_pui16ConcFrames[XBEE_CONC_NODES]; // stops at 65535
+static uint8_t g_pui8ConcRssi[XBEE_CONC_NODES];     // -dBm, 0 unknown
+static uint16_t g_pui16ConcSlots[1 << XBEE_CONC_SLOT_BITS];
+
+static uint32_t g_pui32ConcHigh[XBEE_CONC_HIGHS];
+static uint32_t g_ui32ConcHighs;
+static uint32_t g_ui32ConcCount;
+static tXBeeConcStats g_sConcStats;
+
+//*****************************************************************************
+//
+// Sources turned away, and with the table full and no node gone, the
+// second before which none can be
+//
+//*****************************************************************************
+static uint32_t g_pui32ConcUntracked[(1 << XBEE_CONC_UNTRACKED_BITS) / 32];
+static uint16_t g_ui16ConcEvictAt;
+static bool g_bConcEvictWait;
+
+//*****************************************************************************
+//
+// Benchmark: frames per run
+//
+//*****************************************************************************
+#define CONCBENCH_FRAMES        20000
+
+//*****************************************************************************
+//
+// Empty the node tables.
+//
+//*****************************************************************************
+static void
+XBeeConcEmpty(void)
+{
+	memset(g_pui16ConcSlots, 0, sizeof(g_pui16ConcSlots));
+	memset(g_pui32ConcUntracked, 0, sizeof(g_pui32ConcUntracked));
+	g_ui32ConcHighs = 0;
+	g_ui32ConcCount = 0;
+	g_bConcEvictWait = false;
+}
+
+//*****************************************************************************
+//
+// Forget all nodes, and everything kept under their numbers.
+//
+//*****************************************************************************
+void
+XBeeConcClear(void)
+{
+	XBeeConcEmpty();
+	XBeeDupClear();
+	XBeeNodeClear();
+	XBeeIoClear();
+	XBeeQualClear();
+}
+
+//*****************************************************************************
+//
+// First index slot for an address.
+//
+//*****************************************************************************
+static uint32_t
+XBeeConcHash(uint32_t ui32Hi, uint32_t ui32Lo)
+{
+	return ((ui32Lo ^ ui32Hi) * 0x9E3779B1) >> (32 - XBEE_CONC_SLOT_BITS);
+}
+
+//*****************************************************************************
+//
+// Take node ui32Node out of the index. Entries after its slot, up to the
+// next empty one, move back into the hole if that is still at or after
+// their first slot, so every probe stays unbroken.
+//
+//*****************************************************************************
+static void
+XBeeConcUnindex(uint32_t ui32Node)
+{
+	uint32_t ui32Mask;
+	uint32_t ui32Hole;
+	uint32_t ui32Slot;
+	uint32_t ui32Home;
+	uint32_t ui32Other;
+
+	ui32Mask = (1 << XBEE_CONC_SLOT_BITS) - 1;
+	ui32Hole = XBeeConcHash(g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Node]],
+	                        g_pui32ConcAddrLo[ui32Node]);
+	while(g_pui16ConcSlots[ui32Hole] != (ui32Node + 1))
+	{
+		ui32Hole = (ui32Hole + 1) & ui32Mask;
+	}
+
+	for(ui32Slot = (ui32Hole + 1) & ui32Mask; g_pui16ConcSlots[ui32Slot];
+	    ui32Slot = (ui32Slot + 1) & ui32Mask)
+	{
+		ui32Other = g_pui16ConcSlots[ui32Slot] - 1;
+		ui32Home = XBeeConcHash(g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Other]],
+		                        g_pui32ConcAddrLo[ui32Other]);
+		if(((ui32Slot - ui32Home) & ui32Mask) >=
+		   ((ui32Slot - ui32Hole) & ui32Mask))
+		{
+			g_pui16ConcSlots[ui32Hole] = g_pui16ConcSlots[ui32Slot];
+			ui32Hole = ui32Slot;
+		}
+	}
+	g_pui16ConcSlots[ui32Hole] = 0;
+}
+
+//*****************************************************************************
+//
+// Free the number of the node heard from longest ago, if that is
+// XBEE_CONC_QUIET_S or more, forgetting everything kept under it. Returns
+// the number, or XBEE_CONC_NONE if no node is gone. A scan that finds none
+// also finds when the first could be, and none is made before then.
+//
+//*****************************************************************************
+static uint32_t
+XBeeConcEvict(void)
+{
+	uint32_t ui32Node;
+	uint32_t ui32Oldest;
+	uint16_t ui16Now;
+	uint16_t ui16Age;
+	uint16_t ui16Oldest;
+
+	ui16Now = (uint16_t)(XBeeTickGet() / 1000);
+	if(g_bConcEvictWait && ((int16_t)(ui16Now - g_ui16ConcEvictAt) < 0))
+	{
+		return XBEE_CONC_NONE;
+	}
+
+	ui32Oldest = 0;
+	ui16Oldest = 0;
+	for(ui32Node = 0; ui32Node < g_ui32ConcCount; ui32Node++)
+	{
+		ui16Age = ui16Now - g_pui16ConcSeen[ui32Node];
+		if(ui16Age > ui16Oldest)
+		{
+			ui16Oldest = ui16Age;
+			ui32Oldest = ui32Node;
+		}
+	}
+	if(ui16Oldest < XBEE_CONC_QUIET_S)
+	{
+		g_bConcEvictWait = true;
+		g_ui16ConcEvictAt = ui16Now + (XBEE_CONC_QUIET_S - ui16Oldest);
+		return XBEE_CONC_NONE;
+	}
+	g_bConcEvictWait = false;
+
+	XBeeConcUnindex(ui32Oldest);
+	XBeeDupForget(ui32Oldest);
+	XBeeNodeForget(ui32Oldest);
+	XBeeIoForget(ui32Oldest);
+	XBeeQualForget(ui32Oldest);
+	g_sConcStats.ui32Evicted++;
+
+	return ui32Oldest;
+}
+
+//*****************************************************************************
+//
+// Count a source turned away, once.
+//
+//*****************************************************************************
+static void
+XBeeConcUntracked(uint32_t ui32Slot)
+{
+	uint32_t ui32Bit;
+
+	ui32Bit = ui32Slot >> (XBEE_CONC_SLOT_BITS - XBEE_CONC_UNTRACKED_BITS);
+	if(!(g_pui32ConcUntracked[ui32Bit / 32] & (1u << (ui32Bit & 31))))
+	{
+		g_pui32ConcUntracked[ui32Bit / 32] |= 1u << (ui32Bit & 31);
+		g_sConcStats.ui32Untracked++;
+	}
+}
+
+//*****************************************************************************
+//
+// Add a node in index slot ui32Slot, the empty one its probe ended on.
+// Returns its number, or XBEE_CONC_NONE if the tables are full and no node
+// is gone.
+//
+//*****************************************************************************
+static uint32_t
+XBeeConcAdd(uint32_t ui32Slot, uint32_t ui32Hi, uint32_t ui32Lo)
+{
+	uint32_t ui32High;
+	uint32_t ui32Node;
+
+	for(ui32High = 0; ui32High < g_ui32ConcHighs; ui32High++)
+	{
+		if(g_pui32ConcHigh[ui32High] == ui32Hi)
+		{
+			break;
+		}
+	}
+	if((ui32High == g_ui32ConcHighs) && (g_ui32ConcHighs >= XBEE_CONC_HIGHS))
+	{
+		XBeeConcUntracked(XBeeConcHash(ui32Hi, ui32Lo));
+		return XBEE_CONC_NONE;
+	}
+
+	if(g_ui32ConcCount < XBEE_CONC_NODES)
+	{
+		ui32Node = g_ui32ConcCount++;
+	}
+	else
+	{
+		ui32Node = XBeeConcEvict();
+		if(ui32Node == XBEE_CONC_NONE)
+		{
+			XBeeConcUntracked(XBeeConcHash(ui32Hi, ui32Lo));
+			return XBEE_CONC_NONE;
+		}
+
+		//
+		// Closing up the index may have moved the empty slot
+		//
+		for(ui32Slot = XBeeConcHash(ui32Hi, ui32Lo); g_pui16ConcSlots[ui32Slot];
+		    ui32Slot = (ui32Slot + 1) & ((1 << XBEE_CONC_SLOT_BITS) - 1))
+		{
+		}
+	}
+	if(ui32High == g_ui32ConcHighs)
+	{
+		g_pui32ConcHigh[g_ui32ConcHighs++] = ui32Hi;
+	}
+
+	g_pui32ConcAddrLo[ui32Node] = ui32Lo;
+	g_pui8ConcAddrHi[ui32Node] = (uint8_t)ui32High;
+	g_pui16ConcSeen[ui32Node] = (uint16_t)(XBeeTickGet() / 1000);
+	g_pui16ConcSample[ui32Node] = 0;
+	g_pui16ConcFrames[ui32Node] = 0;
+	g_pui8ConcRssi[ui32Node] = 0;
+	g_pui16ConcSlots[ui32Slot] = (uint16_t)(ui32Node + 1);
+
+	return ui32Node;
+}
+
+//*****************************************************************************
+//
+// Number of node ui64Addr. With bAdd a node not seen before is added,
+// without it, or if there is no room, XBEE_CONC_NONE is returned.
+//
+//*****************************************************************************
+uint32_t
+XBeeConcNode(uint64_t ui64Addr, bool bAdd)
+{
+	uint32_t ui32Hi;
+	uint32_t ui32Lo;
+	uint32_t ui32Slot;
+	uint32_t ui32Node;
+
+	ui32Hi = (uint32_t)(ui64Addr >> 32);
+	ui32Lo = (uint32_t)ui64Addr;
+	g_sConcStats.ui32Lookups++;
+
+	for(ui32Slot = XBeeConcHash(ui32Hi, ui32Lo); ;
+	    ui32Slot = (ui32Slot + 1) & ((1 << XBEE_CONC_SLOT_BITS) - 1))
+	{
+		ui32Node = g_pui16ConcSlots[ui32Slot];
+		if(ui32Node == 0)
+		{
+			return bAdd ? XBeeConcAdd(ui32Slot, ui32Hi, ui32Lo) :
+			       XBEE_CONC_NONE;
+		}
+		ui32Node--;
+		if((g_pui32ConcAddrLo[ui32Node] == ui32Lo) &&
+		   (g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Node]] == ui32Hi))
+		{
+			return ui32Node;
+		}
+		g_sConcStats.ui32Probes++;
+	}
+}
+
+//*****************************************************************************
+//
+// 64-bit address of node ui32Node.
+//
+//*****************************************************************************
+uint64_t
+XBeeConcAddr(uint32_t ui32Node)
+{
+	if(ui32Node >= g_ui32ConcCount)
+	{
+		return 0;
+	}
+
+	return ((uint64_t)g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Node]] << 32) |
+	       g_pui32ConcAddrLo[ui32Node];
+}
+
+//*****************************************************************************
+//
+// A frame came from ui64Addr at ui8Rssi (-dBm, 0 if not known). Returns
+// the node number for XBeeConcSample(), or XBEE_CONC_NONE if there is no
+// room for a new node.
+//
+//*****************************************************************************
+uint32_t
+XBeeConcFrame(uint64_t ui64Addr, uint8_t ui8Rssi)
+{
+	uint32_t ui32Node;
+
+	ui32Node = XBeeConcNode(ui64Addr, true);
+	if(ui32Node == XBEE_CONC_NONE)
+	{
+		g_sConcStats.ui32Refused++;
+		return XBEE_CONC_NONE;
+	}
+
+	g_sConcStats.ui32Frames++;
+	g_pui16ConcSeen[ui32Node] = (uint16_t)(XBeeTickGet() / 1000);
+	if(ui8Rssi)
+	{
+		g_pui8ConcRssi[ui32Node] = ui8Rssi;
+	}
+	if(g_pui16ConcFrames[ui32Node] != 0xFFFF)
+	{
+		g_pui16ConcFrames[ui32Node]++;
+	}
+
+	return ui32Node;
+}
+
+//*****************************************************************************
+//
+// Last sample of a node, as returned by XBeeConcFrame().
+//
+//*****************************************************************************
+void
+XBeeConcSample(uint32_t ui32Node, uint16_t ui16Value)
+{
+	if(ui32Node < g_ui32ConcCount)
+	{
+		g_pui16ConcSample[ui32Node] = ui16Value;
+	}
+}
+
+uint32_t
+XBeeConcCount(void)
+{
+	return g_ui32ConcCount;
+}
+
+void
+XBeeConcStatsGet(tXBeeConcStats *psStats)
+{
+	*psStats = g_sConcStats;
+}
+
+//*****************************************************************************
+//
+// Address of simulated node ui32Index: a common serial number prefix, the
+// lower half spread out like a production run.
+//
+//*****************************************************************************
+static uint64_t
+XBeeConcBenchAddr(uint32_t ui32Index)
+{
+	return 0x0013A20000000000ULL | (0x40000000 + (ui32Index * 40503));
+}
+
+//*****************************************************************************
+//
+// Feed CONCBENCH_FRAMES frames from ui32Nodes simulated nodes, in a random
+// order, through the index, then look the same addresses up by scanning
+// the address array as a plain table would. Prints cycles and frames per
+// second for both. Runs in the node tables, so only while they are empty
+// and no frames can come in; they are emptied again after.
+//
+//*****************************************************************************
+static void
+XBeeConcBench(uint32_t ui32Nodes)
+{
+	tXBeeConcStats sBefore;
+	uint64_t ui64Addr;
+	uint32_t ui32Count;
+	uint32_t ui32Node;
+	uint32_t ui32Index;
+	uint32_t ui32Start;
+	uint32_t ui32Hashed;
+	uint32_t ui32Linear;
+	uint32_t ui32Mhz;
+
+	sBefore = g_sConcStats;
+	srand(1);
+
+	//
+	// Every node heard from once, so both runs see the full fleet
+	//
+	for(ui32Index = 0; ui32Index < ui32Nodes; ui32Index++)
+	{
+		XBeeConcFrame(XBeeConcBenchAddr(ui32Index), 60);
+	}
+
+	ui32Hashed = 0;
+	for(ui32Count = 0; ui32Count < CONCBENCH_FRAMES; ui32Count++)
+	{
+		ui64Addr = XBeeConcBenchAddr(rand() % ui32Nodes);
+		ui32Start = XBeeCycleCountGet();
+		ui32Node = XBeeConcFrame(ui64Addr, 40 + (ui32Count & 31));
+		XBeeConcSample(ui32Node, (uint16_t)ui32Count);
+		ui32Hashed += XBeeCycleCountGet() - ui32Start;
+	}
+
+	ui32Linear = 0;
+	for(ui32Count = 0; ui32Count < CONCBENCH_FRAMES; ui32Count++)
+	{
+		ui64Addr = XBeeConcBenchAddr(rand() % ui32Nodes);
+		ui32Start = XBeeCycleCountGet();
+		for(ui32Node = 0; ui32Node < g_ui32ConcCount; ui32Node++)
+		{
+			if((g_pui32ConcAddrLo[ui32Node] == (uint32_t)ui64Addr) &&
+			   (g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Node]] ==
+			    (uint32_t)(ui64Addr >> 32)))
+			{
+				g_pui16ConcSample[ui32Node] = (uint16_t)ui32Count;
+				break;
+			}
+		}
+		ui32Linear += XBeeCycleCountGet() - ui32Start;
+	}
+
+	ui32Mhz = ROM_SysCtlClockGet() / 1000000;
+	ui32Hashed /= CONCBENCH_FRAMES;
+	ui32Linear /= CONCBENCH_FRAMES;
+	UARTprintf("%4u nodes: indexed %u cycles/frame, %u frames/s; "
+	           "linear scan %u cycles/frame, %u frames/s\n", ui32Nodes,
+	           ui32Hashed, ui32Hashed ? ((ui32Mhz * 1000000) / ui32Hashed) : 0,
+	           ui32Linear, ui32Linear ? ((ui32Mhz * 1000000) / ui32Linear) : 0);
+	if(ui32Nodes > g_ui32ConcCount)
+	{
+		UARTprintf("           %u nodes did not fit, their frames were "
+		           "refused (%u)\n", ui32Nodes - g_ui32ConcCount,
+		           g_sConcStats.ui32Refused - sBefore.ui32Refused);
+	}
+
+	g_sConcStats = sBefore;
+	XBeeConcEmpty();
+}
+
+//*****************************************************************************
+//
+// Print one line per node.
+//
+//*****************************************************************************
+static void
+XBeeConcList(void)
+{
+	uint32_t ui32Node;
+	uint16_t ui16Now;
+
+	ui16Now = (uint16_t)(XBeeTickGet() / 1000);
+	UARTprintf("         address   age s  rssi  frames  sample\n");
+	for(ui32Node = 0; ui32Node < g_ui32ConcCount; ui32Node++)
+	{
+		UARTprintf("%08x%08x %7u  %4d %7u %7u\n",
+		           g_pui32ConcHigh[g_pui8ConcAddrHi[ui32Node]],
+		           g_pui32ConcAddrLo[ui32Node],
+		           (uint16_t)(ui16Now - g_pui16ConcSeen[ui32Node]),
+		           -(int32_t)g_pui8ConcRssi[ui32Node],
+		           g_pui16ConcFrames[ui32Node], g_pui16ConcSample[ui32Node]);
+	}
+}
+
+//*****************************************************************************
+//
+// Conc Command
+// Input: none / 'list' / 'clear' / 'bench [nodes]'
+// Response: fleet summary: nodes by how recently heard from, RSSI range,
+//		frames and index probes; 'list' adds a line per node
+// Use: to watch a coordinator's fleet. Nodes only sent to, or found by
+//		ATND, count as never heard. 'bench' times frame handling with that
+//		many simulated nodes (500 and 1000 by default) against a linear
+//		scan, in the node table: only with the link down (not API mode)
+//		and the table empty. 'clear' empties it, and with it the other per
+//		node state.
+//
+//*****************************************************************************
+int
+Cmd_conc(int argc, char *argv[])
+{
+	uint32_t ui32Node;
+	uint32_t ui32Nodes;
+	uint32_t ui32Active;
+	uint32_t ui32Quiet;
+	uint32_t ui32Never;
+	uint32_t ui32Heard;
+	uint32_t ui32Sum;
+	uint32_t ui32Best;
+	uint32_t ui32Worst;
+	uint16_t ui16Now;
+	uint16_t ui16Age;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeConcClear();
+		memset(&g_sConcStats, 0, sizeof(g_sConcStats));
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "list")))
+	{
+		XBeeConcList();
+		return 0;
+	}
+	else if((argc >= 2) && (argc <= 3) && (0 == strcmp(argv[1], "bench")))
+	{
+		if(XBeeLinkApi())
+		{
+			UARTprintf("Error: link is up, its frames would land in the "
+			           "benchmark\n");
+			return 1;
+		}
+		if(g_ui32ConcCount)
+		{
+			UARTprintf("Error: %u nodes known, 'conc clear' first\n",
+			           g_ui32ConcCount);
+			return 1;
+		}
+		if(argc == 3)
+		{
+			ui32Nodes = strtoul(argv[2], 0, 10);
+			if((ui32Nodes == 0) || (ui32Nodes > 0xFFFF))
+			{
+				UARTprintf("Error: invalid input, try again\n");
+				return 1;
+			}
+			XBeeConcBench(ui32Nodes);
+			return 0;
+		}
+		XBeeConcBench(500);
+		XBeeConcBench(1000);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	//
+	// One pass over the times, one over the RSSIs
+	//
+	ui16Now = (uint16_t)(XBeeTickGet() / 1000);
+	ui32Active = 0;
+	ui32Quiet = 0;
+	ui32Never = 0;
+	for(ui32Node = 0; ui32Node < g_ui32ConcCount; ui32Node++)
+	{
+		ui16Age = ui16Now - g_pui16ConcSeen[ui32Node];
+		if(g_pui16ConcFrames[ui32Node] == 0)
+		{
+			ui32Never++;
+		}
+		else if(ui16Age < XBEE_CONC_ACTIVE_S)
+		{
+			ui32Active++;
+		}
+		else if(ui16Age < XBEE_CONC_QUIET_S)
+		{
+			ui32Quiet++;
+		}
+	}
+
+	ui32Heard = 0;
+	ui32Sum = 0;
+	ui32Best = 0xFF;
+	ui32Worst = 0;
+	for(ui32Node = 0; ui32Node < g_ui32ConcCount; ui32Node++)
+	{
+		if(g_pui8ConcRssi[ui32Node] == 0)
+		{
+			continue;
+		}
+		ui32Heard++;
+		ui32Sum += g_pui8ConcRssi[ui32Node];
+		if(g_pui8ConcRssi[ui32Node] < ui32Best)
+		{
+			ui32Best = g_pui8ConcRssi[ui32Node];
+		}
+		if(g_pui8ConcRssi[ui32Node] > ui32Worst)
+		{
+			ui32Worst = g_pui8ConcRssi[ui32Node];
+		}
+	}
+
+	UARTprintf("nodes %u of %u: active %u, quiet %u, gone %u, never heard "
+	           "%u\n", g_ui32ConcCount, XBEE_CONC_NODES, ui32Active,
+	           ui32Quiet, g_ui32ConcCount - ui32Active - ui32Quiet - ui32Never,
+	           ui32Never);
+	if(ui32Heard)
+	{
+		UARTprintf("rssi best -%u, average -%u, worst -%u dBm\n", ui32Best,
+		           ui32Sum / ui32Heard, ui32Worst);
+	}
+	UARTprintf("frames %u, refused %u, index probes %u.%02u per lookup, "
+	           "prefixes %u of %u\n", g_sConcStats.ui32Frames,
+	           g_sConcStats.ui32Refused,
+	           g_sConcStats.ui32Lookups ?
+	           (g_sConcStats.ui32Probes / g_sConcStats.ui32Lookups) : 0,
+	           g_sConcStats.ui32Lookups ?
+	           (((g_sConcStats.ui32Probes * 100) / g_sConcStats.ui32Lookups) %
+	            100) : 0, g_ui32ConcHighs, XBEE_CONC_HIGHS);
+	UARTprintf("gone nodes replaced %u, sources turned away %u\n",
+	           g_sConcStats.ui32Evicted, g_sConcStats.ui32Untracked);
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+//*****************************************************************************
+//
+// XBeeConc.h - Headers for use with XBeeConc.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEECONC_H__
+#define __XBEECONC_H__
+
+//*****************************************************************************
+//
+// Nodes the concentrator keeps, 16 bytes each with the index, and the hash
+// index size, twice the nodes so a lookup rarely probes more than once or
+// twice. The node number is also the index into the other per node tables
+// (XBeeDup.c 8 bytes a node, XBeeNode.c, XBeeIo.c and XBeeQual.c for the
+// few nodes they keep more about), so 512 nodes take 12KB all told; the
+// LM4F120's 32KB has no room for 1024 next to the rest of the firmware.
+//
+//*****************************************************************************
+#define XBEE_CONC_NODES         512
+#define XBEE_CONC_SLOT_BITS     10
+
+//*****************************************************************************
+//
+// Distinct upper halves of 64-bit addresses. Nodes store an index into a
+// table of these; XBee serial numbers share a few manufacturer prefixes and
+// 16-bit addresses all have 0.
+//
+//*****************************************************************************
+#define XBEE_CONC_HIGHS         16
+
+//*****************************************************************************
+//
+// The summary counts a node as active if heard from in the last
+// XBEE_CONC_ACTIVE_S seconds, quiet up to XBEE_CONC_QUIET_S, gone after.
+// With the table full a new node takes the number of the one gone
+// longest. Last seen times are kept in seconds, 16 bits, so ages wrap at
+// 18 hours.
+//
+//*****************************************************************************
+#define XBEE_CONC_ACTIVE_S      60
+#define XBEE_CONC_QUIET_S       600
+
+//*****************************************************************************
+//
+// Returned for a frame from a node there is no room for
+//
+//*****************************************************************************
+#define XBEE_CONC_NONE          0xFFFFFFFF
+
+//*****************************************************************************
+//
+// Sources turned away are counted once each by marking a 2^bits map with
+// a hash of their address; two sharing a bit count as one.
+//
+//*****************************************************************************
+#define XBEE_CONC_UNTRACKED_BITS 8
+
+//*****************************************************************************
+//
+// Counters
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Frames;
+	uint32_t ui32Lookups;
+	uint32_t ui32Probes;                // index slots looked at beyond the first
+	uint32_t ui32Refused;               // frames from nodes that did not fit
+	uint32_t ui32Untracked;             // sources that did not fit, about
+	uint32_t ui32Evicted;               // gone nodes dropped for new ones
+}
+tXBeeConcStats;
+
+//*****************************************************************************
+//
+// Concentrator functions
+//
+//*****************************************************************************
+extern void XBeeConcClear(void);
+extern uint32_t XBeeConcNode(uint64_t ui64Addr, bool bAdd);
+extern uint64_t XBeeConcAddr(uint32_t ui32Node);
+extern uint32_t XBeeConcFrame(uint64_t ui64Addr, uint8_t ui8Rssi);
+extern void XBeeConcSample(uint32_t ui32Node, uint16_t ui16Value);
+extern uint32_t XBeeConcCount(void);
+extern void XBeeConcStatsGet(tXBeeConcStats *psStats);
+extern int Cmd_conc(int argc, char *argv[]);
+
+#endif //__XBEECONC_H__
@@ -30,6 +30,33 @@
 #include "utils/uartstdio.h"
 #include "inc/lm4f120h5qr.h"
 #include "rgb.h"
+#include "XBeeUart.h"
+#include "XBeeFrame.h"
+#include "XBeeTick.h"
+#include "XBeeResp.h"
+#include "XBeeNode.h"
+#include "XBeeLink.h"
+#include "XBeeBulk.h"
+#include "XBeeLz.h"
+#include "XBeeIo.h"
+#include "XBeeHost.h"
+#include "XBeeBoot.h"
+#include "XBeeClock.h"
+#include "XBeeSched.h"
+#include "XBeeTx.h"
+#include "XBeeProf.h"
+#include "XBeePool.h"
+#include "XBeeTrace.h"
+#include "XBeeQual.h"
+#include "XBeeIdle.h"
+#include "XBeeBridge.h"
+#include "XBeeDup.h"
+#include "XBeeAir.h"
+#include "XBeeConc.h"
+#include "XBeeChan.h"
+#include "XBeeSlot.h"
+#include "XBeeStore.h"
+#include "XBeeIc.h"
 #include "XBee.h"
 
 //LED Defines
@@ -57,49 +84,66 @@ static char g_pcCmdBuf[CMD_BUF_SIZE];
 
 //*****************************************************************************
 //
-// The UART1 interrupt handler.
-// Get response from XBee (UART1), print to terminal (UART0)
+// Poll UART0 for command line input without blocking, so responses from the
+// XBee keep draining while a command is typed. Echo and backspace work as
+// in UARTgets(). Returns true once a complete line is in g_pcCmdBuf.
 //
 //*****************************************************************************
-void
-UART1IntHandler(void)
+static bool
+ConsoleLinePoll(void)
 {
-	unsigned char x;
-    uint32_t ui32Status;
+    static uint32_t ui32Count = 0;
+    static uint32_t ui32KeyTick = 0;
+    static bool bLastWasCR = false;
+    unsigned char x;
 
-    //
-    // Get the interrrupt status.
-    //
-    ui32Status = ROM_UARTIntStatus(UART1_BASE, true);
+    while(ROM_UARTCharsAvail(UART0_BASE))
+    {
+        x = ROM_UARTCharGetNonBlocking(UART0_BASE);
+        ui32KeyTick = XBeeTickGet();
 
-    //
-    // Clear the asserted interrupts.
-    //
-    ROM_UARTIntClear(UART1_BASE, ui32Status);
+        //
+        // Swallow the LF of a CR/LF pair
+        //
+        if((x == '\n') && bLastWasCR)
+        {
+            bLastWasCR = false;
+            continue;
+        }
+        bLastWasCR = (x == '\r');
+
+        if((x == '\r') || (x == '\n'))
+        {
+            g_pcCmdBuf[ui32Count] = 0;
+            ui32Count = 0;
+            UARTprintf("\n");
+            return true;
+        }
+        else if((x == '\b') || (x == 0x7f))
+        {
+            if(ui32Count)
+            {
+                ui32Count--;
+                UARTprintf("\b \b");
+            }
+        }
+        else if(ui32Count < (CMD_BUF_SIZE - 1))
+        {
+            g_pcCmdBuf[ui32Count++] = x;
+            ROM_UARTCharPut(UART0_BASE, x);
+        }
+    }
 
-	  UARTprintf("Response:'");
     //
-    // Loop while there are characters in the receive FIFO.
+    // No sleeping while a line is being typed, so Enter gets no wake delay
     //
-    while(ROM_UARTCharsAvail(UART1_BASE))
+    if(ui32Count &&
+       !XBEE_TICK_REACHED(XBeeTickGet(), ui32KeyTick + XBEE_IDLE_TYPING_MS))
     {
-        //
-        // Read the next character from the UART and write it back to the UART.
-        // if special character print out the integer for it
-			  //
-				x=ROM_UARTCharGetNonBlocking(UART1_BASE);
-				if(x<' ' | x>'~')
-				{
-					UARTprintf("/%d",(int)x);
-					//ROM_UARTCharPutNonBlocking(UART0_BASE,x);
-				}
-				else
-				{
-					ROM_UARTCharPutNonBlocking(UART0_BASE,x);
-				}
-					
+        XBeeIdleBusy();
     }
-		UARTprintf("'\n");
+
+    return false;
 }
 
 //*****************************************************************************
@@ -187,11 +231,41 @@ tCmdLineEntry g_sCmdTable[] =
 		{ "ATP",  	Cmd_ATP,    "Config I/O pins 10-11: usage: ATP <pin#> <command> " },
 		{ "ATIR",  	Cmd_ATIR,   "I/O Rate Set: Hex Value sets rate in miliseconds, 0 turns off " },
 		{ "ATIT",  	Cmd_ATIT,   "Itteration Tailor: Set number of samples (hex) taken before transmit (max 0x44): ATIT <hex #> " },
+		{ "ATIC",  	Cmd_ATIC,   "Change Detect: Hex mask of DIO lines that send a sample when they change, 0 turns off: ATIC <hex #> " },
 		{ "ATIA",  	Cmd_ATIA,   "Input Address allows updates from given XBee address: ATIA <address> " },
 		{ "AT%V",  	Cmd_ATV,    "% Voltage Command: Returns supply voltage, useful for tracking battery" },
 		{ "ATPR",  	Cmd_ATPR,   "Pull Up Resistor: ATPR <1=on, 0=off>" },
 		{ "ATRE",  	Cmd_ATRE,   "Reset Command: Reset all configs to factory presets" },
+		{ "ATND",  	Cmd_ATND,   "Node Discover: find nodes on the PAN into the node table: ATND [NI]" },
 		{ "test",  	test,   		"test functionality" },
+		{ "uart",  	Cmd_uart,   "UART1 link stats: uart [clear | flow <1/0> | baud <rate>]" },
+		{ "escbench",	Cmd_escbench,	"Time API mode 2 escape / unescape (cycles per byte x100)" },
+		{ "params",	Cmd_params,	"Show values decoded from XBee responses (serial, MY, ID, %V)" },
+		{ "respbench",	Cmd_respbench,	"Time the AT response tokenizer" },
+		{ "nodes",	Cmd_nodes,	"Show node table from ATND: nodes [clear | layout <s1 | zb>]" },
+		{ "link",	Cmd_link,	"Node to node message stats: link [clear | lz <1/0>]" },
+		{ "send",	Cmd_send,	"Bulk send part of the flash image to a node running recv: send <bytes> [fragsize]" },
+		{ "recv",	Cmd_recv,	"Receive one bulk transfer: recv [sink | stop]" },
+		{ "lzbench",	Cmd_lzbench,	"Time message compression and show the effective link rate" },
+		{ "io",	Cmd_io,	"Received I/O sample output: io [raw | agg [window ms] | lines | clear]" },
+		{ "host",	Cmd_host,	"Switch UART0 to binary host frames: host [stats]" },
+		{ "boot",	Cmd_boot,	"Radio mode and baud found at boot, ready time: boot [probe]" },
+		{ "clock",	Cmd_clock,	"Clock governor, load and energy per level: clock [auto | 16 | 80 | clear]" },
+		{ "sched",	Cmd_sched,	"TX queueing delay per class: sched [clear | share <control|data|bulk> <%>]" },
+		{ "tx",	Cmd_tx,	"API TX window and delivery: tx [clear | window <n> | sim <1/0> [ppm] | bench <n> [bytes]]" },
+		{ "prof",	Cmd_prof,	"Cycles per ISR, encoder and command (XBEE_PROFILE builds): prof [clear]" },
+		{ "pool",	Cmd_pool,	"Frame buffer pool use per size class: pool [clear]" },
+		{ "trace",	Cmd_trace,	"Latency between nodes: trace [clear | on | off | ping | gen <ms>]" },
+		{ "qual",	Cmd_qual,	"Link quality per node: qual [clear | db | bench <bytes> <ppm>]" },
+		{ "idle",	Cmd_idle,	"Sleep residency: idle [clear | on | off]" },
+		{ "bridge",	Cmd_bridge,	"PC <-> XBee pass through, ^]^]^] exits: bridge [stats]" },
+		{ "dup",	Cmd_dup,	"Duplicate suppression: dup [clear | bench [sources]]" },
+		{ "air",	Cmd_air,	"Airtime budget: air [on | off | clear | rate | duty | window]" },
+		{ "conc",	Cmd_conc,	"Concentrator node table: conc [list | clear | bench [nodes]]" },
+		{ "chan",	Cmd_chan,	"Quietest channel: chan [scan | mask | auto | loss | sim | noise]" },
+		{ "slot",	Cmd_slot,	"Sampling schedule: slot [plan <period> | stop | bench [period]]" },
+		{ "store",	Cmd_store,	"Flash queue while the link is down: store [on | off | clear]" },
+		{ "ic",	Cmd_ic,	"Change detection: ic [local | <hex addr> <hex mask> [hex IR ms] | bench [nodes]]" },
 
     { 0, 0, 0 }
 };
@@ -267,20 +341,32 @@ main(void)
     ROM_SysCtlClockSet(SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC | SYSCTL_OSC_MAIN |
                        SYSCTL_XTAL_16MHZ);
 
-	//Setup UART1 on PB0 / PB1
-		SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-		GPIOPinConfigure(GPIO_PB0_U1RX);
-		GPIOPinConfigure(GPIO_PB1_U1TX);
-		GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-		UARTStdioConfig(1, 9600, SysCtlClockGet());
+	//Fixed block buffers for frames on their way to the XBee
+		XBeePoolInit();
+
+	//Setup UART1 on PB0 / PB1, buffered. Flow control off until the XBee
+	//has been set to ATD6=1.
+		XBeeUartInit(9600, false);
 	
 		ConfigureUART(); //UART0
-		
-		//
-    // Enable the UART1 interrupt.
-    //
-    ROM_IntEnable(INT_UART1);
-    ROM_UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+
+	//1ms time base for response timeouts
+		XBeeTickInit();
+
+	//Sleep between events, woken by UART0, UART1 or the next deadline
+		XBeeIdleInit();
+
+	//Run at 16MHz, 80MHz only while the link is busy
+		XBeeClockInit();
+
+	//Cycle counts per scope when built with XBEE_PROFILE
+		XBeeProfInit();
+
+	//Route UART1 bytes to the AT response decoder or node messages
+		XBeeLinkInit();
+
+	//Messages left in the flash queue by a reset go out once the link is up
+		XBeeStoreInit();
 
 
 	//Initialize LED's
@@ -298,11 +384,17 @@ main(void)
     //
     ROM_IntMasterEnable();
 		
+		//
+		// Find the radio's mode and baud rate and read its parameters. The
+		// command list waits for 'help' so it does not hold up the probe.
+		//
+		XBeeBootProbe();
+		UARTprintf("Type 'help' for a list of commands\n");
+
 		//
     // Enter an infinite loop for reading and processing commands from the
     // user.
     //
-		Cmd_help(0,0);
     while(1)
     {
         //
@@ -311,15 +403,20 @@ main(void)
         UARTprintf("\n> ");
 
         //
-        // Get a line of text from the user.
+        // Get a line of text from the user, servicing the XBee link while
+        // waiting. In host mode UART0 carries binary frames instead.
         //
-        UARTgets(g_pcCmdBuf, sizeof(g_pcCmdBuf));
+        while(XBeeHostPoll() || !ConsoleLinePoll())
+        {
+            XBeeLinkPoll();
+            XBeeIdleEnter();
+        }
 
         //
         // Pass the line from the user to the command processor.  It will be
         // parsed and valid commands executed.
         //
-        nStatus = CmdLineProcess(g_pcCmdBuf);
+        nStatus = XBeeProfCmdLine(g_pcCmdBuf);
 
         //
         // Handle the case of bad command.
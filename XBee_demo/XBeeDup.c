@@ -0,0 +1,417 @@
+//*****************************************************************************
+//
+// XBeeDup.c - Duplicate message suppression by source and sequence
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! A message can arrive twice: the receiving MAC passes on a retry whose
+//! first copy got through but whose ACK was lost, or a sender puts the same
+//! message on the air again. Link messages other than bulk fragments, which
+//! have their own sequence and ACKs, therefore carry a 16-bit number after
+//! the payload (XBEE_MSG_FLAG_SEQ), one counter per sender.
+//!
+//! For each source the receiver keeps the highest number seen and a 32 bit
+//! map of the ones before it, like an IPsec replay window. Sources are the
+//! concentrator's node numbers (XBeeConc.c), which the receive path has
+//! already looked up, so the state is one column per field indexed by it
+//! and checking a number is a shift and a mask: a duplicate is dropped in
+//! constant time before the message is expanded or dispatched. Every node
+//! the concentrator has room for is covered; a sender it has no room for
+//! is not checked.
+//!
+//! Numbers only have to be unique per sender, so gaps (messages to other
+//! nodes) cost nothing. A number further back than the window cannot be
+//! told from an old copy and is dropped, without counting as a sign of
+//! life. A sender that restarts picks a new first number (XBeeDupSeqNext);
+//! if that lands ahead of its old window it is heard at once, otherwise
+//! once the source has expired.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeePool.h"
+#include "XBeeTick.h"
+#include "XBeeConc.h"
+#include "XBeeDup.h"
+
+//*****************************************************************************
+//
+// A set of sources, one field per array: bit n of the window is set if
+// sequence number seq - 1 - n has been received, a set bit in the known
+// map marks a source with state. The receive path checks against the
+// live set; the benchmark builds a scratch one in a pool buffer.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t *pui32Window;
+	uint16_t *pui16Seq;
+	uint16_t *pui16Age;
+	uint32_t *pui32Known;
+	uint32_t ui32Sources;
+	tXBeeDupStats *psStats;
+}
+tXBeeDupSet;
+
+//*****************************************************************************
+//
+// The live set, then the sequence number of the next message sent from
+// here.
+//
+//*****************************************************************************
+static uint32_t g_pui32DupWindow[XBEE_DUP_SOURCES];
+static uint16_t g_pui16DupSeq[XBEE_DUP_SOURCES];
+static uint16_t g_pui16DupAge[XBEE_DUP_SOURCES];
+static uint32_t g_pui32DupKnown[(XBEE_DUP_SOURCES + 31) / 32];
+static tXBeeDupStats g_sDupStats;
+static const tXBeeDupSet g_sDupLive =
+{
+	g_pui32DupWindow, g_pui16DupSeq, g_pui16DupAge, g_pui32DupKnown,
+	XBEE_DUP_SOURCES, &g_sDupStats
+};
+static uint16_t g_ui16DupSeq;
+static bool g_bDupSeqSet;
+
+//*****************************************************************************
+//
+// The age of an entry is 16 bits of XBEE_DUP_AGE_SHIFT ticks, which must
+// hold the expiry time.
+//
+//*****************************************************************************
+#if (XBEE_DUP_EXPIRE_MS >> XBEE_DUP_AGE_SHIFT) > 0x7FFF
+#error "XBEE_DUP_EXPIRE_MS does not fit the entry age"
+#endif
+
+//*****************************************************************************
+//
+// Messages in the benchmark, and the sources its scratch set holds: 8
+// bytes each and the known map in one XBEE_POOL_LARGE buffer.
+//
+//*****************************************************************************
+#define DUPBENCH_MSGS           20000
+#define DUPBENCH_SOURCES        32
+
+//*****************************************************************************
+//
+// Forget all sources.
+//
+//*****************************************************************************
+void
+XBeeDupClear(void)
+{
+	memset(g_pui32DupKnown, 0, sizeof(g_pui32DupKnown));
+}
+
+//*****************************************************************************
+//
+// Forget source ui32Source, a node number the concentrator gives to
+// another node.
+//
+//*****************************************************************************
+void
+XBeeDupForget(uint32_t ui32Source)
+{
+	if(ui32Source < XBEE_DUP_SOURCES)
+	{
+		g_pui32DupKnown[ui32Source / 32] &= ~(1u << (ui32Source & 31));
+	}
+}
+
+//*****************************************************************************
+//
+// Sequence number for the next message sent. The first one is taken from
+// the microsecond clock: a receiver keeps a source for XBEE_DUP_EXPIRE_MS,
+// and a sender that restarts sooner than that and always began at 0 would
+// land behind its old window every time, with its messages dropped until
+// the source expires. From the clock that happens about half the time.
+//
+//*****************************************************************************
+uint16_t
+XBeeDupSeqNext(void)
+{
+	return XBeeDupSeqTake(1);
+}
+
+//*****************************************************************************
+//
+// The first of ui32Count consecutive sequence numbers, for a sender that
+// numbers several messages at once. With 0 it is the next number that
+// will be given out.
+//
+//*****************************************************************************
+uint16_t
+XBeeDupSeqTake(uint32_t ui32Count)
+{
+	uint16_t ui16Seq;
+
+	if(!g_bDupSeqSet)
+	{
+		g_ui16DupSeq = (uint16_t)XBeeTickMicros();
+		g_bDupSeqSet = true;
+	}
+	ui16Seq = g_ui16DupSeq;
+	g_ui16DupSeq += ui32Count;
+	return ui16Seq;
+}
+
+//*****************************************************************************
+//
+// Record message ui16Seq from source ui32Source in psSet. Returns false if
+// it has been seen already, or is too far behind to tell, and should be
+// dropped. Sources outside the set are let through.
+//
+//*****************************************************************************
+static bool
+XBeeDupSetCheck(const tXBeeDupSet *psSet, uint32_t ui32Source,
+                uint16_t ui16Seq)
+{
+	uint32_t *pui32Known;
+	uint32_t ui32Known;
+	uint32_t ui32Bit;
+	uint16_t ui16Now;
+	int32_t i32Delta;
+
+	if(ui32Source >= psSet->ui32Sources)
+	{
+		psSet->psStats->ui32Untracked++;
+		return true;
+	}
+
+	psSet->psStats->ui32Checked++;
+	ui16Now = (uint16_t)(XBeeTickGet() >> XBEE_DUP_AGE_SHIFT);
+	pui32Known = &psSet->pui32Known[ui32Source / 32];
+	ui32Known = 1u << (ui32Source & 31);
+
+	if(!(*pui32Known & ui32Known))
+	{
+		*pui32Known |= ui32Known;
+	}
+	else if((uint16_t)(ui16Now - psSet->pui16Age[ui32Source]) <
+	        (XBEE_DUP_EXPIRE_MS >> XBEE_DUP_AGE_SHIFT))
+	{
+		i32Delta = (int16_t)(ui16Seq - psSet->pui16Seq[ui32Source]);
+
+		//
+		// Too far behind to tell from an old copy: drop it, and leave the
+		// age alone so a restarted sender is heard once the source expires
+		//
+		if(-i32Delta > XBEE_DUP_WINDOW)
+		{
+			psSet->psStats->ui32Late++;
+			return false;
+		}
+		psSet->pui16Age[ui32Source] = ui16Now;
+
+		//
+		// Ahead: slide the window up, the old highest becomes bit
+		// i32Delta - 1
+		//
+		if(i32Delta > 0)
+		{
+			if(i32Delta > XBEE_DUP_WINDOW)
+			{
+				psSet->pui32Window[ui32Source] = 0;
+			}
+			else if(i32Delta == XBEE_DUP_WINDOW)
+			{
+				psSet->pui32Window[ui32Source] = 1u << (XBEE_DUP_WINDOW - 1);
+			}
+			else
+			{
+				psSet->pui32Window[ui32Source] =
+				    (psSet->pui32Window[ui32Source] << i32Delta) |
+				    (1u << (i32Delta - 1));
+			}
+			psSet->pui16Seq[ui32Source] = ui16Seq;
+			return true;
+		}
+
+		//
+		// At or behind within the window: a duplicate if already marked
+		//
+		if(i32Delta == 0)
+		{
+			psSet->psStats->ui32Suppressed++;
+			return false;
+		}
+		ui32Bit = 1u << (-i32Delta - 1);
+		if(psSet->pui32Window[ui32Source] & ui32Bit)
+		{
+			psSet->psStats->ui32Suppressed++;
+			return false;
+		}
+		psSet->pui32Window[ui32Source] |= ui32Bit;
+		return true;
+	}
+	else
+	{
+		psSet->psStats->ui32Restarts++;
+	}
+
+	//
+	// New or quiet too long: start over from this message
+	//
+	psSet->pui16Seq[ui32Source] = ui16Seq;
+	psSet->pui32Window[ui32Source] = 0;
+	psSet->pui16Age[ui32Source] = ui16Now;
+	return true;
+}
+
+//*****************************************************************************
+//
+// Record message ui16Seq from source ui32Source, a node number or
+// XBEE_DUP_PEER. Returns false if it should be dropped. Messages from any
+// other source (XBEE_CONC_NONE, a node the concentrator had no room for)
+// are let through.
+//
+//*****************************************************************************
+bool
+XBeeDupCheck(uint32_t ui32Source, uint16_t ui16Seq)
+{
+	return XBeeDupSetCheck(&g_sDupLive, ui32Source, ui16Seq);
+}
+
+void
+XBeeDupStatsGet(tXBeeDupStats *psStats)
+{
+	*psStats = g_sDupStats;
+}
+
+//*****************************************************************************
+//
+// Feed DUPBENCH_MSGS messages from ui32Sources senders, taking turns, one in
+// eight of them a repeat of one of the last few, to a scratch set of
+// DUPBENCH_SOURCES in a pool buffer; the live windows are not touched. The
+// senders are numbered 0 up, as the concentrator would give them. Prints
+// the cycles per check and how many repeats were not caught (those of
+// senders beyond the scratch set). Returns 1 if there was no buffer.
+//
+//*****************************************************************************
+static int
+XBeeDupBench(uint32_t ui32Sources)
+{
+	tXBeeDupStats sStats;
+	tXBeeDupSet sSet;
+	tXBeeBuf *psBuf;
+	uint32_t ui32Sent;
+	uint32_t ui32Msg;
+	uint32_t ui32Repeats;
+	uint32_t ui32Missed;
+	uint32_t ui32Start;
+	uint32_t ui32Cycles;
+	uint32_t ui32Count;
+	bool bRepeat;
+
+	psBuf = XBeePoolAlloc((DUPBENCH_SOURCES * 8) + (DUPBENCH_SOURCES / 8));
+	if(!psBuf)
+	{
+		UARTprintf("Error: no buffer for the benchmark\n");
+		return 1;
+	}
+	sSet.pui32Window = (uint32_t *)psBuf->pui8Data;
+	sSet.pui16Seq = (uint16_t *)(sSet.pui32Window + DUPBENCH_SOURCES);
+	sSet.pui16Age = sSet.pui16Seq + DUPBENCH_SOURCES;
+	sSet.pui32Known = (uint32_t *)(sSet.pui16Age + DUPBENCH_SOURCES);
+	sSet.ui32Sources = DUPBENCH_SOURCES;
+	sSet.psStats = &sStats;
+	memset(sSet.pui32Known, 0, DUPBENCH_SOURCES / 8);
+	memset(&sStats, 0, sizeof(sStats));
+
+	ui32Sent = 0;
+	ui32Repeats = 0;
+	ui32Missed = 0;
+	ui32Cycles = 0;
+	srand(1);
+
+	for(ui32Count = 0; ui32Count < DUPBENCH_MSGS; ui32Count++)
+	{
+		bRepeat = (ui32Sent > 8) && ((rand() & 7) == 0);
+		ui32Msg = bRepeat ? (ui32Sent - 1 - (rand() & 7)) : ui32Sent++;
+
+		ui32Start = XBeeCycleCountGet();
+		if(XBeeDupSetCheck(&sSet, ui32Msg % ui32Sources,
+		                   (uint16_t)(ui32Msg / ui32Sources)) && bRepeat)
+		{
+			ui32Missed++;
+		}
+		ui32Cycles += XBeeCycleCountGet() - ui32Start;
+		ui32Repeats += bRepeat;
+	}
+	XBeePoolFree(psBuf);
+
+	UARTprintf("%4u sources: %u cycles/check, %u of %u repeats dropped, "
+	           "%u messages untracked\n", ui32Sources,
+	           ui32Cycles / DUPBENCH_MSGS, ui32Repeats - ui32Missed,
+	           ui32Repeats, sStats.ui32Untracked);
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Dup Command
+// Input: none / 'clear' / 'bench [sources]'
+// Response: messages checked, duplicates dropped, numbers too far behind
+//		the window dropped, sources that expired and started over, and
+//		messages from senders with no node number, which are not checked
+// Use: to see how many messages arrive twice. 'bench' times the check
+//		with that many senders (by default up to twice what its scratch
+//		set holds) and counts the repeats caught. It leaves the live
+//		windows alone.
+//
+//*****************************************************************************
+int
+Cmd_dup(int argc, char *argv[])
+{
+	uint32_t ui32Sources;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeDupClear();
+		memset(&g_sDupStats, 0, sizeof(g_sDupStats));
+		return 0;
+	}
+	else if((argc >= 2) && (argc <= 3) && (0 == strcmp(argv[1], "bench")))
+	{
+		if(argc == 3)
+		{
+			ui32Sources = strtoul(argv[2], 0, 10);
+			if((ui32Sources == 0) || (ui32Sources > 0xFFFF))
+			{
+				UARTprintf("Error: invalid input, try again\n");
+				return 1;
+			}
+			return XBeeDupBench(ui32Sources);
+		}
+		return XBeeDupBench(1) || XBeeDupBench(DUPBENCH_SOURCES / 2) ||
+		       XBeeDupBench(DUPBENCH_SOURCES) ||
+		       XBeeDupBench(DUPBENCH_SOURCES * 2);
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("checked %u, duplicates dropped %u, too late %u, "
+	           "expired %u, untracked %u\n", g_sDupStats.ui32Checked,
+	           g_sDupStats.ui32Suppressed, g_sDupStats.ui32Late,
+	           g_sDupStats.ui32Restarts, g_sDupStats.ui32Untracked);
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+//*****************************************************************************
+//
+// XBeeDup.h - Headers for use with XBeeDup.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEDUP_H__
+#define __XBEEDUP_H__
+
+//*****************************************************************************
+//
+// Sources tracked: every concentrator node (XBeeConc.h) by its number,
+// and in transparent mode, where the only sender is the other node,
+// XBEE_DUP_PEER. 8 bytes per source.
+//
+//*****************************************************************************
+#define XBEE_DUP_PEER           XBEE_CONC_NODES
+#define XBEE_DUP_SOURCES        (XBEE_CONC_NODES + 1)
+
+//*****************************************************************************
+//
+// Sequence number trailer on link messages flagged XBEE_MSG_FLAG_SEQ, and
+// the sequence numbers remembered behind the highest one of a source. A
+// number further back than the window is dropped: it may be a copy of a
+// message long since passed on. A source whose messages have all been
+// dropped or missing for XBEE_DUP_EXPIRE_MS is forgotten, and the next
+// number from it starts over; that is how a restarted sender is heard
+// again.
+//
+// XBEE_DUP_RETRY_MS is the longest a sender may wait before putting the
+// same message on the air again; the store probes every XBEE_STORE_PROBE_MS
+// (checked in XBeeStore.c), MAC retries come within milliseconds. A source
+// is kept for several of those, or the copy after a long gap gets through.
+//
+//*****************************************************************************
+#define XBEE_DUP_SEQ_SIZE       2
+#define XBEE_DUP_WINDOW         32
+#define XBEE_DUP_RETRY_MS       10000
+#define XBEE_DUP_EXPIRE_MS      (6 * XBEE_DUP_RETRY_MS)
+
+//*****************************************************************************
+//
+// The time of a source's last message is kept as the tick count
+// >> XBEE_DUP_AGE_SHIFT, 16 bits.
+//
+//*****************************************************************************
+#define XBEE_DUP_AGE_SHIFT      6
+
+//*****************************************************************************
+//
+// Counters
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Checked;
+	uint32_t ui32Suppressed;            // duplicates dropped
+	uint32_t ui32Late;                  // far behind the window, dropped
+	uint32_t ui32Restarts;              // source expired, started over
+	uint32_t ui32Untracked;             // from no node number, not checked
+}
+tXBeeDupStats;
+
+//*****************************************************************************
+//
+// Duplicate suppression functions
+//
+//*****************************************************************************
+extern void XBeeDupClear(void);
+extern void XBeeDupForget(uint32_t ui32Source);
+extern uint16_t XBeeDupSeqNext(void);
+extern uint16_t XBeeDupSeqTake(uint32_t ui32Count);
+extern bool XBeeDupCheck(uint32_t ui32Source, uint16_t ui16Seq);
+extern void XBeeDupStatsGet(tXBeeDupStats *psStats);
+extern int Cmd_dup(int argc, char *argv[]);
+
+#endif //__XBEEDUP_H__
@@ -0,0 +1,702 @@
+//*****************************************************************************
+//
+// XBeeFrame.c - API mode 2 (escaped) frame encoder / decoder
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! In API mode 2 every 0x7E, 0x7D, 0x11 and 0x13 inside a frame is sent as
+//! 0x7D followed by the byte XOR 0x20. Real payloads rarely contain these, so
+//! the encoder and decoder test four bytes at a time and copy clean runs
+//! with one memcpy, only dropping to a byte loop for a word that may hold a
+//! special byte. The frame checksum is summed from the same words.
+//!
+//! Frame layout: 0x7E, length MSB, length LSB, frame data, checksum. The
+//! length counts the frame data only, the checksum is 0xFF minus the low
+//! byte of the sum of the frame data.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeePool.h"
+#include "XBeeSched.h"
+#include "XBeeProf.h"
+#include "XBeeTick.h"
+#include "XBeeAir.h"
+#include "XBeeFrame.h"
+
+//*****************************************************************************
+//
+// Word tests. XBEE_HASZERO is non zero if any byte of v is 0x00 (it can give
+// a false positive but never a false negative, which only costs a trip
+// through the byte loop). Masking bit 0 and 1 folds 0x7C-0x7F onto 0x7C,
+// masking bit 1 folds 0x11 / 0x13 onto 0x11.
+//
+//*****************************************************************************
+#define XBEE_HASZERO(v)         (((v) - 0x01010101) & ~(v) & 0x80808080)
+#define XBEE_HASBYTE(w, b)      XBEE_HASZERO((w) ^ (0x01010101 * (b)))
+#define XBEE_WORD_ESC_TX(w)     (XBEE_HASBYTE((w) & 0xFCFCFCFC, 0x7C) |     \
+                                 XBEE_HASBYTE((w) & 0xFDFDFDFD, 0x11))
+#define XBEE_WORD_ESC_RX(w)     XBEE_HASBYTE((w) & 0xFCFCFCFC, 0x7C)
+
+//*****************************************************************************
+//
+// Byte sum of a word, only the low byte of the result is meaningful. The two
+// 16-bit lanes each hold two bytes, the high lane lands above bit 15 after
+// the fold and drops out of the low byte.
+//
+//*****************************************************************************
+#define XBEE_WORD_SUM(w)        ((((w) & 0x00FF00FF) +                      \
+                                  (((w) >> 8) & 0x00FF00FF)) +              \
+                                 ((((w) & 0x00FF00FF) +                     \
+                                   (((w) >> 8) & 0x00FF00FF)) >> 16))
+
+//*****************************************************************************
+//
+// Receiver states
+//
+//*****************************************************************************
+#define XBEE_RX_DELIM           0
+#define XBEE_RX_LEN_HI          1
+#define XBEE_RX_LEN_LO          2
+#define XBEE_RX_DATA            3
+#define XBEE_RX_CHECKSUM        4
+
+//*****************************************************************************
+//
+// True for the four bytes that must be escaped.
+//
+//*****************************************************************************
+static bool
+XBeeFrameIsSpecial(uint8_t ui8Byte)
+{
+	return (ui8Byte == XBEE_FRAME_DELIM) || (ui8Byte == XBEE_FRAME_ESC) ||
+	       (ui8Byte == XBEE_FRAME_XON) || (ui8Byte == XBEE_FRAME_XOFF);
+}
+
+//*****************************************************************************
+//
+// Escape ui32Len bytes from pui8Src into pui8Dst, which must hold twice that.
+// Returns the number of bytes written. The unescaped bytes are added to
+// *pui32Sum.
+//
+//*****************************************************************************
+uint32_t
+XBeeFrameEscape(uint8_t *pui8Dst, const uint8_t *pui8Src, uint32_t ui32Len,
+                uint32_t *pui32Sum)
+{
+	uint8_t *pui8Start;
+	uint32_t ui32Sum;
+	uint32_t ui32Word;
+	uint32_t ui32Run;
+	uint8_t ui8Byte;
+	int x;
+
+	pui8Start = pui8Dst;
+	ui32Sum = *pui32Sum;
+
+	while(ui32Len)
+	{
+		//
+		// Measure the run of clean words, then copy it in one go
+		//
+		for(ui32Run = 0; (ui32Len - ui32Run) >= 4; ui32Run += 4)
+		{
+			memcpy(&ui32Word, pui8Src + ui32Run, 4);
+			if(XBEE_WORD_ESC_TX(ui32Word))
+			{
+				break;
+			}
+			ui32Sum += XBEE_WORD_SUM(ui32Word);
+		}
+		if(ui32Run)
+		{
+			memcpy(pui8Dst, pui8Src, ui32Run);
+			pui8Dst += ui32Run;
+			pui8Src += ui32Run;
+			ui32Len -= ui32Run;
+		}
+
+		//
+		// Byte loop for the suspect word, or the tail
+		//
+		for(x = 0; (x < 4) && ui32Len; x++, ui32Len--)
+		{
+			ui8Byte = *pui8Src++;
+			ui32Sum += ui8Byte;
+			if(XBeeFrameIsSpecial(ui8Byte))
+			{
+				*pui8Dst++ = XBEE_FRAME_ESC;
+				*pui8Dst++ = ui8Byte ^ XBEE_FRAME_ESC_XOR;
+			}
+			else
+			{
+				*pui8Dst++ = ui8Byte;
+			}
+		}
+	}
+
+	*pui32Sum = ui32Sum;
+	return pui8Dst - pui8Start;
+}
+
+//*****************************************************************************
+//
+// Unescape from pui8Src into pui8Dst until ui32DstLen bytes are produced,
+// the source runs out, or an unescaped 0x7E (start of the next frame) is
+// found. The 0x7E is not consumed. *pbEscaped carries a trailing 0x7D over
+// to the next call. Returns bytes produced, *pui32Used is bytes consumed.
+//
+//*****************************************************************************
+uint32_t
+XBeeFrameUnescape(uint8_t *pui8Dst, uint32_t ui32DstLen,
+                  const uint8_t *pui8Src, uint32_t ui32Len,
+                  uint32_t *pui32Used, bool *pbEscaped, uint32_t *pui32Sum)
+{
+	const uint8_t *pui8SrcStart;
+	uint8_t *pui8DstStart;
+	uint32_t ui32Sum;
+	uint32_t ui32Word;
+	uint32_t ui32Run;
+	uint32_t ui32Max;
+	uint8_t ui8Byte;
+
+	pui8SrcStart = pui8Src;
+	pui8DstStart = pui8Dst;
+	ui32Sum = *pui32Sum;
+
+	while(ui32Len && ui32DstLen)
+	{
+		if(!*pbEscaped)
+		{
+			ui32Max = (ui32Len < ui32DstLen) ? ui32Len : ui32DstLen;
+			for(ui32Run = 0; (ui32Max - ui32Run) >= 4; ui32Run += 4)
+			{
+				memcpy(&ui32Word, pui8Src + ui32Run, 4);
+				if(XBEE_WORD_ESC_RX(ui32Word))
+				{
+					break;
+				}
+				ui32Sum += XBEE_WORD_SUM(ui32Word);
+			}
+			if(ui32Run)
+			{
+				memcpy(pui8Dst, pui8Src, ui32Run);
+				pui8Dst += ui32Run;
+				pui8Src += ui32Run;
+				ui32Len -= ui32Run;
+				ui32DstLen -= ui32Run;
+				continue;
+			}
+		}
+
+		//
+		// One byte at a time until the next word boundary is clean
+		//
+		ui8Byte = *pui8Src;
+		if(ui8Byte == XBEE_FRAME_DELIM)
+		{
+			break;
+		}
+		pui8Src++;
+		ui32Len--;
+
+		if(*pbEscaped)
+		{
+			ui8Byte ^= XBEE_FRAME_ESC_XOR;
+			*pbEscaped = false;
+		}
+		else if(ui8Byte == XBEE_FRAME_ESC)
+		{
+			*pbEscaped = true;
+			continue;
+		}
+
+		*pui8Dst++ = ui8Byte;
+		ui32Sum += ui8Byte;
+		ui32DstLen--;
+	}
+
+	*pui32Sum = ui32Sum;
+	*pui32Used = pui8Src - pui8SrcStart;
+	return pui8Dst - pui8DstStart;
+}
+
+//*****************************************************************************
+//
+// Build a complete frame around ui32Len bytes of frame data (API identifier
+// first). pui8Dst must hold XBEE_FRAME_MAX_ENCODED(ui32Len) bytes. Returns
+// the encoded length.
+//
+//*****************************************************************************
+uint32_t
+XBeeFrameBuild(uint8_t *pui8Dst, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	uint8_t pui8Header[2];
+	uint32_t ui32Sum;
+	uint32_t ui32Out;
+	uint8_t ui8Check;
+
+	pui8Header[0] = (uint8_t)(ui32Len >> 8);
+	pui8Header[1] = (uint8_t)ui32Len;
+
+	XBEE_PROF_ENTER(XBEE_PROF_FRAME_BUILD);
+
+	pui8Dst[0] = XBEE_FRAME_DELIM;
+	ui32Out = 1;
+
+	//
+	// The length is escaped but not part of the checksum
+	//
+	ui32Sum = 0;
+	ui32Out += XBeeFrameEscape(pui8Dst + ui32Out, pui8Header, 2, &ui32Sum);
+
+	ui32Sum = 0;
+	ui32Out += XBeeFrameEscape(pui8Dst + ui32Out, pui8Data, ui32Len,
+	                           &ui32Sum);
+
+	ui8Check = 0xFF - (uint8_t)ui32Sum;
+	ui32Out += XBeeFrameEscape(pui8Dst + ui32Out, &ui8Check, 1, &ui32Sum);
+
+	XBEE_PROF_EXIT(XBEE_PROF_FRAME_BUILD);
+
+	return ui32Out;
+}
+
+//*****************************************************************************
+//
+// Encode a frame straight into a pool buffer and hand it to the scheduler
+// in a transmit class (see XBeeSched.h). The buffer is sized for the
+// escapes this data really needs, so most frames fit a MEDIUM block.
+// ui32Len may not exceed XBEE_FRAME_MAX_DATA. Returns false if the frame
+// could not be queued (no buffer, or the class's queue full).
+//
+//*****************************************************************************
+bool
+XBeeFrameQueue(uint32_t ui32Class, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	tXBeeBuf *psBuf;
+	uint32_t ui32Size;
+	uint32_t ui32Index;
+
+	//
+	// Delimiter, worst case length and checksum, data and its escapes
+	//
+	ui32Size = 1 + (2 * 3) + ui32Len;
+	for(ui32Index = 0; ui32Index < ui32Len; ui32Index++)
+	{
+		if(XBeeFrameIsSpecial(pui8Data[ui32Index]))
+		{
+			ui32Size++;
+		}
+	}
+
+	psBuf = XBeeSchedAlloc(ui32Class, ui32Size);
+	if(psBuf == 0)
+	{
+		return false;
+	}
+
+	psBuf->ui16Len = XBeeFrameBuild(psBuf->pui8Data, pui8Data, ui32Len);
+	psBuf->ui16AirLen = XBeeAirBytes(pui8Data, ui32Len, psBuf->ui16Len);
+	if((ui32Len > 1) && ((pui8Data[0] == XBEE_API_TX_64) ||
+	                     (pui8Data[0] == XBEE_API_TX_16)))
+	{
+		psBuf->ui8FrameId = pui8Data[1];
+	}
+	return XBeeSchedSubmit(ui32Class, psBuf);
+}
+
+//*****************************************************************************
+//
+// Encode and queue a frame for the XBee itself (API commands), in the
+// control class.
+//
+//*****************************************************************************
+void
+XBeeFrameSend(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	XBeeFrameQueue(XBEE_SCHED_CONTROL, pui8Data, ui32Len);
+}
+
+//*****************************************************************************
+//
+// Reset a frame receiver.
+//
+//*****************************************************************************
+void
+XBeeFrameRxInit(tXBeeFrameRx *psRx)
+{
+	memset(psRx, 0, sizeof(*psRx));
+	psRx->ui8State = XBEE_RX_DELIM;
+}
+
+//*****************************************************************************
+//
+// Feed received bytes to a frame receiver. pfnHandler is called for each
+// complete frame with a good checksum, from inside this call. Returns the
+// number of bytes used, which is less than ui32Len when a frame ended early
+// in the data, so the caller can route what follows elsewhere.
+//
+//*****************************************************************************
+uint32_t
+XBeeFrameRxFeed(tXBeeFrameRx *psRx, const uint8_t *pui8Data,
+                uint32_t ui32Len, tXBeeFrameHandler pfnHandler)
+{
+	const uint8_t *pui8Delim;
+	uint32_t ui32Start;
+	uint32_t ui32Used;
+	uint8_t ui8Byte;
+
+	ui32Start = ui32Len;
+
+	while(ui32Len)
+	{
+		//
+		// Hunt for the start of a frame
+		//
+		if(psRx->ui8State == XBEE_RX_DELIM)
+		{
+			pui8Delim = memchr(pui8Data, XBEE_FRAME_DELIM, ui32Len);
+			if(!pui8Delim)
+			{
+				return ui32Start;
+			}
+			ui32Len -= (pui8Delim - pui8Data) + 1;
+			pui8Data = pui8Delim + 1;
+			psRx->ui8State = XBEE_RX_LEN_HI;
+			psRx->bEscaped = false;
+			continue;
+		}
+
+		//
+		// Bulk of the frame goes through the word at a time decoder
+		//
+		if(psRx->ui8State == XBEE_RX_DATA)
+		{
+			psRx->ui16Count += XBeeFrameUnescape(
+			        &psRx->pui8Data[psRx->ui16Count],
+			        psRx->ui16Len - psRx->ui16Count, pui8Data, ui32Len,
+			        &ui32Used, &psRx->bEscaped, &psRx->ui32Sum);
+			pui8Data += ui32Used;
+			ui32Len -= ui32Used;
+
+			if(psRx->ui16Count == psRx->ui16Len)
+			{
+				psRx->ui8State = XBEE_RX_CHECKSUM;
+			}
+			if(!ui32Len)
+			{
+				return ui32Start;
+			}
+		}
+
+		//
+		// Header and checksum bytes, one at a time. A bare 0x7E anywhere
+		// means the previous frame was cut short.
+		//
+		ui8Byte = *pui8Data++;
+		ui32Len--;
+
+		if(ui8Byte == XBEE_FRAME_DELIM)
+		{
+			psRx->ui32Resync++;
+			psRx->ui8State = XBEE_RX_LEN_HI;
+			psRx->bEscaped = false;
+			continue;
+		}
+		if(psRx->bEscaped)
+		{
+			ui8Byte ^= XBEE_FRAME_ESC_XOR;
+			psRx->bEscaped = false;
+		}
+		else if(ui8Byte == XBEE_FRAME_ESC)
+		{
+			psRx->bEscaped = true;
+			continue;
+		}
+
+		switch(psRx->ui8State)
+		{
+			case XBEE_RX_LEN_HI:
+			{
+				psRx->ui16Len = (uint16_t)ui8Byte << 8;
+				psRx->ui8State = XBEE_RX_LEN_LO;
+				break;
+			}
+
+			case XBEE_RX_LEN_LO:
+			{
+				psRx->ui16Len |= ui8Byte;
+				psRx->ui16Count = 0;
+				psRx->ui32Sum = 0;
+				if((psRx->ui16Len == 0) ||
+				   (psRx->ui16Len > XBEE_FRAME_MAX_DATA))
+				{
+					psRx->ui32Oversize++;
+					psRx->ui8State = XBEE_RX_DELIM;
+					return ui32Start - ui32Len;
+				}
+				else
+				{
+					psRx->ui8State = XBEE_RX_DATA;
+				}
+				break;
+			}
+
+			case XBEE_RX_CHECKSUM:
+			{
+				if((uint8_t)(psRx->ui32Sum + ui8Byte) == 0xFF)
+				{
+					psRx->ui32Frames++;
+					pfnHandler(psRx->pui8Data, psRx->ui16Len);
+				}
+				else
+				{
+					psRx->ui32BadChecksum++;
+				}
+				psRx->ui8State = XBEE_RX_DELIM;
+				return ui32Start - ui32Len;
+			}
+
+			default:
+			{
+				psRx->ui8State = XBEE_RX_DELIM;
+				break;
+			}
+		}
+	}
+
+	return ui32Start;
+}
+
+//*****************************************************************************
+//
+// True when the receiver is between frames.
+//
+//*****************************************************************************
+bool
+XBeeFrameRxIdle(tXBeeFrameRx *psRx)
+{
+	return psRx->ui8State == XBEE_RX_DELIM;
+}
+
+//*****************************************************************************
+//
+// CRC-16/CCITT (polynomial 0x1021), a nibble at a time from a 16 entry
+// table. Start with 0xFFFF and pass the result back in to continue.
+//
+//*****************************************************************************
+static const uint16_t g_pui16Crc16Lut[16] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t
+XBeeCrc16(uint16_t ui16Crc, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	while(ui32Len--)
+	{
+		ui16Crc = (ui16Crc << 4) ^
+		          g_pui16Crc16Lut[(ui16Crc >> 12) ^ (*pui8Data >> 4)];
+		ui16Crc = (ui16Crc << 4) ^
+		          g_pui16Crc16Lut[(ui16Crc >> 12) ^ (*pui8Data & 0x0F)];
+		pui8Data++;
+	}
+
+	return ui16Crc;
+}
+
+//*****************************************************************************
+//
+// Benchmark buffers, XBEE_FRAME_MAX_DATA bytes and twice that for the
+// escaped copy, borrowed from the pool while the bench runs
+//
+//*****************************************************************************
+#define ESCBENCH_LOOPS          100
+
+static uint8_t *g_pui8BenchSrc;
+static uint8_t *g_pui8BenchEnc;
+static uint8_t *g_pui8BenchDec;
+
+//*****************************************************************************
+//
+// Reference escaper, one byte at a time, for comparison only.
+//
+//*****************************************************************************
+static uint32_t
+XBeeFrameEscapeBytewise(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                        uint32_t ui32Len, uint32_t *pui32Sum)
+{
+	uint32_t ui32Out;
+	uint32_t x;
+
+	for(ui32Out = 0, x = 0; x < ui32Len; x++)
+	{
+		*pui32Sum += pui8Src[x];
+		if(XBeeFrameIsSpecial(pui8Src[x]))
+		{
+			pui8Dst[ui32Out++] = XBEE_FRAME_ESC;
+			pui8Dst[ui32Out++] = pui8Src[x] ^ XBEE_FRAME_ESC_XOR;
+		}
+		else
+		{
+			pui8Dst[ui32Out++] = pui8Src[x];
+		}
+	}
+
+	return ui32Out;
+}
+
+//*****************************************************************************
+//
+// Time escape, bytewise escape and unescape of the bench buffer, print the
+// cycles per byte of each. Returns non zero if the round trip failed.
+//
+//*****************************************************************************
+static int
+XBeeFrameBenchRun(const char *pcName)
+{
+	uint32_t ui32Start;
+	uint32_t ui32Escape;
+	uint32_t ui32Bytewise;
+	uint32_t ui32Unescape;
+	uint32_t ui32Enc;
+	uint32_t ui32Dec;
+	uint32_t ui32Used;
+	uint32_t ui32Sum;
+	uint32_t ui32DecSum;
+	bool bEscaped;
+	int x;
+
+	ui32Start = XBeeCycleCountGet();
+	for(x = 0; x < ESCBENCH_LOOPS; x++)
+	{
+		ui32Sum = 0;
+		ui32Enc = XBeeFrameEscape(g_pui8BenchEnc, g_pui8BenchSrc,
+		                          XBEE_FRAME_MAX_DATA, &ui32Sum);
+	}
+	ui32Escape = XBeeCycleCountGet() - ui32Start;
+
+	ui32Start = XBeeCycleCountGet();
+	for(x = 0; x < ESCBENCH_LOOPS; x++)
+	{
+		ui32Sum = 0;
+		ui32Enc = XBeeFrameEscapeBytewise(g_pui8BenchEnc, g_pui8BenchSrc,
+		                                  XBEE_FRAME_MAX_DATA, &ui32Sum);
+	}
+	ui32Bytewise = XBeeCycleCountGet() - ui32Start;
+
+	ui32Start = XBeeCycleCountGet();
+	for(x = 0; x < ESCBENCH_LOOPS; x++)
+	{
+		ui32DecSum = 0;
+		bEscaped = false;
+		ui32Dec = XBeeFrameUnescape(g_pui8BenchDec, XBEE_FRAME_MAX_DATA,
+		                            g_pui8BenchEnc, ui32Enc, &ui32Used,
+		                            &bEscaped, &ui32DecSum);
+	}
+	ui32Unescape = XBeeCycleCountGet() - ui32Start;
+
+	UARTprintf("%8s: %3d -> %3d bytes, cycles/byte x100: escape %d, "
+	           "bytewise %d, unescape %d\n", pcName, XBEE_FRAME_MAX_DATA,
+	           ui32Enc, ui32Escape / XBEE_FRAME_MAX_DATA,
+	           ui32Bytewise / XBEE_FRAME_MAX_DATA,
+	           ui32Unescape / XBEE_FRAME_MAX_DATA);
+
+	if((ui32Dec != XBEE_FRAME_MAX_DATA) ||
+	   ((uint8_t)ui32DecSum != (uint8_t)ui32Sum) ||
+	   memcmp(g_pui8BenchDec, g_pui8BenchSrc, XBEE_FRAME_MAX_DATA))
+	{
+		UARTprintf("Error: round trip mismatch\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Escape Benchmark Command
+// Input: n/a
+// Response: cycles per byte (x100) for random, text and worst case payloads
+// Use: to check the cost of API mode 2 framing on this part
+//
+//*****************************************************************************
+int
+Cmd_escbench(int argc, char *argv[])
+{
+	tXBeeBuf *psSrc;
+	tXBeeBuf *psEnc;
+	tXBeeBuf *psDec;
+	uint32_t ui32Seed;
+	int iErrors;
+	int x;
+
+	psSrc = XBeePoolAlloc(XBEE_FRAME_MAX_DATA);
+	psEnc = XBeePoolAlloc(2 * XBEE_FRAME_MAX_DATA);
+	psDec = XBeePoolAlloc(XBEE_FRAME_MAX_DATA);
+	if(!psSrc || !psEnc || !psDec)
+	{
+		XBeePoolFree(psSrc);
+		XBeePoolFree(psEnc);
+		XBeePoolFree(psDec);
+		UARTprintf("Error: no pool buffers free, try again\n");
+		return 1;
+	}
+	g_pui8BenchSrc = psSrc->pui8Data;
+	g_pui8BenchEnc = psEnc->pui8Data;
+	g_pui8BenchDec = psDec->pui8Data;
+
+	XBeeCycleCountEnable();
+
+	iErrors = 0;
+
+	//
+	// Random bytes, about 1 in 64 needs escaping
+	//
+	ui32Seed = 12345;
+	for(x = 0; x < XBEE_FRAME_MAX_DATA; x++)
+	{
+		ui32Seed = (ui32Seed * 1103515245) + 12345;
+		g_pui8BenchSrc[x] = (uint8_t)(ui32Seed >> 16);
+	}
+	iErrors += XBeeFrameBenchRun("random");
+
+	//
+	// Printable text, never needs escaping
+	//
+	for(x = 0; x < XBEE_FRAME_MAX_DATA; x++)
+	{
+		g_pui8BenchSrc[x] = 'A' + (x % 26);
+	}
+	iErrors += XBeeFrameBenchRun("text");
+
+	//
+	// Every byte needs escaping
+	//
+	memset(g_pui8BenchSrc, XBEE_FRAME_DELIM, XBEE_FRAME_MAX_DATA);
+	iErrors += XBeeFrameBenchRun("worst");
+
+	XBeePoolFree(psSrc);
+	XBeePoolFree(psEnc);
+	XBeePoolFree(psDec);
+
+	return iErrors;
+}
@@ -0,0 +1,121 @@
+//*****************************************************************************
+//
+// XBeeFrame.h - Headers for use with XBeeFrame.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEFRAME_H__
+#define __XBEEFRAME_H__
+
+//*****************************************************************************
+//
+// API mode 2 (ATAP2) framing bytes
+//
+//*****************************************************************************
+#define XBEE_FRAME_DELIM        0x7E
+#define XBEE_FRAME_ESC          0x7D
+#define XBEE_FRAME_XON          0x11
+#define XBEE_FRAME_XOFF         0x13
+#define XBEE_FRAME_ESC_XOR      0x20
+
+//*****************************************************************************
+//
+// API identifiers
+//
+//*****************************************************************************
+#define XBEE_API_TX_64          0x00    // transmit request, 64-bit dest
+#define XBEE_API_TX_16          0x01    // transmit request, 16-bit dest
+#define XBEE_API_AT             0x08    // local AT command
+#define XBEE_API_REMOTE_AT      0x17    // AT command to another node
+#define XBEE_API_RX_64          0x80    // received data, 64-bit source
+#define XBEE_API_RX_16          0x81    // received data, 16-bit source
+#define XBEE_API_AT_RESPONSE    0x88
+#define XBEE_API_REMOTE_AT_RESPONSE 0x97
+#define XBEE_API_TX_STATUS      0x89
+#define XBEE_API_ZB_TX_STATUS   0x8B    // ZigBee firmware, with retry count
+#define XBEE_API_RX_IO_64       0x82    // I/O sample, 64-bit source
+#define XBEE_API_RX_IO_16       0x83    // I/O sample, 16-bit source
+
+//*****************************************************************************
+//
+// Largest frame data (API identifier + payload) accepted by the receiver,
+// and the worst case encoded size of a frame carrying n data bytes:
+// delimiter, then length, data and checksum all escaped.
+//
+//*****************************************************************************
+#define XBEE_FRAME_MAX_DATA     128
+#define XBEE_FRAME_MAX_ENCODED(n) (1 + (2 * ((n) + 3)))
+
+//*****************************************************************************
+//
+// Handler called by the receiver for every frame with a good checksum.
+// pui8Data points at the API identifier, ui32Len counts it.
+//
+//*****************************************************************************
+typedef void (*tXBeeFrameHandler)(const uint8_t *pui8Data, uint32_t ui32Len);
+
+//*****************************************************************************
+//
+// Streaming frame receiver state. Bytes may be fed in any sized pieces, an
+// escape split across two pieces is handled.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint8_t ui8State;
+	bool bEscaped;
+	uint16_t ui16Len;
+	uint16_t ui16Count;
+	uint32_t ui32Sum;
+	uint8_t pui8Data[XBEE_FRAME_MAX_DATA];
+	uint32_t ui32Frames;
+	uint32_t ui32BadChecksum;
+	uint32_t ui32Oversize;
+	uint32_t ui32Resync;
+}
+tXBeeFrameRx;
+
+//*****************************************************************************
+//
+// Escape engine. Both scan a 32-bit word at a time and copy clean words
+// straight through, adding their bytes into *pui32Sum on the way. The frame
+// checksum is 0xFF minus the low byte of that sum.
+//
+//*****************************************************************************
+extern uint32_t XBeeFrameEscape(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                                uint32_t ui32Len, uint32_t *pui32Sum);
+extern uint32_t XBeeFrameUnescape(uint8_t *pui8Dst, uint32_t ui32DstLen,
+                                  const uint8_t *pui8Src, uint32_t ui32Len,
+                                  uint32_t *pui32Used, bool *pbEscaped,
+                                  uint32_t *pui32Sum);
+
+//*****************************************************************************
+//
+// Frame build / send / receive
+//
+//*****************************************************************************
+extern uint32_t XBeeFrameBuild(uint8_t *pui8Dst, const uint8_t *pui8Data,
+                               uint32_t ui32Len);
+extern bool XBeeFrameQueue(uint32_t ui32Class, const uint8_t *pui8Data,
+                           uint32_t ui32Len);
+extern void XBeeFrameSend(const uint8_t *pui8Data, uint32_t ui32Len);
+extern void XBeeFrameRxInit(tXBeeFrameRx *psRx);
+extern uint32_t XBeeFrameRxFeed(tXBeeFrameRx *psRx, const uint8_t *pui8Data,
+                                uint32_t ui32Len,
+                                tXBeeFrameHandler pfnHandler);
+extern bool XBeeFrameRxIdle(tXBeeFrameRx *psRx);
+extern uint16_t XBeeCrc16(uint16_t ui16Crc, const uint8_t *pui8Data,
+                          uint32_t ui32Len);
+extern int Cmd_escbench(int argc, char *argv[]);
+
+#endif //__XBEEFRAME_H__
@@ -0,0 +1,367 @@
+//*****************************************************************************
+//
+// XBeeHost.c - Framed binary host protocol on the UART0 console
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! 'host' switches UART0 from the text console to length prefixed, CRC
+//! checked request / response frames (see XBeeHost.h). Every request
+//! carries a tag chosen by the host that is returned in its response, so
+//! the host does not have to wait for one answer before sending the next
+//! request. AT requests are answered from the response queue as the XBee
+//! replies, so up to XBEE_RESP_QUEUE_SIZE of them are in flight at once.
+//!
+//! Anything UARTprintf still prints (CMD requests, discovery results,
+//! transfer reports) goes out between frames as plain text. A host can log
+//! it or skip it while hunting for the next XBEE_HOST_SOF, the CRC stops a
+//! '\xA5' in the text being taken for a frame.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/rom.h"
+#include "driverlib/uart.h"
+#include "utils/cmdline.h"
+#include "utils/uartstdio.h"
+#include "XBeeSched.h"
+#include "XBeeProf.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeResp.h"
+#include "XBeeNode.h"
+#include "XBeeConc.h"
+#include "XBeeLink.h"
+#include "XBeeIdle.h"
+#include "XBeeHost.h"
+
+//*****************************************************************************
+//
+// Receiver
+//
+//*****************************************************************************
+static bool g_bHostActive;
+static uint8_t g_pui8HostRx[XBEE_HOST_MAX_FRAME];
+static uint32_t g_ui32HostRxCount;
+static uint32_t g_ui32HostRxTick;
+static tXBeeHostStats g_sHostStats;
+
+//*****************************************************************************
+//
+// Send one response frame.
+//
+//*****************************************************************************
+static void
+XBeeHostRespond(uint8_t ui8Tag, uint8_t ui8Op, uint8_t ui8Status,
+                const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	uint8_t pui8Hdr[6];
+	uint16_t ui16Crc;
+	uint32_t ui32Index;
+
+	pui8Hdr[0] = XBEE_HOST_SOF;
+	XBEE_PUT16(&pui8Hdr[1], ui32Len + 3);
+	pui8Hdr[3] = ui8Tag;
+	pui8Hdr[4] = ui8Op | XBEE_HOST_RESPONSE;
+	pui8Hdr[5] = ui8Status;
+
+	ui16Crc = XBeeCrc16(0xFFFF, &pui8Hdr[1], 5);
+	ui16Crc = XBeeCrc16(ui16Crc, pui8Data, ui32Len);
+
+	for(ui32Index = 0; ui32Index < sizeof(pui8Hdr); ui32Index++)
+	{
+		ROM_UARTCharPut(UART0_BASE, pui8Hdr[ui32Index]);
+	}
+	for(ui32Index = 0; ui32Index < ui32Len; ui32Index++)
+	{
+		ROM_UARTCharPut(UART0_BASE, pui8Data[ui32Index]);
+	}
+	ROM_UARTCharPut(UART0_BASE, ui16Crc >> 8);
+	ROM_UARTCharPut(UART0_BASE, ui16Crc & 0xFF);
+
+	g_sHostStats.ui32Responses++;
+}
+
+//*****************************************************************************
+//
+// Response handler for AT requests, pvArg is the request tag.
+//
+//*****************************************************************************
+static bool
+XBeeHostAtResp(void *pvArg, const tXBeeResp *psResp)
+{
+	uint8_t pui8Data[1 + 8 + XBEE_RESP_LINE_SIZE];
+	uint32_t ui32Len;
+	uint8_t ui8Status;
+
+	pui8Data[0] = psResp->ui32Type;
+	XBEE_PUT32(&pui8Data[1], (uint32_t)(psResp->ui64Value >> 32));
+	XBEE_PUT32(&pui8Data[5], (uint32_t)psResp->ui64Value);
+	ui32Len = psResp->ui32Len;
+	if(ui32Len > XBEE_RESP_LINE_SIZE)
+	{
+		ui32Len = XBEE_RESP_LINE_SIZE;
+	}
+	memcpy(&pui8Data[9], psResp->pcText, ui32Len);
+
+	ui8Status = (psResp->ui32Type == XBEE_RESP_ERROR) ? XBEE_HOST_ERROR :
+	            (psResp->ui32Type == XBEE_RESP_TIMEOUT) ? XBEE_HOST_TIMEOUT :
+	            XBEE_HOST_OK;
+
+	g_sHostStats.ui32InFlight--;
+	XBeeHostRespond((uint8_t)(uintptr_t)pvArg, XBEE_HOST_OP_AT, ui8Status,
+	                pui8Data, 9 + ui32Len);
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Carry out one request. pui8Data is the payload, NUL terminated in place.
+//
+//*****************************************************************************
+static void
+XBeeHostRequest(uint8_t ui8Tag, uint8_t ui8Op, uint8_t *pui8Data,
+                uint32_t ui32Len)
+{
+	uint8_t pui8Resp[20 + XBEE_NODE_NI_SIZE];
+	tXBeeNode *psNode;
+	uint64_t ui64Addr;
+	uint32_t ui32Idx;
+	int32_t i32Status;
+
+	g_sHostStats.ui32Requests++;
+
+	switch(ui8Op)
+	{
+		case XBEE_HOST_OP_PING:
+		{
+			XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_OK, pui8Data, ui32Len);
+			break;
+		}
+
+		case XBEE_HOST_OP_CMD:
+		{
+			//
+			// Same table as the text console, without its line length limit
+			//
+			pui8Data[ui32Len] = 0;
+			i32Status = XBeeProfCmdLine((char *)pui8Data);
+			XBEE_PUT32(pui8Resp, (uint32_t)i32Status);
+			XBeeHostRespond(ui8Tag, ui8Op,
+			                (i32Status == CMDLINE_BAD_CMD) ? XBEE_HOST_BAD_ARG :
+			                XBEE_HOST_OK, pui8Resp, 4);
+			break;
+		}
+
+		case XBEE_HOST_OP_AT:
+		{
+			if((ui32Len == 0) || (ui32Len > (XBEE_RESP_LINE_SIZE - 3)))
+			{
+				XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_BAD_ARG, 0, 0);
+				break;
+			}
+			if(!XBeeSchedReserve(ui32Len + 3) ||
+			   !XBeeRespExpect(XBeeHostAtResp, (void *)(uintptr_t)ui8Tag,
+			                   XBEE_RESP_TIMEOUT_MS))
+			{
+				XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_BUSY, 0, 0);
+				break;
+			}
+			g_sHostStats.ui32InFlight++;
+			XBeeSchedPut('A');
+			XBeeSchedPut('T');
+			for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+			{
+				XBeeSchedPut(pui8Data[ui32Idx]);
+			}
+			XBeeSchedPut('\r');
+			break;
+		}
+
+		case XBEE_HOST_OP_NODE:
+		{
+			psNode = (ui32Len >= 2) ? XBeeNodeGet(XBEE_GET16(pui8Data)) : 0;
+			XBEE_PUT16(pui8Resp, XBeeNodeCount());
+			if(psNode == 0)
+			{
+				XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_BAD_ARG, pui8Resp, 2);
+				break;
+			}
+			ui64Addr = XBeeConcAddr(psNode->ui16Node);
+			XBEE_PUT32(&pui8Resp[2], (uint32_t)(ui64Addr >> 32));
+			XBEE_PUT32(&pui8Resp[6], (uint32_t)ui64Addr);
+			XBEE_PUT16(&pui8Resp[10], psNode->ui16My);
+			XBEE_PUT16(&pui8Resp[12], psNode->ui16Parent);
+			pui8Resp[14] = psNode->ui8DevType;
+			pui8Resp[15] = psNode->ui8Rssi;
+			ui32Len = strlen(psNode->pcNI);
+			memcpy(&pui8Resp[16], psNode->pcNI, ui32Len);
+			XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_OK, pui8Resp,
+			                16 + ui32Len);
+			break;
+		}
+
+		case XBEE_HOST_OP_EXIT:
+		{
+			XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_OK, 0, 0);
+			g_bHostActive = false;
+			break;
+		}
+
+		default:
+		{
+			XBeeHostRespond(ui8Tag, ui8Op, XBEE_HOST_BAD_OP, 0, 0);
+			break;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Switch UART0 to the binary protocol.
+//
+//*****************************************************************************
+void
+XBeeHostStart(void)
+{
+	g_ui32HostRxCount = 0;
+	g_bHostActive = true;
+}
+
+//*****************************************************************************
+//
+// Read and carry out requests from UART0. Returns false, without touching
+// UART0, when the text console is in use. Call from the main loop.
+//
+//*****************************************************************************
+bool
+XBeeHostPoll(void)
+{
+	uint32_t ui32Len;
+	uint8_t ui8Byte;
+
+	if(!g_bHostActive)
+	{
+		return false;
+	}
+
+	//
+	// Give up on a frame the host stopped sending half way
+	//
+	if(g_ui32HostRxCount &&
+	   XBEE_TICK_REACHED(XBeeTickGet(), g_ui32HostRxTick + XBEE_HOST_IDLE_MS))
+	{
+		g_sHostStats.ui32Abandoned++;
+		g_ui32HostRxCount = 0;
+	}
+
+	//
+	// Stay awake through a frame so its last byte is seen at once
+	//
+	if(g_ui32HostRxCount)
+	{
+		XBeeIdleBusy();
+	}
+
+	while(g_bHostActive && ROM_UARTCharsAvail(UART0_BASE))
+	{
+		ui8Byte = ROM_UARTCharGetNonBlocking(UART0_BASE);
+		g_ui32HostRxTick = XBeeTickGet();
+
+		if((g_ui32HostRxCount == 0) && (ui8Byte != XBEE_HOST_SOF))
+		{
+			continue;
+		}
+		g_pui8HostRx[g_ui32HostRxCount++] = ui8Byte;
+
+		if(g_ui32HostRxCount < 3)
+		{
+			continue;
+		}
+
+		ui32Len = XBEE_GET16(&g_pui8HostRx[1]);
+		if((ui32Len < 2) || (ui32Len > (XBEE_HOST_MAX_PAYLOAD + 2)))
+		{
+			g_sHostStats.ui32BadLength++;
+			g_ui32HostRxCount = 0;
+			continue;
+		}
+		if(g_ui32HostRxCount < (3 + ui32Len + 2))
+		{
+			continue;
+		}
+
+		g_ui32HostRxCount = 0;
+		if(XBeeCrc16(0xFFFF, &g_pui8HostRx[1], 2 + ui32Len) !=
+		   XBEE_GET16(&g_pui8HostRx[3 + ui32Len]))
+		{
+			g_sHostStats.ui32BadCrc++;
+			continue;
+		}
+
+		XBeeHostRequest(g_pui8HostRx[3], g_pui8HostRx[4], &g_pui8HostRx[5],
+		                ui32Len - 2);
+	}
+
+	return true;
+}
+
+void
+XBeeHostStatsGet(tXBeeHostStats *psStats)
+{
+	*psStats = g_sHostStats;
+}
+
+//*****************************************************************************
+//
+// Host Command
+// Input: none / 'stats'
+// Response: none, UART0 switches to binary frames until an EXIT request
+// Use: to let a PC drive the board without parsing text, see XBeeHost.h
+//		for the frame format
+//
+//*****************************************************************************
+int
+Cmd_host(int argc, char *argv[])
+{
+	if((2 == argc) && (0 == strcmp(argv[1], "stats")))
+	{
+		UARTprintf("requests %d, responses %d, in flight %d, bad crc %d, "
+		           "bad length %d, abandoned %d\n", g_sHostStats.ui32Requests,
+		           g_sHostStats.ui32Responses, g_sHostStats.ui32InFlight,
+		           g_sHostStats.ui32BadCrc, g_sHostStats.ui32BadLength,
+		           g_sHostStats.ui32Abandoned);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	//
+	// Already in binary mode (sent as a CMD request), nothing to do
+	//
+	if(!g_bHostActive)
+	{
+		UARTprintf("host mode\n");
+		XBeeHostStart();
+	}
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// XBeeHost.h - Headers for use with XBeeHost.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEHOST_H__
+#define __XBEEHOST_H__
+
+//*****************************************************************************
+//
+// Frame: SOF, length (2, MSB first), tag, opcode, payload, CRC-16 (2). The
+// length counts tag, opcode and payload. The CRC (CCITT, start 0xFFFF)
+// covers length to the end of the payload.
+//
+//*****************************************************************************
+#define XBEE_HOST_SOF           0xA5
+#define XBEE_HOST_MAX_PAYLOAD   250
+#define XBEE_HOST_MAX_FRAME     (3 + 2 + XBEE_HOST_MAX_PAYLOAD + 2)
+#define XBEE_HOST_IDLE_MS       100     // partial frame given up after this
+
+//*****************************************************************************
+//
+// Request opcodes. A response has the opcode with XBEE_HOST_RESPONSE set,
+// the request's tag, a status byte and then its own payload.
+//
+//   PING  payload is echoed back
+//   CMD   payload is a console command line, response is its status (4)
+//   AT    payload is an AT command without the "AT" (e.g. "SH", "ID3332"),
+//         the XBee must be in command mode. Response is the line type (1),
+//         the value (8) and the text of the line. Up to XBEE_RESP_QUEUE_SIZE
+//         may be in flight.
+//   NODE  payload is a node table index (2), response is the node count
+//         (2), address (8), MY (2), parent (2), device type, RSSI and NI
+//   EXIT  back to the text console
+//
+//*****************************************************************************
+#define XBEE_HOST_OP_PING       0x01
+#define XBEE_HOST_OP_CMD        0x02
+#define XBEE_HOST_OP_AT         0x03
+#define XBEE_HOST_OP_NODE       0x04
+#define XBEE_HOST_OP_EXIT       0x0F
+#define XBEE_HOST_RESPONSE      0x80
+
+//*****************************************************************************
+//
+// Response status
+//
+//*****************************************************************************
+#define XBEE_HOST_OK            0
+#define XBEE_HOST_BAD_OP        1
+#define XBEE_HOST_BAD_ARG       2
+#define XBEE_HOST_BUSY          3
+#define XBEE_HOST_ERROR         4
+#define XBEE_HOST_TIMEOUT       5
+
+//*****************************************************************************
+//
+// Host protocol statistics
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Requests;
+	uint32_t ui32Responses;
+	uint32_t ui32BadCrc;
+	uint32_t ui32BadLength;
+	uint32_t ui32Abandoned;             // partial frame timed out
+	uint32_t ui32InFlight;
+}
+tXBeeHostStats;
+
+//*****************************************************************************
+//
+// Host protocol functions
+//
+//*****************************************************************************
+extern void XBeeHostStart(void);
+extern bool XBeeHostPoll(void);
+extern void XBeeHostStatsGet(tXBeeHostStats *psStats);
+extern int Cmd_host(int argc, char *argv[]);
+
+#endif //__XBEEHOST_H__
@@ -0,0 +1,373 @@
+//*****************************************************************************
+//
+// XBeeIc.c - Digital change detection (ATIC) on this and other nodes
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! With only ATIR a door or switch input is sampled and sent at the rate
+//! needed to see it change in time, although it changes a few dozen times
+//! a day. ATIC names the digital lines whose change sends a sample at once;
+//! ATIR can then be slowed to a heartbeat.
+//!
+//! 'ic <node> <mask> [ir]' sets IC, and IR if given, on this radio
+//! ('local') or on another node by address. In API mode both go as AT
+//! command frames, to other nodes as remote AT commands applied at once
+//! (not written, ATWR on the node keeps them). In command mode only the
+//! local IC can be set, as ATIC does.
+//!
+//! Change samples and heartbeats arrive as the same I/O frames and are
+//! merged into one state per line in XBeeIo.c ('io lines').
+//!
+//! 'ic bench' works out air time and receive CPU per day for typical
+//! switch and door sensors, sampled periodically fast enough to see a
+//! change within the sensor's latency, against change detection plus the
+//! heartbeat. The CPU figure uses the cycles XBeeIoFrame() has taken per
+//! frame so far.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
+#include "XBeeSched.h"
+#include "XBeeFrame.h"
+#include "XBeeResp.h"
+#include "XBeeLink.h"
+#include "XBeeQual.h"
+#include "XBeeTx.h"
+#include "XBeeIo.h"
+#include "XBeeIc.h"
+
+//*****************************************************************************
+//
+// Frame ID of the AT command frames sent from here, so the answers can be
+// told from others
+//
+//*****************************************************************************
+#define IC_FRAME_ID             0xCF
+
+#define IC_MS_PER_DAY           86400000
+
+//*****************************************************************************
+//
+// A kind of sensor for the bench: how often its line changes and how soon
+// a change has to be seen
+//
+//*****************************************************************************
+typedef struct
+{
+	const char *pcName;
+	uint32_t ui32ChangesPerDay;
+	uint32_t ui32LatencyMs;
+}
+tXBeeIcSensor;
+
+static const tXBeeIcSensor g_psIcSensors[] =
+{
+	{ "door",   40,  1000 },
+	{ "window", 8,   2000 },
+	{ "switch", 30,  250 },
+	{ "motion", 300, 500 },
+};
+
+//*****************************************************************************
+//
+// AT command status names
+//
+//*****************************************************************************
+static const char * const g_ppcIcStatus[] =
+{
+	"OK", "ERROR", "invalid command", "invalid parameter", "no response"
+};
+
+static tXBeeIcStats g_sIcStats;
+
+//*****************************************************************************
+//
+// Send AT command pcCmd with a 16-bit value to this radio (bLocal) or to
+// node ui64Dest, as a frame.
+//
+//*****************************************************************************
+static void
+XBeeIcSend(bool bLocal, uint64_t ui64Dest, const char *pcCmd,
+           uint32_t ui32Value)
+{
+	uint8_t pui8Msg[17];
+
+	g_sIcStats.ui32Sent++;
+
+	if(bLocal)
+	{
+		pui8Msg[0] = XBEE_API_AT;
+		pui8Msg[1] = IC_FRAME_ID;
+		pui8Msg[2] = pcCmd[0];
+		pui8Msg[3] = pcCmd[1];
+		XBEE_PUT16(&pui8Msg[4], ui32Value);
+		XBeeFrameSend(pui8Msg, 6);
+		return;
+	}
+
+	//
+	// A 16-bit address goes with the 64-bit one set to 0xFFFF
+	//
+	pui8Msg[0] = XBEE_API_REMOTE_AT;
+	pui8Msg[1] = IC_FRAME_ID;
+	if(ui64Dest <= 0xFFFF)
+	{
+		XBEE_PUT32(&pui8Msg[2], 0);
+		XBEE_PUT32(&pui8Msg[6], 0xFFFF);
+		XBEE_PUT16(&pui8Msg[10], ui64Dest);
+	}
+	else
+	{
+		XBEE_PUT32(&pui8Msg[2], (uint32_t)(ui64Dest >> 32));
+		XBEE_PUT32(&pui8Msg[6], (uint32_t)ui64Dest);
+		XBEE_PUT16(&pui8Msg[10], 0xFFFE);
+	}
+	pui8Msg[12] = 0x02;                     // apply changes
+	pui8Msg[13] = pcCmd[0];
+	pui8Msg[14] = pcCmd[1];
+	XBEE_PUT16(&pui8Msg[15], ui32Value);
+	XBeeFrameSend(pui8Msg, 17);
+}
+
+//*****************************************************************************
+//
+// Count and print the outcome of one of our AT commands.
+//
+//*****************************************************************************
+static void
+XBeeIcResult(const char *pcNode, const uint8_t *pui8Cmd, uint32_t ui32Status)
+{
+	if(ui32Status == 0)
+	{
+		g_sIcStats.ui32Ok++;
+	}
+	else
+	{
+		g_sIcStats.ui32Failed++;
+	}
+
+	UARTprintf("ic: %s AT%c%c %s\n", pcNode, pui8Cmd[0], pui8Cmd[1],
+	           (ui32Status < (sizeof(g_ppcIcStatus) /
+	                          sizeof(g_ppcIcStatus[0]))) ?
+	           g_ppcIcStatus[ui32Status] : "?");
+}
+
+//*****************************************************************************
+//
+// Called by XBeeBootApiFrame() with local AT command responses. Returns
+// true if the response was to a command sent from here.
+//
+//*****************************************************************************
+bool
+XBeeIcApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	if((ui32Len < 5) || (pui8Msg[1] != IC_FRAME_ID))
+	{
+		return false;
+	}
+
+	XBeeIcResult("local", &pui8Msg[2], pui8Msg[4]);
+	return true;
+}
+
+//*****************************************************************************
+//
+// Link handler for remote AT command responses.
+//
+//*****************************************************************************
+void
+XBeeIcRemoteFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	char pcNode[20];
+
+	if((ui32Len < 15) || (pui8Msg[1] != IC_FRAME_ID))
+	{
+		return;
+	}
+
+	usnprintf(pcNode, sizeof(pcNode), "%08x%08x", XBEE_GET32(&pui8Msg[2]),
+	          XBEE_GET32(&pui8Msg[6]));
+	XBeeIcResult(pcNode, &pui8Msg[12], pui8Msg[14]);
+}
+
+void
+XBeeIcStatsGet(tXBeeIcStats *psStats)
+{
+	*psStats = g_sIcStats;
+}
+
+//*****************************************************************************
+//
+// Print one way of sampling for the bench: frames a day per node, their air
+// time, the share of the channel ui32Nodes such nodes take and the receive
+// CPU.
+//
+//*****************************************************************************
+static void
+XBeeIcBenchLine(const char *pcHow, uint32_t ui32Frames, uint32_t ui32Nodes,
+                uint32_t ui32Cycles)
+{
+	uint32_t ui32AirMs;
+	uint32_t ui32Share;
+	uint32_t ui32CpuMs;
+
+	ui32AirMs = (uint32_t)(((uint64_t)ui32Frames *
+	                        (XBEE_TX_SIM_AIR_US_FIXED +
+	                         ((XBEE_IC_IO_PAYLOAD + XBEE_QUAL_FRAME_OVERHEAD) *
+	                          XBEE_TX_SIM_AIR_US_PER_BYTE))) / 1000);
+	ui32Share = (uint32_t)(((uint64_t)ui32AirMs * ui32Nodes * 10000) /
+	                       IC_MS_PER_DAY);
+	ui32CpuMs = (uint32_t)(((uint64_t)ui32Frames * ui32Cycles) /
+	                       (ROM_SysCtlClockGet() / 1000));
+
+	UARTprintf("  %s %6u frames, air %6u ms, %u.%02u%% of the channel, "
+	           "cpu %5u ms\n", pcHow, ui32Frames, ui32AirMs, ui32Share / 100,
+	           ui32Share % 100, ui32CpuMs);
+}
+
+//*****************************************************************************
+//
+// Air time and CPU per day, periodic sampling against change detection.
+//
+//*****************************************************************************
+static void
+XBeeIcBench(uint32_t ui32Nodes)
+{
+	const tXBeeIcSensor *psSensor;
+	tXBeeIoStats sIo;
+	uint32_t ui32Cycles;
+	uint32_t ui32Periodic;
+	uint32_t ui32Change;
+	uint32_t ui32Saved;
+	uint32_t ui32Index;
+
+	XBeeIoStatsGet(&sIo);
+	ui32Cycles = sIo.ui32Frames ? (sIo.ui32Cycles / sIo.ui32Frames) :
+	             XBEE_IC_FRAME_CYCLES;
+
+	UARTprintf("per node and day, %u nodes sharing the channel, %u cycles "
+	           "per frame received (%s)\n", ui32Nodes, ui32Cycles,
+	           sIo.ui32Frames ? "measured" : "estimate");
+
+	for(ui32Index = 0;
+	    ui32Index < (sizeof(g_psIcSensors) / sizeof(g_psIcSensors[0]));
+	    ui32Index++)
+	{
+		psSensor = &g_psIcSensors[ui32Index];
+		ui32Periodic = IC_MS_PER_DAY / psSensor->ui32LatencyMs;
+		ui32Change = psSensor->ui32ChangesPerDay +
+		             (IC_MS_PER_DAY / XBEE_IC_HEARTBEAT_MS);
+
+		UARTprintf("%s: %u changes, seen within %u ms\n", psSensor->pcName,
+		           psSensor->ui32ChangesPerDay, psSensor->ui32LatencyMs);
+		XBeeIcBenchLine("ATIR     ", ui32Periodic, ui32Nodes, ui32Cycles);
+		XBeeIcBenchLine("ATIC + IR", ui32Change, ui32Nodes, ui32Cycles);
+		ui32Saved = 1000 - ((ui32Change * 1000) / ui32Periodic);
+		UARTprintf("  %u.%u%% of the frames, air time and cpu saved\n",
+		           ui32Saved / 10, ui32Saved % 10);
+	}
+}
+
+//*****************************************************************************
+//
+// Change Detect Command
+// Input: none / '<local | address> <hex mask> [hex IR ms]' /
+//		'bench [nodes]'
+// Response: commands sent and their outcome, then one line per answer as
+//		it comes in
+// Use: set the digital lines that send a sample when they change (ATIC),
+//		and optionally the periodic rate kept as a heartbeat, on this radio
+//		or another node. 'bench' shows what change detection saves for
+//		typical switch and door sensors.
+//
+//*****************************************************************************
+int
+Cmd_ic(int argc, char *argv[])
+{
+	uint64_t ui64Dest;
+	uint64_t ui64Mask;
+	uint64_t ui64Rate;
+	char pcLine[12];
+	bool bLocal;
+
+	if(((2 == argc) || (3 == argc)) && (0 == strcmp(argv[1], "bench")))
+	{
+		XBeeIcBench((3 == argc) ? strtoul(argv[2], 0, 10) :
+		                          XBEE_IC_BENCH_NODES);
+		return 0;
+	}
+	else if((3 == argc) || (4 == argc))
+	{
+		bLocal = (0 == strcmp(argv[1], "local"));
+		ui64Dest = 0;
+		ui64Rate = 0;
+		if((!bLocal && !XBeeHexDecode(argv[1], strlen(argv[1]), &ui64Dest)) ||
+		   !XBeeHexDecode(argv[2], strlen(argv[2]), &ui64Mask) ||
+		   (ui64Mask > 0xFF) ||
+		   ((4 == argc) &&
+		    (!XBeeHexDecode(argv[3], strlen(argv[3]), &ui64Rate) ||
+		     (ui64Rate > 0xFFFF))))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+
+		if(XBeeLinkApi())
+		{
+			XBeeIcSend(bLocal, ui64Dest, "IC", (uint32_t)ui64Mask);
+			if(4 == argc)
+			{
+				XBeeIcSend(bLocal, ui64Dest, "IR", (uint32_t)ui64Rate);
+			}
+			return 0;
+		}
+
+		//
+		// Command mode: only this radio, and IR with ATIR
+		//
+		if(!bLocal || (4 == argc))
+		{
+			UARTprintf("Error: only 'ic local <mask>' in command mode\n");
+			return 1;
+		}
+		if(!XBeeRespExpect(XBeeRespPrint, "ATIC", XBEE_RESP_TIMEOUT_MS))
+		{
+			UARTprintf("Error: busy, commands still waiting for a response\n");
+			return 1;
+		}
+		XBeeSchedWrite(XBEE_SCHED_CONTROL, (const uint8_t *)pcLine,
+		               usnprintf(pcLine, sizeof(pcLine), "ATIC%x\r",
+		                         (uint32_t)ui64Mask));
+		g_sIcStats.ui32Sent++;
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("IC/IR commands sent %u, OK %u, failed %u\n",
+	           g_sIcStats.ui32Sent, g_sIcStats.ui32Ok, g_sIcStats.ui32Failed);
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// XBeeIc.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+
+#ifndef __XBEEIC_H__
+#define __XBEEIC_H__
+
+//*****************************************************************************
+//
+// 'ic bench': with change detection the periodic samples are kept at
+// XBEE_IC_HEARTBEAT_MS so a node that has gone quiet is still noticed.
+// An I/O sample of the digital lines only carries XBEE_IC_IO_PAYLOAD
+// bytes (count, channel mask, lines). Until sample frames have been
+// received the receive cost is taken as XBEE_IC_FRAME_CYCLES.
+//
+//*****************************************************************************
+#define XBEE_IC_HEARTBEAT_MS    60000
+#define XBEE_IC_IO_PAYLOAD      5
+#define XBEE_IC_FRAME_CYCLES    4000
+#define XBEE_IC_BENCH_NODES     20
+
+//*****************************************************************************
+//
+// Counters for IC / IR set on this or other nodes
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Sent;
+	uint32_t ui32Ok;
+	uint32_t ui32Failed;                // error status or no answer
+}
+tXBeeIcStats;
+
+//*****************************************************************************
+//
+// Change detection functions
+//
+//*****************************************************************************
+extern bool XBeeIcApiFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeIcRemoteFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeIcStatsGet(tXBeeIcStats *psStats);
+extern int Cmd_ic(int argc, char *argv[]);
+
+#endif //__XBEEIC_H__
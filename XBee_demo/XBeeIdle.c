@@ -0,0 +1,271 @@
+//*****************************************************************************
+//
+// XBeeIdle.c - Tickless sleep between radio and console events
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Everything that happens on its own time (transmit and bulk timeouts,
+//! retransmits, response deadlines, I/O windows, trace pings, the clock
+//! governor, pacing) tells XBeeIdleDeadline() when it next needs to run,
+//! each time it is polled. XBeeIdleEnter(), at the end of a pass of the
+//! waiting loop, takes the earliest of those and sleeps until then with
+//! WFI, SysTick stopped from ticking every ms (XBeeTickSleep()).
+//!
+//! Anything else that needs the loop wakes it with an interrupt: UART1
+//! receive and transmit (responses, frames, the transmit queue draining)
+//! and UART0 receive, whose interrupt is enabled only while asleep and
+//! does nothing but wake the core; the console and host protocol still
+//! read UART0 by polling.
+//!
+//! Sleep is the plain WFI sleep mode, clocks and PLL stay up, so waking
+//! takes a few cycles and nothing has to be restarted. The one delay is
+//! UART0's receive timeout (32 bit times) when a single key arrives, which
+//! is why a half typed line keeps the loop awake: the Enter that sends a
+//! command is picked up at once, as before. Likewise a host frame being
+//! received.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/uart.h"
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeSched.h"
+#include "XBeeIdle.h"
+
+static bool g_bIdleOn = true;
+static bool g_bIdleBusy;
+static bool g_bIdleDeadline;
+static uint32_t g_ui32IdleDeadline;
+static tXBeeIdleStats g_sIdleStats;
+static void (*g_pfnIdleUart0Isr)(void);
+
+//*****************************************************************************
+//
+// UART0 wakes the core from WFI. The console reads the byte itself, so
+// the interrupt just goes off again until the next sleep. Something that
+// reads UART0 by interrupt instead can take it over.
+//
+//*****************************************************************************
+void
+UART0IntHandler(void)
+{
+	if(g_pfnIdleUart0Isr)
+	{
+		g_pfnIdleUart0Isr();
+		return;
+	}
+
+	ROM_UARTIntDisable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+	ROM_UARTIntClear(UART0_BASE, UART_INT_RX | UART_INT_RT);
+}
+
+//*****************************************************************************
+//
+// Give the UART0 interrupt to pfnIsr, or take it back with 0, which also
+// puts back the receive level that wakes on the first key.
+//
+//*****************************************************************************
+void
+XBeeIdleUart0IsrSet(void (*pfnIsr)(void))
+{
+	g_pfnIdleUart0Isr = pfnIsr;
+	if(pfnIsr == 0)
+	{
+		ROM_UARTIntDisable(UART0_BASE, 0xFFFFFFFF);
+		ROM_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX1_8);
+	}
+}
+
+//*****************************************************************************
+//
+// Let UART0 receive interrupts through. Call after ConfigureUART().
+//
+//*****************************************************************************
+void
+XBeeIdleInit(void)
+{
+	ROM_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX1_8);
+	ROM_UARTIntDisable(UART0_BASE, 0xFFFFFFFF);
+	ROM_IntEnable(INT_UART0);
+
+	g_sIdleStats.ui32StartTick = XBeeTickGet();
+}
+
+//*****************************************************************************
+//
+// Something must run again at tick ui32Tick. Call from a poll each time it
+// finds a timer still running; the earliest since the last
+// XBeeIdleEnter() wins.
+//
+//*****************************************************************************
+void
+XBeeIdleDeadline(uint32_t ui32Tick)
+{
+	if(!g_bIdleDeadline || ((int32_t)(ui32Tick - g_ui32IdleDeadline) < 0))
+	{
+		g_ui32IdleDeadline = ui32Tick;
+		g_bIdleDeadline = true;
+	}
+}
+
+//*****************************************************************************
+//
+// Something needs the loop to keep going without waiting for an event.
+//
+//*****************************************************************************
+void
+XBeeIdleBusy(void)
+{
+	g_bIdleBusy = true;
+}
+
+//*****************************************************************************
+//
+// Sleep until the earliest deadline or an interrupt, unless there is work
+// already. Call at the end of each pass of a loop that waits on the link.
+//
+//*****************************************************************************
+void
+XBeeIdleEnter(void)
+{
+	uint32_t ui32Now;
+	uint32_t ui32Ms;
+	uint32_t ui32Us;
+	bool bBusy;
+
+	bBusy = g_bIdleBusy;
+	g_bIdleBusy = false;
+
+	ui32Now = XBeeTickGet();
+	ui32Ms = XBEE_IDLE_MAX_MS;
+	if(g_bIdleDeadline)
+	{
+		g_bIdleDeadline = false;
+		if(XBEE_TICK_REACHED(ui32Now, g_ui32IdleDeadline))
+		{
+			return;
+		}
+		if((g_ui32IdleDeadline - ui32Now) < ui32Ms)
+		{
+			ui32Ms = g_ui32IdleDeadline - ui32Now;
+		}
+	}
+
+	if(!g_bIdleOn || bBusy)
+	{
+		return;
+	}
+
+	//
+	// Last look for work with interrupts held off, so none that comes in
+	// from here on is missed: WFI returns at once if one is pending
+	//
+	ROM_IntMasterDisable();
+	if(ROM_UARTCharsAvail(UART0_BASE) || XBeeUartRxAvail() ||
+	   (!XBeeSchedIdle() && !XBeeSchedHeld() &&
+	    (XBeeUartTxPending() <= XBEE_SCHED_AHEAD)))
+	{
+		ROM_IntMasterEnable();
+		return;
+	}
+
+	ROM_UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+	ui32Us = XBeeTickSleep(ui32Ms);
+	ROM_UARTIntDisable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+	ROM_IntMasterEnable();
+
+	g_sIdleStats.ui32Sleeps++;
+	if(XBEE_TICK_REACHED(XBeeTickGet(), ui32Now + ui32Ms))
+	{
+		g_sIdleStats.ui32DeadlineWakes++;
+	}
+	if((ui32Us / 1000) > g_sIdleStats.ui32LongestMs)
+	{
+		g_sIdleStats.ui32LongestMs = ui32Us / 1000;
+	}
+	g_sIdleStats.ui32SleepUs += ui32Us;
+	g_sIdleStats.ui32SleepMs += g_sIdleStats.ui32SleepUs / 1000;
+	g_sIdleStats.ui32SleepUs %= 1000;
+}
+
+void
+XBeeIdleStatsGet(tXBeeIdleStats *psStats)
+{
+	*psStats = g_sIdleStats;
+}
+
+//*****************************************************************************
+//
+// Idle Command
+// Input: none / 'clear' / 'on' / 'off'
+// Response: share of the time asleep since the last clear, and how the
+//		sleeps ended
+// Use: to see how much of the time the core is stopped. 'off' keeps it
+//		spinning as before, to compare current draw or latency.
+//
+//*****************************************************************************
+int
+Cmd_idle(int argc, char *argv[])
+{
+	uint32_t ui32Total;
+	uint32_t ui32Share;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sIdleStats, 0, sizeof(g_sIdleStats));
+		g_sIdleStats.ui32StartTick = XBeeTickGet();
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "on")))
+	{
+		g_bIdleOn = true;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "off")))
+	{
+		g_bIdleOn = false;
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	ui32Total = XBeeTickGet() - g_sIdleStats.ui32StartTick;
+	ui32Share = ui32Total ?
+	            (uint32_t)(((uint64_t)g_sIdleStats.ui32SleepMs * 1000) /
+	                       ui32Total) : 0;
+
+	UARTprintf("idle %s, asleep %u.%u%% of %u ms\n", g_bIdleOn ? "on" : "off",
+	           ui32Share / 10, ui32Share % 10, ui32Total);
+	UARTprintf("sleeps %u, %u to a deadline, %u woken by interrupts, "
+	           "average %u ms, longest %u ms\n", g_sIdleStats.ui32Sleeps,
+	           g_sIdleStats.ui32DeadlineWakes,
+	           g_sIdleStats.ui32Sleeps - g_sIdleStats.ui32DeadlineWakes,
+	           g_sIdleStats.ui32Sleeps ?
+	           (g_sIdleStats.ui32SleepMs / g_sIdleStats.ui32Sleeps) : 0,
+	           g_sIdleStats.ui32LongestMs);
+
+	return 0;
+}
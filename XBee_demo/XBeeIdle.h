@@ -0,0 +1,65 @@
+//*****************************************************************************
+//
+// XBeeIdle.h - Headers for use with XBeeIdle.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEIDLE_H__
+#define __XBEEIDLE_H__
+
+//*****************************************************************************
+//
+// Longest sleep with no deadline pending. SysTick cuts it further at 80MHz.
+//
+//*****************************************************************************
+#define XBEE_IDLE_MAX_MS        1000
+
+//*****************************************************************************
+//
+// A half typed command line keeps the loop awake this long after the last
+// key, so the Enter that ends it is seen at once.
+//
+//*****************************************************************************
+#define XBEE_IDLE_TYPING_MS     10000
+
+//*****************************************************************************
+//
+// Residency since the last clear
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32StartTick;
+	uint32_t ui32SleepMs;               // time asleep, ms and us parts
+	uint32_t ui32SleepUs;
+	uint32_t ui32Sleeps;
+	uint32_t ui32DeadlineWakes;         // the rest were woken by interrupts
+	uint32_t ui32LongestMs;
+}
+tXBeeIdleStats;
+
+//*****************************************************************************
+//
+// Idle functions. UART0IntHandler must be in the vector table.
+//
+//*****************************************************************************
+extern void XBeeIdleInit(void);
+extern void XBeeIdleDeadline(uint32_t ui32Tick);
+extern void XBeeIdleBusy(void);
+extern void XBeeIdleEnter(void);
+extern void XBeeIdleStatsGet(tXBeeIdleStats *psStats);
+extern void XBeeIdleUart0IsrSet(void (*pfnIsr)(void));
+extern void UART0IntHandler(void);
+extern int Cmd_idle(int argc, char *argv[]);
+
+#endif //__XBEEIDLE_H__
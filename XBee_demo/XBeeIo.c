@@ -0,0 +1,647 @@
+//*****************************************************************************
+//
+// XBeeIo.c - Aggregation of received I/O samples before console output
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Nodes set up with ATIR/ATIT send I/O sample frames (0x82 / 0x83) to an
+//! XBee in API mode. At a few ms per sample the text for every sample is
+//! more than the 115200 baud console can carry, so by default each node's
+//! samples are reduced here:
+//!
+//!   digital  one line whenever a line changes: the bits that changed and
+//!            the new state of all lines
+//!   analog   one line per window per node with min/mean/max of each ADC
+//!
+//! Raw mode prints every sample as before. Either way the line raw mode
+//! would have printed is formatted, so the byte counters show the real
+//! saving.
+//!
+//! In both modes every sample goes into one state per node and line,
+//! whether the XBee sent it because a line changed (ATIC) or because its
+//! period came round (ATIR): the level, when a line last changed and when
+//! the node was last heard. A periodic sample that shows an edge the
+//! change sample for it never brought (lost on the air) is merged the same
+//! way, only later. Frames that changed nothing are counted; with change
+//! detection on they are the heartbeat, without it they are what it would
+//! save. 'io lines' shows the state.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeQual.h"
+#include "XBeeIdle.h"
+#include "XBeeConc.h"
+#include "XBeeIo.h"
+
+//*****************************************************************************
+//
+// Frame layout after the source address
+//
+//*****************************************************************************
+#define IO_OFFSET_RSSI          0
+#define IO_OFFSET_COUNT         2
+#define IO_OFFSET_CHANNELS      3
+#define IO_OFFSET_SAMPLES       5
+
+#define IO_ADC_SHIFT            9
+#define IO_LINE_SIZE            160
+
+//*****************************************************************************
+//
+// One node's window, under its concentrator node number
+//
+//*****************************************************************************
+typedef struct
+{
+	uint16_t ui16Node;
+	bool bDioValid;
+	uint8_t ui8Rssi;
+	uint16_t ui16Dio;
+	uint16_t ui16Channels;
+	uint16_t ui16EdgeLines;             // lines that changed last
+	uint16_t ui16Edges;
+	uint32_t ui32EdgeTick;
+	uint32_t ui32HeardTick;
+	uint32_t ui32WindowStart;
+	uint32_t ui32Count;
+	uint16_t pui16Min[XBEE_IO_ADC_CHANNELS];
+	uint16_t pui16Max[XBEE_IO_ADC_CHANNELS];
+	uint32_t pui32Sum[XBEE_IO_ADC_CHANNELS];
+}
+tXBeeIoNode;
+
+static tXBeeIoNode g_psIoNodes[XBEE_IO_NODES];
+static uint32_t g_ui32IoNodeCount;
+static uint32_t g_ui32IoMode = XBEE_IO_MODE_AGGREGATE;
+static uint32_t g_ui32IoWindowMs = XBEE_IO_WINDOW_MS;
+static tXBeeIoStats g_sIoStats;
+
+//*****************************************************************************
+//
+// Print a line to the console and count it.
+//
+//*****************************************************************************
+static void
+XBeeIoOut(const char *pcLine, uint32_t ui32Len)
+{
+	g_sIoStats.ui32OutBytes += ui32Len;
+	UARTwrite(pcLine, ui32Len);
+}
+
+//*****************************************************************************
+//
+// Format the node address, 16 hex digits or 4 for a 16-bit source.
+//
+//*****************************************************************************
+static uint32_t
+XBeeIoAddr(char *pcLine, uint32_t ui32Size, const tXBeeIoNode *psNode)
+{
+	uint64_t ui64Addr;
+
+	ui64Addr = XBeeConcAddr(psNode->ui16Node);
+	if(ui64Addr <= 0xFFFF)
+	{
+		return usnprintf(pcLine, ui32Size, "IO %04x", (uint32_t)ui64Addr);
+	}
+
+	return usnprintf(pcLine, ui32Size, "IO %08x%08x",
+	                 (uint32_t)(ui64Addr >> 32), (uint32_t)ui64Addr);
+}
+
+//*****************************************************************************
+//
+// Find the window of node ui32Node, or start one. Returns 0 if the table
+// is full.
+//
+//*****************************************************************************
+static tXBeeIoNode *
+XBeeIoNodeGet(uint32_t ui32Node)
+{
+	tXBeeIoNode *psNode;
+	uint32_t ui32Index;
+
+	for(ui32Index = 0; ui32Index < g_ui32IoNodeCount; ui32Index++)
+	{
+		psNode = &g_psIoNodes[ui32Index];
+		if(psNode->ui16Node == ui32Node)
+		{
+			return psNode;
+		}
+	}
+
+	if(g_ui32IoNodeCount >= XBEE_IO_NODES)
+	{
+		g_sIoStats.ui32Dropped++;
+		return 0;
+	}
+
+	psNode = &g_psIoNodes[g_ui32IoNodeCount++];
+	memset(psNode, 0, sizeof(tXBeeIoNode));
+	psNode->ui16Node = (uint16_t)ui32Node;
+
+	return psNode;
+}
+
+//*****************************************************************************
+//
+// Print the node's analog summary and start a new window.
+//
+//*****************************************************************************
+static void
+XBeeIoFlush(tXBeeIoNode *psNode)
+{
+	char pcLine[IO_LINE_SIZE];
+	uint32_t ui32Len;
+	uint32_t ui32Adc;
+
+	if(psNode->ui32Count && (psNode->ui16Channels >> IO_ADC_SHIFT))
+	{
+		ui32Len = XBeeIoAddr(pcLine, sizeof(pcLine), psNode);
+		ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+		                     " n=%d", psNode->ui32Count);
+		for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+		{
+			if(psNode->ui16Channels & (1 << (IO_ADC_SHIFT + ui32Adc)))
+			{
+				ui32Len += usnprintf(pcLine + ui32Len,
+				                     sizeof(pcLine) - ui32Len,
+				                     " A%d %d/%d/%d", ui32Adc,
+				                     psNode->pui16Min[ui32Adc],
+				                     psNode->pui32Sum[ui32Adc] /
+				                     psNode->ui32Count,
+				                     psNode->pui16Max[ui32Adc]);
+			}
+		}
+		ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+		                     "\n");
+		XBeeIoOut(pcLine, ui32Len);
+	}
+
+	psNode->ui32Count = 0;
+	psNode->ui32WindowStart = XBeeTickGet();
+}
+
+//*****************************************************************************
+//
+// Take one sample. Always formats the raw line for the byte count. Returns
+// the digital lines that changed.
+//
+//*****************************************************************************
+static uint16_t
+XBeeIoSample(tXBeeIoNode *psNode, uint16_t ui16Dio, const uint16_t *pui16Adc)
+{
+	char pcLine[IO_LINE_SIZE];
+	uint32_t ui32Len;
+	uint32_t ui32Adc;
+	uint16_t ui16Changed;
+
+	g_sIoStats.ui32Samples++;
+
+	ui32Len = XBeeIoAddr(pcLine, sizeof(pcLine), psNode);
+	ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+	                     " -%d D %03x A", psNode->ui8Rssi, ui16Dio);
+	for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+	{
+		if(psNode->ui16Channels & (1 << (IO_ADC_SHIFT + ui32Adc)))
+		{
+			ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+			                     " %d", pui16Adc[ui32Adc]);
+		}
+	}
+	ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len, "\n");
+	g_sIoStats.ui32RawBytes += ui32Len;
+
+	//
+	// Digital lines: the state, the first sample sets the baseline
+	//
+	ui16Changed = 0;
+	if(psNode->ui16Channels & XBEE_IO_DIO_MASK)
+	{
+		ui16Changed = psNode->bDioValid ?
+		              ((ui16Dio ^ psNode->ui16Dio) &
+		               psNode->ui16Channels & XBEE_IO_DIO_MASK) :
+		              (psNode->ui16Channels & XBEE_IO_DIO_MASK);
+		if(ui16Changed && psNode->bDioValid)
+		{
+			psNode->ui16EdgeLines = ui16Changed;
+			psNode->ui32EdgeTick = XBeeTickGet();
+			psNode->ui16Edges++;
+		}
+		psNode->ui16Dio = ui16Dio;
+		psNode->bDioValid = true;
+	}
+
+	if(g_ui32IoMode == XBEE_IO_MODE_RAW)
+	{
+		XBeeIoOut(pcLine, ui32Len);
+		return ui16Changed;
+	}
+
+	//
+	// Only the changes are printed
+	//
+	if(ui16Changed)
+	{
+		g_sIoStats.ui32Changes++;
+		ui32Len = XBeeIoAddr(pcLine, sizeof(pcLine), psNode);
+		ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+		                     " D ^%03x =%03x\n", ui16Changed, ui16Dio);
+		XBeeIoOut(pcLine, ui32Len);
+	}
+
+	//
+	// Analog: fold into the window
+	//
+	if(psNode->ui32Count == 0)
+	{
+		psNode->ui32WindowStart = XBeeTickGet();
+		for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+		{
+			psNode->pui16Min[ui32Adc] = 0xFFFF;
+			psNode->pui16Max[ui32Adc] = 0;
+			psNode->pui32Sum[ui32Adc] = 0;
+		}
+	}
+	for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+	{
+		if(pui16Adc[ui32Adc] < psNode->pui16Min[ui32Adc])
+		{
+			psNode->pui16Min[ui32Adc] = pui16Adc[ui32Adc];
+		}
+		if(pui16Adc[ui32Adc] > psNode->pui16Max[ui32Adc])
+		{
+			psNode->pui16Max[ui32Adc] = pui16Adc[ui32Adc];
+		}
+		psNode->pui32Sum[ui32Adc] += pui16Adc[ui32Adc];
+	}
+	psNode->ui32Count++;
+
+	return ui16Changed;
+}
+
+//*****************************************************************************
+//
+// Link handler for I/O sample frames (Series 1 format).
+//
+//*****************************************************************************
+void
+XBeeIoFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	tXBeeIoNode *psNode;
+	uint16_t pui16Adc[XBEE_IO_ADC_CHANNELS];
+	uint64_t ui64Addr;
+	uint32_t ui32Start;
+	uint32_t ui32Conc;
+	uint32_t ui32Pos;
+	uint32_t ui32Count;
+	uint32_t ui32Adc;
+	uint16_t ui16Channels;
+	uint16_t ui16Changed;
+	uint16_t ui16Dio;
+	bool bAddr16;
+
+	ui32Start = XBeeCycleCountGet();
+	g_sIoStats.ui32Frames++;
+
+	bAddr16 = (pui8Msg[0] == XBEE_API_RX_IO_16);
+	ui32Pos = bAddr16 ? 3 : 9;
+	if(ui32Len < (ui32Pos + IO_OFFSET_SAMPLES))
+	{
+		g_sIoStats.ui32Bad++;
+		return;
+	}
+
+	if(bAddr16)
+	{
+		ui64Addr = XBEE_GET16(&pui8Msg[1]);
+	}
+	else
+	{
+		ui64Addr = ((uint64_t)XBEE_GET32(&pui8Msg[1]) << 32) |
+		           XBEE_GET32(&pui8Msg[5]);
+	}
+
+	//
+	// The concentrator keeps every node it has room for; the windows here
+	// only as many as fit, the others' samples still go to the
+	// concentrator
+	//
+	ui32Conc = XBeeConcFrame(ui64Addr, pui8Msg[ui32Pos + IO_OFFSET_RSSI]);
+	if(ui32Conc == XBEE_CONC_NONE)
+	{
+		g_sIoStats.ui32Dropped++;
+		return;
+	}
+	psNode = XBeeIoNodeGet(ui32Conc);
+
+	ui16Channels = XBEE_GET16(&pui8Msg[ui32Pos + IO_OFFSET_CHANNELS]);
+	if(psNode && (ui16Channels != psNode->ui16Channels))
+	{
+		//
+		// Node was reconfigured, the window no longer adds up
+		//
+		psNode->ui32Count = 0;
+		psNode->bDioValid = false;
+		psNode->ui16Channels = ui16Channels;
+	}
+	if(psNode)
+	{
+		psNode->ui8Rssi = pui8Msg[ui32Pos + IO_OFFSET_RSSI];
+		psNode->ui32HeardTick = XBeeTickGet();
+	}
+	XBeeQualRssi(ui64Addr, pui8Msg[ui32Pos + IO_OFFSET_RSSI]);
+	ui32Count = pui8Msg[ui32Pos + IO_OFFSET_COUNT];
+	ui32Pos += IO_OFFSET_SAMPLES;
+
+	memset(pui16Adc, 0, sizeof(pui16Adc));
+	ui16Dio = 0;
+	ui16Changed = 0;
+
+	while(ui32Count--)
+	{
+		if(ui16Channels & XBEE_IO_DIO_MASK)
+		{
+			if((ui32Pos + 2) > ui32Len)
+			{
+				g_sIoStats.ui32Bad++;
+				return;
+			}
+			ui16Dio = XBEE_GET16(&pui8Msg[ui32Pos]) & XBEE_IO_DIO_MASK;
+			ui32Pos += 2;
+		}
+
+		for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+		{
+			if(ui16Channels & (1 << (IO_ADC_SHIFT + ui32Adc)))
+			{
+				if((ui32Pos + 2) > ui32Len)
+				{
+					g_sIoStats.ui32Bad++;
+					return;
+				}
+				pui16Adc[ui32Adc] = XBEE_GET16(&pui8Msg[ui32Pos]) & 0x3FF;
+				ui32Pos += 2;
+			}
+		}
+
+		if(psNode)
+		{
+			ui16Changed |= XBeeIoSample(psNode, ui16Dio, pui16Adc);
+		}
+	}
+
+	//
+	// Frames that only repeat the digital lines are what change detection
+	// saves
+	//
+	if(psNode && (ui16Channels & XBEE_IO_DIO_MASK) &&
+	   !(ui16Channels >> IO_ADC_SHIFT))
+	{
+		if(ui16Changed)
+		{
+			g_sIoStats.ui32ChangeFrames++;
+		}
+		else
+		{
+			g_sIoStats.ui32RepeatFrames++;
+		}
+	}
+
+	//
+	// Last value of the first analog channel, or the digital lines if none
+	//
+	for(ui32Adc = 0; ui32Adc < XBEE_IO_ADC_CHANNELS; ui32Adc++)
+	{
+		if(ui16Channels & (1 << (IO_ADC_SHIFT + ui32Adc)))
+		{
+			break;
+		}
+	}
+	XBeeConcSample(ui32Conc, (ui32Adc < XBEE_IO_ADC_CHANNELS) ?
+	                         pui16Adc[ui32Adc] : ui16Dio);
+
+	g_sIoStats.ui32Cycles += XBeeCycleCountGet() - ui32Start;
+}
+
+//*****************************************************************************
+//
+// Print the summary of every window that has run its time. Called from
+// XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeIoPoll(void)
+{
+	uint32_t ui32Now;
+	uint32_t ui32Index;
+
+	if(g_ui32IoMode == XBEE_IO_MODE_RAW)
+	{
+		return;
+	}
+
+	ui32Now = XBeeTickGet();
+	for(ui32Index = 0; ui32Index < g_ui32IoNodeCount; ui32Index++)
+	{
+		if(g_psIoNodes[ui32Index].ui32Count &&
+		   XBEE_TICK_REACHED(ui32Now, g_psIoNodes[ui32Index].ui32WindowStart +
+		                              g_ui32IoWindowMs))
+		{
+			XBeeIoFlush(&g_psIoNodes[ui32Index]);
+		}
+		else if(g_psIoNodes[ui32Index].ui32Count)
+		{
+			XBeeIdleDeadline(g_psIoNodes[ui32Index].ui32WindowStart +
+			                 g_ui32IoWindowMs);
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Select raw or aggregate output and the aggregate window. Open windows are
+// thrown away.
+//
+//*****************************************************************************
+void
+XBeeIoModeSet(uint32_t ui32Mode, uint32_t ui32WindowMs)
+{
+	g_ui32IoMode = ui32Mode;
+	if(ui32WindowMs)
+	{
+		g_ui32IoWindowMs = ui32WindowMs;
+	}
+	XBeeIoClear();
+}
+
+//*****************************************************************************
+//
+// Forget all nodes' windows and line state.
+//
+//*****************************************************************************
+void
+XBeeIoClear(void)
+{
+	g_ui32IoNodeCount = 0;
+}
+
+//*****************************************************************************
+//
+// Forget the window and line state of node ui32Node, a number the
+// concentrator gives to another node.
+//
+//*****************************************************************************
+void
+XBeeIoForget(uint32_t ui32Node)
+{
+	uint32_t ui32Index;
+
+	for(ui32Index = 0; ui32Index < g_ui32IoNodeCount; ui32Index++)
+	{
+		if(g_psIoNodes[ui32Index].ui16Node == ui32Node)
+		{
+			g_ui32IoNodeCount--;
+			memmove(&g_psIoNodes[ui32Index], &g_psIoNodes[ui32Index + 1],
+			        (g_ui32IoNodeCount - ui32Index) * sizeof(tXBeeIoNode));
+			return;
+		}
+	}
+}
+
+void
+XBeeIoStatsGet(tXBeeIoStats *psStats)
+{
+	*psStats = g_sIoStats;
+}
+
+//*****************************************************************************
+//
+// Print the digital state of every node: the level of each line sampled,
+// the lines that changed last and when, and when the node was last heard.
+//
+//*****************************************************************************
+static void
+XBeeIoLines(void)
+{
+	char pcLine[IO_LINE_SIZE];
+	tXBeeIoNode *psNode;
+	uint32_t ui32Now;
+	uint32_t ui32Index;
+	uint32_t ui32Line;
+	uint32_t ui32Len;
+
+	ui32Now = XBeeTickGet();
+	for(ui32Index = 0; ui32Index < g_ui32IoNodeCount; ui32Index++)
+	{
+		psNode = &g_psIoNodes[ui32Index];
+		if(!psNode->bDioValid)
+		{
+			continue;
+		}
+
+		ui32Len = XBeeIoAddr(pcLine, sizeof(pcLine), psNode);
+		for(ui32Line = 0; (XBEE_IO_DIO_MASK >> ui32Line) & 1; ui32Line++)
+		{
+			if(psNode->ui16Channels & (1 << ui32Line))
+			{
+				ui32Len += usnprintf(pcLine + ui32Len,
+				                     sizeof(pcLine) - ui32Len, " D%d=%d",
+				                     ui32Line, (psNode->ui16Dio >> ui32Line) & 1);
+			}
+		}
+		if(psNode->ui16Edges)
+		{
+			ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+			                     ", %d edges, ^%03x %d ms ago",
+			                     psNode->ui16Edges, psNode->ui16EdgeLines,
+			                     ui32Now - psNode->ui32EdgeTick);
+		}
+		ui32Len += usnprintf(pcLine + ui32Len, sizeof(pcLine) - ui32Len,
+		                     ", heard %d ms ago\n",
+		                     ui32Now - psNode->ui32HeardTick);
+		UARTwrite(pcLine, ui32Len);
+	}
+}
+
+//*****************************************************************************
+//
+// I/O Samples Command
+// Input: none / 'raw' / 'agg [window ms]' / 'lines' / 'clear'
+// Response: sample counters and console bytes saved, or with 'lines' the
+//		state of each node's digital lines
+// Use: to choose how received I/O samples are shown. 'agg' (the default)
+//		prints digital changes and analog min/mean/max per window, 'raw'
+//		prints every sample.
+//
+//*****************************************************************************
+int
+Cmd_io(int argc, char *argv[])
+{
+	if((2 == argc) && (0 == strcmp(argv[1], "raw")))
+	{
+		XBeeIoModeSet(XBEE_IO_MODE_RAW, 0);
+		return 0;
+	}
+	else if((argc >= 2) && (argc <= 3) && (0 == strcmp(argv[1], "agg")))
+	{
+		XBeeIoModeSet(XBEE_IO_MODE_AGGREGATE,
+		              (3 == argc) ? strtoul(argv[2], 0, 0) : 0);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "lines")))
+	{
+		XBeeIoLines();
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sIoStats, 0, sizeof(g_sIoStats));
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("mode %s, window %d ms, %d/%d nodes\n",
+	           (g_ui32IoMode == XBEE_IO_MODE_RAW) ? "raw" : "agg",
+	           g_ui32IoWindowMs, g_ui32IoNodeCount, XBEE_IO_NODES);
+	UARTprintf("frames %d, samples %d, digital changes %d, bad %d, "
+	           "dropped %d\n", g_sIoStats.ui32Frames, g_sIoStats.ui32Samples,
+	           g_sIoStats.ui32Changes, g_sIoStats.ui32Bad,
+	           g_sIoStats.ui32Dropped);
+	UARTprintf("digital frames with a change %d, repeating the state %d, "
+	           "%d cycles per frame\n", g_sIoStats.ui32ChangeFrames,
+	           g_sIoStats.ui32RepeatFrames,
+	           g_sIoStats.ui32Frames ?
+	           (g_sIoStats.ui32Cycles / g_sIoStats.ui32Frames) : 0);
+	UARTprintf("console bytes %d of %d raw (%d%%)\n", g_sIoStats.ui32OutBytes,
+	           g_sIoStats.ui32RawBytes,
+	           g_sIoStats.ui32RawBytes ?
+	           (uint32_t)(((uint64_t)g_sIoStats.ui32OutBytes * 100) /
+	                      g_sIoStats.ui32RawBytes) : 100);
+
+	return 0;
+}
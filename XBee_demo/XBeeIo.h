@@ -0,0 +1,76 @@
+//*****************************************************************************
+//
+// XBeeIo.h - Headers for use with XBeeIo.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEIO_H__
+#define __XBEEIO_H__
+
+//*****************************************************************************
+//
+// Output modes. RAW prints every sample, AGGREGATE prints digital changes
+// as they happen and analog min/mean/max once per window.
+//
+//*****************************************************************************
+#define XBEE_IO_MODE_RAW        0
+#define XBEE_IO_MODE_AGGREGATE  1
+
+//*****************************************************************************
+//
+// Sizes. Series 1 samples up to 9 digital lines (D0-D8) and 6 ADCs (A0-A5).
+//
+//*****************************************************************************
+#define XBEE_IO_NODES           16
+#define XBEE_IO_ADC_CHANNELS    6
+#define XBEE_IO_DIO_MASK        0x01FF
+#define XBEE_IO_WINDOW_MS       1000
+
+//*****************************************************************************
+//
+// Sample statistics. ui32RawBytes is what raw mode would have printed for
+// every sample received, ui32OutBytes what was actually printed. Frames
+// from digital only nodes are split into those that changed a line and
+// those that repeated the known state. ui32Cycles is the time spent in
+// XBeeIoFrame().
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Frames;
+	uint32_t ui32Samples;
+	uint32_t ui32Changes;
+	uint32_t ui32Bad;
+	uint32_t ui32Dropped;               // window table or concentrator full
+	uint32_t ui32RawBytes;
+	uint32_t ui32OutBytes;
+	uint32_t ui32ChangeFrames;
+	uint32_t ui32RepeatFrames;
+	uint32_t ui32Cycles;
+}
+tXBeeIoStats;
+
+//*****************************************************************************
+//
+// I/O sample functions
+//
+//*****************************************************************************
+extern void XBeeIoFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeIoPoll(void);
+extern void XBeeIoModeSet(uint32_t ui32Mode, uint32_t ui32WindowMs);
+extern void XBeeIoClear(void);
+extern void XBeeIoForget(uint32_t ui32Node);
+extern void XBeeIoStatsGet(tXBeeIoStats *psStats);
+extern int Cmd_io(int argc, char *argv[]);
+
+#endif //__XBEEIO_H__
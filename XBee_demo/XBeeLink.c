@@ -0,0 +1,764 @@
+//*****************************************************************************
+//
+// XBeeLink.c - Node to node messages over the UART1 radio link
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! In transparent mode the XBees pass bytes through untouched, so messages
+//! between nodes are wrapped in the same 0x7E / escape / checksum framing
+//! the XBee uses for API mode 2 (XBeeFrame.c). Everything received on UART1
+//! is sorted here: while a command waits for its response the bytes go to
+//! the response tokenizer, a 0x7E starts a message frame, and anything else
+//! is plain data that is echoed to the console as before.
+//!
+//! Received messages are handed out by type through g_psLinkTable. The
+//! same table takes frames from the local XBee when it runs in API mode 2,
+//! such as I/O samples forwarded from remote nodes.
+//!
+//! When the boot probe found the XBee in API mode, messages go out as
+//! transmit requests to the link destination through XBeeTx.c, and come in
+//! inside receive frames (0x80 / 0x81) that are unwrapped before dispatch
+//! and counted as the message inside.
+//!
+//! With compression on, payloads are run through XBeeLz.c on the way out
+//! and sent with XBEE_MSG_FLAG_LZ only if that made them smaller, so each
+//! message says for itself how to read it and handlers never see the
+//! compressed form. A message is traced, packed and numbered in one pool
+//! buffer rather than in copies on the stack.
+//!
+//! With tracing on (XBeeTrace.c), data class messages also carry a trace
+//! header inside the compressed part. It is taken off here after expansion
+//! and the handler's run time is recorded with it.
+//!
+//! Messages other than bulk fragments end in a sequence number, checked
+//! against the source's window in XBeeDup.c before anything else is done
+//! with them, so a message received twice reaches its handler once.
+//!
+//! Data messages held in flash while the link was down (XBeeStore.c) come
+//! back packed into batch messages, each unpacked here and dispatched as if
+//! it had arrived on its own.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeePool.h"
+#include "XBeeFrame.h"
+#include "XBeeResp.h"
+#include "XBeeBulk.h"
+#include "XBeeLz.h"
+#include "XBeeIo.h"
+#include "XBeeBoot.h"
+#include "XBeeClock.h"
+#include "XBeeSched.h"
+#include "XBeeTx.h"
+#include "XBeeProf.h"
+#include "XBeeTrace.h"
+#include "XBeeQual.h"
+#include "XBeeDup.h"
+#include "XBeeConc.h"
+#include "XBeeChan.h"
+#include "XBeeSlot.h"
+#include "XBeeStore.h"
+#include "XBeeIc.h"
+#include "XBeeLink.h"
+
+static void XBeeLinkApiRx(const uint8_t *pui8Msg, uint32_t ui32Len);
+static void XBeeLinkBatch(const uint8_t *pui8Msg, uint32_t ui32Len);
+
+//*****************************************************************************
+//
+// Message handlers, by type
+//
+//*****************************************************************************
+static const tXBeeLinkEntry g_psLinkTable[] =
+{
+	{ XBEE_MSG_BULK_START,  XBeeBulkMsg },
+	{ XBEE_MSG_BULK_DATA,   XBeeBulkMsg },
+	{ XBEE_MSG_BULK_ACK,    XBeeBulkMsg },
+	{ XBEE_MSG_BULK_NAK,    XBeeBulkMsg },
+	{ XBEE_MSG_TX_BENCH,    XBeeTxBenchMsg },
+	{ XBEE_MSG_TRACE_PING,  XBeeTraceMsg },
+	{ XBEE_MSG_TRACE_PONG,  XBeeTraceMsg },
+	{ XBEE_MSG_TRACE_DATA,  XBeeTraceMsg },
+	{ XBEE_MSG_SLOT_ASSIGN, XBeeSlotMsg },
+	{ XBEE_MSG_SLOT_BEACON, XBeeSlotMsg },
+	{ XBEE_MSG_SLOT_SAMPLE, XBeeSlotMsg },
+	{ XBEE_MSG_STORE_BATCH, XBeeLinkBatch },
+	{ XBEE_API_RX_IO_64,    XBeeIoFrame },
+	{ XBEE_API_RX_IO_16,    XBeeIoFrame },
+	{ XBEE_API_AT_RESPONSE, XBeeBootApiFrame },
+	{ XBEE_API_REMOTE_AT_RESPONSE, XBeeIcRemoteFrame },
+	{ XBEE_API_TX_STATUS,   XBeeTxStatusFrame },
+	{ XBEE_API_ZB_TX_STATUS, XBeeTxStatusFrame },
+	{ 0, 0 }
+};
+
+//*****************************************************************************
+//
+// Receiver and statistics
+//
+//*****************************************************************************
+static tXBeeFrameRx g_sLinkRx;
+static tXBeeLinkStats g_sLinkStats;
+static bool g_bLinkCompress;
+static bool g_bLinkMidLine;
+static uint8_t g_pui8LinkExpand[XBEE_MSG_MAX];
+
+//*****************************************************************************
+//
+// Where messages go in API mode, 16-bit MY or 64-bit serial number
+//
+//*****************************************************************************
+static uint64_t g_ui64LinkDest = 0xFFFF;
+
+//*****************************************************************************
+//
+// Sender of the message being dispatched: the other node in transparent
+// mode, the address from the receive frame in API mode, and its
+// concentrator node number, which keys its duplicate window
+//
+//*****************************************************************************
+#define LINK_SOURCE_PEER        0xFFFFFFFFFFFFFFFEULL
+
+static uint64_t g_ui64LinkSource = LINK_SOURCE_PEER;
+static uint32_t g_ui32LinkNode = XBEE_DUP_PEER;
+
+//*****************************************************************************
+//
+// Look up and call the handler for a received message.
+//
+//*****************************************************************************
+static void
+XBeeLinkDispatch(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	const tXBeeLinkEntry *psEntry;
+	uint32_t ui32Expanded;
+	uint32_t ui32RxTime;
+	uint32_t ui32WireLen;
+	bool bTraced;
+
+	ui32RxTime = XBeeTickMicros();
+	ui32WireLen = ui32Len;
+	bTraced = false;
+
+	if(ui32Len < XBEE_MSG_HDR_SIZE)
+	{
+		g_sLinkStats.ui32MsgUnknown++;
+		return;
+	}
+
+	//
+	// A receive frame comes back here with the message it carries
+	//
+	if((pui8Msg[0] == XBEE_API_RX_64) || (pui8Msg[0] == XBEE_API_RX_16))
+	{
+		XBeeLinkApiRx(pui8Msg, ui32Len);
+		return;
+	}
+
+	//
+	// Duplicates go first, before any work is spent on them
+	//
+	if(XBEE_MSG_IS_LINK(pui8Msg[0]) && (pui8Msg[1] & XBEE_MSG_FLAG_SEQ))
+	{
+		if(ui32Len < (XBEE_MSG_HDR_SIZE + XBEE_DUP_SEQ_SIZE))
+		{
+			g_sLinkStats.ui32MsgUnknown++;
+			return;
+		}
+		ui32Len -= XBEE_DUP_SEQ_SIZE;
+		if(!XBeeDupCheck(g_ui32LinkNode, XBEE_GET16(&pui8Msg[ui32Len])))
+		{
+			return;
+		}
+	}
+
+	if(XBEE_MSG_IS_LINK(pui8Msg[0]) && (pui8Msg[1] & XBEE_MSG_FLAG_LZ))
+	{
+		ui32Expanded = XBeeLzDecompress(&g_pui8LinkExpand[XBEE_MSG_HDR_SIZE],
+		                                XBEE_MSG_MAX - XBEE_MSG_HDR_SIZE,
+		                                &pui8Msg[XBEE_MSG_HDR_SIZE],
+		                                ui32Len - XBEE_MSG_HDR_SIZE);
+		if(ui32Expanded == 0)
+		{
+			g_sLinkStats.ui32LzBad++;
+			return;
+		}
+		g_pui8LinkExpand[0] = pui8Msg[0];
+		g_pui8LinkExpand[1] = pui8Msg[1] & ~XBEE_MSG_FLAG_LZ;
+		pui8Msg = g_pui8LinkExpand;
+		ui32Len = ui32Expanded + XBEE_MSG_HDR_SIZE;
+	}
+
+	//
+	// Take the trace header out, the handler sees the message as sent
+	//
+	if(XBEE_MSG_IS_LINK(pui8Msg[0]) && (pui8Msg[1] & XBEE_MSG_FLAG_TRACE))
+	{
+		if(ui32Len < (XBEE_MSG_HDR_SIZE + XBEE_TRACE_HDR_SIZE))
+		{
+			g_sLinkStats.ui32MsgUnknown++;
+			return;
+		}
+		XBeeTraceRxStart(&pui8Msg[XBEE_MSG_HDR_SIZE], ui32RxTime,
+		                 ui32WireLen);
+		bTraced = true;
+		ui32Len -= XBEE_TRACE_HDR_SIZE;
+		g_pui8LinkExpand[0] = pui8Msg[0];
+		g_pui8LinkExpand[1] = pui8Msg[1] & ~XBEE_MSG_FLAG_TRACE;
+		memmove(&g_pui8LinkExpand[XBEE_MSG_HDR_SIZE],
+		        &pui8Msg[XBEE_MSG_HDR_SIZE + XBEE_TRACE_HDR_SIZE],
+		        ui32Len - XBEE_MSG_HDR_SIZE);
+		pui8Msg = g_pui8LinkExpand;
+	}
+
+	for(psEntry = g_psLinkTable; psEntry->pfnHandler; psEntry++)
+	{
+		if(psEntry->ui8Type == pui8Msg[0])
+		{
+			g_sLinkStats.ui32MsgRx++;
+			psEntry->pfnHandler(pui8Msg, ui32Len);
+			if(bTraced)
+			{
+				XBeeTraceRxDone();
+			}
+			return;
+		}
+	}
+
+	g_sLinkStats.ui32MsgUnknown++;
+}
+
+//*****************************************************************************
+//
+// Link handler for batches from the flash queue: a length byte before each
+// message.
+//
+//*****************************************************************************
+static void
+XBeeLinkBatch(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Pos;
+	uint32_t ui32Part;
+
+	ui32Pos = XBEE_MSG_HDR_SIZE;
+	while(ui32Pos < ui32Len)
+	{
+		ui32Part = pui8Msg[ui32Pos++];
+		if((ui32Part < XBEE_MSG_HDR_SIZE) || (ui32Part > (ui32Len - ui32Pos)) ||
+		   (pui8Msg[ui32Pos] == XBEE_MSG_STORE_BATCH))
+		{
+			g_sLinkStats.ui32MsgUnknown++;
+			return;
+		}
+		XBeeLinkDispatch(&pui8Msg[ui32Pos], ui32Part);
+		ui32Pos += ui32Part;
+	}
+}
+
+//*****************************************************************************
+//
+// Link handler for API receive frames, the message is the RF data after
+// the source address, RSSI and options. The RSSI goes to the link quality
+// of the source.
+//
+//*****************************************************************************
+static void
+XBeeLinkApiRx(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Hdr;
+	uint64_t ui64Source;
+	uint32_t ui32Node;
+
+	ui32Hdr = (pui8Msg[0] == XBEE_API_RX_64) ? 11 : 5;
+
+	if(ui32Len >= ui32Hdr)
+	{
+		if(ui32Hdr == 11)
+		{
+			ui64Source = ((uint64_t)XBEE_GET32(&pui8Msg[1]) << 32) |
+			             XBEE_GET32(&pui8Msg[5]);
+		}
+		else
+		{
+			ui64Source = XBEE_GET16(&pui8Msg[1]);
+		}
+		ui32Node = XBeeConcFrame(ui64Source, pui8Msg[ui32Hdr - 2]);
+		XBeeQualRssi(ui64Source, pui8Msg[ui32Hdr - 2]);
+	}
+
+	if((ui32Len <= ui32Hdr) || !XBEE_MSG_IS_LINK(pui8Msg[ui32Hdr]))
+	{
+		g_sLinkStats.ui32MsgUnknown++;
+		return;
+	}
+
+	g_ui64LinkSource = ui64Source;
+	g_ui32LinkNode = ui32Node;
+	XBeeLinkDispatch(&pui8Msg[ui32Hdr], ui32Len - ui32Hdr);
+	g_ui64LinkSource = LINK_SOURCE_PEER;
+	g_ui32LinkNode = XBEE_DUP_PEER;
+}
+
+//*****************************************************************************
+//
+// True if the XBee was found in API mode, so messages need transmit
+// requests around them.
+//
+//*****************************************************************************
+bool
+XBeeLinkApi(void)
+{
+	tXBeeBootInfo sInfo;
+
+	XBeeBootInfoGet(&sInfo);
+	return sInfo.ui32Mode == XBEE_MODE_API;
+}
+
+//*****************************************************************************
+//
+// Sort received bytes between the tokenizer, the frame receiver and the
+// console.
+//
+// Frames keep going to their handlers while a command waits for its
+// answer, so ATND's long wait costs no data. Answers are text lines and
+// the radio never puts a frame inside one, so while one is pending a
+// delimiter only starts a frame at the start of a line; in the middle of
+// one it is a '~' in, say, a node identifier.
+//
+//*****************************************************************************
+static void
+XBeeLinkRoute(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	const uint8_t *pui8Delim;
+	uint32_t ui32Run;
+
+	while(ui32Len)
+	{
+		if(XBeeFrameRxIdle(&g_sLinkRx))
+		{
+			//
+			// Plain data up to the next frame
+			//
+			pui8Delim = memchr(pui8Data, XBEE_FRAME_DELIM, ui32Len);
+			ui32Run = pui8Delim ? (uint32_t)(pui8Delim - pui8Data) : ui32Len;
+			if(ui32Run)
+			{
+				g_bLinkMidLine = (pui8Data[ui32Run - 1] != '\r');
+			}
+			if(pui8Delim && g_bLinkMidLine && XBeeRespPending())
+			{
+				ui32Run++;
+			}
+			if(ui32Run)
+			{
+				XBeeRespFeed(pui8Data, ui32Run);
+				pui8Data += ui32Run;
+				ui32Len -= ui32Run;
+				continue;
+			}
+		}
+
+		ui32Run = XBeeFrameRxFeed(&g_sLinkRx, pui8Data, ui32Len,
+		                          XBeeLinkDispatch);
+		pui8Data += ui32Run;
+		ui32Len -= ui32Run;
+		g_bLinkMidLine = false;
+	}
+}
+
+//*****************************************************************************
+//
+// Set up the link receiver.
+//
+//*****************************************************************************
+void
+XBeeLinkInit(void)
+{
+	XBeeFrameRxInit(&g_sLinkRx);
+	XBeeConcClear();
+}
+
+//*****************************************************************************
+//
+// Drain UART1 and run the timers of everything that sits on the link. Call
+// from the main loop.
+//
+//*****************************************************************************
+void
+XBeeLinkPoll(void)
+{
+	uint8_t pui8Buf[32];
+	uint32_t ui32Count;
+	uint32_t ui32Start;
+	bool bWork;
+
+	ui32Start = XBeeCycleCountGet();
+	bWork = false;
+	while((ui32Count = XBeeUartRead(pui8Buf, sizeof(pui8Buf))) != 0)
+	{
+		XBEE_PROF_ENTER(XBEE_PROF_LINK_ROUTE);
+		XBeeLinkRoute(pui8Buf, ui32Count);
+		XBEE_PROF_EXIT(XBEE_PROF_LINK_ROUTE);
+		bWork = true;
+	}
+
+	//
+	// Cycles spent on received data are the load the clock governor sees
+	//
+	if(bWork)
+	{
+		XBeeClockWork(XBeeCycleCountGet() - ui32Start);
+	}
+
+	XBeeRespPoll();
+	XBeeBulkPoll();
+	XBeeIoPoll();
+	XBeeTxPoll();
+	XBeeTracePoll();
+	XBeeClockPoll();
+	XBeeChanPoll();
+	XBeeSlotPoll();
+	XBeeStorePoll();
+
+	XBEE_PROF_ENTER(XBEE_PROF_SCHED_POLL);
+	XBeeSchedPoll();
+	XBEE_PROF_EXIT(XBEE_PROF_SCHED_POLL);
+}
+
+//*****************************************************************************
+//
+// Transmit class of a message: bulk fragments queue behind everything else,
+// the bulk handshake and ACKs go with the control traffic.
+//
+//*****************************************************************************
+static uint32_t
+XBeeLinkClass(uint8_t ui8Type)
+{
+	switch(ui8Type)
+	{
+		case XBEE_MSG_BULK_DATA:
+			return XBEE_SCHED_BULK;
+
+		case XBEE_MSG_BULK_START:
+		case XBEE_MSG_BULK_ACK:
+		case XBEE_MSG_BULK_NAK:
+		case XBEE_MSG_TRACE_PING:
+		case XBEE_MSG_TRACE_PONG:
+			return XBEE_SCHED_CONTROL;
+
+		default:
+			return XBEE_SCHED_DATA;
+	}
+}
+
+//*****************************************************************************
+//
+// Queue a finished message, framed for the other node in transparent mode
+// or as a transmit request in API mode. Data messages start the pacing gap
+// to the destination, or go to the flash queue while it holds them.
+//
+//*****************************************************************************
+static void
+XBeeLinkOut(uint32_t ui32Class, const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	if((ui32Class == XBEE_SCHED_DATA) && XBeeLinkApi() &&
+	   XBeeStoreHold(pui8Msg, ui32Len))
+	{
+		return;
+	}
+
+	if(ui32Class == XBEE_SCHED_DATA)
+	{
+		XBeeQualSent(g_ui64LinkDest);
+	}
+
+	if(XBeeLinkApi())
+	{
+		XBeeTxSend(g_ui64LinkDest, ui32Class, pui8Msg, ui32Len,
+		           (ui32Class == XBEE_SCHED_DATA) ? XBeeStoreResult : 0, 0);
+	}
+	else
+	{
+		XBeeFrameQueue(ui32Class, pui8Msg, ui32Len);
+	}
+}
+
+//*****************************************************************************
+//
+// Send a message to the other node.
+//
+//*****************************************************************************
+void
+XBeeLinkSend(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	XBeeLinkSendStamped(pui8Msg, ui32Len, XBeeTickMicros());
+}
+
+//*****************************************************************************
+//
+// Send a message whose data was taken at ui32Origin (XBeeTickMicros()),
+// which goes in the trace header when tracing is on.
+//
+// The message is built in one pool buffer of two halves: what goes out in
+// the first, the traced copy in the second when it still has to be
+// compressed into the first. Without a buffer it goes as it is, untraced,
+// uncompressed and without a sequence number.
+//
+//*****************************************************************************
+void
+XBeeLinkSendStamped(const uint8_t *pui8Msg, uint32_t ui32Len,
+                    uint32_t ui32Origin)
+{
+	tXBeeBuf *psBuf;
+	uint8_t *pui8Out;
+	uint8_t *pui8Built;
+	uint32_t ui32Packed;
+	uint32_t ui32Class;
+	uint16_t ui16Seq;
+	bool bTrace;
+	bool bSeq;
+
+	g_sLinkStats.ui32MsgTx++;
+	ui32Class = XBeeLinkClass(pui8Msg[0]);
+
+	//
+	// Data messages only, and only if the header still fits a transmit
+	// request
+	//
+	bTrace = XBeeTraceEnabled() && (ui32Class == XBEE_SCHED_DATA) &&
+	         ((ui32Len + XBEE_TRACE_HDR_SIZE) <= XBEE_TX_MAX_PAYLOAD);
+
+	//
+	// Bulk fragments have a sequence of their own and every byte counted
+	//
+	bSeq = (ui32Class != XBEE_SCHED_BULK) &&
+	       ((ui32Len + (bTrace ? XBEE_TRACE_HDR_SIZE : 0) +
+	         XBEE_DUP_SEQ_SIZE) <= XBEE_TX_MAX_PAYLOAD);
+
+	psBuf = 0;
+	if(bTrace || bSeq || (g_bLinkCompress && (ui32Len > XBEE_MSG_HDR_SIZE)))
+	{
+		psBuf = XBeePoolAlloc(2 * XBEE_MSG_MAX);
+	}
+	if(psBuf == 0)
+	{
+		XBeeLinkOut(ui32Class, pui8Msg, ui32Len);
+		return;
+	}
+	pui8Out = psBuf->pui8Data;
+	pui8Built = 0;
+
+	if(bTrace)
+	{
+		pui8Built = g_bLinkCompress ? &pui8Out[XBEE_MSG_MAX] : pui8Out;
+		pui8Built[0] = pui8Msg[0];
+		pui8Built[1] = pui8Msg[1] | XBEE_MSG_FLAG_TRACE;
+		XBeeTraceHeaderPut(&pui8Built[XBEE_MSG_HDR_SIZE], ui32Origin);
+		memcpy(&pui8Built[XBEE_MSG_HDR_SIZE + XBEE_TRACE_HDR_SIZE],
+		       &pui8Msg[XBEE_MSG_HDR_SIZE], ui32Len - XBEE_MSG_HDR_SIZE);
+		pui8Msg = pui8Built;
+		ui32Len += XBEE_TRACE_HDR_SIZE;
+	}
+
+	if(g_bLinkCompress && (ui32Len > XBEE_MSG_HDR_SIZE))
+	{
+		XBEE_PROF_ENTER(XBEE_PROF_LZ_COMPRESS);
+		ui32Packed = XBeeLzCompress(&pui8Out[XBEE_MSG_HDR_SIZE],
+		                            XBEE_MSG_MAX - XBEE_MSG_HDR_SIZE,
+		                            &pui8Msg[XBEE_MSG_HDR_SIZE],
+		                            ui32Len - XBEE_MSG_HDR_SIZE);
+		XBEE_PROF_EXIT(XBEE_PROF_LZ_COMPRESS);
+		g_sLinkStats.ui32LzIn += ui32Len - XBEE_MSG_HDR_SIZE;
+		if(ui32Packed)
+		{
+			g_sLinkStats.ui32LzOut += ui32Packed;
+			pui8Out[0] = pui8Msg[0];
+			pui8Out[1] = pui8Msg[1] | XBEE_MSG_FLAG_LZ;
+			pui8Built = pui8Out;
+			pui8Msg = pui8Built;
+			ui32Len = ui32Packed + XBEE_MSG_HDR_SIZE;
+		}
+		else
+		{
+			g_sLinkStats.ui32LzOut += ui32Len - XBEE_MSG_HDR_SIZE;
+		}
+	}
+
+	//
+	// The number goes on the end of the message where it was built, or of
+	// a copy of the caller's
+	//
+	if(bSeq)
+	{
+		if(pui8Built == 0)
+		{
+			memcpy(pui8Out, pui8Msg, ui32Len);
+			pui8Built = pui8Out;
+			pui8Msg = pui8Built;
+		}
+		ui16Seq = XBeeDupSeqNext();
+		pui8Built[1] |= XBEE_MSG_FLAG_SEQ;
+		XBEE_PUT16(&pui8Built[ui32Len], ui16Seq);
+		ui32Len += XBEE_DUP_SEQ_SIZE;
+	}
+
+	XBeeLinkOut(ui32Class, pui8Msg, ui32Len);
+	XBeePoolFree(psBuf);
+}
+
+//*****************************************************************************
+//
+// True if a message sent now would be tracked and is not held back by the
+// pacing gap of a lossy link. In API mode the transmit window to the
+// destination must also have room.
+//
+//*****************************************************************************
+bool
+XBeeLinkSendReady(void)
+{
+	return XBeeQualReady(g_ui64LinkDest) &&
+	       (!XBeeLinkApi() || XBeeTxReady(g_ui64LinkDest));
+}
+
+//*****************************************************************************
+//
+// Destination of messages in API mode. 0xFFFF (broadcast) until set.
+//
+//*****************************************************************************
+void
+XBeeLinkDestSet(uint64_t ui64Dest)
+{
+	g_ui64LinkDest = ui64Dest;
+}
+
+uint64_t
+XBeeLinkDestGet(void)
+{
+	return g_ui64LinkDest;
+}
+
+//*****************************************************************************
+//
+// Sender of the message being handled, for handlers that answer it.
+//
+//*****************************************************************************
+uint64_t
+XBeeLinkSourceGet(void)
+{
+	return g_ui64LinkSource;
+}
+
+//*****************************************************************************
+//
+// Turn compression of outgoing messages on or off. Compressed messages are
+// always accepted.
+//
+//*****************************************************************************
+void
+XBeeLinkCompressSet(bool bEnable)
+{
+	g_bLinkCompress = bEnable;
+}
+
+//*****************************************************************************
+//
+// Best case payload rate of the link in bytes per second. The serial side
+// (10 bits per byte) is the limit well before the 250kbit/s RF rate.
+//
+//*****************************************************************************
+uint32_t
+XBeeLinkRate(void)
+{
+	uint32_t ui32Rate;
+
+	ui32Rate = XBeeUartBaudGet() / 10;
+	if(ui32Rate > (250000 / 8))
+	{
+		ui32Rate = 250000 / 8;
+	}
+
+	return ui32Rate;
+}
+
+void
+XBeeLinkStatsGet(tXBeeLinkStats *psStats)
+{
+	*psStats = g_sLinkStats;
+}
+
+//*****************************************************************************
+//
+// Link Command
+// Input: none / 'clear' / 'lz <1/0>' / 'dest <hex address>'
+// Response: message, compression and frame counters
+// Use: to check the health of node to node messaging, to turn compression
+//		of outgoing messages on or off, and to set where messages go in API
+//		mode (16-bit MY or 64-bit serial number)
+//
+//*****************************************************************************
+int
+Cmd_link(int argc, char *argv[])
+{
+	uint64_t ui64Dest;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sLinkStats, 0, sizeof(g_sLinkStats));
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "lz")))
+	{
+		XBeeLinkCompressSet(argv[2][0] == '1');
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "dest")))
+	{
+		if(!XBeeHexDecode(argv[2], strlen(argv[2]), &ui64Dest))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		XBeeLinkDestSet(ui64Dest);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("msgs tx %u, rx %u, unknown %u\n", g_sLinkStats.ui32MsgTx,
+	           g_sLinkStats.ui32MsgRx, g_sLinkStats.ui32MsgUnknown);
+	UARTprintf("lz %s, %u -> %u payload bytes, %u bad\n",
+	           g_bLinkCompress ? "on" : "off", g_sLinkStats.ui32LzIn,
+	           g_sLinkStats.ui32LzOut, g_sLinkStats.ui32LzBad);
+	UARTprintf("frames %u, bad checksum %u, oversize %u, resync %u\n",
+	           g_sLinkRx.ui32Frames, g_sLinkRx.ui32BadChecksum,
+	           g_sLinkRx.ui32Oversize, g_sLinkRx.ui32Resync);
+	UARTprintf("link rate %u bytes/s\n", XBeeLinkRate());
+	if(XBeeLinkApi())
+	{
+		UARTprintf("API mode, dest %08x%08x\n",
+		           (uint32_t)(g_ui64LinkDest >> 32), (uint32_t)g_ui64LinkDest);
+	}
+
+	return 0;
+}
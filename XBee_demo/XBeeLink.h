@@ -0,0 +1,135 @@
+//*****************************************************************************
+//
+// XBeeLink.h - Headers for use with XBeeLink.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEELINK_H__
+#define __XBEELINK_H__
+
+//*****************************************************************************
+//
+// Node to node message types. Every message starts with the type and a
+// flags byte. The values are kept clear of the XBee API identifiers.
+//
+//*****************************************************************************
+#define XBEE_MSG_BULK_START     0x40
+#define XBEE_MSG_BULK_DATA      0x41
+#define XBEE_MSG_BULK_ACK       0x42
+#define XBEE_MSG_BULK_NAK       0x43
+#define XBEE_MSG_TX_BENCH       0x44
+#define XBEE_MSG_TRACE_PING     0x45
+#define XBEE_MSG_TRACE_PONG     0x46
+#define XBEE_MSG_TRACE_DATA     0x47
+#define XBEE_MSG_SLOT_ASSIGN    0x48
+#define XBEE_MSG_SLOT_BEACON    0x49
+#define XBEE_MSG_SLOT_SAMPLE    0x4A
+#define XBEE_MSG_STORE_BATCH    0x4B
+
+#define XBEE_MSG_HDR_SIZE       2
+#define XBEE_MSG_MAX            XBEE_FRAME_MAX_DATA
+
+//*****************************************************************************
+//
+// Node to node messages use 0x40-0x7F, anything else arriving in a frame is
+// from the XBee itself (API mode) and has no flags byte.
+//
+//*****************************************************************************
+#define XBEE_MSG_IS_LINK(t)     (((t) & 0xC0) == 0x40)
+
+//*****************************************************************************
+//
+// Header flags. XBEE_MSG_FLAG_LZ marks a payload compressed by XBeeLz.c, the
+// link expands it before the handler sees it. XBEE_MSG_FLAG_TRACE marks a
+// trace header (XBeeTrace.h) after the message header, which the link
+// strips. XBEE_MSG_FLAG_SEQ marks a sequence number after everything else
+// (XBeeDup.h), outside the compressed part, checked and removed by the link.
+//
+//*****************************************************************************
+#define XBEE_MSG_FLAG_LZ        0x80
+#define XBEE_MSG_FLAG_TRACE     0x40
+#define XBEE_MSG_FLAG_SEQ       0x20
+
+//*****************************************************************************
+//
+// Multi byte message fields are sent MSB first, like the XBee API.
+//
+//*****************************************************************************
+#define XBEE_PUT16(p, v)        do                                          \
+                                {                                           \
+                                    (p)[0] = (uint8_t)((v) >> 8);           \
+                                    (p)[1] = (uint8_t)(v);                  \
+                                }                                           \
+                                while(0)
+#define XBEE_PUT32(p, v)        do                                          \
+                                {                                           \
+                                    XBEE_PUT16((p), (v) >> 16);             \
+                                    XBEE_PUT16((p) + 2, (v));               \
+                                }                                           \
+                                while(0)
+#define XBEE_GET16(p)           ((uint16_t)(((p)[0] << 8) | (p)[1]))
+#define XBEE_GET32(p)           (((uint32_t)XBEE_GET16(p) << 16) |          \
+                                 XBEE_GET16((p) + 2))
+
+//*****************************************************************************
+//
+// Called for a received message of the matching type. pui8Msg points at
+// the type byte.
+//
+//*****************************************************************************
+typedef void (*tXBeeMsgHandler)(const uint8_t *pui8Msg, uint32_t ui32Len);
+
+typedef struct
+{
+	uint8_t ui8Type;
+	tXBeeMsgHandler pfnHandler;
+}
+tXBeeLinkEntry;
+
+//*****************************************************************************
+//
+// Link statistics
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32MsgTx;
+	uint32_t ui32MsgRx;
+	uint32_t ui32MsgUnknown;
+	uint32_t ui32LzIn;                  // payload bytes offered to XBeeLz
+	uint32_t ui32LzOut;                 // and what went out
+	uint32_t ui32LzBad;                 // received, failed to expand
+}
+tXBeeLinkStats;
+
+//*****************************************************************************
+//
+// Link functions
+//
+//*****************************************************************************
+extern void XBeeLinkInit(void);
+extern void XBeeLinkPoll(void);
+extern void XBeeLinkSend(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeLinkSendStamped(const uint8_t *pui8Msg, uint32_t ui32Len,
+                                uint32_t ui32Origin);
+extern bool XBeeLinkSendReady(void);
+extern bool XBeeLinkApi(void);
+extern void XBeeLinkDestSet(uint64_t ui64Dest);
+extern uint64_t XBeeLinkDestGet(void);
+extern uint64_t XBeeLinkSourceGet(void);
+extern uint32_t XBeeLinkRate(void);
+extern void XBeeLinkCompressSet(bool bEnable);
+extern void XBeeLinkStatsGet(tXBeeLinkStats *psStats);
+extern int Cmd_link(int argc, char *argv[]);
+
+#endif //__XBEELINK_H__
@@ -0,0 +1,397 @@
+//*****************************************************************************
+//
+// XBeeLz.c - Small window LZ compression of link messages
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! LZSS over a single message. Output is groups of up to 8 items, each group
+//! led by a control byte whose bits (LSB first) mark the items that are
+//! matches. A literal is one byte, a match is two: distance - 1 and
+//! length - XBEE_LZ_MIN_MATCH.
+//!
+//! The match finder remembers the last position of each 3 byte hash. The
+//! table is never cleared between messages: a stale entry is only used if
+//! it is behind the current position and the bytes really match, so at
+//! worst it costs a missed match.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/sysctl.h"
+#include "driverlib/rom.h"
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeePool.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeLz.h"
+
+//*****************************************************************************
+//
+// Last position of each hash
+//
+//*****************************************************************************
+static uint8_t g_pui8LzHash[XBEE_LZ_HASH_SIZE];
+
+#define LZ_HASH(p)              ((((((uint32_t)(p)[0] << 16) |              \
+                                    ((uint32_t)(p)[1] << 8) | (p)[2]) *     \
+                                   2654435761U) >> 24) & (XBEE_LZ_HASH_SIZE - 1))
+
+//*****************************************************************************
+//
+// Compress ui32Len bytes into pui8Dst. Returns the compressed length, or 0
+// if the result would not be smaller than the input (send it raw).
+//
+//*****************************************************************************
+uint32_t
+XBeeLzCompress(uint8_t *pui8Dst, uint32_t ui32DstSize,
+               const uint8_t *pui8Src, uint32_t ui32Len)
+{
+	uint32_t ui32In;
+	uint32_t ui32Out;
+	uint32_t ui32Ctrl;
+	uint32_t ui32Cand;
+	uint32_t ui32Match;
+	uint32_t ui32Max;
+	uint32_t ui32Hash;
+	uint8_t ui8Mask;
+
+	if((ui32Len > XBEE_LZ_WINDOW) || (ui32Len < XBEE_LZ_MIN_SIZE))
+	{
+		return 0;
+	}
+	if(ui32DstSize >= ui32Len)
+	{
+		ui32DstSize = ui32Len - 1;
+	}
+
+	ui32In = 0;
+	ui32Out = 0;
+	ui32Ctrl = 0;
+	ui8Mask = 0;
+
+	while(ui32In < ui32Len)
+	{
+		//
+		// Start a new group
+		//
+		if(ui8Mask == 0)
+		{
+			if(ui32Out >= ui32DstSize)
+			{
+				return 0;
+			}
+			ui32Ctrl = ui32Out++;
+			pui8Dst[ui32Ctrl] = 0;
+			ui8Mask = 1;
+		}
+
+		//
+		// Look for an earlier copy of the next bytes
+		//
+		ui32Match = 0;
+		if((ui32In + XBEE_LZ_MIN_MATCH) <= ui32Len)
+		{
+			ui32Hash = LZ_HASH(pui8Src + ui32In);
+			ui32Cand = g_pui8LzHash[ui32Hash];
+			g_pui8LzHash[ui32Hash] = (uint8_t)ui32In;
+
+			if(ui32Cand < ui32In)
+			{
+				ui32Max = ui32Len - ui32In;
+				if(ui32Max > XBEE_LZ_MAX_MATCH)
+				{
+					ui32Max = XBEE_LZ_MAX_MATCH;
+				}
+				while((ui32Match < ui32Max) &&
+				      (pui8Src[ui32Cand + ui32Match] ==
+				       pui8Src[ui32In + ui32Match]))
+				{
+					ui32Match++;
+				}
+			}
+		}
+
+		if(ui32Match >= XBEE_LZ_MIN_MATCH)
+		{
+			if((ui32Out + 2) > ui32DstSize)
+			{
+				return 0;
+			}
+			pui8Dst[ui32Ctrl] |= ui8Mask;
+			pui8Dst[ui32Out++] = (uint8_t)(ui32In - ui32Cand - 1);
+			pui8Dst[ui32Out++] = (uint8_t)(ui32Match - XBEE_LZ_MIN_MATCH);
+
+			//
+			// Index the positions inside the match too, repeats in text
+			// are usually runs of the same phrase
+			//
+			for(ui32Max = ui32In + ui32Match, ui32In++;
+			    ui32In < ui32Max; ui32In++)
+			{
+				if((ui32In + XBEE_LZ_MIN_MATCH) <= ui32Len)
+				{
+					g_pui8LzHash[LZ_HASH(pui8Src + ui32In)] = (uint8_t)ui32In;
+				}
+			}
+		}
+		else
+		{
+			if(ui32Out >= ui32DstSize)
+			{
+				return 0;
+			}
+			pui8Dst[ui32Out++] = pui8Src[ui32In++];
+		}
+
+		ui8Mask <<= 1;
+	}
+
+	return ui32Out;
+}
+
+//*****************************************************************************
+//
+// Expand a compressed message. Returns the original length, or 0 if the
+// input is corrupt or does not fit in ui32DstSize.
+//
+//*****************************************************************************
+uint32_t
+XBeeLzDecompress(uint8_t *pui8Dst, uint32_t ui32DstSize,
+                 const uint8_t *pui8Src, uint32_t ui32Len)
+{
+	uint32_t ui32In;
+	uint32_t ui32Out;
+	uint32_t ui32Dist;
+	uint32_t ui32Match;
+	uint8_t ui8Ctrl;
+	uint8_t ui8Mask;
+
+	ui32In = 0;
+	ui32Out = 0;
+	ui8Ctrl = 0;
+	ui8Mask = 0;
+
+	while(ui32In < ui32Len)
+	{
+		if(ui8Mask == 0)
+		{
+			ui8Ctrl = pui8Src[ui32In++];
+			ui8Mask = 1;
+			continue;
+		}
+
+		if(ui8Ctrl & ui8Mask)
+		{
+			if((ui32In + 2) > ui32Len)
+			{
+				return 0;
+			}
+			ui32Dist = pui8Src[ui32In++] + 1;
+			ui32Match = pui8Src[ui32In++] + XBEE_LZ_MIN_MATCH;
+			if((ui32Dist > ui32Out) || ((ui32Out + ui32Match) > ui32DstSize))
+			{
+				return 0;
+			}
+
+			//
+			// Byte by byte, the copy may overlap itself (runs)
+			//
+			while(ui32Match--)
+			{
+				pui8Dst[ui32Out] = pui8Dst[ui32Out - ui32Dist];
+				ui32Out++;
+			}
+		}
+		else
+		{
+			if(ui32Out >= ui32DstSize)
+			{
+				return 0;
+			}
+			pui8Dst[ui32Out++] = pui8Src[ui32In++];
+		}
+
+		ui8Mask <<= 1;
+	}
+
+	return ui32Out;
+}
+
+//*****************************************************************************
+//
+// Benchmark payloads
+//
+//*****************************************************************************
+#define LZBENCH_LOOPS           100
+
+static const char g_pcLzBenchTelemetry[] =
+	"node=0013A200 t=23.5C h=41% v=3301mV rssi=-48 ok\r\n"
+	"node=0013A200 t=23.6C h=41% v=3300mV rssi=-47 ok\r\n"
+	"node=0013A200 t=23.6C h=40";
+
+static const char g_pcLzBenchLog[] =
+	"ATND: 12 nodes in table\nATID: 0x3332\nATMY: 0x0001\n"
+	"uart: rx 1024 tx 980 overrun 0\nATND: 12 nodes in tab";
+
+//*****************************************************************************
+//
+// Bench buffers, XBEE_MSG_MAX bytes each, borrowed from the pool while the
+// bench runs
+//
+//*****************************************************************************
+static uint8_t *g_pui8LzBenchSrc;
+static uint8_t *g_pui8LzBenchEnc;
+static uint8_t *g_pui8LzBenchDec;
+
+//*****************************************************************************
+//
+// Time compress and decompress of the bench buffer and work out what the
+// link would deliver with compression on. Returns non zero if the round trip
+// failed.
+//
+//*****************************************************************************
+static int
+XBeeLzBenchRun(const char *pcName, uint32_t ui32Len)
+{
+	uint32_t ui32Start;
+	uint32_t ui32Comp;
+	uint32_t ui32Decomp;
+	uint32_t ui32Enc;
+	uint32_t ui32Dec;
+	uint32_t ui32AirUs;
+	uint32_t ui32CpuUs;
+	uint32_t ui32Mhz;
+	int x;
+
+	ui32Start = XBeeCycleCountGet();
+	for(x = 0; x < LZBENCH_LOOPS; x++)
+	{
+		ui32Enc = XBeeLzCompress(g_pui8LzBenchEnc, XBEE_MSG_MAX,
+		                         g_pui8LzBenchSrc, ui32Len);
+	}
+	ui32Comp = (XBeeCycleCountGet() - ui32Start) / LZBENCH_LOOPS;
+
+	ui32Dec = ui32Len;
+	ui32Decomp = 0;
+	if(ui32Enc)
+	{
+		ui32Start = XBeeCycleCountGet();
+		for(x = 0; x < LZBENCH_LOOPS; x++)
+		{
+			ui32Dec = XBeeLzDecompress(g_pui8LzBenchDec, XBEE_MSG_MAX,
+			                           g_pui8LzBenchEnc, ui32Enc);
+		}
+		ui32Decomp = (XBeeCycleCountGet() - ui32Start) / LZBENCH_LOOPS;
+	}
+	else
+	{
+		//
+		// Not worth it, goes out raw
+		//
+		ui32Enc = ui32Len;
+		memcpy(g_pui8LzBenchDec, g_pui8LzBenchSrc, ui32Len);
+	}
+
+	//
+	// Effective rate: original bytes over air time of the compressed bytes
+	// plus the CPU time on both ends
+	//
+	ui32Mhz = ROM_SysCtlClockGet() / 1000000;
+	ui32AirUs = (ui32Enc * 1000000) / XBeeLinkRate();
+	ui32CpuUs = (ui32Comp + ui32Decomp) / ui32Mhz;
+
+	UARTprintf("%9s: %3d -> %3d bytes (%d%%), cycles/byte comp %d, "
+	           "decomp %d, %d bytes/s effective vs %d raw\n", pcName,
+	           ui32Len, ui32Enc, (ui32Enc * 100) / ui32Len,
+	           ui32Comp / ui32Len, ui32Decomp / ui32Len,
+	           (ui32Len * 1000000) / (ui32AirUs + ui32CpuUs),
+	           XBeeLinkRate());
+
+	if((ui32Dec != ui32Len) ||
+	   memcmp(g_pui8LzBenchDec, g_pui8LzBenchSrc, ui32Len))
+	{
+		UARTprintf("Error: round trip mismatch\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// LZ Benchmark Command
+// Input: n/a
+// Response: ratio, cycles per byte and effective link rate per payload
+// Use: to decide if 'link lz 1' pays off at the current UART1 baud rate
+//
+//*****************************************************************************
+int
+Cmd_lzbench(int argc, char *argv[])
+{
+	tXBeeBuf *psSrc;
+	tXBeeBuf *psEnc;
+	tXBeeBuf *psDec;
+	uint32_t ui32Len;
+	uint32_t ui32Seed;
+	int iErrors;
+	int x;
+
+	psSrc = XBeePoolAlloc(XBEE_MSG_MAX);
+	psEnc = XBeePoolAlloc(XBEE_MSG_MAX);
+	psDec = XBeePoolAlloc(XBEE_MSG_MAX);
+	if(!psSrc || !psEnc || !psDec)
+	{
+		XBeePoolFree(psSrc);
+		XBeePoolFree(psEnc);
+		XBeePoolFree(psDec);
+		UARTprintf("Error: no pool buffers free, try again\n");
+		return 1;
+	}
+	g_pui8LzBenchSrc = psSrc->pui8Data;
+	g_pui8LzBenchEnc = psEnc->pui8Data;
+	g_pui8LzBenchDec = psDec->pui8Data;
+
+	XBeeCycleCountEnable();
+
+	iErrors = 0;
+
+	ui32Len = sizeof(g_pcLzBenchTelemetry) - 1;
+	memcpy(g_pui8LzBenchSrc, g_pcLzBenchTelemetry, ui32Len);
+	iErrors += XBeeLzBenchRun("telemetry", ui32Len);
+
+	ui32Len = sizeof(g_pcLzBenchLog) - 1;
+	memcpy(g_pui8LzBenchSrc, g_pcLzBenchLog, ui32Len);
+	iErrors += XBeeLzBenchRun("log", ui32Len);
+
+	//
+	// Random bytes do not compress, this is the cost of trying
+	//
+	ui32Seed = 12345;
+	for(x = 0; x < XBEE_MSG_MAX; x++)
+	{
+		ui32Seed = (ui32Seed * 1103515245) + 12345;
+		g_pui8LzBenchSrc[x] = (uint8_t)(ui32Seed >> 16);
+	}
+	iErrors += XBeeLzBenchRun("random", XBEE_MSG_MAX);
+
+	XBeePoolFree(psSrc);
+	XBeePoolFree(psEnc);
+	XBeePoolFree(psDec);
+
+	return iErrors;
+}
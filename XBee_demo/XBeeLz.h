@@ -0,0 +1,49 @@
+//*****************************************************************************
+//
+// XBeeLz.h - Headers for use with XBeeLz.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEELZ_H__
+#define __XBEELZ_H__
+
+//*****************************************************************************
+//
+// The window is the message itself, so offsets and the match finder table
+// fit in a byte. The table is the only static RAM the codec uses.
+//
+//*****************************************************************************
+#define XBEE_LZ_WINDOW          256
+#define XBEE_LZ_HASH_SIZE       256
+#define XBEE_LZ_MIN_MATCH       3
+#define XBEE_LZ_MAX_MATCH       (XBEE_LZ_MIN_MATCH + 255)
+
+//*****************************************************************************
+//
+// Shorter payloads are never worth compressing.
+//
+//*****************************************************************************
+#define XBEE_LZ_MIN_SIZE        8
+
+//*****************************************************************************
+//
+// Compression functions
+//
+//*****************************************************************************
+extern uint32_t XBeeLzCompress(uint8_t *pui8Dst, uint32_t ui32DstSize,
+                               const uint8_t *pui8Src, uint32_t ui32Len);
+extern uint32_t XBeeLzDecompress(uint8_t *pui8Dst, uint32_t ui32DstSize,
+                                 const uint8_t *pui8Src, uint32_t ui32Len);
+extern int Cmd_lzbench(int argc, char *argv[]);
+
+#endif //__XBEELZ_H__
@@ -0,0 +1,419 @@
+//*****************************************************************************
+//
+// XBeeNode.c - Streaming ATND node discovery and neighbour table
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! ATND answers with one block of lines per node, each block ending in an
+//! empty line, and a final empty line once the discovery time is up. With
+//! hundreds of nodes that is several KB, so nothing is buffered: each line
+//! goes into a single scratch record as it arrives and the record is merged
+//! into the table when its block ends.
+//!
+//! Nodes are keyed by their concentrator node number (XBeeConc.c), which
+//! holds the 64-bit address. The table is kept sorted by it so lookups are
+//! a binary search and a repeated discovery updates existing entries in
+//! place.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeResp.h"
+#include "XBeeConc.h"
+#include "XBeeNode.h"
+
+//*****************************************************************************
+//
+// Record fields
+//
+//*****************************************************************************
+#define ND_FIELD_MY             0
+#define ND_FIELD_SH             1
+#define ND_FIELD_SL             2
+#define ND_FIELD_DB             3
+#define ND_FIELD_NI             4
+#define ND_FIELD_PARENT         5
+#define ND_FIELD_DEVTYPE        6
+#define ND_FIELD_IGNORE         7
+
+static const uint8_t g_pui8LayoutS1[] =
+{
+	ND_FIELD_MY, ND_FIELD_SH, ND_FIELD_SL, ND_FIELD_DB, ND_FIELD_NI
+};
+
+static const uint8_t g_pui8LayoutZB[] =
+{
+	ND_FIELD_MY, ND_FIELD_SH, ND_FIELD_SL, ND_FIELD_NI, ND_FIELD_PARENT,
+	ND_FIELD_DEVTYPE, ND_FIELD_IGNORE, ND_FIELD_IGNORE, ND_FIELD_IGNORE
+};
+
+//*****************************************************************************
+//
+// Table, record being parsed and parser state
+//
+//*****************************************************************************
+static tXBeeNode g_psNodes[XBEE_NODE_TABLE_SIZE];
+static uint32_t g_ui32NodeCount;
+static tXBeeNode g_sNodeScratch;
+static uint64_t g_ui64NodeScratchAddr;
+static uint32_t g_ui32NodeField;
+static const uint8_t *g_pui8Layout = g_pui8LayoutS1;
+static uint32_t g_ui32LayoutLen = sizeof(g_pui8LayoutS1);
+static tXBeeNodeStats g_sNodeStats;
+
+//*****************************************************************************
+//
+// Binary search. Returns the index of node ui32Node, or of where it would
+// go.
+//
+//*****************************************************************************
+static uint32_t
+XBeeNodeSearch(uint32_t ui32Node, bool *pbFound)
+{
+	uint32_t ui32Lo;
+	uint32_t ui32Hi;
+	uint32_t ui32Mid;
+
+	ui32Lo = 0;
+	ui32Hi = g_ui32NodeCount;
+	while(ui32Lo < ui32Hi)
+	{
+		ui32Mid = (ui32Lo + ui32Hi) / 2;
+		if(g_psNodes[ui32Mid].ui16Node < ui32Node)
+		{
+			ui32Lo = ui32Mid + 1;
+		}
+		else
+		{
+			ui32Hi = ui32Mid;
+		}
+	}
+
+	*pbFound = (ui32Lo < g_ui32NodeCount) &&
+	           (g_psNodes[ui32Lo].ui16Node == ui32Node);
+	return ui32Lo;
+}
+
+//*****************************************************************************
+//
+// Merge the scratch record into the table.
+//
+//*****************************************************************************
+static void
+XBeeNodeCommit(void)
+{
+	uint32_t ui32Index;
+	uint32_t ui32Node;
+	bool bFound;
+
+	g_sNodeStats.ui32Records++;
+	g_sNodeScratch.ui8Round = g_sNodeStats.ui8Round;
+
+	ui32Node = XBeeConcNode(g_ui64NodeScratchAddr, true);
+	if(ui32Node == XBEE_CONC_NONE)
+	{
+		g_sNodeStats.ui32Dropped++;
+		return;
+	}
+	g_sNodeScratch.ui16Node = (uint16_t)ui32Node;
+
+	ui32Index = XBeeNodeSearch(ui32Node, &bFound);
+	if(bFound)
+	{
+		g_sNodeStats.ui32Updated++;
+	}
+	else if(g_ui32NodeCount >= XBEE_NODE_TABLE_SIZE)
+	{
+		g_sNodeStats.ui32Dropped++;
+		return;
+	}
+	else
+	{
+		memmove(&g_psNodes[ui32Index + 1], &g_psNodes[ui32Index],
+		        (g_ui32NodeCount - ui32Index) * sizeof(tXBeeNode));
+		g_ui32NodeCount++;
+		g_sNodeStats.ui32Added++;
+	}
+
+	g_psNodes[ui32Index] = g_sNodeScratch;
+}
+
+//*****************************************************************************
+//
+// Start a new record in the scratch entry.
+//
+//*****************************************************************************
+static void
+XBeeNodeScratchReset(void)
+{
+	memset(&g_sNodeScratch, 0, sizeof(g_sNodeScratch));
+	g_ui64NodeScratchAddr = 0;
+	g_sNodeScratch.ui16Parent = 0xFFFE;
+	g_sNodeScratch.ui8DevType = XBEE_DEV_UNKNOWN;
+	g_ui32NodeField = 0;
+}
+
+//*****************************************************************************
+//
+// Call before sending ATND.
+//
+//*****************************************************************************
+void
+XBeeNodeDiscoverStart(void)
+{
+	XBeeNodeScratchReset();
+	g_sNodeStats.ui8Round++;
+	g_sNodeStats.bRunning = true;
+}
+
+//*****************************************************************************
+//
+// ATND response handler, one line at a time.
+//
+//*****************************************************************************
+bool
+XBeeRespNodeDiscover(void *pvArg, const tXBeeResp *psResp)
+{
+	uint32_t ui32Field;
+
+	if((psResp->ui32Type == XBEE_RESP_ERROR) ||
+	   (psResp->ui32Type == XBEE_RESP_TIMEOUT))
+	{
+		g_sNodeStats.bRunning = false;
+		return XBeeRespPrint("ATND", psResp);
+	}
+
+	ui32Field = (g_ui32NodeField < g_ui32LayoutLen) ?
+	            g_pui8Layout[g_ui32NodeField] : ND_FIELD_IGNORE;
+
+	//
+	// A blank line ends a record, or the whole discovery if no record was
+	// started. A blank NI is just an empty name.
+	//
+	if((psResp->ui32Type == XBEE_RESP_EMPTY) && (ui32Field != ND_FIELD_NI))
+	{
+		if(g_ui32NodeField == 0)
+		{
+			g_sNodeStats.bRunning = false;
+			UARTprintf("ATND: %d nodes in table\n", g_ui32NodeCount);
+			return true;
+		}
+
+		XBeeNodeCommit();
+		XBeeNodeScratchReset();
+		return false;
+	}
+
+	g_ui32NodeField++;
+
+	switch(ui32Field)
+	{
+		case ND_FIELD_MY:
+		{
+			g_sNodeScratch.ui16My = (uint16_t)psResp->ui64Value;
+			break;
+		}
+
+		case ND_FIELD_SH:
+		{
+			g_ui64NodeScratchAddr |= psResp->ui64Value << 32;
+			break;
+		}
+
+		case ND_FIELD_SL:
+		{
+			g_ui64NodeScratchAddr |= psResp->ui64Value & 0xFFFFFFFF;
+			break;
+		}
+
+		case ND_FIELD_DB:
+		{
+			g_sNodeScratch.ui8Rssi = (uint8_t)psResp->ui64Value;
+			break;
+		}
+
+		case ND_FIELD_NI:
+		{
+			strncpy(g_sNodeScratch.pcNI, psResp->pcText, XBEE_NODE_NI_SIZE);
+			break;
+		}
+
+		case ND_FIELD_PARENT:
+		{
+			g_sNodeScratch.ui16Parent = (uint16_t)psResp->ui64Value;
+			break;
+		}
+
+		case ND_FIELD_DEVTYPE:
+		{
+			g_sNodeScratch.ui8DevType = (uint8_t)psResp->ui64Value;
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+//
+// Select the record layout of the attached firmware.
+//
+//*****************************************************************************
+void
+XBeeNodeLayoutSet(uint32_t ui32Layout)
+{
+	if(ui32Layout == XBEE_ND_LAYOUT_ZB)
+	{
+		g_pui8Layout = g_pui8LayoutZB;
+		g_ui32LayoutLen = sizeof(g_pui8LayoutZB);
+	}
+	else
+	{
+		g_pui8Layout = g_pui8LayoutS1;
+		g_ui32LayoutLen = sizeof(g_pui8LayoutS1);
+	}
+}
+
+//*****************************************************************************
+//
+// Table access
+//
+//*****************************************************************************
+tXBeeNode *
+XBeeNodeFind(uint64_t ui64Addr)
+{
+	uint32_t ui32Index;
+	uint32_t ui32Node;
+	bool bFound;
+
+	ui32Node = XBeeConcNode(ui64Addr, false);
+	if(ui32Node == XBEE_CONC_NONE)
+	{
+		return 0;
+	}
+
+	ui32Index = XBeeNodeSearch(ui32Node, &bFound);
+	return bFound ? &g_psNodes[ui32Index] : 0;
+}
+
+uint32_t
+XBeeNodeCount(void)
+{
+	return g_ui32NodeCount;
+}
+
+tXBeeNode *
+XBeeNodeGet(uint32_t ui32Index)
+{
+	return (ui32Index < g_ui32NodeCount) ? &g_psNodes[ui32Index] : 0;
+}
+
+void
+XBeeNodeClear(void)
+{
+	g_ui32NodeCount = 0;
+}
+
+//*****************************************************************************
+//
+// Drop the record of node ui32Node, a number the concentrator gives to
+// another node.
+//
+//*****************************************************************************
+void
+XBeeNodeForget(uint32_t ui32Node)
+{
+	uint32_t ui32Index;
+	bool bFound;
+
+	ui32Index = XBeeNodeSearch(ui32Node, &bFound);
+	if(bFound)
+	{
+		g_ui32NodeCount--;
+		memmove(&g_psNodes[ui32Index], &g_psNodes[ui32Index + 1],
+		        (g_ui32NodeCount - ui32Index) * sizeof(tXBeeNode));
+	}
+}
+
+void
+XBeeNodeStatsGet(tXBeeNodeStats *psStats)
+{
+	*psStats = g_sNodeStats;
+}
+
+//*****************************************************************************
+//
+// Nodes Command
+// Input: none / 'clear' / 'layout <s1 | zb>'
+// Response: the neighbour table, in the order the concentrator first saw
+//		the nodes
+// Use: to list nodes found by ATND. '*' marks nodes that answered the most
+//		recent discovery.
+//
+//*****************************************************************************
+int
+Cmd_nodes(int argc, char *argv[])
+{
+	tXBeeNode *psNode;
+	uint64_t ui64Addr;
+	uint32_t ui32Index;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeNodeClear();
+		memset(&g_sNodeStats, 0, sizeof(g_sNodeStats));
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "layout")))
+	{
+		XBeeNodeLayoutSet((0 == strcmp(argv[2], "zb")) ?
+		                  XBEE_ND_LAYOUT_ZB : XBEE_ND_LAYOUT_S1);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("   Address           MY   Parent Type RSSI NI\n");
+	for(ui32Index = 0; ui32Index < g_ui32NodeCount; ui32Index++)
+	{
+		psNode = &g_psNodes[ui32Index];
+		ui64Addr = XBeeConcAddr(psNode->ui16Node);
+		UARTprintf("%c  %08x%08x  %04x %04x   %2x  -%2d  %s\n",
+		           (psNode->ui8Round == g_sNodeStats.ui8Round) ? '*' : ' ',
+		           (uint32_t)(ui64Addr >> 32), (uint32_t)ui64Addr,
+		           psNode->ui16My,
+		           psNode->ui16Parent, psNode->ui8DevType, psNode->ui8Rssi,
+		           psNode->pcNI);
+	}
+
+	UARTprintf("%d/%d nodes, %d records, %d added, %d updated, "
+	           "%d dropped%s\n", g_ui32NodeCount, XBEE_NODE_TABLE_SIZE,
+	           g_sNodeStats.ui32Records, g_sNodeStats.ui32Added,
+	           g_sNodeStats.ui32Updated, g_sNodeStats.ui32Dropped,
+	           g_sNodeStats.bRunning ? ", discovery running" : "");
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+//*****************************************************************************
+//
+// XBeeNode.h - Headers for use with XBeeNode.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEENODE_H__
+#define __XBEENODE_H__
+
+//*****************************************************************************
+//
+// Neighbour table size (nodes) and node identifier length (ATNI max is 20).
+// Each entry is 30 bytes; the address is the concentrator's (XBeeConc.c).
+//
+//*****************************************************************************
+#define XBEE_NODE_TABLE_SIZE    64
+#define XBEE_NODE_NI_SIZE       20
+
+//*****************************************************************************
+//
+// Discovery can take up to ATNT x 100ms (25.2s max) before the final CR.
+//
+//*****************************************************************************
+#define XBEE_ND_TIMEOUT_MS      30000
+
+//*****************************************************************************
+//
+// ND record layouts. Series 1 sends MY, SH, SL, DB, NI. ZB firmware sends
+// MY, SH, SL, NI, parent, device type, status, profile, manufacturer.
+//
+//*****************************************************************************
+#define XBEE_ND_LAYOUT_S1       0
+#define XBEE_ND_LAYOUT_ZB       1
+
+//*****************************************************************************
+//
+// Device types (ZB)
+//
+//*****************************************************************************
+#define XBEE_DEV_COORDINATOR    0
+#define XBEE_DEV_ROUTER         1
+#define XBEE_DEV_END_DEVICE     2
+#define XBEE_DEV_UNKNOWN        0xFF
+
+//*****************************************************************************
+//
+// One discovered node
+//
+//*****************************************************************************
+typedef struct
+{
+	uint16_t ui16Node;                  // concentrator node number of SH:SL
+	uint16_t ui16My;
+	uint16_t ui16Parent;                // 0xFFFE if none / unknown
+	uint8_t ui8DevType;
+	uint8_t ui8Rssi;                    // -dBm, 0 if unknown
+	uint8_t ui8Round;                   // discovery round last seen in
+	char pcNI[XBEE_NODE_NI_SIZE + 1];
+}
+tXBeeNode;
+
+//*****************************************************************************
+//
+// Discovery statistics
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Records;
+	uint32_t ui32Added;
+	uint32_t ui32Updated;
+	uint32_t ui32Dropped;               // table or concentrator full
+	uint8_t ui8Round;
+	bool bRunning;
+}
+tXBeeNodeStats;
+
+//*****************************************************************************
+//
+// Neighbour table functions
+//
+//*****************************************************************************
+extern bool XBeeRespNodeDiscover(void *pvArg, const tXBeeResp *psResp);
+extern void XBeeNodeLayoutSet(uint32_t ui32Layout);
+extern void XBeeNodeDiscoverStart(void);
+extern tXBeeNode *XBeeNodeFind(uint64_t ui64Addr);
+extern uint32_t XBeeNodeCount(void);
+extern tXBeeNode *XBeeNodeGet(uint32_t ui32Index);
+extern void XBeeNodeClear(void);
+extern void XBeeNodeForget(uint32_t ui32Node);
+extern void XBeeNodeStatsGet(tXBeeNodeStats *psStats);
+extern int Cmd_nodes(int argc, char *argv[]);
+
+#endif //__XBEENODE_H__
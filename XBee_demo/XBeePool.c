@@ -0,0 +1,307 @@
+//*****************************************************************************
+//
+// XBeePool.c - Fixed block buffer pool for the radio stack
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Three size classes of fixed blocks, each a singly linked free list, so
+//! allocate and free are a pop and a push. Both run with interrupts masked
+//! for those few instructions, which makes them safe from the UART1
+//! interrupt, where transmitted frames are given back.
+//!
+//! A request is served from the smallest class it fits, or the next larger
+//! one with a block free. When none has, XBeePoolAlloc() returns 0 and the
+//! caller decides; nothing is ever taken from a heap.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#ifndef __linux__
+#include "driverlib/rom.h"
+#include "driverlib/interrupt.h"
+#endif
+#include "utils/uartstdio.h"
+#include "XBeePool.h"
+
+//*****************************************************************************
+//
+// Block storage, word aligned
+//
+//*****************************************************************************
+static uint32_t g_pui32PoolSmall[(XBEE_POOL_SMALL_SIZE / 4) *
+                                 XBEE_POOL_SMALL_COUNT];
+static uint32_t g_pui32PoolMedium[(XBEE_POOL_MEDIUM_SIZE / 4) *
+                                  XBEE_POOL_MEDIUM_COUNT];
+static uint32_t g_pui32PoolLarge[(XBEE_POOL_LARGE_SIZE / 4) *
+                                 XBEE_POOL_LARGE_COUNT];
+static tXBeeBuf g_psPoolSmallBufs[XBEE_POOL_SMALL_COUNT];
+static tXBeeBuf g_psPoolMediumBufs[XBEE_POOL_MEDIUM_COUNT];
+static tXBeeBuf g_psPoolLargeBufs[XBEE_POOL_LARGE_COUNT];
+
+typedef struct
+{
+	tXBeeBuf *psBufs;
+	uint8_t *pui8Data;
+	uint32_t ui32Size;
+	uint32_t ui32Count;
+	tXBeeBuf *psFree;
+	tXBeePoolStats sStats;
+}
+tXBeePool;
+
+static tXBeePool g_psPools[XBEE_POOL_CLASSES] =
+{
+	{ g_psPoolSmallBufs, (uint8_t *)g_pui32PoolSmall, XBEE_POOL_SMALL_SIZE,
+	  XBEE_POOL_SMALL_COUNT },
+	{ g_psPoolMediumBufs, (uint8_t *)g_pui32PoolMedium, XBEE_POOL_MEDIUM_SIZE,
+	  XBEE_POOL_MEDIUM_COUNT },
+	{ g_psPoolLargeBufs, (uint8_t *)g_pui32PoolLarge, XBEE_POOL_LARGE_SIZE,
+	  XBEE_POOL_LARGE_COUNT }
+};
+
+//*****************************************************************************
+//
+// Mask interrupts, returning whether they were masked already.
+//
+//*****************************************************************************
+static bool
+XBeePoolLock(void)
+{
+#ifdef __linux__
+	return true;
+#else
+	return ROM_IntMasterDisable();
+#endif
+}
+
+static void
+XBeePoolUnlock(bool bMasked)
+{
+#ifndef __linux__
+	if(!bMasked)
+	{
+		ROM_IntMasterEnable();
+	}
+#endif
+}
+
+//*****************************************************************************
+//
+// Chain every block onto its free list. Call once before anything
+// allocates.
+//
+//*****************************************************************************
+void
+XBeePoolInit(void)
+{
+	tXBeePool *psPool;
+	uint32_t ui32Class;
+	uint32_t ui32Block;
+
+	for(ui32Class = 0; ui32Class < XBEE_POOL_CLASSES; ui32Class++)
+	{
+		psPool = &g_psPools[ui32Class];
+		psPool->psFree = 0;
+		for(ui32Block = psPool->ui32Count; ui32Block--; )
+		{
+			psPool->psBufs[ui32Block].pui8Data = psPool->pui8Data +
+			                                     (ui32Block * psPool->ui32Size);
+			psPool->psBufs[ui32Block].ui16Size = psPool->ui32Size;
+			psPool->psBufs[ui32Block].ui8Class = ui32Class;
+			psPool->psBufs[ui32Block].psNext = psPool->psFree;
+			psPool->psFree = &psPool->psBufs[ui32Block];
+		}
+		memset(&psPool->sStats, 0, sizeof(psPool->sStats));
+		psPool->sStats.ui32Free = psPool->ui32Count;
+	}
+}
+
+//*****************************************************************************
+//
+// Get a buffer of at least ui32Size bytes, with ui16Len 0 and psNext 0.
+// Returns 0 if none is free.
+//
+//*****************************************************************************
+tXBeeBuf *
+XBeePoolAlloc(uint32_t ui32Size)
+{
+	tXBeePool *psPool;
+	tXBeeBuf *psBuf;
+	uint32_t ui32First;
+	uint32_t ui32Class;
+	uint32_t ui32Used;
+	bool bMasked;
+
+	for(ui32First = 0; ui32First < XBEE_POOL_CLASSES; ui32First++)
+	{
+		if(ui32Size <= g_psPools[ui32First].ui32Size)
+		{
+			break;
+		}
+	}
+	if(ui32First == XBEE_POOL_CLASSES)
+	{
+		g_psPools[XBEE_POOL_LARGE].sStats.ui32Fails++;
+		return 0;
+	}
+
+	psBuf = 0;
+	bMasked = XBeePoolLock();
+
+	for(ui32Class = ui32First; ui32Class < XBEE_POOL_CLASSES; ui32Class++)
+	{
+		psPool = &g_psPools[ui32Class];
+		if(psPool->psFree)
+		{
+			psBuf = psPool->psFree;
+			psPool->psFree = psBuf->psNext;
+			psPool->sStats.ui32Free--;
+			ui32Used = psPool->ui32Count - psPool->sStats.ui32Free;
+			if(ui32Used > psPool->sStats.ui32PeakUsed)
+			{
+				psPool->sStats.ui32PeakUsed = ui32Used;
+			}
+			break;
+		}
+	}
+
+	if(psBuf == 0)
+	{
+		g_psPools[ui32First].sStats.ui32Fails++;
+	}
+	else
+	{
+		g_psPools[ui32First].sStats.ui32Allocs++;
+		if(ui32Class != ui32First)
+		{
+			g_psPools[ui32First].sStats.ui32Spills++;
+		}
+	}
+
+	XBeePoolUnlock(bMasked);
+
+	if(psBuf)
+	{
+		psBuf->psNext = 0;
+		psBuf->ui16Len = 0;
+		psBuf->ui16AirLen = 0;
+		psBuf->ui8FrameId = 0;
+	}
+
+	return psBuf;
+}
+
+//*****************************************************************************
+//
+// Give a buffer back. Freeing 0 does nothing.
+//
+//*****************************************************************************
+void
+XBeePoolFree(tXBeeBuf *psBuf)
+{
+	tXBeePool *psPool;
+	bool bMasked;
+
+	if(psBuf == 0)
+	{
+		return;
+	}
+
+	psPool = &g_psPools[psBuf->ui8Class];
+
+	bMasked = XBeePoolLock();
+	psBuf->psNext = psPool->psFree;
+	psPool->psFree = psBuf;
+	psPool->sStats.ui32Free++;
+	XBeePoolUnlock(bMasked);
+}
+
+//*****************************************************************************
+//
+// Free blocks that could hold ui32Size bytes.
+//
+//*****************************************************************************
+uint32_t
+XBeePoolAvail(uint32_t ui32Size)
+{
+	uint32_t ui32Class;
+	uint32_t ui32Avail;
+
+	ui32Avail = 0;
+	for(ui32Class = 0; ui32Class < XBEE_POOL_CLASSES; ui32Class++)
+	{
+		if(ui32Size <= g_psPools[ui32Class].ui32Size)
+		{
+			ui32Avail += g_psPools[ui32Class].sStats.ui32Free;
+		}
+	}
+
+	return ui32Avail;
+}
+
+void
+XBeePoolStatsGet(uint32_t ui32Class, tXBeePoolStats *psStats)
+{
+	*psStats = g_psPools[ui32Class].sStats;
+}
+
+//*****************************************************************************
+//
+// Pool Command
+// Input: none / 'clear'
+// Response: per size class, blocks free and the most ever in use, requests,
+//		spills to a larger class and failures
+// Use: to size the pools for the traffic the node really sees
+//
+//*****************************************************************************
+int
+Cmd_pool(int argc, char *argv[])
+{
+	tXBeePool *psPool;
+	uint32_t ui32Class;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		for(ui32Class = 0; ui32Class < XBEE_POOL_CLASSES; ui32Class++)
+		{
+			psPool = &g_psPools[ui32Class];
+			psPool->sStats.ui32PeakUsed = psPool->ui32Count -
+			                              psPool->sStats.ui32Free;
+			psPool->sStats.ui32Allocs = 0;
+			psPool->sStats.ui32Spills = 0;
+			psPool->sStats.ui32Fails = 0;
+		}
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("size  free blocks  peak    allocs  spills   fails\n");
+	for(ui32Class = 0; ui32Class < XBEE_POOL_CLASSES; ui32Class++)
+	{
+		psPool = &g_psPools[ui32Class];
+		UARTprintf("%4u %5u %6u %5u %9u %7u %7u\n", psPool->ui32Size,
+		           psPool->sStats.ui32Free, psPool->ui32Count,
+		           psPool->sStats.ui32PeakUsed, psPool->sStats.ui32Allocs,
+		           psPool->sStats.ui32Spills, psPool->sStats.ui32Fails);
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+//*****************************************************************************
+//
+// XBeePool.h - Headers for use with XBeePool.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEPOOL_H__
+#define __XBEEPOOL_H__
+
+//*****************************************************************************
+//
+// Size classes. SMALL takes AT text and short messages, MEDIUM an encoded
+// frame of typical size, LARGE the worst case encoded frame
+// (XBEE_FRAME_MAX_ENCODED(XBEE_FRAME_MAX_DATA), 263 bytes).
+//
+//*****************************************************************************
+#define XBEE_POOL_SMALL         0
+#define XBEE_POOL_MEDIUM        1
+#define XBEE_POOL_LARGE         2
+#define XBEE_POOL_CLASSES       3
+
+#define XBEE_POOL_SMALL_SIZE    32
+#define XBEE_POOL_SMALL_COUNT   16
+#define XBEE_POOL_MEDIUM_SIZE   128
+#define XBEE_POOL_MEDIUM_COUNT  16
+#define XBEE_POOL_LARGE_SIZE    264
+#define XBEE_POOL_LARGE_COUNT   4
+
+//*****************************************************************************
+//
+// A buffer from the pool. Whoever holds it may use psNext and ui32Stamp to
+// queue it; passing the pointer on passes ownership, and the last owner
+// gives it back with XBeePoolFree(). ui8FrameId is that of a transmit
+// request in the buffer, 0 for anything else.
+//
+//*****************************************************************************
+typedef struct tXBeeBuf
+{
+	struct tXBeeBuf *psNext;
+	uint32_t ui32Stamp;
+	uint16_t ui16Len;                   // bytes used
+	uint16_t ui16Size;                  // bytes in pui8Data
+	uint16_t ui16AirLen;                // RF payload, 0 if not sent on air
+	uint8_t ui8Class;
+	uint8_t ui8FrameId;
+	uint8_t *pui8Data;
+}
+tXBeeBuf;
+
+//*****************************************************************************
+//
+// Per size class statistics
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Free;
+	uint32_t ui32PeakUsed;
+	uint32_t ui32Allocs;
+	uint32_t ui32Spills;                // served from a larger class
+	uint32_t ui32Fails;                 // this and every larger class empty
+}
+tXBeePoolStats;
+
+//*****************************************************************************
+//
+// Pool functions. Allocate and free may be called from interrupt handlers.
+//
+//*****************************************************************************
+extern void XBeePoolInit(void);
+extern tXBeeBuf *XBeePoolAlloc(uint32_t ui32Size);
+extern void XBeePoolFree(tXBeeBuf *psBuf);
+extern uint32_t XBeePoolAvail(uint32_t ui32Size);
+extern void XBeePoolStatsGet(uint32_t ui32Class, tXBeePoolStats *psStats);
+extern int Cmd_pool(int argc, char *argv[]);
+
+#endif //__XBEEPOOL_H__
@@ -0,0 +1,302 @@
+//*****************************************************************************
+//
+// XBeeProf.c - Named cycle count profiling scopes
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Build with XBEE_PROFILE defined to compile the hooks in. Each scope keeps
+//! a call count and min / max / total time, read out with 'prof'.
+//!
+//! On the target the time is the DWT cycle counter, which keeps counting
+//! cycles whatever the clock governor does. Built on Linux for host tests
+//! it is CLOCK_MONOTONIC in ns, so the same hooks work there.
+//!
+//! The cost of an empty scope is measured by XBeeProfInit() and taken off
+//! every sample. Time spent in interrupts that preempt a scope is counted
+//! in that scope.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef __linux__
+#include <time.h>
+#else
+#include "driverlib/sysctl.h"
+#include "XBeeTick.h"
+#endif
+#include "utils/cmdline.h"
+#include "utils/uartstdio.h"
+#include "XBeeProf.h"
+
+//*****************************************************************************
+//
+// The scopes take about 1KB of RAM, so they exist only in XBEE_PROFILE
+// builds.
+//
+//*****************************************************************************
+#ifdef XBEE_PROFILE
+static tXBeeProfScope g_psProfScopes[XBEE_PROF_SCOPES] =
+{
+	{ "uart1 isr" },
+	{ "link route" },
+	{ "frame build" },
+	{ "lz compress" },
+	{ "sched poll" },
+	{ "cmdline" }
+};
+
+static uint32_t g_ui32ProfOverhead;
+#endif
+
+//*****************************************************************************
+//
+// Current time stamp.
+//
+//*****************************************************************************
+uint32_t
+XBeeProfNow(void)
+{
+#ifdef __linux__
+	struct timespec sTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &sTime);
+	return (uint32_t)((sTime.tv_sec * 1000000000ULL) + sTime.tv_nsec);
+#else
+	return XBeeCycleCountGet();
+#endif
+}
+
+#ifdef XBEE_PROFILE
+//*****************************************************************************
+//
+// Add one sample to a scope.
+//
+//*****************************************************************************
+static void
+XBeeProfRecord(tXBeeProfScope *psScope, uint32_t ui32Time)
+{
+	ui32Time = (ui32Time > g_ui32ProfOverhead) ?
+	           (ui32Time - g_ui32ProfOverhead) : 0;
+
+	if((psScope->ui32Count == 0) || (ui32Time < psScope->ui32Min))
+	{
+		psScope->ui32Min = ui32Time;
+	}
+	if(ui32Time > psScope->ui32Max)
+	{
+		psScope->ui32Max = ui32Time;
+	}
+	psScope->ui64Total += ui32Time;
+	psScope->ui32Count++;
+}
+
+void
+XBeeProfEnter(uint32_t ui32Scope)
+{
+	g_psProfScopes[ui32Scope].ui32Start = XBeeProfNow();
+}
+
+void
+XBeeProfExit(uint32_t ui32Scope)
+{
+	XBeeProfRecord(&g_psProfScopes[ui32Scope],
+	               XBeeProfNow() - g_psProfScopes[ui32Scope].ui32Start);
+}
+#endif
+
+//*****************************************************************************
+//
+// Start the cycle counter and measure what an empty scope costs.
+//
+//*****************************************************************************
+void
+XBeeProfInit(void)
+{
+#ifdef XBEE_PROFILE
+	uint32_t ui32Loop;
+
+#ifndef __linux__
+	XBeeCycleCountEnable();
+#endif
+
+	g_ui32ProfOverhead = 0;
+	for(ui32Loop = 0; ui32Loop < 8; ui32Loop++)
+	{
+		XBeeProfEnter(XBEE_PROF_CMDLINE);
+		XBeeProfExit(XBEE_PROF_CMDLINE);
+	}
+	g_ui32ProfOverhead = g_psProfScopes[XBEE_PROF_CMDLINE].ui32Min;
+
+	XBeeProfClear();
+#endif
+}
+
+#ifdef XBEE_PROFILE
+//*****************************************************************************
+//
+// Scope for the command whose name starts pcName, given one on first use.
+// Returns 0 if the name is not in the command table or the scopes have run
+// out.
+//
+//*****************************************************************************
+static tXBeeProfScope *
+XBeeProfCmdScope(const char *pcName)
+{
+	tCmdLineEntry *psEntry;
+	uint32_t ui32Len;
+	uint32_t ui32Scope;
+
+	ui32Len = 0;
+	while(pcName[ui32Len] && (pcName[ui32Len] != ' '))
+	{
+		ui32Len++;
+	}
+
+	for(psEntry = g_sCmdTable; psEntry->pcCmd; psEntry++)
+	{
+		if((strncmp(psEntry->pcCmd, pcName, ui32Len) == 0) &&
+		   (psEntry->pcCmd[ui32Len] == 0))
+		{
+			break;
+		}
+	}
+	if(psEntry->pcCmd == 0)
+	{
+		return 0;
+	}
+
+	for(ui32Scope = XBEE_PROF_FIXED; ui32Scope < XBEE_PROF_SCOPES; ui32Scope++)
+	{
+		if(g_psProfScopes[ui32Scope].pcName == 0)
+		{
+			g_psProfScopes[ui32Scope].pcName = psEntry->pcCmd;
+		}
+		if(g_psProfScopes[ui32Scope].pcName == psEntry->pcCmd)
+		{
+			return &g_psProfScopes[ui32Scope];
+		}
+	}
+
+	return 0;
+}
+#endif
+
+//*****************************************************************************
+//
+// CmdLineProcess() with the time taken charged to the command's own scope
+// as well as XBEE_PROF_CMDLINE.
+//
+//*****************************************************************************
+int
+XBeeProfCmdLine(char *pcLine)
+{
+#ifdef XBEE_PROFILE
+	tXBeeProfScope *psScope;
+	uint32_t ui32Start;
+	uint32_t ui32Time;
+	int i32Status;
+
+	while(*pcLine == ' ')
+	{
+		pcLine++;
+	}
+
+	ui32Start = XBeeProfNow();
+	i32Status = CmdLineProcess(pcLine);
+	ui32Time = XBeeProfNow() - ui32Start;
+
+	XBeeProfRecord(&g_psProfScopes[XBEE_PROF_CMDLINE], ui32Time);
+	psScope = XBeeProfCmdScope(pcLine);
+	if(psScope)
+	{
+		XBeeProfRecord(psScope, ui32Time);
+	}
+
+	return i32Status;
+#else
+	return CmdLineProcess(pcLine);
+#endif
+}
+
+void
+XBeeProfClear(void)
+{
+#ifdef XBEE_PROFILE
+	uint32_t ui32Scope;
+
+	for(ui32Scope = 0; ui32Scope < XBEE_PROF_SCOPES; ui32Scope++)
+	{
+		g_psProfScopes[ui32Scope].ui32Count = 0;
+		g_psProfScopes[ui32Scope].ui32Min = 0;
+		g_psProfScopes[ui32Scope].ui32Max = 0;
+		g_psProfScopes[ui32Scope].ui64Total = 0;
+	}
+#endif
+}
+
+//*****************************************************************************
+//
+// Prof Command
+// Input: none / 'clear'
+// Response: calls and min / mean / max time of every scope that has run
+// Use: to see what the interrupt handler, the encoders and each command
+//		really cost. Needs a build with XBEE_PROFILE defined.
+//
+//*****************************************************************************
+int
+Cmd_prof(int argc, char *argv[])
+{
+#ifdef XBEE_PROFILE
+	tXBeeProfScope *psScope;
+#endif
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeProfClear();
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+#ifndef XBEE_PROFILE
+	UARTprintf("profiling not built in, define XBEE_PROFILE\n");
+#else
+#ifdef __linux__
+	UARTprintf("ns, less %u for the hooks\n", g_ui32ProfOverhead);
+#else
+	UARTprintf("cycles (now %u MHz), less %u for the hooks\n",
+	           SysCtlClockGet() / 1000000, g_ui32ProfOverhead);
+#endif
+	UARTprintf("      scope     calls       min      mean       max\n");
+	for(psScope = g_psProfScopes; psScope < &g_psProfScopes[XBEE_PROF_SCOPES];
+	    psScope++)
+	{
+		if(psScope->pcName && psScope->ui32Count)
+		{
+			UARTprintf("%11s %9u %9u %9u %9u\n", psScope->pcName,
+			           psScope->ui32Count, psScope->ui32Min,
+			           (uint32_t)(psScope->ui64Total / psScope->ui32Count),
+			           psScope->ui32Max);
+		}
+	}
+#endif
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+//*****************************************************************************
+//
+// XBeeProf.h - Headers for use with XBeeProf.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEPROF_H__
+#define __XBEEPROF_H__
+
+//*****************************************************************************
+//
+// Fixed profiling scopes. Each console command gets a scope of its own
+// after these, the first time it runs.
+//
+//*****************************************************************************
+#define XBEE_PROF_UART1_ISR     0
+#define XBEE_PROF_LINK_ROUTE    1
+#define XBEE_PROF_FRAME_BUILD   2
+#define XBEE_PROF_LZ_COMPRESS   3
+#define XBEE_PROF_SCHED_POLL    4
+#define XBEE_PROF_CMDLINE       5
+#define XBEE_PROF_FIXED         6
+#define XBEE_PROF_SCOPES        (XBEE_PROF_FIXED + 24)
+
+//*****************************************************************************
+//
+// Wrap the code to be measured in XBEE_PROF_ENTER(scope) and
+// XBEE_PROF_EXIT(scope). Compiled in only when XBEE_PROFILE is defined, so
+// the hooks cost nothing otherwise. A scope must not be entered again
+// before it exits (an ISR can not nest with itself, so that is fine there).
+//
+//*****************************************************************************
+#ifdef XBEE_PROFILE
+#define XBEE_PROF_ENTER(s)      XBeeProfEnter(s)
+#define XBEE_PROF_EXIT(s)       XBeeProfExit(s)
+#else
+#define XBEE_PROF_ENTER(s)
+#define XBEE_PROF_EXIT(s)
+#endif
+
+//*****************************************************************************
+//
+// One scope. Times are DWT cycles on the target, ns on Linux (host tests).
+//
+//*****************************************************************************
+typedef struct
+{
+	const char *pcName;
+	uint32_t ui32Count;
+	uint32_t ui32Min;
+	uint32_t ui32Max;
+	uint64_t ui64Total;
+	uint32_t ui32Start;
+}
+tXBeeProfScope;
+
+//*****************************************************************************
+//
+// Profiling functions
+//
+//*****************************************************************************
+extern void XBeeProfInit(void);
+extern uint32_t XBeeProfNow(void);
+extern void XBeeProfEnter(uint32_t ui32Scope);
+extern void XBeeProfExit(uint32_t ui32Scope);
+extern int XBeeProfCmdLine(char *pcLine);
+extern void XBeeProfClear(void);
+extern int Cmd_prof(int argc, char *argv[]);
+
+#endif //__XBEEPROF_H__
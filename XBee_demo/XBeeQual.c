@@ -0,0 +1,651 @@
+//*****************************************************************************
+//
+// XBeeQual.c - Per destination link quality, fragment size and pacing
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! For every node we talk to this keeps the RSSI it is heard at (from API
+//! receive and I/O sample frames, or ATDB on request) and how many frames
+//! to it are delivered: transmit status in API mode, bulk ACKs against
+//! retransmits in transparent mode.
+//!
+//! From those it picks two parameters per destination:
+//!
+//!   fragment size  Frame loss is taken to grow with frame length (byte
+//!                  errors), so loss p measured at length Lm is about
+//!                  p * (L + H) / (Lm + H) at length L, H being the
+//!                  overhead per frame. The size used is the one giving
+//!                  the most payload per air time, L * (1 - p(L)) / T(L).
+//!                  T(L) counts the bytes and the fixed cost per frame,
+//!                  and for lost frames all the MAC tries.
+//!                  A clean link gets the largest fragments, a bad one
+//!                  smaller fragments that are more likely to get through.
+//!
+//!   pacing         A gap of p / (1 - p) frame air times between data
+//!                  frames, the air time the expected retries would take.
+//!                  On a lossy link this stops the window from filling the
+//!                  channel with retries.
+//!
+//! Bulk transfers take the fragment size when they start; XBeeLinkSendReady()
+//! holds data senders back for the gap.
+//!
+//! Destinations are keyed by their concentrator node number, so a node
+//! only sent to gets one too. The broadcast address, where messages also
+//! go in transparent mode, is not a node and has an entry of its own.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeBulk.h"
+#include "XBeeBoot.h"
+#include "XBeeSched.h"
+#include "XBeeTx.h"
+#include "XBeeIdle.h"
+#include "XBeeConc.h"
+#include "XBeeQual.h"
+
+//*****************************************************************************
+//
+// Moving averages take 1/16 of each new value
+//
+//*****************************************************************************
+#define QUAL_SHIFT              4
+#define QUAL_ONE                65536
+
+//*****************************************************************************
+//
+// Key of the broadcast address, past the concentrator's node numbers
+//
+//*****************************************************************************
+#define QUAL_BROADCAST          0xFFFF
+#define QUAL_NODE_BROADCAST     XBEE_CONC_NODES
+
+static tXBeeQualDest g_psQualDests[XBEE_QUAL_DESTS];
+
+//*****************************************************************************
+//
+// Air time of a frame carrying ui32Frag bytes of fragment, in us.
+//
+//*****************************************************************************
+#define QUAL_AIR_US(ui32Frag)                                                 \
+        ((((ui32Frag) + XBEE_QUAL_FRAME_OVERHEAD) *                           \
+          XBEE_QUAL_AIR_US_PER_BYTE) + XBEE_QUAL_AIR_US_FIXED)
+
+//*****************************************************************************
+//
+// True if psDest has delivery results, which only sending to it gives.
+//
+//*****************************************************************************
+#define QUAL_HAS_HISTORY(psDest)                                              \
+        (((psDest)->ui32Delivered + (psDest)->ui32Failed) != 0)
+
+//*****************************************************************************
+//
+// Key of ui64Addr, added to the concentrator with bAdd. XBEE_CONC_NONE if
+// it is not, or does not fit, there.
+//
+//*****************************************************************************
+static uint32_t
+XBeeQualNode(uint64_t ui64Addr, bool bAdd)
+{
+	if(ui64Addr == QUAL_BROADCAST)
+	{
+		return QUAL_NODE_BROADCAST;
+	}
+
+	return XBeeConcNode(ui64Addr, bAdd);
+}
+
+//*****************************************************************************
+//
+// Entry for ui64Addr, taking over the least recently used one if it is new.
+// Returns 0 if the concentrator has no room for the address.
+// With bHeardOnly (RSSI from a node that may only ever send to us) only a
+// free entry or one without delivery results is taken over, and 0 is
+// returned if there is none: on a coordinator with many sensors their
+// frames would otherwise keep wiping what was learnt about the nodes this
+// one sends to.
+//
+//*****************************************************************************
+static tXBeeQualDest *
+XBeeQualGet(uint64_t ui64Addr, bool bHeardOnly)
+{
+	tXBeeQualDest *psDest;
+	tXBeeQualDest *psOldest;
+	uint32_t ui32Node;
+	uint32_t ui32Now;
+
+	ui32Node = XBeeQualNode(ui64Addr, true);
+	if(ui32Node == XBEE_CONC_NONE)
+	{
+		return 0;
+	}
+
+	ui32Now = XBeeTickGet();
+	psOldest = 0;
+	for(psDest = g_psQualDests; psDest < &g_psQualDests[XBEE_QUAL_DESTS];
+	    psDest++)
+	{
+		if(psDest->bUsed && (psDest->ui16Node == ui32Node))
+		{
+			psDest->ui32LastTick = ui32Now;
+			return psDest;
+		}
+		if(bHeardOnly && psDest->bUsed && QUAL_HAS_HISTORY(psDest))
+		{
+			continue;
+		}
+		if(!psOldest || (psOldest->bUsed &&
+		                 (!psDest->bUsed ||
+		                  ((int32_t)(psDest->ui32LastTick -
+		                             psOldest->ui32LastTick) < 0))))
+		{
+			psOldest = psDest;
+		}
+	}
+	if(psOldest == 0)
+	{
+		return 0;
+	}
+
+	memset(psOldest, 0, sizeof(*psOldest));
+	psOldest->ui16Node = (uint16_t)ui32Node;
+	psOldest->bUsed = true;
+	psOldest->ui32LastTick = ui32Now;
+	psOldest->ui32AvgLen = XBEE_BULK_FRAG_DEFAULT;
+	psOldest->ui32FragSize = XBEE_BULK_FRAG_MAX;
+
+	return psOldest;
+}
+
+//*****************************************************************************
+//
+// Choose fragment size and gap from what is known now.
+//
+//*****************************************************************************
+static void
+XBeeQualAdapt(tXBeeQualDest *psDest)
+{
+	uint32_t ui32Loss;
+	uint32_t ui32Len;
+	uint32_t ui32Frag;
+	uint32_t ui32Lost;
+	uint32_t ui32Good;
+	uint32_t ui32Best;
+	uint32_t ui32Air;
+	int32_t i32Margin;
+
+	//
+	// Loss at length ui32Len, measured, or guessed from RSSI early on
+	//
+	if((psDest->ui32Delivered + psDest->ui32Failed) >= XBEE_QUAL_WARMUP)
+	{
+		ui32Loss = psDest->ui32Loss;
+		ui32Len = psDest->ui32AvgLen;
+	}
+	else
+	{
+		ui32Loss = 0;
+		ui32Len = XBEE_BULK_FRAG_DEFAULT;
+		if(psDest->ui32RssiCount)
+		{
+			i32Margin = (psDest->i32Rssi / 16) - XBEE_QUAL_SENSITIVITY;
+			if(i32Margin <= 0)
+			{
+				ui32Loss = QUAL_ONE / 2;
+			}
+			else if(i32Margin < XBEE_QUAL_MARGIN_DB)
+			{
+				ui32Loss = ((QUAL_ONE / 2) *
+				            (XBEE_QUAL_MARGIN_DB - i32Margin)) /
+				           XBEE_QUAL_MARGIN_DB;
+			}
+		}
+	}
+
+	//
+	// Payload through per air time for each size, steps of 8 and the
+	// maximum
+	//
+	ui32Best = 0;
+	psDest->ui32FragSize = XBEE_BULK_FRAG_MIN;
+	for(ui32Frag = XBEE_BULK_FRAG_MIN; ui32Frag <= XBEE_BULK_FRAG_MAX;
+	    ui32Frag = ((ui32Frag + 8) > XBEE_BULK_FRAG_MAX) &&
+	               (ui32Frag != XBEE_BULK_FRAG_MAX) ?
+	               XBEE_BULK_FRAG_MAX : (ui32Frag + 8))
+	{
+		ui32Lost = (uint32_t)(((uint64_t)ui32Loss *
+		                       (ui32Frag + XBEE_QUAL_FRAME_OVERHEAD)) /
+		                      (ui32Len + XBEE_QUAL_FRAME_OVERHEAD));
+		if(ui32Lost >= QUAL_ONE)
+		{
+			break;
+		}
+		ui32Good = (uint32_t)(((uint64_t)ui32Frag * (QUAL_ONE - ui32Lost) *
+		                       QUAL_ONE) /
+		                      (((uint64_t)QUAL_AIR_US(ui32Frag) *
+		                        (QUAL_ONE + ((XBEE_QUAL_MAC_TRIES - 1) *
+		                                     ui32Lost))) / 1000));
+		if(ui32Good > ui32Best)
+		{
+			ui32Best = ui32Good;
+			psDest->ui32FragSize = ui32Frag;
+		}
+	}
+
+	//
+	// Gap of p / (1 - p) air times at the chosen size
+	//
+	ui32Lost = (uint32_t)(((uint64_t)ui32Loss *
+	                       (psDest->ui32FragSize +
+	                        XBEE_QUAL_FRAME_OVERHEAD)) /
+	                      (ui32Len + XBEE_QUAL_FRAME_OVERHEAD));
+	ui32Air = QUAL_AIR_US(psDest->ui32FragSize);
+	if(ui32Lost >= (QUAL_ONE / 2))
+	{
+		psDest->ui32GapUs = XBEE_QUAL_GAP_MAX_US;
+	}
+	else
+	{
+		psDest->ui32GapUs = (ui32Air * ui32Lost) / (QUAL_ONE - ui32Lost);
+		if(psDest->ui32GapUs > XBEE_QUAL_GAP_MAX_US)
+		{
+			psDest->ui32GapUs = XBEE_QUAL_GAP_MAX_US;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// A frame from ui64Addr was heard at -ui8Rssi dBm (the RSSI byte of API
+// receive frames, or ATDB).
+//
+//*****************************************************************************
+void
+XBeeQualRssi(uint64_t ui64Addr, uint8_t ui8Rssi)
+{
+	tXBeeQualDest *psDest;
+	int32_t i32Rssi;
+
+	psDest = XBeeQualGet(ui64Addr, true);
+	if(psDest == 0)
+	{
+		return;
+	}
+	i32Rssi = -16 * (int32_t)ui8Rssi;
+
+	if(psDest->ui32RssiCount == 0)
+	{
+		psDest->i32Rssi = i32Rssi;
+	}
+	else
+	{
+		psDest->i32Rssi += (i32Rssi - psDest->i32Rssi) / (1 << QUAL_SHIFT);
+	}
+	psDest->ui32RssiCount++;
+
+	XBeeQualAdapt(psDest);
+}
+
+//*****************************************************************************
+//
+// A frame of ui32Len bytes to ui64Addr was, or was not, delivered.
+//
+//*****************************************************************************
+void
+XBeeQualResult(uint64_t ui64Addr, bool bDelivered, uint32_t ui32Len)
+{
+	tXBeeQualDest *psDest;
+
+	psDest = XBeeQualGet(ui64Addr, false);
+	if(psDest == 0)
+	{
+		return;
+	}
+
+	if(bDelivered)
+	{
+		psDest->ui32Delivered++;
+		psDest->ui32Loss -= psDest->ui32Loss >> QUAL_SHIFT;
+	}
+	else
+	{
+		psDest->ui32Failed++;
+		psDest->ui32Loss += (QUAL_ONE - psDest->ui32Loss) >> QUAL_SHIFT;
+	}
+	psDest->ui32AvgLen = ((psDest->ui32AvgLen * ((1 << QUAL_SHIFT) - 1)) +
+	                      ui32Len) >> QUAL_SHIFT;
+
+	XBeeQualAdapt(psDest);
+}
+
+//*****************************************************************************
+//
+// Fragment size to use towards ui64Addr.
+//
+//*****************************************************************************
+uint32_t
+XBeeQualFragSize(uint64_t ui64Addr)
+{
+	tXBeeQualDest *psDest;
+
+	psDest = XBeeQualGet(ui64Addr, false);
+	return psDest ? psDest->ui32FragSize : XBEE_BULK_FRAG_MAX;
+}
+
+//*****************************************************************************
+//
+// True once the pacing gap since the last frame to ui64Addr has passed.
+// If not, the idle loop is told when it will have.
+//
+//*****************************************************************************
+bool
+XBeeQualReady(uint64_t ui64Addr)
+{
+	tXBeeQualDest *psDest;
+	uint32_t ui32Node;
+	int32_t i32Left;
+
+	ui32Node = XBeeQualNode(ui64Addr, false);
+	for(psDest = g_psQualDests; psDest < &g_psQualDests[XBEE_QUAL_DESTS];
+	    psDest++)
+	{
+		if(psDest->bUsed && (psDest->ui16Node == ui32Node))
+		{
+			if(psDest->ui32GapUs == 0)
+			{
+				return true;
+			}
+			i32Left = (int32_t)(psDest->ui32NextUs - XBeeTickMicros());
+			if(i32Left <= 0)
+			{
+				return true;
+			}
+			XBeeIdleDeadline(XBeeTickGet() + ((i32Left + 999) / 1000));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// A frame went out to ui64Addr, start its pacing gap.
+//
+//*****************************************************************************
+void
+XBeeQualSent(uint64_t ui64Addr)
+{
+	tXBeeQualDest *psDest;
+	uint32_t ui32Node;
+
+	ui32Node = XBeeQualNode(ui64Addr, false);
+	for(psDest = g_psQualDests; psDest < &g_psQualDests[XBEE_QUAL_DESTS];
+	    psDest++)
+	{
+		if(psDest->bUsed && (psDest->ui16Node == ui32Node))
+		{
+			psDest->ui32NextUs = XBeeTickMicros() + psDest->ui32GapUs;
+			return;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Forget what is known about ui64Addr.
+//
+//*****************************************************************************
+void
+XBeeQualReset(uint64_t ui64Addr)
+{
+	tXBeeQualDest *psDest;
+
+	psDest = XBeeQualGet(ui64Addr, false);
+	if(psDest)
+	{
+		psDest->bUsed = false;
+		XBeeQualGet(ui64Addr, false);
+	}
+}
+
+//*****************************************************************************
+//
+// Forget all destinations.
+//
+//*****************************************************************************
+void
+XBeeQualClear(void)
+{
+	memset(g_psQualDests, 0, sizeof(g_psQualDests));
+}
+
+//*****************************************************************************
+//
+// Free the entry of node ui32Node, a number the concentrator gives to
+// another node.
+//
+//*****************************************************************************
+void
+XBeeQualForget(uint32_t ui32Node)
+{
+	tXBeeQualDest *psDest;
+
+	for(psDest = g_psQualDests; psDest < &g_psQualDests[XBEE_QUAL_DESTS];
+	    psDest++)
+	{
+		if(psDest->bUsed && (psDest->ui16Node == ui32Node))
+		{
+			psDest->bUsed = false;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Bench: move ui32Bytes to the link destination through the simulated
+// radio in fragments of ui32Frag bytes, or of the adapted size if
+// ui32Frag is 0, resending what is not delivered. Each frame's callback
+// argument is the fragment length it carries.
+//
+//*****************************************************************************
+static uint32_t g_ui32QualBenchDone;
+static uint32_t g_ui32QualBenchOwed;
+
+static void
+XBeeQualBenchDone(void *pvArg, uint8_t ui8FrameId, uint32_t ui32Result,
+                  uint32_t ui32Retries)
+{
+	if(ui32Result == XBEE_TX_SUCCESS)
+	{
+		g_ui32QualBenchDone += (uint32_t)(uintptr_t)pvArg;
+	}
+	else
+	{
+		g_ui32QualBenchOwed += (uint32_t)(uintptr_t)pvArg;
+	}
+}
+
+static uint32_t
+XBeeQualBenchRun(uint32_t ui32Bytes, uint32_t ui32Frag, bool bPace)
+{
+	uint8_t pui8Msg[XBEE_MSG_HDR_SIZE + XBEE_BULK_FRAG_MAX];
+	uint64_t ui64Dest;
+	uint32_t ui32Start;
+	uint32_t ui32Len;
+	uint8_t ui8FrameId;
+
+	ui64Dest = XBeeLinkDestGet();
+	XBeeQualReset(ui64Dest);
+
+	memset(pui8Msg, 0x55, sizeof(pui8Msg));
+	pui8Msg[0] = XBEE_MSG_TX_BENCH;
+	pui8Msg[1] = 0;
+
+	g_ui32QualBenchDone = 0;
+	g_ui32QualBenchOwed = ui32Bytes;
+	ui32Start = XBeeTickGet();
+
+	while(g_ui32QualBenchDone < ui32Bytes)
+	{
+		if(g_ui32QualBenchOwed && XBeeTxReady(ui64Dest) &&
+		   (!bPace || XBeeQualReady(ui64Dest)))
+		{
+			ui32Len = ui32Frag ? ui32Frag : XBeeQualFragSize(ui64Dest);
+			if(ui32Len > g_ui32QualBenchOwed)
+			{
+				ui32Len = g_ui32QualBenchOwed;
+			}
+			ui8FrameId = XBeeTxSend(ui64Dest, XBEE_SCHED_DATA, pui8Msg,
+			                        XBEE_MSG_HDR_SIZE + ui32Len,
+			                        XBeeQualBenchDone,
+			                        (void *)(uintptr_t)ui32Len);
+			if(ui8FrameId)
+			{
+				g_ui32QualBenchOwed -= ui32Len;
+				XBeeQualSent(ui64Dest);
+			}
+		}
+		XBeeLinkPoll();
+	}
+
+	return XBeeTickGet() - ui32Start;
+}
+
+//*****************************************************************************
+//
+// Print one bench result.
+//
+//*****************************************************************************
+static void
+XBeeQualBenchReport(const char *pcName, uint32_t ui32Bytes, uint32_t ui32Ms)
+{
+	UARTprintf("%9s: %u bytes in %u ms, %u bytes/s\n", pcName, ui32Bytes,
+	           ui32Ms, ui32Ms ? ((ui32Bytes * 1000) / ui32Ms) : 0);
+}
+
+//*****************************************************************************
+//
+// Qual Command
+// Input: none / 'clear' / 'db' / 'bench <bytes> <byte errors per million>'
+// Response: per destination RSSI, delivery rate and the fragment size and
+//		pacing gap chosen
+// Use: to see how each link is doing and what the stack does about it.
+//		'db' reads ATDB for the link destination (command mode first in
+//		transparent mode). 'bench' compares fixed and adapted fragment sizes,
+//		and the adapted size with pacing, on the simulated radio with byte
+//		errors. The radio there has the channel to itself, so pacing can
+//		only cost throughput; it is there for the other nodes.
+//
+//*****************************************************************************
+int
+Cmd_qual(int argc, char *argv[])
+{
+	tXBeeQualDest *psDest;
+	uint64_t ui64Value;
+	uint64_t ui64Addr;
+	uint32_t ui32Bytes;
+	uint32_t ui32Ppm;
+	uint32_t ui32Results;
+	uint32_t ui32Loss;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeQualClear();
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "db")))
+	{
+		if(XBeeBootGet("DB", &ui64Value))
+		{
+			UARTprintf("Error: no answer to ATDB\n");
+			return 1;
+		}
+		XBeeQualRssi(XBeeLinkDestGet(), (uint8_t)ui64Value);
+		return 0;
+	}
+	else if((4 == argc) && (0 == strcmp(argv[1], "bench")))
+	{
+		ui32Bytes = strtoul(argv[2], 0, 10);
+		ui32Ppm = strtoul(argv[3], 0, 10);
+		if((ui32Bytes == 0) || (ui32Ppm >= 100000))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+
+		XBeeTxSimSet(true, ui32Ppm);
+		XBeeQualBenchReport("fixed 95", ui32Bytes,
+		                    XBeeQualBenchRun(ui32Bytes, XBEE_BULK_FRAG_MAX,
+		                                     false));
+		XBeeQualBenchReport("fixed 64", ui32Bytes,
+		                    XBeeQualBenchRun(ui32Bytes,
+		                                     XBEE_BULK_FRAG_DEFAULT, false));
+		XBeeQualBenchReport("fixed 16", ui32Bytes,
+		                    XBeeQualBenchRun(ui32Bytes, XBEE_BULK_FRAG_MIN,
+		                                     false));
+		XBeeQualBenchReport("adapted", ui32Bytes,
+		                    XBeeQualBenchRun(ui32Bytes, 0, false));
+		XBeeQualBenchReport("+ paced", ui32Bytes,
+		                    XBeeQualBenchRun(ui32Bytes, 0, true));
+		XBeeTxSimSet(false, 0);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("     destination rssi  loss   delivered/failed  frag "
+	           "  gap us\n");
+	for(psDest = g_psQualDests; psDest < &g_psQualDests[XBEE_QUAL_DESTS];
+	    psDest++)
+	{
+		if(!psDest->bUsed)
+		{
+			continue;
+		}
+
+		ui32Results = psDest->ui32Delivered + psDest->ui32Failed;
+		ui32Loss = (psDest->ui32Loss * 1000) / QUAL_ONE;
+		ui64Addr = (psDest->ui16Node == QUAL_NODE_BROADCAST) ?
+		           QUAL_BROADCAST : XBeeConcAddr(psDest->ui16Node);
+		UARTprintf("%08x%08x", (uint32_t)(ui64Addr >> 32),
+		           (uint32_t)ui64Addr);
+		if(psDest->ui32RssiCount)
+		{
+			UARTprintf(" %4d", psDest->i32Rssi / 16);
+		}
+		else
+		{
+			UARTprintf("    -");
+		}
+		UARTprintf(" %3u.%u%% %10u/%u %5u %8u%s\n", ui32Loss / 10,
+		           ui32Loss % 10, psDest->ui32Delivered, psDest->ui32Failed,
+		           psDest->ui32FragSize, psDest->ui32GapUs,
+		           (ui32Results < XBEE_QUAL_WARMUP) ? " (from rssi)" : "");
+	}
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+//*****************************************************************************
+//
+// XBeeQual.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEQUAL_H__
+#define __XBEEQUAL_H__
+
+//*****************************************************************************
+//
+// Destinations tracked. The one used longest ago makes room for a new one.
+//
+//*****************************************************************************
+#define XBEE_QUAL_DESTS         8
+
+//*****************************************************************************
+//
+// Until a destination has XBEE_QUAL_WARMUP delivery results its loss rate
+// is guessed from RSSI: none with XBEE_QUAL_MARGIN_DB or more above the
+// receiver sensitivity, rising to 50% at the sensitivity.
+//
+//*****************************************************************************
+#define XBEE_QUAL_WARMUP        8
+#define XBEE_QUAL_SENSITIVITY   (-92)
+#define XBEE_QUAL_MARGIN_DB     20
+
+//*****************************************************************************
+//
+// Bytes on air per frame besides the fragment (message and API headers,
+// MAC header and FCS), the air time per byte at 250kbit/s plus the fixed
+// cost of CCA and ACK per frame, the tries the MAC makes before a frame
+// counts as lost, and the longest gap pacing will insert.
+//
+//*****************************************************************************
+#define XBEE_QUAL_FRAME_OVERHEAD 20
+#define XBEE_QUAL_AIR_US_PER_BYTE 32
+#define XBEE_QUAL_AIR_US_FIXED  1500
+#define XBEE_QUAL_MAC_TRIES     4
+#define XBEE_QUAL_GAP_MAX_US    50000
+
+//*****************************************************************************
+//
+// What is known about one destination, under its concentrator node number
+// (XBeeConc.c). Loss is a moving average of failed deliveries in
+// 1/65536ths, for frames of about ui32AvgLen bytes.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint16_t ui16Node;
+	bool bUsed;
+	uint32_t ui32LastTick;
+	int32_t i32Rssi;                    // dBm x 16, moving average
+	uint32_t ui32RssiCount;
+	uint32_t ui32Loss;
+	uint32_t ui32AvgLen;
+	uint32_t ui32Delivered;
+	uint32_t ui32Failed;
+	uint32_t ui32FragSize;              // chosen parameters
+	uint32_t ui32GapUs;
+	uint32_t ui32NextUs;                // pacing, earliest next send
+}
+tXBeeQualDest;
+
+//*****************************************************************************
+//
+// Link quality functions
+//
+//*****************************************************************************
+extern void XBeeQualRssi(uint64_t ui64Addr, uint8_t ui8Rssi);
+extern void XBeeQualResult(uint64_t ui64Addr, bool bDelivered,
+                           uint32_t ui32Len);
+extern uint32_t XBeeQualFragSize(uint64_t ui64Addr);
+extern bool XBeeQualReady(uint64_t ui64Addr);
+extern void XBeeQualSent(uint64_t ui64Addr);
+extern void XBeeQualReset(uint64_t ui64Addr);
+extern void XBeeQualClear(void);
+extern void XBeeQualForget(uint32_t ui32Node);
+extern int Cmd_qual(int argc, char *argv[]);
+
+#endif //__XBEEQUAL_H__
@@ -0,0 +1,694 @@
+//*****************************************************************************
+//
+// XBeeResp.c - Streaming AT command response tokenizer
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! In command mode the XBee answers each command, in order, with one or more
+//! lines ending in CR. Every Cmd_* queues a handler with XBeeRespExpect()
+//! before it sends its CR, and each response line is classified (OK, ERROR,
+//! hex number, text, empty) and handed to the handler at the head of the
+//! queue. A handler that never gets its line is called with
+//! XBEE_RESP_TIMEOUT so the queue cannot get stuck.
+//!
+//! With nothing queued, received bytes are echoed to the console raw, as
+//! they always were, since they are data from another radio.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/sysctl.h"
+#include "utils/uartstdio.h"
+#include "XBeeSched.h"
+#include "XBeeTick.h"
+#include "XBeeResp.h"
+#include "XBeeLink.h"
+#include "XBeeIdle.h"
+
+//*****************************************************************************
+//
+// Hex digit lookup, 0xFF for anything that is not a hex digit.
+//
+//*****************************************************************************
+static const uint8_t g_pui8HexLut[256] =
+{
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,     // '0' - '7'
+	0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,     // '8' - '9'
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,     // 'A' - 'F'
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,     // 'a' - 'f'
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+//*****************************************************************************
+//
+// Queue of commands waiting for a response, oldest at the tail.
+//
+//*****************************************************************************
+typedef struct
+{
+	tXBeeRespHandler pfnHandler;
+	void *pvArg;
+	uint32_t ui32Deadline;
+}
+tXBeeRespEntry;
+
+static tXBeeRespEntry g_psRespQueue[XBEE_RESP_QUEUE_SIZE];
+static uint32_t g_ui32RespHead;
+static uint32_t g_ui32RespTail;
+static uint32_t g_ui32RespLastTick;
+
+//*****************************************************************************
+//
+// Line being assembled, one spare byte for the terminator.
+//
+//*****************************************************************************
+static char g_pcRespLine[XBEE_RESP_LINE_SIZE + 1];
+static uint32_t g_ui32RespLineLen;
+
+//*****************************************************************************
+//
+// Decoded values
+//
+//*****************************************************************************
+tXBeeParams g_sXBeeParams;
+
+//*****************************************************************************
+//
+// Decode up to 16 hex digits. Returns false if the text is empty, too long
+// or holds anything but hex digits.
+//
+//*****************************************************************************
+bool
+XBeeHexDecode(const char *pcText, uint32_t ui32Len, uint64_t *pui64Value)
+{
+	uint64_t ui64Value;
+	uint8_t ui8Nibble;
+
+	if((ui32Len == 0) || (ui32Len > 16))
+	{
+		return false;
+	}
+
+	for(ui64Value = 0; ui32Len; ui32Len--)
+	{
+		ui8Nibble = g_pui8HexLut[(uint8_t)*pcText++];
+		if(ui8Nibble == 0xFF)
+		{
+			return false;
+		}
+		ui64Value = (ui64Value << 4) | ui8Nibble;
+	}
+
+	*pui64Value = ui64Value;
+	return true;
+}
+
+//*****************************************************************************
+//
+// Queue a handler for the response to the command about to be sent. Call
+// before sending the command's CR. Returns false if the queue is full, in
+// which case the command must not be sent: its response would go to the
+// wrong handler. Callers report that as busy.
+//
+//*****************************************************************************
+bool
+XBeeRespExpect(tXBeeRespHandler pfnHandler, void *pvArg,
+               uint32_t ui32TimeoutMs)
+{
+	tXBeeRespEntry *psEntry;
+
+	if((g_ui32RespHead - g_ui32RespTail) >= XBEE_RESP_QUEUE_SIZE)
+	{
+		return false;
+	}
+
+	psEntry = &g_psRespQueue[g_ui32RespHead % XBEE_RESP_QUEUE_SIZE];
+	psEntry->pfnHandler = pfnHandler;
+	psEntry->pvArg = pvArg;
+	psEntry->ui32Deadline = XBeeTickGet() + ui32TimeoutMs;
+	g_ui32RespHead++;
+
+	return true;
+}
+
+bool
+XBeeRespPending(void)
+{
+	return g_ui32RespHead != g_ui32RespTail;
+}
+
+//*****************************************************************************
+//
+// Hand a response to the oldest waiting command, dropping it from the queue
+// once its handler says the response is complete.
+//
+//*****************************************************************************
+static void
+XBeeRespDispatch(const tXBeeResp *psResp)
+{
+	tXBeeRespEntry *psEntry;
+
+	psEntry = &g_psRespQueue[g_ui32RespTail % XBEE_RESP_QUEUE_SIZE];
+	if(psResp->ui32Type != XBEE_RESP_TIMEOUT)
+	{
+		g_ui32RespLastTick = XBeeTickGet();
+	}
+	if(psEntry->pfnHandler(psEntry->pvArg, psResp) ||
+	   (psResp->ui32Type == XBEE_RESP_TIMEOUT))
+	{
+		g_ui32RespTail++;
+	}
+}
+
+//*****************************************************************************
+//
+// Tick at which the radio last answered a command.
+//
+//*****************************************************************************
+uint32_t
+XBeeRespLastTick(void)
+{
+	return g_ui32RespLastTick;
+}
+
+//*****************************************************************************
+//
+// Classify the completed line and pass it on.
+//
+//*****************************************************************************
+static void
+XBeeRespLine(void)
+{
+	tXBeeResp sResp;
+	uint32_t ui32Len;
+
+	ui32Len = g_ui32RespLineLen;
+	g_pcRespLine[ui32Len] = 0;
+	g_ui32RespLineLen = 0;
+
+	sResp.pcText = g_pcRespLine;
+	sResp.ui32Len = ui32Len;
+	sResp.ui64Value = 0;
+
+	if(ui32Len == 0)
+	{
+		sResp.ui32Type = XBEE_RESP_EMPTY;
+	}
+	else if((ui32Len == 2) && (0 == memcmp(g_pcRespLine, "OK", 2)))
+	{
+		sResp.ui32Type = XBEE_RESP_OK;
+	}
+	else if((ui32Len == 5) && (0 == memcmp(g_pcRespLine, "ERROR", 5)))
+	{
+		sResp.ui32Type = XBEE_RESP_ERROR;
+	}
+	else if(XBeeHexDecode(g_pcRespLine, ui32Len, &sResp.ui64Value))
+	{
+		sResp.ui32Type = XBEE_RESP_HEX;
+	}
+	else
+	{
+		sResp.ui32Type = XBEE_RESP_TEXT;
+	}
+
+	if(XBeeRespPending())
+	{
+		XBeeRespDispatch(&sResp);
+	}
+	else if(ui32Len)
+	{
+		UARTprintf("Response:'%s'\n", g_pcRespLine);
+	}
+}
+
+//*****************************************************************************
+//
+// Raw echo of data nobody asked for, special characters printed as their
+// integer value.
+//
+//*****************************************************************************
+static void
+XBeeRespUnsolicited(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	unsigned char x;
+
+	UARTprintf("Response:'");
+	while(ui32Len--)
+	{
+		x = *pui8Data++;
+		if(x<' ' | x>'~')
+		{
+			UARTprintf("/%d",(int)x);
+		}
+		else
+		{
+			UARTprintf("%c",x);
+		}
+	}
+	UARTprintf("'\n");
+}
+
+//*****************************************************************************
+//
+// Feed bytes received from the XBee to the tokenizer. Lines are split on CR,
+// plain runs between CRs are copied in one go.
+//
+//*****************************************************************************
+void
+XBeeRespFeed(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	const uint8_t *pui8CR;
+	uint32_t ui32Run;
+	uint32_t ui32Copy;
+
+	while(ui32Len)
+	{
+		if(!XBeeRespPending() && (g_ui32RespLineLen == 0))
+		{
+			XBeeRespUnsolicited(pui8Data, ui32Len);
+			return;
+		}
+
+		pui8CR = memchr(pui8Data, '\r', ui32Len);
+		ui32Run = pui8CR ? (uint32_t)(pui8CR - pui8Data) : ui32Len;
+
+		//
+		// Keep what fits, overlong lines are truncated
+		//
+		ui32Copy = XBEE_RESP_LINE_SIZE - g_ui32RespLineLen;
+		if(ui32Copy > ui32Run)
+		{
+			ui32Copy = ui32Run;
+		}
+		memcpy(&g_pcRespLine[g_ui32RespLineLen], pui8Data, ui32Copy);
+		g_ui32RespLineLen += ui32Copy;
+		pui8Data += ui32Run;
+		ui32Len -= ui32Run;
+
+		if(pui8CR)
+		{
+			pui8Data++;
+			ui32Len--;
+			XBeeRespLine();
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Expire the oldest command if its deadline has passed. Received bytes are
+// fed in by XBeeLinkPoll(), which also calls this.
+//
+//*****************************************************************************
+void
+XBeeRespPoll(void)
+{
+	tXBeeResp sResp;
+
+	if(XBeeRespPending())
+	{
+		XBeeIdleDeadline(
+		    g_psRespQueue[g_ui32RespTail % XBEE_RESP_QUEUE_SIZE].ui32Deadline);
+	}
+
+	if(XBeeRespPending() &&
+	   XBEE_TICK_REACHED(XBeeTickGet(),
+	        g_psRespQueue[g_ui32RespTail % XBEE_RESP_QUEUE_SIZE].ui32Deadline))
+	{
+		g_ui32RespLineLen = 0;
+		sResp.ui32Type = XBEE_RESP_TIMEOUT;
+		sResp.ui64Value = 0;
+		sResp.pcText = "";
+		sResp.ui32Len = 0;
+		XBeeRespDispatch(&sResp);
+	}
+}
+
+//*****************************************************************************
+//
+// Keep a copy of the response for XBeeATGet(). The text is not kept.
+//
+//*****************************************************************************
+static bool
+XBeeRespCapture(void *pvArg, const tXBeeResp *psResp)
+{
+	tXBeeResp *psCopy;
+
+	psCopy = pvArg;
+	psCopy->ui64Value = psResp->ui64Value;
+	psCopy->ui32Len = psResp->ui32Len;
+	psCopy->pcText = "";
+	psCopy->ui32Type = psResp->ui32Type;
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Read a hex parameter (e.g. "SH", "MY") and wait for the answer. The XBee
+// must already be in command mode. Returns 0 with *pui64Value set, 1 on
+// ERROR, a non hex answer or a timeout. Not for use inside a handler.
+//
+//*****************************************************************************
+int
+XBeeATGet(const char *pcCmd, uint64_t *pui64Value)
+{
+	volatile tXBeeResp sResp;
+
+	sResp.ui32Type = 0xFFFFFFFF;
+	if(!XBeeSchedReserve(strlen(pcCmd) + 3) ||
+	   !XBeeRespExpect(XBeeRespCapture, (void *)&sResp,
+	                   XBEE_RESP_TIMEOUT_MS))
+	{
+		return 1;
+	}
+
+	XBeeSchedPut('A');
+	XBeeSchedPut('T');
+	while(*pcCmd)
+	{
+		XBeeSchedPut(*pcCmd++);
+	}
+	XBeeSchedPut('\r');
+
+	while(sResp.ui32Type == 0xFFFFFFFF)
+	{
+		XBeeLinkPoll();
+		XBeeIdleEnter();
+	}
+
+	if(sResp.ui32Type != XBEE_RESP_HEX)
+	{
+		return 1;
+	}
+
+	*pui64Value = sResp.ui64Value;
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Print a 64-bit value, UARTprintf has no 64-bit conversions.
+//
+//*****************************************************************************
+static void
+XBeeRespPrintHex64(uint64_t ui64Value)
+{
+	if(ui64Value >> 32)
+	{
+		UARTprintf("0x%x%08x", (uint32_t)(ui64Value >> 32),
+		           (uint32_t)ui64Value);
+	}
+	else
+	{
+		UARTprintf("0x%x", (uint32_t)ui64Value);
+	}
+}
+
+//*****************************************************************************
+//
+// Print a response labelled with the command name in pvArg.
+//
+//*****************************************************************************
+bool
+XBeeRespPrint(void *pvArg, const tXBeeResp *psResp)
+{
+	const char *pcLabel;
+
+	pcLabel = pvArg ? (const char *)pvArg : "XBee";
+
+	switch(psResp->ui32Type)
+	{
+		case XBEE_RESP_OK:
+		{
+			UARTprintf("%s: OK\n", pcLabel);
+			break;
+		}
+
+		case XBEE_RESP_ERROR:
+		{
+			UARTprintf("%s: ERROR\n", pcLabel);
+			break;
+		}
+
+		case XBEE_RESP_HEX:
+		{
+			UARTprintf("%s: ", pcLabel);
+			XBeeRespPrintHex64(psResp->ui64Value);
+			UARTprintf("\n");
+			break;
+		}
+
+		case XBEE_RESP_TEXT:
+		{
+			UARTprintf("%s: '%s'\n", pcLabel, psResp->pcText);
+			break;
+		}
+
+		case XBEE_RESP_TIMEOUT:
+		{
+			UARTprintf("%s: no response\n", pcLabel);
+			break;
+		}
+
+		default:
+		{
+			//
+			// Stray blank line, keep waiting
+			//
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Serial number halves. Once both have been read they are merged into the
+// 64-bit serial number.
+//
+//*****************************************************************************
+bool
+XBeeRespSerialHigh(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_HEX)
+	{
+		g_sXBeeParams.ui64Serial = (g_sXBeeParams.ui64Serial & 0xFFFFFFFF) |
+		                           (psResp->ui64Value << 32);
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_SH;
+	}
+
+	return XBeeRespPrint("ATSH", psResp);
+}
+
+bool
+XBeeRespSerialLow(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_HEX)
+	{
+		g_sXBeeParams.ui64Serial = (g_sXBeeParams.ui64Serial &
+		                            0xFFFFFFFF00000000ULL) |
+		                           (psResp->ui64Value & 0xFFFFFFFF);
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_SL;
+	}
+
+	return XBeeRespPrint("ATSL", psResp);
+}
+
+bool
+XBeeRespMy(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_HEX)
+	{
+		g_sXBeeParams.ui16My = (uint16_t)psResp->ui64Value;
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_MY;
+	}
+
+	return XBeeRespPrint("ATMY", psResp);
+}
+
+bool
+XBeeRespPanId(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_HEX)
+	{
+		g_sXBeeParams.ui16PanId = (uint16_t)psResp->ui64Value;
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_ID;
+	}
+
+	return XBeeRespPrint("ATID", psResp);
+}
+
+bool
+XBeeRespVoltage(void *pvArg, const tXBeeResp *psResp)
+{
+	if(psResp->ui32Type == XBEE_RESP_HEX)
+	{
+		g_sXBeeParams.ui32SupplyMv = (uint32_t)((psResp->ui64Value *
+		                                         XBEE_VOLTAGE_SCALE_NUM) /
+		                                        XBEE_VOLTAGE_SCALE_DEN);
+		g_sXBeeParams.ui32Valid |= XBEE_PARAM_VOLTAGE;
+		UARTprintf("AT%%V: %d mV\n", g_sXBeeParams.ui32SupplyMv);
+		return true;
+	}
+
+	return XBeeRespPrint("AT%V", psResp);
+}
+
+//*****************************************************************************
+//
+// Parameters Command
+// Input: n/a
+// Response: decoded values read so far
+// Use: to check what the firmware knows about the local XBee
+//
+//*****************************************************************************
+int
+Cmd_params(int argc, char *argv[])
+{
+	UARTprintf("Serial: ");
+	if((g_sXBeeParams.ui32Valid & XBEE_PARAM_SERIAL) == XBEE_PARAM_SERIAL)
+	{
+		XBeeRespPrintHex64(g_sXBeeParams.ui64Serial);
+		UARTprintf("\n");
+	}
+	else
+	{
+		UARTprintf("not read (ATSH and ATSL)\n");
+	}
+
+	if(g_sXBeeParams.ui32Valid & XBEE_PARAM_MY)
+	{
+		UARTprintf("MY:     0x%04x\n", g_sXBeeParams.ui16My);
+	}
+	if(g_sXBeeParams.ui32Valid & XBEE_PARAM_ID)
+	{
+		UARTprintf("PAN ID: 0x%04x\n", g_sXBeeParams.ui16PanId);
+	}
+	if(g_sXBeeParams.ui32Valid & XBEE_PARAM_VOLTAGE)
+	{
+		UARTprintf("Supply: %d mV\n", g_sXBeeParams.ui32SupplyMv);
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Benchmark support: a typical mix of response lines, and a handler that
+// only counts them.
+//
+//*****************************************************************************
+#define RESPBENCH_LOOPS         100
+
+static const char g_pcBenchResp[] =
+	"OK\r0013A200\r40A1B2C3\r1234\rERROR\r3333\rOK\r0\rABCD\rNODE_1\r"
+	"OK\rFFFE\r0C\r0013A200\r40A1B2C4\rOK\r";
+
+static bool
+XBeeRespBenchCount(void *pvArg, const tXBeeResp *psResp)
+{
+	(*(uint32_t *)pvArg)++;
+	return false;
+}
+
+//*****************************************************************************
+//
+// Response Benchmark Command
+// Input: n/a
+// Response: tokenizer cost in cycles per byte and parse rate
+// Use: to check the cost of typed response decoding on this part
+//
+//*****************************************************************************
+int
+Cmd_respbench(int argc, char *argv[])
+{
+	uint32_t ui32Lines;
+	uint32_t ui32Bytes;
+	uint32_t ui32Start;
+	uint32_t ui32Cycles;
+	uint32_t ui32Clock;
+	int x;
+
+	if(XBeeRespPending())
+	{
+		UARTprintf("Error: commands still waiting for a response\n");
+		return 1;
+	}
+
+	XBeeCycleCountEnable();
+	ui32Lines = 0;
+	ui32Bytes = (sizeof(g_pcBenchResp) - 1) * RESPBENCH_LOOPS;
+	XBeeRespExpect(XBeeRespBenchCount, &ui32Lines, 0xFFFFFFF);
+
+	ui32Start = XBeeCycleCountGet();
+	for(x = 0; x < RESPBENCH_LOOPS; x++)
+	{
+		XBeeRespFeed((const uint8_t *)g_pcBenchResp,
+		             sizeof(g_pcBenchResp) - 1);
+	}
+	ui32Cycles = XBeeCycleCountGet() - ui32Start;
+
+	//
+	// Take the counting handler back off the queue
+	//
+	g_ui32RespTail++;
+
+	ui32Clock = SysCtlClockGet();
+	UARTprintf("%d lines, %d bytes in %d cycles\n", ui32Lines, ui32Bytes,
+	           ui32Cycles);
+	UARTprintf("%d cycles/line, %d cycles/byte x100\n",
+	           ui32Lines ? (ui32Cycles / ui32Lines) : 0,
+	           (ui32Cycles / ui32Bytes) * 100 +
+	           ((ui32Cycles % ui32Bytes) * 100) / ui32Bytes);
+	UARTprintf("%d lines/s, %d bytes/s at %d Hz\n",
+	           ui32Cycles ?
+	           (uint32_t)(((uint64_t)ui32Lines * ui32Clock) / ui32Cycles) : 0,
+	           ui32Cycles ?
+	           (uint32_t)(((uint64_t)ui32Bytes * ui32Clock) / ui32Cycles) : 0,
+	           ui32Clock);
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+//*****************************************************************************
+//
+// XBeeResp.h - Headers for use with XBeeResp.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEERESP_H__
+#define __XBEERESP_H__
+
+//*****************************************************************************
+//
+// Response line types
+//
+//*****************************************************************************
+#define XBEE_RESP_OK            0
+#define XBEE_RESP_ERROR         1
+#define XBEE_RESP_HEX           2   // ui64Value holds the number
+#define XBEE_RESP_TEXT          3   // anything else, see pcText
+#define XBEE_RESP_EMPTY         4   // bare CR, ends multi line responses
+#define XBEE_RESP_TIMEOUT       5   // no response before the deadline
+
+//*****************************************************************************
+//
+// Sizes and timing. A line holds the ATED answer, 16 values of 3 characters.
+//
+//*****************************************************************************
+#define XBEE_RESP_LINE_SIZE     56
+#define XBEE_RESP_QUEUE_SIZE    8
+#define XBEE_RESP_TIMEOUT_MS    1000
+
+//*****************************************************************************
+//
+// Supply voltage scale for AT%V. Series 1 reports 1200/1024 mV per count,
+// ZB firmware reports mV directly (set both to 1).
+//
+//*****************************************************************************
+#define XBEE_VOLTAGE_SCALE_NUM  1200
+#define XBEE_VOLTAGE_SCALE_DEN  1024
+
+//*****************************************************************************
+//
+// One classified response line. pcText is only valid inside the handler.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Type;
+	uint64_t ui64Value;
+	const char *pcText;
+	uint32_t ui32Len;
+}
+tXBeeResp;
+
+//*****************************************************************************
+//
+// Called with each response line for the command at the head of the queue.
+// Return true when the command's response is complete, false to be given
+// the next line as well.
+//
+//*****************************************************************************
+typedef bool (*tXBeeRespHandler)(void *pvArg, const tXBeeResp *psResp);
+
+//*****************************************************************************
+//
+// Values decoded from responses, for use by the rest of the firmware.
+// ui32Valid has one XBEE_PARAM_* bit per field that has been read.
+//
+//*****************************************************************************
+#define XBEE_PARAM_SH           0x01
+#define XBEE_PARAM_SL           0x02
+#define XBEE_PARAM_SERIAL       (XBEE_PARAM_SH | XBEE_PARAM_SL)
+#define XBEE_PARAM_MY           0x04
+#define XBEE_PARAM_ID           0x08
+#define XBEE_PARAM_VOLTAGE      0x10
+
+typedef struct
+{
+	uint32_t ui32Valid;
+	uint64_t ui64Serial;
+	uint16_t ui16My;
+	uint16_t ui16PanId;
+	uint32_t ui32SupplyMv;
+}
+tXBeeParams;
+
+extern tXBeeParams g_sXBeeParams;
+
+//*****************************************************************************
+//
+// Tokenizer and pending command queue
+//
+//*****************************************************************************
+extern bool XBeeRespExpect(tXBeeRespHandler pfnHandler, void *pvArg,
+                           uint32_t ui32TimeoutMs);
+extern bool XBeeRespPending(void);
+extern uint32_t XBeeRespLastTick(void);
+extern void XBeeRespFeed(const uint8_t *pui8Data, uint32_t ui32Len);
+extern void XBeeRespPoll(void);
+extern int XBeeATGet(const char *pcCmd, uint64_t *pui64Value);
+extern bool XBeeHexDecode(const char *pcText, uint32_t ui32Len,
+                          uint64_t *pui64Value);
+
+//*****************************************************************************
+//
+// Standard handlers. XBeeRespPrint prints the response labelled with pvArg
+// (a string), the others also store the value in g_sXBeeParams.
+//
+//*****************************************************************************
+extern bool XBeeRespPrint(void *pvArg, const tXBeeResp *psResp);
+extern bool XBeeRespSerialHigh(void *pvArg, const tXBeeResp *psResp);
+extern bool XBeeRespSerialLow(void *pvArg, const tXBeeResp *psResp);
+extern bool XBeeRespMy(void *pvArg, const tXBeeResp *psResp);
+extern bool XBeeRespPanId(void *pvArg, const tXBeeResp *psResp);
+extern bool XBeeRespVoltage(void *pvArg, const tXBeeResp *psResp);
+
+extern int Cmd_params(int argc, char *argv[]);
+extern int Cmd_respbench(int argc, char *argv[]);
+
+#endif //__XBEERESP_H__
@@ -0,0 +1,525 @@
+//*****************************************************************************
+//
+// XBeeSched.c - Priority classed transmit scheduler for UART1
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Everything bound for the XBee is queued here by class instead of going
+//! straight to the UART1 driver, one pool buffer per frame (or AT text
+//! write). Buffers are handed to the driver whole, so a higher class
+//! overtakes a lower one at the next frame boundary but never splits a
+//! frame.
+//!
+//! Only the buffer pointer moves: the frame is encoded once into its pool
+//! buffer, and the UART1 interrupt frees the buffer after the last byte is
+//! sent.
+//!
+//! The driver is kept short (XBEE_SCHED_AHEAD) so what is already committed
+//! there can not hold a control frame up for long.
+//!
+//! Frames that go on the air are also charged to the airtime budget
+//! (XBeeAir.c). One that does not fit yet stays at the head of its class,
+//! and the other classes are served meanwhile.
+//!
+//! Nothing here waits. A write to a class whose queue is full, or with no
+//! pool buffer left, fails and is counted; the caller backs off (checks
+//! XBeeSchedSpace() or XBeeLinkSendReady() first) or lets the message go.
+//! Waiting here would hold the main loop, and the console with it, until
+//! the airtime budget refills.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeePool.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeLink.h"
+#include "XBeeAir.h"
+#include "XBeeIdle.h"
+#include "XBeeTx.h"
+#include "XBeeSched.h"
+
+//*****************************************************************************
+//
+// Queues, lists of pool buffers linked through psNext
+//
+//*****************************************************************************
+typedef struct
+{
+	tXBeeBuf *psHead;
+	tXBeeBuf *psTail;
+	uint32_t ui32Queued;
+	uint32_t ui32Limit;
+	uint32_t ui32Share;
+	uint32_t ui32Spent;
+	tXBeeBuf *psDeferred;               // head last held for airtime
+	tXBeeSchedStats sStats;
+}
+tXBeeSchedQueue;
+
+static tXBeeSchedQueue g_psSchedQueue[XBEE_SCHED_CLASSES] =
+{
+	{ 0, 0, 0, XBEE_SCHED_CONTROL_SIZE, XBEE_SCHED_SHARE_CONTROL },
+	{ 0, 0, 0, XBEE_SCHED_DATA_SIZE, XBEE_SCHED_SHARE_DATA },
+	{ 0, 0, 0, XBEE_SCHED_BULK_SIZE, XBEE_SCHED_SHARE_BULK }
+};
+
+static const char * const g_ppcSchedNames[XBEE_SCHED_CLASSES] =
+{
+	"control", "data", "bulk"
+};
+
+static uint32_t g_ui32SchedPeriodTick;
+static bool g_bSchedHeld;
+
+//*****************************************************************************
+//
+// Control buffer set aside by XBeeSchedReserve() that XBeeSchedPut() is
+// filling with AT text, not yet queued, and the bytes still to come
+//
+//*****************************************************************************
+static tXBeeBuf *g_psSchedPutBuf;
+static uint32_t g_ui32SchedPutLeft;
+
+//*****************************************************************************
+//
+// Get a pool buffer for a write in ui32Class. Returns 0, and counts a drop,
+// if the pool has none of that size free; buffers come back as the UART
+// sends them.
+//
+//*****************************************************************************
+tXBeeBuf *
+XBeeSchedAlloc(uint32_t ui32Class, uint32_t ui32Size)
+{
+	if(XBeePoolAvail(ui32Size) == 0)
+	{
+		g_psSchedQueue[ui32Class].sStats.ui32Dropped++;
+		return 0;
+	}
+
+	return XBeePoolAlloc(ui32Size);
+}
+
+//*****************************************************************************
+//
+// Queue one frame, taking ownership of psBuf. Returns false, with psBuf
+// freed, if the class's queue has no room for it.
+//
+//*****************************************************************************
+bool
+XBeeSchedSubmit(uint32_t ui32Class, tXBeeBuf *psBuf)
+{
+	tXBeeSchedQueue *psQueue;
+
+	psQueue = &g_psSchedQueue[ui32Class];
+
+	if(XBeeSchedSpace(ui32Class) < psBuf->ui16Len)
+	{
+		psQueue->sStats.ui32Refused++;
+		XBeePoolFree(psBuf);
+		return false;
+	}
+
+	psBuf->psNext = 0;
+	psBuf->ui32Stamp = XBeeTickGet();
+	if(psQueue->psTail)
+	{
+		psQueue->psTail->psNext = psBuf;
+	}
+	else
+	{
+		psQueue->psHead = psBuf;
+	}
+	psQueue->psTail = psBuf;
+	psQueue->ui32Queued += psBuf->ui16Len;
+
+	if(psQueue->ui32Queued > psQueue->sStats.ui32HighWater)
+	{
+		psQueue->sStats.ui32HighWater = psQueue->ui32Queued;
+	}
+
+	//
+	// Go straight out if the UART has room
+	//
+	XBeeSchedPoll();
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Queue a copy of ui32Len bytes, at most XBEE_POOL_LARGE_SIZE. Returns false
+// if it could not be queued.
+//
+//*****************************************************************************
+bool
+XBeeSchedWrite(uint32_t ui32Class, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	tXBeeBuf *psBuf;
+
+	psBuf = XBeeSchedAlloc(ui32Class, ui32Len);
+	if(psBuf == 0)
+	{
+		return false;
+	}
+
+	memcpy(psBuf->pui8Data, pui8Data, ui32Len);
+	psBuf->ui16Len = ui32Len;
+	return XBeeSchedSubmit(ui32Class, psBuf);
+}
+
+//*****************************************************************************
+//
+// Queue the reserved buffer with what XBeeSchedPut() has put in it.
+//
+//*****************************************************************************
+static void
+XBeeSchedPutFlush(void)
+{
+	tXBeeBuf *psBuf;
+
+	psBuf = g_psSchedPutBuf;
+	g_psSchedPutBuf = 0;
+	if(psBuf && psBuf->ui16Len)
+	{
+		XBeeSchedSubmit(XBEE_SCHED_CONTROL, psBuf);
+	}
+	else
+	{
+		XBeePoolFree(psBuf);
+	}
+}
+
+//*****************************************************************************
+//
+// Set aside room for the next ui32Len bytes of XBeeSchedPut(), a whole AT
+// command, so it is queued whole or not at all. Returns false, with
+// nothing reserved, if the control queue or the pool has no room; the
+// caller then sends nothing. The bytes are queued in one buffer once
+// ui32Len of them or a carriage return have been put.
+//
+//*****************************************************************************
+bool
+XBeeSchedReserve(uint32_t ui32Len)
+{
+	XBeeSchedPutFlush();
+
+	if(XBeeSchedSpace(XBEE_SCHED_CONTROL) < ui32Len)
+	{
+		g_psSchedQueue[XBEE_SCHED_CONTROL].sStats.ui32Refused++;
+		return false;
+	}
+	g_psSchedPutBuf = XBeeSchedAlloc(XBEE_SCHED_CONTROL, ui32Len);
+	g_ui32SchedPutLeft = ui32Len;
+
+	return g_psSchedPutBuf != 0;
+}
+
+//*****************************************************************************
+//
+// Single byte write in the control class, for XBEEWRITE() in XBee.c. Goes
+// into the buffer XBeeSchedReserve() set aside; without one it is queued
+// on its own, if there is room.
+//
+//*****************************************************************************
+void
+XBeeSchedPut(uint8_t ui8Char)
+{
+	tXBeeBuf *psBuf;
+
+	psBuf = g_psSchedPutBuf;
+	if(psBuf && (psBuf->ui16Len < psBuf->ui16Size))
+	{
+		psBuf->pui8Data[psBuf->ui16Len++] = ui8Char;
+		if((--g_ui32SchedPutLeft == 0) || (ui8Char == '\r'))
+		{
+			XBeeSchedPutFlush();
+		}
+		return;
+	}
+
+	XBeeSchedPutFlush();
+	XBeeSchedWrite(XBEE_SCHED_CONTROL, &ui8Char, 1);
+}
+
+//*****************************************************************************
+//
+// Bytes that can be queued in a class without blocking.
+//
+//*****************************************************************************
+uint32_t
+XBeeSchedSpace(uint32_t ui32Class)
+{
+	tXBeeSchedQueue *psQueue;
+
+	psQueue = &g_psSchedQueue[ui32Class];
+
+	return (psQueue->ui32Queued < psQueue->ui32Limit) ?
+	       (psQueue->ui32Limit - psQueue->ui32Queued) : 0;
+}
+
+//*****************************************************************************
+//
+// True when nothing is queued in any class.
+//
+//*****************************************************************************
+bool
+XBeeSchedIdle(void)
+{
+	uint32_t ui32Class;
+
+	for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+	{
+		if(g_psSchedQueue[ui32Class].psHead)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// True if what is queued is all waiting for airtime, so there is nothing to
+// do until XBeeAirWait() has passed.
+//
+//*****************************************************************************
+bool
+XBeeSchedHeld(void)
+{
+	return g_bSchedHeld;
+}
+
+//*****************************************************************************
+//
+// Pick the class to send next: the highest with something queued and budget
+// left, else the highest with anything queued. Classes in ui32Skip (a bit
+// per class) are passed over. Returns XBEE_SCHED_CLASSES if there is none.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSchedPick(uint32_t ui32Budget, uint32_t ui32Skip)
+{
+	tXBeeSchedQueue *psQueue;
+	uint32_t ui32Class;
+	uint32_t ui32First;
+
+	ui32First = XBEE_SCHED_CLASSES;
+	for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+	{
+		psQueue = &g_psSchedQueue[ui32Class];
+		if((psQueue->psHead == 0) || (ui32Skip & (1 << ui32Class)))
+		{
+			continue;
+		}
+		if(psQueue->ui32Spent < ((ui32Budget * psQueue->ui32Share) / 100))
+		{
+			return ui32Class;
+		}
+		if(ui32First == XBEE_SCHED_CLASSES)
+		{
+			ui32First = ui32Class;
+		}
+	}
+
+	return ui32First;
+}
+
+//*****************************************************************************
+//
+// Hand queued frames to the UART1 driver, highest priority first. Called
+// from XBeeLinkPoll() and by every write.
+//
+//*****************************************************************************
+void
+XBeeSchedPoll(void)
+{
+	tXBeeSchedQueue *psQueue;
+	tXBeeBuf *psBuf;
+	uint32_t ui32Now;
+	uint32_t ui32Budget;
+	uint32_t ui32Class;
+	uint32_t ui32Len;
+	uint32_t ui32Delay;
+	uint32_t ui32Held;
+
+	ui32Now = XBeeTickGet();
+	if(XBEE_TICK_REACHED(ui32Now, g_ui32SchedPeriodTick + XBEE_SCHED_PERIOD_MS))
+	{
+		g_ui32SchedPeriodTick = ui32Now;
+		for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+		{
+			g_psSchedQueue[ui32Class].ui32Spent = 0;
+		}
+	}
+	ui32Budget = (XBeeLinkRate() * XBEE_SCHED_PERIOD_MS) / 1000;
+	ui32Held = 0;
+	g_bSchedHeld = false;
+
+	while(XBeeUartTxPending() <= XBEE_SCHED_AHEAD)
+	{
+		ui32Class = XBeeSchedPick(ui32Budget, ui32Held);
+		if(ui32Class == XBEE_SCHED_CLASSES)
+		{
+			g_bSchedHeld = (ui32Held != 0);
+			return;
+		}
+		psQueue = &g_psSchedQueue[ui32Class];
+		psBuf = psQueue->psHead;
+
+		//
+		// Not enough air time: the frame keeps its place and the other
+		// classes get a turn
+		//
+		if(psBuf->ui16AirLen && !XBeeAirTake(psBuf->ui16AirLen))
+		{
+			if(psQueue->psDeferred != psBuf)
+			{
+				psQueue->psDeferred = psBuf;
+				psQueue->sStats.ui32Deferred++;
+			}
+			XBeeIdleDeadline(ui32Now + XBeeAirWait(psBuf->ui16AirLen));
+			ui32Held |= 1 << ui32Class;
+			continue;
+		}
+		psQueue->psDeferred = 0;
+
+		psQueue->psHead = psBuf->psNext;
+		if(psQueue->psHead == 0)
+		{
+			psQueue->psTail = 0;
+		}
+		ui32Len = psBuf->ui16Len;
+		ui32Delay = ui32Now - psBuf->ui32Stamp;
+		psQueue->ui32Queued -= ui32Len;
+
+		//
+		// The driver owns the buffer from here, and a transmit request's
+		// timeout starts
+		//
+		if(psBuf->ui8FrameId)
+		{
+			XBeeTxReleased(psBuf->ui8FrameId);
+		}
+		XBeeUartSubmit(psBuf);
+
+		psQueue->ui32Spent += ui32Len;
+		psQueue->sStats.ui32Bytes += ui32Len;
+		if(psQueue->ui32Spent > ((ui32Budget * psQueue->ui32Share) / 100))
+		{
+			psQueue->sStats.ui32OverBudget++;
+		}
+		psQueue->sStats.ui32Frames++;
+		psQueue->sStats.ui32DelaySum += ui32Delay;
+		if(ui32Delay > psQueue->sStats.ui32DelayMax)
+		{
+			psQueue->sStats.ui32DelayMax = ui32Delay;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Change a class's share of the link rate.
+//
+//*****************************************************************************
+void
+XBeeSchedShareSet(uint32_t ui32Class, uint32_t ui32Percent)
+{
+	g_psSchedQueue[ui32Class].ui32Share = ui32Percent;
+}
+
+void
+XBeeSchedStatsGet(uint32_t ui32Class, tXBeeSchedStats *psStats)
+{
+	*psStats = g_psSchedQueue[ui32Class].sStats;
+}
+
+//*****************************************************************************
+//
+// Sched Command
+// Input: none / 'clear' / 'share <control|data|bulk> <percent>'
+// Response: per class frames, bytes, queueing delay, budget overruns and
+//		frames held for the airtime budget
+// Use: to see how long each class waits for the radio, and to change how
+//		the link rate is shared when classes compete
+//
+//*****************************************************************************
+int
+Cmd_sched(int argc, char *argv[])
+{
+	tXBeeSchedQueue *psQueue;
+	uint32_t ui32Class;
+	uint32_t ui32Percent;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+		{
+			memset(&g_psSchedQueue[ui32Class].sStats, 0,
+			       sizeof(tXBeeSchedStats));
+		}
+		return 0;
+	}
+	else if((4 == argc) && (0 == strcmp(argv[1], "share")))
+	{
+		for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+		{
+			if(0 == strcmp(argv[2], g_ppcSchedNames[ui32Class]))
+			{
+				break;
+			}
+		}
+		ui32Percent = strtoul(argv[3], 0, 10);
+		if((ui32Class == XBEE_SCHED_CLASSES) || (ui32Percent > 100))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		XBeeSchedShareSet(ui32Class, ui32Percent);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("class share  frames    bytes  delay ms avg   max  "
+	           "over    full  peak  drop  held\n");
+	for(ui32Class = 0; ui32Class < XBEE_SCHED_CLASSES; ui32Class++)
+	{
+		psQueue = &g_psSchedQueue[ui32Class];
+		UARTprintf("%7s %3d%% %7d %8d %12d %5d %5d %7d %5d %5d %5d\n",
+		           g_ppcSchedNames[ui32Class], psQueue->ui32Share,
+		           psQueue->sStats.ui32Frames, psQueue->sStats.ui32Bytes,
+		           psQueue->sStats.ui32Frames ?
+		           (psQueue->sStats.ui32DelaySum /
+		            psQueue->sStats.ui32Frames) : 0,
+		           psQueue->sStats.ui32DelayMax,
+		           psQueue->sStats.ui32OverBudget,
+		           psQueue->sStats.ui32Refused,
+		           psQueue->sStats.ui32HighWater,
+		           psQueue->sStats.ui32Dropped,
+		           psQueue->sStats.ui32Deferred);
+	}
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+//*****************************************************************************
+//
+// XBeeSched.h - Headers for use with XBeeSched.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEESCHED_H__
+#define __XBEESCHED_H__
+
+//*****************************************************************************
+//
+// Transmit classes, highest priority first
+//
+//   CONTROL  AT commands, API frames to the local XBee, link handshakes/ACKs
+//   DATA     samples and other node to node messages
+//   BULK     bulk transfer fragments
+//
+//*****************************************************************************
+#define XBEE_SCHED_CONTROL      0
+#define XBEE_SCHED_DATA         1
+#define XBEE_SCHED_BULK         2
+#define XBEE_SCHED_CLASSES      3
+
+//*****************************************************************************
+//
+// Queue limits in bytes. A write is refused while its class has this much
+// queued; each must be larger than the biggest encoded frame.
+//
+//*****************************************************************************
+#define XBEE_SCHED_CONTROL_SIZE 512
+#define XBEE_SCHED_DATA_SIZE    512
+#define XBEE_SCHED_BULK_SIZE    1024
+
+//*****************************************************************************
+//
+// A frame is only handed to the UART1 driver when no more than this many
+// bytes are waiting there, so a control frame never waits behind more than this
+// plus one frame.
+//
+//*****************************************************************************
+#define XBEE_SCHED_AHEAD        64
+
+//*****************************************************************************
+//
+// Byte budgets. Each class may send its share (percent of the link rate)
+// in every XBEE_SCHED_PERIOD_MS. A class over its budget only sends when no
+// class within budget has anything queued.
+//
+//*****************************************************************************
+#define XBEE_SCHED_PERIOD_MS    100
+#define XBEE_SCHED_SHARE_CONTROL 20
+#define XBEE_SCHED_SHARE_DATA   30
+#define XBEE_SCHED_SHARE_BULK   50
+
+//*****************************************************************************
+//
+// Per class statistics. Queueing delay is from XBeeSchedSubmit() until the
+// frame is handed to the UART1 driver, in ms.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Frames;
+	uint32_t ui32Bytes;
+	uint32_t ui32DelaySum;
+	uint32_t ui32DelayMax;
+	uint32_t ui32OverBudget;            // sent while over budget
+	uint32_t ui32Refused;               // writes refused, queue full
+	uint32_t ui32HighWater;             // peak queue occupancy, bytes
+	uint32_t ui32Dropped;               // writes lost, no pool buffer
+	uint32_t ui32Deferred;              // frames held for airtime budget
+}
+tXBeeSchedStats;
+
+struct tXBeeBuf;
+
+//*****************************************************************************
+//
+// Transmit scheduler functions
+//
+//*****************************************************************************
+extern bool XBeeSchedWrite(uint32_t ui32Class, const uint8_t *pui8Data,
+                           uint32_t ui32Len);
+extern bool XBeeSchedReserve(uint32_t ui32Len);
+extern void XBeeSchedPut(uint8_t ui8Char);
+extern struct tXBeeBuf *XBeeSchedAlloc(uint32_t ui32Class, uint32_t ui32Size);
+extern bool XBeeSchedSubmit(uint32_t ui32Class, struct tXBeeBuf *psBuf);
+extern void XBeeSchedPoll(void);
+extern uint32_t XBeeSchedSpace(uint32_t ui32Class);
+extern bool XBeeSchedIdle(void);
+extern bool XBeeSchedHeld(void);
+extern void XBeeSchedShareSet(uint32_t ui32Class, uint32_t ui32Percent);
+extern void XBeeSchedStatsGet(uint32_t ui32Class, tXBeeSchedStats *psStats);
+extern int Cmd_sched(int argc, char *argv[]);
+
+#endif //__XBEESCHED_H__
@@ -0,0 +1,730 @@
+//*****************************************************************************
+//
+// XBeeSlot.c - Sampling schedule handed out by the coordinator
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Nodes that sample at the same period and were powered up together send
+//! at nearly the same moment every period; CSMA spreads a few of them, but
+//! past a few dozen most frames end in collisions and CCA failures.
+//!
+//! 'slot plan <period>' on the coordinator gives each node in the
+//! neighbour table (ATND) its own offset into a common period: node i of n
+//! sends i x period / n ms into each cycle. The assignment goes to each
+//! node as a message, again at each beacon until the node has acknowledged
+//! it (transmit status). Every XBEE_SLOT_BEACON_MS the coordinator
+//! broadcasts how far into the cycle it is, which the nodes take as the
+//! cycle start, so their clocks cannot drift out of their slot.
+//!
+//! A node sends a sample message at the start of its slot each period; the
+//! coordinator counts them against what the plan should deliver.
+//! XBee radios sampling on their own (ATIR) cannot be given an offset,
+//! so this is for nodes that run this firmware.
+//!
+//! 'slot bench' compares the two on a simulated channel with 802.15.4
+//! CSMA-CA, for 8 to XBEE_SLOT_SIM_NODES nodes.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeSched.h"
+#include "XBeeLink.h"
+#include "XBeeResp.h"
+#include "XBeeNode.h"
+#include "XBeeConc.h"
+#include "XBeeQual.h"
+#include "XBeeTx.h"
+#include "XBeeIdle.h"
+#include "XBeeSlot.h"
+
+//*****************************************************************************
+//
+// Role of this node
+//
+//*****************************************************************************
+#define SLOT_OFF                0
+#define SLOT_COORDINATOR        1
+#define SLOT_NODE               2
+
+//*****************************************************************************
+//
+// Simulation: node state packs the next attempt (us into the cycle, low
+// 26 bits), backoffs and retries so far. Times start SLOT_SIM_MARGIN_US
+// into the cycle so early clocks stay positive.
+//
+//*****************************************************************************
+#define SLOT_SIM_TIME           0x03FFFFFF
+#define SLOT_SIM_NB_SHIFT       26
+#define SLOT_SIM_RETRY_SHIFT    29
+#define SLOT_SIM_DONE           0xFFFFFFFF
+#define SLOT_SIM_MARGIN_US      5000
+
+//*****************************************************************************
+//
+// Schedule: period and start of the cycle (tick) on both sides, this
+// node's offset or the coordinator's slot width
+//
+//*****************************************************************************
+static uint32_t g_ui32SlotRole;
+static uint32_t g_ui32SlotPeriod;
+static uint32_t g_ui32SlotOffset;
+static uint32_t g_ui32SlotEpoch;
+static tXBeeSlotStats g_sSlotStats;
+
+//*****************************************************************************
+//
+// Coordinator: nodes in the plan, those still to acknowledge their slot,
+// the assignment pass and the next beacon
+//
+//*****************************************************************************
+static uint32_t g_ui32SlotNodes;
+static uint32_t g_pui32SlotPending[(XBEE_NODE_TABLE_SIZE + 31) / 32];
+static uint32_t g_ui32SlotPass;
+static uint32_t g_ui32SlotBeacon;
+
+//*****************************************************************************
+//
+// Node: where samples go, when the next is due and its sequence number
+//
+//*****************************************************************************
+static uint64_t g_ui64SlotCoordinator;
+static uint32_t g_ui32SlotNext;
+static uint16_t g_ui16SlotSeq;
+
+static uint32_t g_pui32SlotSim[XBEE_SLOT_SIM_NODES];
+static uint32_t g_ui32SlotSimRand;
+
+//*****************************************************************************
+//
+// Address to send to for neighbour table entry psNode.
+//
+//*****************************************************************************
+static uint64_t
+XBeeSlotAddr(const tXBeeNode *psNode)
+{
+	return (psNode->ui16My != 0xFFFE) ? psNode->ui16My :
+	       XBeeConcAddr(psNode->ui16Node);
+}
+
+//*****************************************************************************
+//
+// Start of the first slot of this node at or after ui32Tick.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotNextStart(uint32_t ui32Tick)
+{
+	int32_t i32Into;
+	uint32_t ui32Cycles;
+
+	i32Into = (int32_t)(ui32Tick - g_ui32SlotEpoch - g_ui32SlotOffset);
+	ui32Cycles = (i32Into <= 0) ? 0 :
+	             (((uint32_t)i32Into + g_ui32SlotPeriod - 1) /
+	              g_ui32SlotPeriod);
+
+	return g_ui32SlotEpoch + g_ui32SlotOffset +
+	       (ui32Cycles * g_ui32SlotPeriod);
+}
+
+//*****************************************************************************
+//
+// Transmit status of an assignment, pvArg is the node's table index.
+//
+//*****************************************************************************
+static void
+XBeeSlotAssignDone(void *pvArg, uint8_t ui8FrameId, uint32_t ui32Result,
+                   uint32_t ui32Retries)
+{
+	uint32_t ui32Index;
+
+	ui32Index = (uint32_t)(uintptr_t)pvArg;
+	if((ui32Result == XBEE_TX_SUCCESS) &&
+	   (g_pui32SlotPending[ui32Index / 32] & (1 << (ui32Index % 32))))
+	{
+		g_pui32SlotPending[ui32Index / 32] &= ~(1 << (ui32Index % 32));
+		g_sSlotStats.ui32Assigned++;
+	}
+	else if(ui32Result != XBEE_TX_SUCCESS)
+	{
+		g_sSlotStats.ui32AssignFailed++;
+	}
+}
+
+//*****************************************************************************
+//
+// Send node ui32Index its slot.
+//
+//*****************************************************************************
+static void
+XBeeSlotAssign(uint32_t ui32Index)
+{
+	uint8_t pui8Msg[XBEE_SLOT_ASSIGN_SIZE];
+	uint32_t ui32Offset;
+	uint32_t ui32Into;
+
+	ui32Offset = (ui32Index * g_ui32SlotPeriod) / g_ui32SlotNodes;
+	ui32Into = XBeeTickGet() - g_ui32SlotEpoch;
+
+	pui8Msg[0] = XBEE_MSG_SLOT_ASSIGN;
+	pui8Msg[1] = 0;
+	XBEE_PUT16(&pui8Msg[2], g_ui32SlotPeriod);
+	XBEE_PUT16(&pui8Msg[4], ui32Offset);
+	XBEE_PUT32(&pui8Msg[6], ui32Into);
+	XBeeTxSend(XBeeSlotAddr(XBeeNodeGet(ui32Index)), XBEE_SCHED_CONTROL,
+	           pui8Msg, sizeof(pui8Msg), XBeeSlotAssignDone,
+	           (void *)(uintptr_t)ui32Index);
+}
+
+//*****************************************************************************
+//
+// Coordinator: hand out slots not yet acknowledged, a few at a time so
+// the transmit window keeps room for everything else, and beacon.
+//
+//*****************************************************************************
+static void
+XBeeSlotCoordinatorPoll(uint32_t ui32Now)
+{
+	uint8_t pui8Msg[XBEE_SLOT_BEACON_SIZE];
+	uint32_t ui32Into;
+
+	while((g_ui32SlotPass < g_ui32SlotNodes) &&
+	      (XBeeTxInFlight() < (XBEE_TX_SLOTS / 2)))
+	{
+		if(g_pui32SlotPending[g_ui32SlotPass / 32] &
+		   (1 << (g_ui32SlotPass % 32)))
+		{
+			XBeeSlotAssign(g_ui32SlotPass);
+		}
+		g_ui32SlotPass++;
+	}
+
+	if(XBEE_TICK_REACHED(ui32Now, g_ui32SlotBeacon))
+	{
+		ui32Into = ui32Now - g_ui32SlotEpoch;
+		pui8Msg[0] = XBEE_MSG_SLOT_BEACON;
+		pui8Msg[1] = 0;
+		XBEE_PUT32(&pui8Msg[2], ui32Into);
+		XBeeTxSend(0xFFFF, XBEE_SCHED_CONTROL, pui8Msg, sizeof(pui8Msg), 0,
+		           0);
+		g_sSlotStats.ui32Beacons++;
+		g_ui32SlotBeacon += XBEE_SLOT_BEACON_MS;
+
+		//
+		// Nodes that missed their assignment get it again
+		//
+		g_ui32SlotPass = 0;
+	}
+
+	XBeeIdleDeadline(g_ui32SlotBeacon);
+}
+
+//*****************************************************************************
+//
+// Node: send a sample at the start of each slot.
+//
+//*****************************************************************************
+static void
+XBeeSlotNodePoll(uint32_t ui32Now)
+{
+	uint8_t pui8Msg[XBEE_SLOT_SAMPLE_SIZE];
+	uint32_t ui32Late;
+
+	if(!XBEE_TICK_REACHED(ui32Now, g_ui32SlotNext))
+	{
+		XBeeIdleDeadline(g_ui32SlotNext);
+		return;
+	}
+
+	ui32Late = ui32Now - g_ui32SlotNext;
+	if(XBeeTxReady(g_ui64SlotCoordinator))
+	{
+		pui8Msg[0] = XBEE_MSG_SLOT_SAMPLE;
+		pui8Msg[1] = 0;
+		XBEE_PUT16(&pui8Msg[2], g_ui16SlotSeq);
+		XBEE_PUT16(&pui8Msg[4], (ui32Late > 0xFFFF) ? 0xFFFF : ui32Late);
+		XBeeTxSend(g_ui64SlotCoordinator, XBEE_SCHED_DATA, pui8Msg,
+		           sizeof(pui8Msg), 0, 0);
+		g_sSlotStats.ui32Sent++;
+	}
+	g_ui16SlotSeq++;
+
+	g_ui32SlotNext = XBeeSlotNextStart(ui32Now + 1);
+	XBeeIdleDeadline(g_ui32SlotNext);
+}
+
+//*****************************************************************************
+//
+// Called from XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeSlotPoll(void)
+{
+	if(g_ui32SlotRole == SLOT_COORDINATOR)
+	{
+		XBeeSlotCoordinatorPoll(XBeeTickGet());
+	}
+	else if(g_ui32SlotRole == SLOT_NODE)
+	{
+		XBeeSlotNodePoll(XBeeTickGet());
+	}
+}
+
+//*****************************************************************************
+//
+// Link handler for slot messages.
+//
+//*****************************************************************************
+void
+XBeeSlotMsg(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Now;
+	uint32_t ui32Epoch;
+	uint32_t ui32Shift;
+
+	ui32Now = XBeeTickGet();
+
+	if((pui8Msg[0] == XBEE_MSG_SLOT_ASSIGN) &&
+	   (ui32Len >= XBEE_SLOT_ASSIGN_SIZE) && XBEE_GET16(&pui8Msg[2]))
+	{
+		g_ui32SlotRole = SLOT_NODE;
+		g_ui64SlotCoordinator = XBeeLinkSourceGet();
+		g_ui32SlotPeriod = XBEE_GET16(&pui8Msg[2]);
+		g_ui32SlotOffset = XBEE_GET16(&pui8Msg[4]) % g_ui32SlotPeriod;
+		g_ui32SlotEpoch = ui32Now - XBEE_GET32(&pui8Msg[6]);
+		g_ui32SlotNext = XBeeSlotNextStart(ui32Now);
+	}
+	else if((pui8Msg[0] == XBEE_MSG_SLOT_BEACON) &&
+	        (ui32Len >= XBEE_SLOT_BEACON_SIZE) &&
+	        (g_ui32SlotRole == SLOT_NODE))
+	{
+		ui32Epoch = ui32Now - XBEE_GET32(&pui8Msg[2]);
+		ui32Shift = (uint32_t)abs((int32_t)(ui32Epoch - g_ui32SlotEpoch));
+		if(ui32Shift)
+		{
+			g_sSlotStats.ui32Corrected++;
+			if(ui32Shift > g_sSlotStats.ui32CorrectionMax)
+			{
+				g_sSlotStats.ui32CorrectionMax = ui32Shift;
+			}
+			g_ui32SlotEpoch = ui32Epoch;
+			g_ui32SlotNext = XBeeSlotNextStart(ui32Now);
+		}
+	}
+	else if((pui8Msg[0] == XBEE_MSG_SLOT_SAMPLE) &&
+	        (ui32Len >= XBEE_SLOT_SAMPLE_SIZE) &&
+	        (g_ui32SlotRole == SLOT_COORDINATOR))
+	{
+		g_sSlotStats.ui32Samples++;
+		if(XBEE_GET16(&pui8Msg[4]) > g_sSlotStats.ui32LateMax)
+		{
+			g_sSlotStats.ui32LateMax = XBEE_GET16(&pui8Msg[4]);
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Plan a schedule of ui32Period ms for the nodes in the neighbour table and
+// start handing it out. Returns the period used, longer if the nodes do
+// not fit, or 0 if the table is empty.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotPlan(uint32_t ui32Period)
+{
+	uint32_t ui32Index;
+
+	g_ui32SlotNodes = XBeeNodeCount();
+	if(g_ui32SlotNodes == 0)
+	{
+		return 0;
+	}
+	if((ui32Period / g_ui32SlotNodes) < XBEE_SLOT_MIN_MS)
+	{
+		ui32Period = g_ui32SlotNodes * XBEE_SLOT_MIN_MS;
+	}
+
+	memset(g_pui32SlotPending, 0, sizeof(g_pui32SlotPending));
+	for(ui32Index = 0; ui32Index < g_ui32SlotNodes; ui32Index++)
+	{
+		g_pui32SlotPending[ui32Index / 32] |= 1 << (ui32Index % 32);
+	}
+
+	memset(&g_sSlotStats, 0, sizeof(g_sSlotStats));
+	g_ui32SlotRole = SLOT_COORDINATOR;
+	g_ui32SlotPeriod = ui32Period;
+	g_ui32SlotEpoch = XBeeTickGet();
+	g_ui32SlotBeacon = g_ui32SlotEpoch + XBEE_SLOT_BEACON_MS;
+	g_ui32SlotPass = 0;
+
+	return ui32Period;
+}
+
+void
+XBeeSlotStatsGet(tXBeeSlotStats *psStats)
+{
+	*psStats = g_sSlotStats;
+}
+
+//*****************************************************************************
+//
+// Simulation random numbers, 0 to ui32Range - 1.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotSimRand(uint32_t ui32Range)
+{
+	g_ui32SlotSimRand = (g_ui32SlotSimRand * 1664525) + 1013904223;
+	return (g_ui32SlotSimRand >> 8) % ui32Range;
+}
+
+//*****************************************************************************
+//
+// Fixed per node value from 0 to ui32Range - 1: start phase and clock error
+// without keeping them.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotSimHash(uint32_t ui32Node, uint32_t ui32Salt, uint32_t ui32Range)
+{
+	uint32_t ui32Hash;
+
+	ui32Hash = (ui32Node + 1) * 0x9E3779B1;
+	ui32Hash ^= ui32Salt;
+	ui32Hash ^= ui32Hash >> 15;
+	ui32Hash *= 0x85EBCA6B;
+	ui32Hash ^= ui32Hash >> 13;
+
+	return ui32Hash % ui32Range;
+}
+
+//*****************************************************************************
+//
+// Put node ui32Node's attempt back at ui32Time after a busy channel (a
+// further backoff) or a collision (a retry), or drop it if it has run out
+// of either. Returns true if the sample was lost.
+//
+//*****************************************************************************
+static bool
+XBeeSlotSimDefer(uint32_t ui32Node, uint32_t ui32Time, bool bCollided)
+{
+	uint32_t ui32State;
+	uint32_t ui32Backoffs;
+	uint32_t ui32Retries;
+	uint32_t ui32Exp;
+
+	ui32State = g_pui32SlotSim[ui32Node];
+	ui32Backoffs = (ui32State >> SLOT_SIM_NB_SHIFT) & 7;
+	ui32Retries = ui32State >> SLOT_SIM_RETRY_SHIFT;
+
+	if(bCollided)
+	{
+		ui32Backoffs = 0;
+		ui32Retries++;
+	}
+	else
+	{
+		ui32Backoffs++;
+	}
+	if((ui32Backoffs > XBEE_SLOT_SIM_BACKOFFS) ||
+	   (ui32Retries > XBEE_SLOT_SIM_RETRIES))
+	{
+		g_pui32SlotSim[ui32Node] = SLOT_SIM_DONE;
+		return true;
+	}
+
+	ui32Exp = XBEE_SLOT_SIM_MIN_BE + ui32Backoffs;
+	if(ui32Exp > XBEE_SLOT_SIM_MAX_BE)
+	{
+		ui32Exp = XBEE_SLOT_SIM_MAX_BE;
+	}
+	ui32Time += XBeeSlotSimRand(1 << ui32Exp) * XBEE_SLOT_SIM_UNIT_US;
+
+	g_pui32SlotSim[ui32Node] = (ui32Time & SLOT_SIM_TIME) |
+	                           (ui32Backoffs << SLOT_SIM_NB_SHIFT) |
+	                           (ui32Retries << SLOT_SIM_RETRY_SHIFT);
+	return false;
+}
+
+//*****************************************************************************
+//
+// One sampling cycle on the simulated channel: every node's sample from
+// the time in g_pui32SlotSim until delivered or given up. Returns the
+// number delivered.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotSimCycle(uint32_t ui32Nodes, uint32_t ui32AirUs)
+{
+	uint32_t ui32Delivered;
+	uint32_t ui32Busy;
+	uint32_t ui32Node;
+	uint32_t ui32First;
+	uint32_t ui32Time;
+	uint32_t ui32Senders;
+
+	ui32Delivered = 0;
+	ui32Busy = 0;
+
+	while(1)
+	{
+		//
+		// Earliest attempt. Done is all ones, after any time.
+		//
+		ui32First = 0;
+		for(ui32Node = 1; ui32Node < ui32Nodes; ui32Node++)
+		{
+			if((g_pui32SlotSim[ui32Node] & SLOT_SIM_TIME) <
+			   (g_pui32SlotSim[ui32First] & SLOT_SIM_TIME))
+			{
+				ui32First = ui32Node;
+			}
+		}
+		if(g_pui32SlotSim[ui32First] == SLOT_SIM_DONE)
+		{
+			return ui32Delivered;
+		}
+		ui32Time = g_pui32SlotSim[ui32First] & SLOT_SIM_TIME;
+
+		//
+		// Channel busy at the CCA: back off
+		//
+		if(ui32Time < ui32Busy)
+		{
+			XBeeSlotSimDefer(ui32First, ui32Time + XBEE_SLOT_SIM_CCA_US,
+			                 false);
+			continue;
+		}
+
+		//
+		// Clear: everyone else whose CCA falls in the same window sends too
+		//
+		ui32Senders = 0;
+		for(ui32Node = 0; ui32Node < ui32Nodes; ui32Node++)
+		{
+			if((g_pui32SlotSim[ui32Node] != SLOT_SIM_DONE) &&
+			   ((g_pui32SlotSim[ui32Node] & SLOT_SIM_TIME) <
+			    (ui32Time + XBEE_SLOT_SIM_CCA_US)))
+			{
+				ui32Senders++;
+			}
+		}
+		ui32Busy = ui32Time + XBEE_SLOT_SIM_CCA_US + ui32AirUs;
+
+		if(ui32Senders == 1)
+		{
+			g_pui32SlotSim[ui32First] = SLOT_SIM_DONE;
+			ui32Delivered++;
+			continue;
+		}
+		for(ui32Node = 0; ui32Node < ui32Nodes; ui32Node++)
+		{
+			if((g_pui32SlotSim[ui32Node] != SLOT_SIM_DONE) &&
+			   ((g_pui32SlotSim[ui32Node] & SLOT_SIM_TIME) <
+			    (ui32Time + XBEE_SLOT_SIM_CCA_US)))
+			{
+				XBeeSlotSimDefer(ui32Node, ui32Busy, true);
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Simulate ui32Nodes nodes sampling every ui32Period ms for
+// XBEE_SLOT_SIM_CYCLES periods, free running or in their slots. Returns
+// the share of samples delivered, per mille.
+//
+//*****************************************************************************
+static uint32_t
+XBeeSlotSimRun(uint32_t ui32Nodes, uint32_t ui32Period, bool bScheduled)
+{
+	uint32_t ui32AirUs;
+	uint32_t ui32Cycle;
+	uint32_t ui32Node;
+	uint32_t ui32Delivered;
+	uint32_t ui32SinceBeacon;
+	int32_t i32Drift;
+	int32_t i32Start;
+
+	ui32AirUs = XBEE_TX_SIM_AIR_US_FIXED +
+	            ((XBEE_SLOT_SAMPLE_SIZE + XBEE_QUAL_FRAME_OVERHEAD) *
+	             XBEE_TX_SIM_AIR_US_PER_BYTE);
+	g_ui32SlotSimRand = 1;
+	ui32Delivered = 0;
+
+	for(ui32Cycle = 0; ui32Cycle < XBEE_SLOT_SIM_CYCLES; ui32Cycle++)
+	{
+		//
+		// How far each clock has run off: since power up when free
+		// running, since the last beacon in a schedule
+		//
+		ui32SinceBeacon = bScheduled ?
+		                  ((ui32Cycle * ui32Period) % XBEE_SLOT_BEACON_MS) :
+		                  (ui32Cycle * ui32Period);
+
+		for(ui32Node = 0; ui32Node < ui32Nodes; ui32Node++)
+		{
+			i32Drift = (int32_t)XBeeSlotSimHash(ui32Node, 0x5EED,
+			                               (2 * XBEE_SLOT_SIM_DRIFT_PPM) + 1) -
+			           XBEE_SLOT_SIM_DRIFT_PPM;
+			if(bScheduled)
+			{
+				i32Start = ((ui32Node * ui32Period) / ui32Nodes) * 1000;
+			}
+			else
+			{
+				i32Start = XBeeSlotSimHash(ui32Node, 0x0FF5,
+				                           XBEE_SLOT_SIM_SPREAD_MS * 1000);
+			}
+			i32Start += (i32Drift * (int32_t)ui32SinceBeacon) / 1000;
+			g_pui32SlotSim[ui32Node] = (SLOT_SIM_MARGIN_US + i32Start) &
+			                           SLOT_SIM_TIME;
+
+			//
+			// First backoff before the first CCA
+			//
+			g_pui32SlotSim[ui32Node] +=
+			    XBeeSlotSimRand(1 << XBEE_SLOT_SIM_MIN_BE) *
+			    XBEE_SLOT_SIM_UNIT_US;
+		}
+
+		ui32Delivered += XBeeSlotSimCycle(ui32Nodes, ui32AirUs);
+	}
+
+	return (ui32Delivered * 1000) / (ui32Nodes * XBEE_SLOT_SIM_CYCLES);
+}
+
+//*****************************************************************************
+//
+// Slot Command
+// Input: none / 'plan <period ms>' / 'stop' / 'bench [period ms]'
+// Response: role and schedule; on the coordinator samples received against
+//		those the plan should have delivered
+// Use: 'plan' on the coordinator gives each node found by ATND a slot in a
+//		common sampling period and keeps the nodes aligned with beacons
+//		(API mode). 'bench' compares free running and scheduled sampling
+//		on a simulated channel at increasing node counts.
+//
+//*****************************************************************************
+int
+Cmd_slot(int argc, char *argv[])
+{
+	uint32_t ui32Period;
+	uint32_t ui32Nodes;
+	uint32_t ui32Free;
+	uint32_t ui32Sched;
+	uint32_t ui32Used;
+	uint32_t ui32Expected;
+
+	if((3 == argc) && (0 == strcmp(argv[1], "plan")))
+	{
+		ui32Period = strtoul(argv[2], 0, 10);
+		if((ui32Period == 0) || (ui32Period > 0xFFFF))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		ui32Used = XBeeSlotPlan(ui32Period);
+		if(ui32Used == 0)
+		{
+			UARTprintf("Error: no nodes, run ATND first\n");
+			return 1;
+		}
+		if(ui32Used > 0xFFFF)
+		{
+			g_ui32SlotRole = SLOT_OFF;
+			UARTprintf("Error: too many nodes for the period field\n");
+			return 1;
+		}
+		UARTprintf("%u nodes, period %u ms, slots %u ms apart\n",
+		           g_ui32SlotNodes, ui32Used, ui32Used / g_ui32SlotNodes);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "stop")))
+	{
+		g_ui32SlotRole = SLOT_OFF;
+		return 0;
+	}
+	else if(((2 == argc) || (3 == argc)) &&
+	        (0 == strcmp(argv[1], "bench")))
+	{
+		ui32Period = (3 == argc) ? strtoul(argv[2], 0, 10) : 1000;
+		if((ui32Period == 0) || (ui32Period > 60000))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+
+		UARTprintf("nodes  free running       scheduled\n");
+		for(ui32Nodes = 8; ui32Nodes <= XBEE_SLOT_SIM_NODES; ui32Nodes *= 2)
+		{
+			ui32Used = ui32Period;
+			if((ui32Used / ui32Nodes) < XBEE_SLOT_MIN_MS)
+			{
+				ui32Used = ui32Nodes * XBEE_SLOT_MIN_MS;
+			}
+			ui32Free = XBeeSlotSimRun(ui32Nodes, ui32Period, false);
+			ui32Sched = XBeeSlotSimRun(ui32Nodes, ui32Used, true);
+			UARTprintf("%5u  %3u.%u%% %5u/s   %3u.%u%% %5u/s  period %u ms\n",
+			           ui32Nodes, ui32Free / 10, ui32Free % 10,
+			           (ui32Nodes * ui32Free) / ui32Period,
+			           ui32Sched / 10, ui32Sched % 10,
+			           (ui32Nodes * ui32Sched) / ui32Used, ui32Used);
+		}
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	if(g_ui32SlotRole == SLOT_COORDINATOR)
+	{
+		ui32Expected = g_sSlotStats.ui32Assigned *
+		               ((XBeeTickGet() - g_ui32SlotEpoch) / g_ui32SlotPeriod);
+		UARTprintf("coordinator: %u nodes, period %u ms, %u acknowledged, "
+		           "%u assignments failed\n", g_ui32SlotNodes,
+		           g_ui32SlotPeriod, g_sSlotStats.ui32Assigned,
+		           g_sSlotStats.ui32AssignFailed);
+		UARTprintf("beacons %u, samples %u of about %u, latest %u ms into "
+		           "a slot\n", g_sSlotStats.ui32Beacons,
+		           g_sSlotStats.ui32Samples, ui32Expected,
+		           g_sSlotStats.ui32LateMax);
+	}
+	else if(g_ui32SlotRole == SLOT_NODE)
+	{
+		UARTprintf("node: slot at %u ms of %u, coordinator %08x%08x\n",
+		           g_ui32SlotOffset, g_ui32SlotPeriod,
+		           (uint32_t)(g_ui64SlotCoordinator >> 32),
+		           (uint32_t)g_ui64SlotCoordinator);
+		UARTprintf("samples sent %u, beacon corrections %u, largest %u ms\n",
+		           g_sSlotStats.ui32Sent, g_sSlotStats.ui32Corrected,
+		           g_sSlotStats.ui32CorrectionMax);
+	}
+	else
+	{
+		UARTprintf("no schedule\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+//*****************************************************************************
+//
+// XBeeSlot.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEESLOT_H__
+#define __XBEESLOT_H__
+
+//*****************************************************************************
+//
+// Slot messages, API mode only. After the message header:
+//
+//   ASSIGN   coordinator to node: period (2), slot offset (2), ms into the
+//            cycle now (4)
+//   BEACON   coordinator broadcast: ms into the cycle now (4)
+//   SAMPLE   node to coordinator: sequence (2), ms after its slot
+//            started that the sample went out (2)
+//
+//*****************************************************************************
+#define XBEE_SLOT_ASSIGN_SIZE   (XBEE_MSG_HDR_SIZE + 8)
+#define XBEE_SLOT_BEACON_SIZE   (XBEE_MSG_HDR_SIZE + 4)
+#define XBEE_SLOT_SAMPLE_SIZE   (XBEE_MSG_HDR_SIZE + 4)
+
+//*****************************************************************************
+//
+// The coordinator beacons every XBEE_SLOT_BEACON_MS; a node's clock drifts
+// at most a few ms from it in that time. Slots are at least
+// XBEE_SLOT_MIN_MS wide (a sample frame, its retries and the drift), the
+// period is stretched if the nodes do not fit.
+//
+//*****************************************************************************
+#define XBEE_SLOT_BEACON_MS     10000
+#define XBEE_SLOT_MIN_MS        8
+
+//*****************************************************************************
+//
+// 'slot bench' simulation: up to XBEE_SLOT_SIM_NODES nodes for
+// XBEE_SLOT_SIM_CYCLES sampling periods. Free running nodes powered up
+// together start within XBEE_SLOT_SIM_SPREAD_MS of each other; every
+// clock is off by up to XBEE_SLOT_SIM_DRIFT_PPM.
+//
+//*****************************************************************************
+#define XBEE_SLOT_SIM_NODES     128
+#define XBEE_SLOT_SIM_CYCLES    30
+#define XBEE_SLOT_SIM_SPREAD_MS 20
+#define XBEE_SLOT_SIM_DRIFT_PPM 40
+
+//*****************************************************************************
+//
+// 802.15.4 unslotted CSMA-CA as the simulation runs it: backoff unit, the
+// window in which two nodes both find the channel clear, backoff exponents,
+// backoffs before a CCA failure and retries after a collision.
+//
+//*****************************************************************************
+#define XBEE_SLOT_SIM_UNIT_US   320
+#define XBEE_SLOT_SIM_CCA_US    320
+#define XBEE_SLOT_SIM_MIN_BE    3
+#define XBEE_SLOT_SIM_MAX_BE    5
+#define XBEE_SLOT_SIM_BACKOFFS  4
+#define XBEE_SLOT_SIM_RETRIES   3
+
+//*****************************************************************************
+//
+// Counters. The coordinator's expected count is what the assigned nodes
+// should have sent since the plan was pushed.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Assigned;              // nodes that acknowledged a slot
+	uint32_t ui32AssignFailed;          // assignments to be sent again
+	uint32_t ui32Beacons;
+	uint32_t ui32Samples;               // coordinator: received
+	uint32_t ui32LateMax;               // ms after the slot start
+	uint32_t ui32Sent;                  // node: samples sent
+	uint32_t ui32Corrected;             // node: beacons that moved the clock
+	uint32_t ui32CorrectionMax;         // ms
+}
+tXBeeSlotStats;
+
+//*****************************************************************************
+//
+// Sampling schedule functions
+//
+//*****************************************************************************
+extern void XBeeSlotMsg(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeSlotPoll(void);
+extern void XBeeSlotStatsGet(tXBeeSlotStats *psStats);
+extern int Cmd_slot(int argc, char *argv[]);
+
+#endif //__XBEESLOT_H__
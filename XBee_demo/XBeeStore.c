@@ -0,0 +1,987 @@
+//*****************************************************************************
+//
+// XBeeStore.c - Flash queue for messages while the link is down
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! In API mode a data message that the XBee could not deliver is gone, and
+//! while the link to the destination is down so is everything after it.
+//! With 'store on', XBEE_STORE_DOWN_FAILS failed deliveries in a row mark
+//! the link down and data messages are appended to a log in the internal
+//! flash instead of being sent, as the finished wire message (compressed,
+//! with its sequence number), so only the number has to be redone when they
+//! go out.
+//!
+//! The log runs through XBEE_STORE_SECTORS erase blocks in turn, so every
+//! block sees the same number of erases. A block is erased only once every
+//! message in it has been delivered, and the next block is taken when one
+//! is full. RAM holds only the write, send and delivered positions and the
+//! batches in flight. When a batch is delivered the delivered word of its
+//! last record is programmed (1 to 0, no erase), so after a reset the
+//! positions are found again from the block headers and those marks, and
+//! only what was not yet delivered goes out. A batch in flight at the reset
+//! goes again with new numbers, and may arrive twice.
+//!
+//! While down the oldest messages are sent every XBEE_STORE_PROBE_MS. When
+//! they get through, the queue drains as fast as the transmit window
+//! allows: as many stored messages as fit in a transmit request go in one
+//! batch message, unpacked and dispatched one by one on the other side.
+//! New messages queue behind the backlog until it is empty, so they arrive
+//! in order.
+//!
+//! Stored messages are numbered (XBeeDup.c) when they are first sent, not
+//! when stored: other messages sent in the meantime would otherwise leave
+//! the whole backlog behind the receiver's window. A failed batch goes
+//! again on its own, with the same numbers, while later batches stay in
+//! flight, and no batch is started that would take the numbers in flight
+//! wider than XBEE_DUP_WINDOW. So a batch that had arrived after all is
+//! dropped by the receiver. Only if other messages have since moved the
+//! numbering on past the window does it get new ones. XBEE_STORE_DOWN_FAILS
+//! failures in a row mark the link down again.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/flash.h"
+#include "driverlib/rom.h"
+#include "utils/uartstdio.h"
+#include "XBeeTick.h"
+#include "XBeeSched.h"
+#include "XBeeLink.h"
+#include "XBeeTx.h"
+#include "XBeeIdle.h"
+#include "XBeeDup.h"
+#include "XBeeStore.h"
+
+//*****************************************************************************
+//
+// Probes repeat a batch that may have arrived already, with the sequence
+// numbers it first went out with. The receiver only drops it while it
+// still remembers this source.
+//
+//*****************************************************************************
+#if XBEE_STORE_PROBE_MS > XBEE_DUP_RETRY_MS
+#error "XBEE_STORE_PROBE_MS is longer than XBEE_DUP_RETRY_MS"
+#endif
+
+//*****************************************************************************
+//
+// Flash contents at offset o into the queue
+//
+//*****************************************************************************
+#define STORE_WORD(o)           (*(const uint32_t *)(uintptr_t)              \
+                                 (XBEE_STORE_BASE + (o)))
+#define STORE_DATA(o)           ((const uint8_t *)(uintptr_t)                \
+                                 (XBEE_STORE_BASE + (o)))
+#define STORE_SECTOR(s)         (((s) % XBEE_STORE_SECTORS) *                \
+                                 XBEE_STORE_SECTOR_SIZE)
+
+//*****************************************************************************
+//
+// A batch in flight: its serial number, which comes back in the transmit
+// status, its first and last record, where it ends, what it holds, the
+// first sequence number it went out with and whether it is waiting for
+// its status, delivered or to be sent again
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Serial;
+	uint32_t ui32First;
+	uint32_t ui32Last;
+	uint32_t ui32End;
+	uint16_t ui16Msgs;
+	uint16_t ui16Bytes;
+	uint16_t ui16Seq;
+	uint8_t ui8State;
+}
+tXBeeStoreBatch;
+
+#define STORE_BATCH_SENT        0
+#define STORE_BATCH_DONE        1
+#define STORE_BATCH_FAILED      2
+
+//*****************************************************************************
+//
+// Queue positions, offsets from XBEE_STORE_BASE: the next record written,
+// the next sent and the oldest not yet delivered
+//
+//*****************************************************************************
+static uint32_t g_ui32StoreHead;
+static uint32_t g_ui32StoreSend;
+static uint32_t g_ui32StoreTail;
+static bool g_bStoreOpen;
+static uint32_t g_ui32StoreSeq;
+static uint32_t g_ui32StoreMsgs;
+static uint32_t g_ui32StoreBytes;
+
+//*****************************************************************************
+//
+// Link state, batches in flight (oldest first) and the drain under way
+//
+//*****************************************************************************
+static bool g_bStoreOn;
+static bool g_bStoreDown;
+static uint32_t g_ui32StoreFails;
+static uint32_t g_ui32StoreProbe;
+static tXBeeStoreBatch g_psStoreBatch[XBEE_STORE_INFLIGHT];
+static uint32_t g_ui32StoreBatches;
+static uint32_t g_ui32StoreSerial;
+static bool g_bStoreDraining;
+static uint32_t g_ui32StoreDrainStart;
+static uint32_t g_ui32StoreDrainMsgs;
+static uint32_t g_ui32StoreDrainBytes;
+static tXBeeStoreStats g_sStoreStats;
+
+//*****************************************************************************
+//
+// Flash taken by a record holding ui32Len bytes.
+//
+//*****************************************************************************
+static uint32_t
+XBeeStoreRecordSize(uint32_t ui32Len)
+{
+	return XBEE_STORE_REC_HDR + ((ui32Len + 3) & ~3);
+}
+
+//*****************************************************************************
+//
+// Length of the message in the record at ui32Pos, or 0 if there is no
+// intact record there. A record never takes the last word of its block.
+//
+//*****************************************************************************
+static uint32_t
+XBeeStoreRecordLen(uint32_t ui32Pos)
+{
+	const uint8_t *pui8Data;
+	uint32_t ui32Word;
+	uint32_t ui32Len;
+	uint32_t ui32Sum;
+	uint32_t ui32Idx;
+
+	ui32Word = STORE_WORD(ui32Pos);
+	ui32Len = ui32Word & 0xFFFF;
+	if(((ui32Word & 0xFF000000) != XBEE_STORE_RECORD) ||
+	   (ui32Len < XBEE_MSG_HDR_SIZE) || (ui32Len > XBEE_TX_MAX_PAYLOAD) ||
+	   (((ui32Pos % XBEE_STORE_SECTOR_SIZE) + XBeeStoreRecordSize(ui32Len)) >
+	    (XBEE_STORE_SECTOR_SIZE - 4)))
+	{
+		return 0;
+	}
+
+	pui8Data = STORE_DATA(ui32Pos + XBEE_STORE_REC_HDR);
+	ui32Sum = 0;
+	for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+	{
+		ui32Sum += pui8Data[ui32Idx];
+	}
+
+	return (((ui32Word >> 16) & 0xFF) == (ui32Sum & 0xFF)) ? ui32Len : 0;
+}
+
+//*****************************************************************************
+//
+// Where the record after the end of a block's records starts: the first in
+// the next block. The write position is never skipped.
+//
+//*****************************************************************************
+static uint32_t
+XBeeStoreSkip(uint32_t ui32Pos)
+{
+	if((ui32Pos != g_ui32StoreHead) && (XBeeStoreRecordLen(ui32Pos) == 0))
+	{
+		ui32Pos = STORE_SECTOR((ui32Pos / XBEE_STORE_SECTOR_SIZE) + 1) +
+		          XBEE_STORE_SECTOR_HDR;
+	}
+
+	return ui32Pos;
+}
+
+//*****************************************************************************
+//
+// Erase block ui32Sector unless it is blank already.
+//
+//*****************************************************************************
+static void
+XBeeStoreErase(uint32_t ui32Sector)
+{
+	uint32_t ui32Pos;
+
+	for(ui32Pos = STORE_SECTOR(ui32Sector);
+	    ui32Pos < (STORE_SECTOR(ui32Sector) + XBEE_STORE_SECTOR_SIZE);
+	    ui32Pos += 4)
+	{
+		if(STORE_WORD(ui32Pos) != 0xFFFFFFFF)
+		{
+			ROM_FlashErase(XBEE_STORE_BASE + STORE_SECTOR(ui32Sector));
+			g_sStoreStats.ui32Erases++;
+			return;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Mark the record at ui32Pos, and with it everything before it, delivered.
+//
+//*****************************************************************************
+static void
+XBeeStoreMark(uint32_t ui32Pos)
+{
+	uint32_t ui32Word;
+
+	ui32Word = XBEE_STORE_DELIVERED;
+	ROM_FlashProgram(&ui32Word, XBEE_STORE_BASE + ui32Pos + 4, 4);
+}
+
+//*****************************************************************************
+//
+// True if the flash from ui32Pos to the end of its block is erased.
+//
+//*****************************************************************************
+static bool
+XBeeStoreBlank(uint32_t ui32Pos)
+{
+	for(; (ui32Pos % XBEE_STORE_SECTOR_SIZE) != 0; ui32Pos += 4)
+	{
+		if(STORE_WORD(ui32Pos) != 0xFFFFFFFF)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Start writing in block ui32Sector.
+//
+//*****************************************************************************
+static void
+XBeeStoreOpen(uint32_t ui32Sector)
+{
+	uint32_t pui32Hdr[2];
+
+	XBeeStoreErase(ui32Sector);
+	pui32Hdr[0] = XBEE_STORE_MAGIC;
+	pui32Hdr[1] = g_ui32StoreSeq++;
+	ROM_FlashProgram(pui32Hdr, XBEE_STORE_BASE + STORE_SECTOR(ui32Sector),
+	                 sizeof(pui32Hdr));
+
+	g_ui32StoreHead = STORE_SECTOR(ui32Sector) + XBEE_STORE_SECTOR_HDR;
+	g_bStoreOpen = true;
+}
+
+//*****************************************************************************
+//
+// Everything before ui32Pos has been delivered. Blocks left behind are
+// erased.
+//
+//*****************************************************************************
+static void
+XBeeStoreConsume(uint32_t ui32Pos)
+{
+	while((g_ui32StoreTail / XBEE_STORE_SECTOR_SIZE) !=
+	      (ui32Pos / XBEE_STORE_SECTOR_SIZE))
+	{
+		XBeeStoreErase(g_ui32StoreTail / XBEE_STORE_SECTOR_SIZE);
+		g_ui32StoreTail = STORE_SECTOR((g_ui32StoreTail /
+		                                XBEE_STORE_SECTOR_SIZE) + 1) +
+		                  XBEE_STORE_SECTOR_HDR;
+	}
+	g_ui32StoreTail = ui32Pos;
+}
+
+//*****************************************************************************
+//
+// Append a message to the log. Returns false if the queue is full.
+//
+//*****************************************************************************
+static bool
+XBeeStoreAppend(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t pui32Rec[(XBEE_STORE_REC_HDR + XBEE_TX_MAX_PAYLOAD + 3) / 4];
+	uint32_t ui32Size;
+	uint32_t ui32Sum;
+	uint32_t ui32Next;
+	uint32_t ui32Idx;
+	bool bEmpty;
+
+	ui32Size = XBeeStoreRecordSize(ui32Len);
+	bEmpty = (g_ui32StoreTail == g_ui32StoreHead);
+
+	if(!g_bStoreOpen)
+	{
+		XBeeStoreOpen(g_ui32StoreHead / XBEE_STORE_SECTOR_SIZE);
+	}
+	else if(((g_ui32StoreHead % XBEE_STORE_SECTOR_SIZE) + ui32Size) >
+	        (XBEE_STORE_SECTOR_SIZE - 4))
+	{
+		ui32Next = ((g_ui32StoreHead / XBEE_STORE_SECTOR_SIZE) + 1) %
+		           XBEE_STORE_SECTORS;
+		if(ui32Next == (g_ui32StoreTail / XBEE_STORE_SECTOR_SIZE))
+		{
+			return false;
+		}
+		XBeeStoreOpen(ui32Next);
+	}
+
+	//
+	// Nothing left behind the write position to send or deliver
+	//
+	if(bEmpty)
+	{
+		XBeeStoreConsume(g_ui32StoreHead);
+		g_ui32StoreSend = g_ui32StoreHead;
+	}
+
+	ui32Sum = 0;
+	for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+	{
+		ui32Sum += pui8Msg[ui32Idx];
+	}
+	pui32Rec[0] = XBEE_STORE_RECORD | ((ui32Sum & 0xFF) << 16) | ui32Len;
+	pui32Rec[1] = 0xFFFFFFFF;
+	pui32Rec[(ui32Size / 4) - 1] = 0;
+	memcpy(&pui32Rec[2], pui8Msg, ui32Len);
+	ROM_FlashProgram(pui32Rec, XBEE_STORE_BASE + g_ui32StoreHead, ui32Size);
+
+	g_ui32StoreHead += ui32Size;
+	g_ui32StoreMsgs++;
+	g_ui32StoreBytes += ui32Len;
+	g_sStoreStats.ui32Stored++;
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Stop sending, the link is down. Batches in flight keep their place; the
+// oldest failed one is what the probes send.
+//
+//*****************************************************************************
+static void
+XBeeStoreLinkDown(void)
+{
+	if(!g_bStoreDown)
+	{
+		g_bStoreDown = true;
+		g_sStoreStats.ui32Downs++;
+		g_ui32StoreProbe = XBeeTickGet() + XBEE_STORE_PROBE_MS;
+	}
+	g_ui32StoreFails = 0;
+}
+
+//*****************************************************************************
+//
+// Transmit status of a batch, pvArg is its serial number.
+//
+//*****************************************************************************
+static void
+XBeeStoreBatchDone(void *pvArg, uint8_t ui8FrameId, uint32_t ui32Result,
+                   uint32_t ui32Retries)
+{
+	tXBeeStoreBatch *psBatch;
+	uint32_t ui32Idx;
+
+	for(ui32Idx = 0; ui32Idx < g_ui32StoreBatches; ui32Idx++)
+	{
+		if(g_psStoreBatch[ui32Idx].ui32Serial == (uint32_t)(uintptr_t)pvArg)
+		{
+			break;
+		}
+	}
+	if(ui32Idx == g_ui32StoreBatches)
+	{
+		//
+		// Forgotten by 'store off' or 'store clear'
+		//
+		return;
+	}
+
+	//
+	// Send this one again, the rest stay in flight; failures in a row, or
+	// any while probing, mean the link is down
+	//
+	if(ui32Result != XBEE_TX_SUCCESS)
+	{
+		g_sStoreStats.ui32Failed++;
+		g_psStoreBatch[ui32Idx].ui8State = STORE_BATCH_FAILED;
+		if(g_bStoreDown || (++g_ui32StoreFails >= XBEE_STORE_DOWN_FAILS))
+		{
+			XBeeStoreLinkDown();
+		}
+		return;
+	}
+	g_ui32StoreFails = 0;
+
+	if(g_bStoreDown || !g_bStoreDraining)
+	{
+		g_bStoreDown = false;
+		g_bStoreDraining = true;
+		g_ui32StoreDrainStart = XBeeTickGet();
+		g_ui32StoreDrainMsgs = 0;
+		g_ui32StoreDrainBytes = 0;
+	}
+
+	//
+	// Delivered in order up to the oldest still in flight
+	//
+	g_psStoreBatch[ui32Idx].ui8State = STORE_BATCH_DONE;
+	while(g_ui32StoreBatches &&
+	      (g_psStoreBatch[0].ui8State == STORE_BATCH_DONE))
+	{
+		psBatch = &g_psStoreBatch[0];
+		XBeeStoreMark(psBatch->ui32Last);
+		XBeeStoreConsume(psBatch->ui32End);
+		g_ui32StoreMsgs -= psBatch->ui16Msgs;
+		g_ui32StoreBytes -= psBatch->ui16Bytes;
+		g_sStoreStats.ui32Delivered += psBatch->ui16Msgs;
+		g_ui32StoreDrainMsgs += psBatch->ui16Msgs;
+		g_ui32StoreDrainBytes += psBatch->ui16Bytes;
+
+		g_ui32StoreBatches--;
+		memmove(&g_psStoreBatch[0], &g_psStoreBatch[1],
+		        g_ui32StoreBatches * sizeof(g_psStoreBatch[0]));
+	}
+
+	if(g_ui32StoreMsgs == 0)
+	{
+		g_bStoreDraining = false;
+		g_sStoreStats.ui32DrainMsgs = g_ui32StoreDrainMsgs;
+		g_sStoreStats.ui32DrainBytes = g_ui32StoreDrainBytes;
+		g_sStoreStats.ui32DrainMs = XBeeTickGet() - g_ui32StoreDrainStart;
+	}
+}
+
+//*****************************************************************************
+//
+// True if the stored message at pui8Msg carries a sequence number.
+//
+//*****************************************************************************
+static bool
+XBeeStoreNumbered(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	return XBEE_MSG_IS_LINK(pui8Msg[0]) && (pui8Msg[1] & XBEE_MSG_FLAG_SEQ) &&
+	       (ui32Len >= (XBEE_MSG_HDR_SIZE + XBEE_DUP_SEQ_SIZE));
+}
+
+//*****************************************************************************
+//
+// The oldest batch in flight in state ui8State, 0 if there is none.
+//
+//*****************************************************************************
+static tXBeeStoreBatch *
+XBeeStoreFind(uint8_t ui8State)
+{
+	uint32_t ui32Idx;
+
+	for(ui32Idx = 0; ui32Idx < g_ui32StoreBatches; ui32Idx++)
+	{
+		if(g_psStoreBatch[ui32Idx].ui8State == ui8State)
+		{
+			return &g_psStoreBatch[ui32Idx];
+		}
+	}
+
+	return 0;
+}
+
+//*****************************************************************************
+//
+// Send psBatch again, or if it is 0 the messages from the send position on
+// that fit one transmit request, a single one as it is. Each message is
+// numbered as it goes. Returns false if nothing was sent.
+//
+//*****************************************************************************
+static bool
+XBeeStoreSendBatch(tXBeeStoreBatch *psBatch)
+{
+	uint8_t pui8Batch[XBEE_TX_MAX_PAYLOAD];
+	const uint8_t *pui8Data;
+	uint32_t ui32First;
+	uint32_t ui32Last;
+	uint32_t ui32Pos;
+	uint32_t ui32Stop;
+	uint32_t ui32Len;
+	uint32_t ui32Fill;
+	uint32_t ui32Msgs;
+	uint32_t ui32Bytes;
+	uint32_t ui32Numbered;
+	uint16_t ui16Next;
+	uint16_t ui16Seq;
+	bool bNumbered;
+
+	//
+	// A batch goes again with the numbers it had, unless messages sent
+	// since have taken the receiver's window past them
+	//
+	ui16Next = XBeeDupSeqTake(0);
+	if(psBatch)
+	{
+		ui32Pos = psBatch->ui32First;
+		ui32Stop = psBatch->ui32End;
+		ui16Seq = psBatch->ui16Seq;
+		if((uint16_t)(ui16Next - ui16Seq) > XBEE_DUP_WINDOW)
+		{
+			ui16Seq = ui16Next;
+		}
+	}
+	else
+	{
+		ui32Pos = g_ui32StoreSend;
+		ui32Stop = g_ui32StoreHead;
+		ui16Seq = ui16Next;
+	}
+
+	pui8Batch[0] = XBEE_MSG_STORE_BATCH;
+	pui8Batch[1] = 0;
+	ui32Fill = XBEE_MSG_HDR_SIZE;
+	ui32Msgs = 0;
+	ui32Bytes = 0;
+	ui32Numbered = 0;
+	ui32First = ui32Pos;
+	ui32Last = ui32Pos;
+
+	while(ui32Pos != ui32Stop)
+	{
+		//
+		// A record cut short by a reset ends its block
+		//
+		ui32Len = XBeeStoreRecordLen(ui32Pos);
+		if(ui32Len == 0)
+		{
+			ui32Pos = XBeeStoreSkip(ui32Pos);
+			continue;
+		}
+		if(ui32Msgs == 0)
+		{
+			ui32First = ui32Pos;
+		}
+		if(ui32Msgs && ((ui32Fill + 1 + ui32Len) > XBEE_TX_MAX_PAYLOAD))
+		{
+			break;
+		}
+
+		//
+		// A new batch keeps every number in flight inside the receiver's
+		// window, so that any batch can still go again
+		//
+		bNumbered = XBeeStoreNumbered(STORE_DATA(ui32Pos + XBEE_STORE_REC_HDR),
+		                              ui32Len);
+		if(!psBatch && bNumbered && g_ui32StoreBatches &&
+		   ((uint16_t)(ui16Seq + ui32Numbered - g_psStoreBatch[0].ui16Seq) >=
+		    XBEE_DUP_WINDOW))
+		{
+			break;
+		}
+
+		if((ui32Fill + 1 + ui32Len) <= XBEE_TX_MAX_PAYLOAD)
+		{
+			pui8Batch[ui32Fill] = ui32Len;
+			memcpy(&pui8Batch[ui32Fill + 1],
+			       STORE_DATA(ui32Pos + XBEE_STORE_REC_HDR), ui32Len);
+			if(bNumbered)
+			{
+				XBEE_PUT16(&pui8Batch[ui32Fill + 1 + ui32Len -
+				                      XBEE_DUP_SEQ_SIZE],
+				           ui16Seq + ui32Numbered);
+			}
+		}
+		ui32Numbered += bNumbered;
+		ui32Fill += 1 + ui32Len;
+		ui32Msgs++;
+		ui32Bytes += ui32Len;
+		ui32Last = ui32Pos;
+		ui32Pos = XBeeStoreSkip(ui32Pos + XBeeStoreRecordSize(ui32Len));
+	}
+	if(ui32Msgs == 0)
+	{
+		return false;
+	}
+
+	pui8Data = pui8Batch;
+	ui32Len = ui32Fill;
+	if(ui32Msgs == 1)
+	{
+		memcpy(pui8Batch, STORE_DATA(ui32First + XBEE_STORE_REC_HDR),
+		       ui32Bytes);
+		if(ui32Numbered)
+		{
+			XBEE_PUT16(&pui8Batch[ui32Bytes - XBEE_DUP_SEQ_SIZE], ui16Seq);
+		}
+		ui32Len = ui32Bytes;
+	}
+	if(XBeeTxSend(XBeeLinkDestGet(), XBEE_SCHED_DATA, pui8Data, ui32Len,
+	              XBeeStoreBatchDone,
+	              (void *)(uintptr_t)g_ui32StoreSerial) == 0)
+	{
+		return false;
+	}
+	if(ui16Seq == ui16Next)
+	{
+		XBeeDupSeqTake(ui32Numbered);
+	}
+
+	if(!psBatch)
+	{
+		psBatch = &g_psStoreBatch[g_ui32StoreBatches++];
+		psBatch->ui32First = ui32First;
+		psBatch->ui32Last = ui32Last;
+		psBatch->ui32End = ui32Pos;
+		psBatch->ui16Msgs = ui32Msgs;
+		psBatch->ui16Bytes = ui32Bytes;
+		g_ui32StoreSend = ui32Pos;
+	}
+	psBatch->ui32Serial = g_ui32StoreSerial++;
+	psBatch->ui16Seq = ui16Seq;
+	psBatch->ui8State = STORE_BATCH_SENT;
+	g_sStoreStats.ui32Batches++;
+
+	return true;
+}
+
+//*****************************************************************************
+//
+// Find the queue left in flash before a reset. Call once at start up; if
+// messages are waiting the queue is turned on to deliver them.
+//
+//*****************************************************************************
+void
+XBeeStoreInit(void)
+{
+	uint32_t ui32Sector;
+	uint32_t ui32Oldest;
+	uint32_t ui32Newest;
+	uint32_t ui32Tail;
+	uint32_t ui32Pos;
+	uint32_t ui32Len;
+	bool bFound;
+
+	bFound = false;
+	ui32Oldest = 0;
+	ui32Newest = 0;
+	for(ui32Sector = 0; ui32Sector < XBEE_STORE_SECTORS; ui32Sector++)
+	{
+		if(STORE_WORD(STORE_SECTOR(ui32Sector)) != XBEE_STORE_MAGIC)
+		{
+			continue;
+		}
+		ui32Pos = STORE_WORD(STORE_SECTOR(ui32Sector) + 4);
+		if(!bFound || (ui32Pos < STORE_WORD(STORE_SECTOR(ui32Oldest) + 4)))
+		{
+			ui32Oldest = ui32Sector;
+		}
+		if(!bFound || (ui32Pos >= g_ui32StoreSeq))
+		{
+			ui32Newest = ui32Sector;
+			g_ui32StoreSeq = ui32Pos + 1;
+		}
+		bFound = true;
+	}
+
+	g_ui32StoreTail = STORE_SECTOR(ui32Oldest) + XBEE_STORE_SECTOR_HDR;
+	g_ui32StoreHead = g_ui32StoreTail;
+	g_ui32StoreSend = g_ui32StoreTail;
+	if(!bFound)
+	{
+		return;
+	}
+
+	//
+	// Count what is left, block by block up to the one written last. What
+	// is not yet delivered starts after the last record marked delivered.
+	//
+	ui32Tail = g_ui32StoreTail;
+	ui32Sector = ui32Oldest;
+	while(1)
+	{
+		ui32Pos = STORE_SECTOR(ui32Sector) + XBEE_STORE_SECTOR_HDR;
+		while((ui32Len = XBeeStoreRecordLen(ui32Pos)) != 0)
+		{
+			if(STORE_WORD(ui32Pos + 4) == XBEE_STORE_DELIVERED)
+			{
+				ui32Tail = ui32Pos + XBeeStoreRecordSize(ui32Len);
+				g_ui32StoreMsgs = 0;
+				g_ui32StoreBytes = 0;
+			}
+			else
+			{
+				g_ui32StoreMsgs++;
+				g_ui32StoreBytes += ui32Len;
+			}
+			ui32Pos += XBeeStoreRecordSize(ui32Len);
+		}
+		if(ui32Sector == ui32Newest)
+		{
+			break;
+		}
+		ui32Sector = (ui32Sector + 1) % XBEE_STORE_SECTORS;
+	}
+	g_ui32StoreHead = ui32Pos;
+	g_bStoreOpen = true;
+	XBeeStoreConsume(ui32Tail);
+	g_ui32StoreSend = g_ui32StoreTail;
+
+	//
+	// Only erased flash is written. A record cut short by the reset ends
+	// its block; if the next one still holds messages the queue is full and
+	// the oldest block of them is dropped to make room.
+	//
+	if(!XBeeStoreBlank(ui32Pos))
+	{
+		ui32Sector = (ui32Newest + 1) % XBEE_STORE_SECTORS;
+		if(ui32Sector == (g_ui32StoreTail / XBEE_STORE_SECTOR_SIZE))
+		{
+			ui32Pos = g_ui32StoreTail;
+			while((ui32Len = XBeeStoreRecordLen(ui32Pos)) != 0)
+			{
+				g_ui32StoreMsgs--;
+				g_ui32StoreBytes -= ui32Len;
+				g_sStoreStats.ui32Dropped++;
+				ui32Pos += XBeeStoreRecordSize(ui32Len);
+			}
+			g_ui32StoreTail = STORE_SECTOR(ui32Sector + 1) +
+			                  XBEE_STORE_SECTOR_HDR;
+			g_ui32StoreSend = g_ui32StoreTail;
+		}
+		XBeeStoreOpen(ui32Sector);
+	}
+
+	g_bStoreOn = (g_ui32StoreMsgs != 0);
+}
+
+//*****************************************************************************
+//
+// Called by XBeeLinkOut() with a finished data message in API mode. Takes
+// it into the queue while the link is down or a backlog is draining, and
+// returns true if it did and the message must not be sent.
+//
+//*****************************************************************************
+bool
+XBeeStoreHold(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	if(!g_bStoreOn || (ui32Len > XBEE_TX_MAX_PAYLOAD) ||
+	   (!g_bStoreDown && (g_ui32StoreMsgs == 0)))
+	{
+		return false;
+	}
+
+	if(XBeeStoreAppend(pui8Msg, ui32Len))
+	{
+		return true;
+	}
+
+	//
+	// Full. Still worth a try if the link is up.
+	//
+	if(!g_bStoreDown)
+	{
+		return false;
+	}
+	g_sStoreStats.ui32Dropped++;
+	return true;
+}
+
+//*****************************************************************************
+//
+// Transmit status of a data message sent directly. Failures in a row mark
+// the link down.
+//
+//*****************************************************************************
+void
+XBeeStoreResult(void *pvArg, uint8_t ui8FrameId, uint32_t ui32Result,
+                uint32_t ui32Retries)
+{
+	if(!g_bStoreOn)
+	{
+		return;
+	}
+
+	if(ui32Result == XBEE_TX_SUCCESS)
+	{
+		g_ui32StoreFails = 0;
+	}
+	else if(++g_ui32StoreFails >= XBEE_STORE_DOWN_FAILS)
+	{
+		XBeeStoreLinkDown();
+	}
+}
+
+//*****************************************************************************
+//
+// Called from XBeeLinkPoll(). Probes while the link is down, otherwise
+// sends failed batches again and keeps the transmit window full of new
+// ones until the queue is empty.
+//
+//*****************************************************************************
+void
+XBeeStorePoll(void)
+{
+	tXBeeStoreBatch *psBatch;
+	uint32_t ui32Now;
+
+	if(!g_bStoreOn || !XBeeLinkApi() || (g_ui32StoreMsgs == 0))
+	{
+		return;
+	}
+
+	if(g_bStoreDown)
+	{
+		ui32Now = XBeeTickGet();
+		if(!XBeeStoreFind(STORE_BATCH_SENT) &&
+		   XBEE_TICK_REACHED(ui32Now, g_ui32StoreProbe))
+		{
+			if(XBeeTxReady(XBeeLinkDestGet()) &&
+			   XBeeStoreSendBatch(XBeeStoreFind(STORE_BATCH_FAILED)))
+			{
+				g_sStoreStats.ui32Probes++;
+			}
+			g_ui32StoreProbe = ui32Now + XBEE_STORE_PROBE_MS;
+		}
+		XBeeIdleDeadline(g_ui32StoreProbe);
+		return;
+	}
+
+	while((psBatch = XBeeStoreFind(STORE_BATCH_FAILED)) != 0)
+	{
+		if(!XBeeTxReady(XBeeLinkDestGet()) || !XBeeStoreSendBatch(psBatch))
+		{
+			return;
+		}
+	}
+	while((g_ui32StoreBatches < XBEE_STORE_INFLIGHT) &&
+	      (g_ui32StoreSend != g_ui32StoreHead) &&
+	      XBeeTxReady(XBeeLinkDestGet()) && XBeeStoreSendBatch(0))
+	{
+	}
+}
+
+//*****************************************************************************
+//
+// Empty the queue and erase every block.
+//
+//*****************************************************************************
+static void
+XBeeStoreClear(void)
+{
+	uint32_t ui32Sector;
+
+	for(ui32Sector = 0; ui32Sector < XBEE_STORE_SECTORS; ui32Sector++)
+	{
+		XBeeStoreErase(ui32Sector);
+	}
+
+	g_ui32StoreHead = XBEE_STORE_SECTOR_HDR;
+	g_ui32StoreSend = g_ui32StoreHead;
+	g_ui32StoreTail = g_ui32StoreHead;
+	g_bStoreOpen = false;
+	g_ui32StoreMsgs = 0;
+	g_ui32StoreBytes = 0;
+	g_ui32StoreBatches = 0;
+	g_bStoreDraining = false;
+}
+
+void
+XBeeStoreStatsGet(tXBeeStoreStats *psStats)
+{
+	*psStats = g_sStoreStats;
+}
+
+//*****************************************************************************
+//
+// Store Command
+// Input: none / 'on' / 'off' / 'clear'
+// Response: link state, queue depth and what the last drain took
+// Use: 'on' keeps data messages in flash while the link to the destination
+//		is down (API mode) and sends them when it is back. 'off' sends
+//		everything directly again, leaving any backlog in flash until the
+//		next 'on'. 'clear' throws the queue away. 'tx sim' with a high
+//		error rate takes the link down without touching the radio.
+//
+//*****************************************************************************
+int
+Cmd_store(int argc, char *argv[])
+{
+	uint32_t ui32Blocks;
+	uint32_t ui32Ms;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "on")))
+	{
+		g_bStoreOn = true;
+		g_bStoreDown = false;
+		g_ui32StoreFails = 0;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "off")))
+	{
+		g_bStoreOn = false;
+		g_ui32StoreBatches = 0;
+		g_ui32StoreSend = g_ui32StoreTail;
+		g_bStoreDraining = false;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeStoreClear();
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	ui32Blocks = g_ui32StoreMsgs ?
+	             ((((g_ui32StoreHead / XBEE_STORE_SECTOR_SIZE) +
+	                XBEE_STORE_SECTORS -
+	                (g_ui32StoreTail / XBEE_STORE_SECTOR_SIZE)) %
+	               XBEE_STORE_SECTORS) + 1) : 0;
+
+	UARTprintf("store %s, link %s, %u messages (%u bytes) in %u of %u "
+	           "blocks\n", g_bStoreOn ? "on" : "off",
+	           g_bStoreDown ? "down" : "up", g_ui32StoreMsgs, g_ui32StoreBytes,
+	           ui32Blocks, XBEE_STORE_SECTORS);
+	UARTprintf("stored %u, dropped %u, delivered %u in %u batches, %u "
+	           "failed\n", g_sStoreStats.ui32Stored, g_sStoreStats.ui32Dropped,
+	           g_sStoreStats.ui32Delivered, g_sStoreStats.ui32Batches,
+	           g_sStoreStats.ui32Failed);
+	UARTprintf("link down %u times, %u probes, %u erases (%u per block)\n",
+	           g_sStoreStats.ui32Downs, g_sStoreStats.ui32Probes,
+	           g_sStoreStats.ui32Erases,
+	           g_sStoreStats.ui32Erases / XBEE_STORE_SECTORS);
+
+	if(g_bStoreDraining)
+	{
+		ui32Ms = XBeeTickGet() - g_ui32StoreDrainStart;
+		UARTprintf("draining for %u ms, %u messages, %u bytes/s\n", ui32Ms,
+		           g_ui32StoreDrainMsgs,
+		           ui32Ms ? ((g_ui32StoreDrainBytes * 1000) / ui32Ms) : 0);
+	}
+	else if(g_sStoreStats.ui32DrainMsgs)
+	{
+		ui32Ms = g_sStoreStats.ui32DrainMs ? g_sStoreStats.ui32DrainMs : 1;
+		UARTprintf("last drain %u messages, %u bytes in %u ms: %u msg/s, "
+		           "%u bytes/s\n", g_sStoreStats.ui32DrainMsgs,
+		           g_sStoreStats.ui32DrainBytes, g_sStoreStats.ui32DrainMs,
+		           (g_sStoreStats.ui32DrainMsgs * 1000) / ui32Ms,
+		           (g_sStoreStats.ui32DrainBytes * 1000) / ui32Ms);
+	}
+
+	return 0;
+}
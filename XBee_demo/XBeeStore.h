@@ -0,0 +1,96 @@
+//*****************************************************************************
+//
+// XBeeStore.h - Headers for use with XBeeQual.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+
+#ifndef __XBEESTORE_H__
+#define __XBEESTORE_H__
+
+//*****************************************************************************
+//
+// The queue is a log in the top 32KB of the 256KB flash, well clear of the
+// program image, in 1KB erase blocks used in turn. Each block starts with
+// XBEE_STORE_MAGIC and the number of blocks opened before it, so the oldest
+// can be found after a reset.
+//
+//*****************************************************************************
+#define XBEE_STORE_BASE         0x00038000
+#define XBEE_STORE_SECTOR_SIZE  1024
+#define XBEE_STORE_SECTORS      32
+#define XBEE_STORE_SIZE         (XBEE_STORE_SECTOR_SIZE * XBEE_STORE_SECTORS)
+#define XBEE_STORE_MAGIC        0x58425352
+#define XBEE_STORE_SECTOR_HDR   8
+
+//*****************************************************************************
+//
+// Records follow the block header, word aligned: one word of
+// XBEE_STORE_RECORD, the sum of the message bytes and the length, a word
+// left erased until the record is the last of a delivered batch, when it
+// is programmed to XBEE_STORE_DELIVERED, then the message as it would have
+// gone out. A block always ends in at least one erased word.
+//
+//*****************************************************************************
+#define XBEE_STORE_RECORD       0x5A000000
+#define XBEE_STORE_DELIVERED    0
+#define XBEE_STORE_REC_HDR      8
+
+//*****************************************************************************
+//
+// XBEE_STORE_DOWN_FAILS data messages in a row without delivery mean the
+// link is down. While it is, the oldest stored messages are sent every
+// XBEE_STORE_PROBE_MS; once they get through the rest follow, packed into
+// batch messages with up to XBEE_STORE_INFLIGHT of them in flight.
+//
+//*****************************************************************************
+#define XBEE_STORE_DOWN_FAILS   2
+#define XBEE_STORE_PROBE_MS     2000
+#define XBEE_STORE_INFLIGHT     4
+
+//*****************************************************************************
+//
+// Counters. The drain figures are for the last time the queue emptied
+// after the link came back.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Stored;
+	uint32_t ui32Dropped;               // queue full
+	uint32_t ui32Delivered;
+	uint32_t ui32Batches;
+	uint32_t ui32Failed;                // batches not delivered, sent again
+	uint32_t ui32Downs;
+	uint32_t ui32Probes;
+	uint32_t ui32Erases;
+	uint32_t ui32DrainMsgs;
+	uint32_t ui32DrainBytes;
+	uint32_t ui32DrainMs;
+}
+tXBeeStoreStats;
+
+//*****************************************************************************
+//
+// Store and forward functions
+//
+//*****************************************************************************
+extern void XBeeStoreInit(void);
+extern bool XBeeStoreHold(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeStoreResult(void *pvArg, uint8_t ui8FrameId,
+                            uint32_t ui32Result, uint32_t ui32Retries);
+extern void XBeeStorePoll(void);
+extern void XBeeStoreStatsGet(tXBeeStoreStats *psStats);
+extern int Cmd_store(int argc, char *argv[]);
+
+#endif //__XBEESTORE_H__
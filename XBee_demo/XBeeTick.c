@@ -0,0 +1,237 @@
+//*****************************************************************************
+//
+// XBeeTick.c - Millisecond time base and cycle counter
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "driverlib/cpu.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "XBeeTick.h"
+
+//*****************************************************************************
+//
+// Cortex-M4 debug registers for the DWT cycle counter
+//
+//*****************************************************************************
+#define DEMCR                   0xE000EDFC
+#define DEMCR_TRCENA            0x01000000
+#define DWT_CTRL                0xE0001000
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define DWT_CYCCNT              0xE0001004
+#define NVIC_ST_CTRL            0xE000E010
+#define NVIC_ST_CTRL_COUNT      0x00010000
+#define NVIC_ST_CTRL_CLK_SRC    0x00000004
+#define NVIC_ST_CTRL_INTEN      0x00000002
+#define NVIC_ST_CTRL_ENABLE     0x00000001
+#define NVIC_ST_RELOAD          0xE000E014
+#define NVIC_ST_CURRENT         0xE000E018
+
+//*****************************************************************************
+//
+// Milliseconds since XBeeTickInit()
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32TickMs;
+
+//*****************************************************************************
+//
+// SysTick clocks per ms. The reload value differs from this only for the
+// part of a ms left over after XBeeTickSleep().
+//
+//*****************************************************************************
+static uint32_t g_ui32TickPeriod;
+
+//*****************************************************************************
+//
+// The SysTick interrupt handler.
+//
+//*****************************************************************************
+void
+SysTickIntHandler(void)
+{
+	g_ui32TickMs++;
+}
+
+//*****************************************************************************
+//
+// Start the 1ms SysTick from the current system clock.
+//
+//*****************************************************************************
+void
+XBeeTickInit(void)
+{
+	g_ui32TickPeriod = SysCtlClockGet() / XBEE_TICKS_PER_SECOND;
+	ROM_SysTickPeriodSet(g_ui32TickPeriod);
+	ROM_SysTickIntEnable();
+	ROM_SysTickEnable();
+}
+
+//*****************************************************************************
+//
+// Reload SysTick after the system clock has changed. The count in progress
+// is restarted so the next tick is a full 1ms at the new rate.
+//
+//*****************************************************************************
+void
+XBeeTickClockUpdate(void)
+{
+	g_ui32TickPeriod = SysCtlClockGet() / XBEE_TICKS_PER_SECOND;
+	ROM_SysTickPeriodSet(g_ui32TickPeriod);
+	HWREG(NVIC_ST_CURRENT) = 0;
+}
+
+uint32_t
+XBeeTickGet(void)
+{
+	return g_ui32TickMs;
+}
+
+//*****************************************************************************
+//
+// Microseconds since XBeeTickInit(), from the tick count and how far SysTick
+// is into the current ms. Wraps every 2^32 us (71 minutes), so only
+// differences mean anything. Needs interrupts on to catch the ms rollover.
+//
+//*****************************************************************************
+uint32_t
+XBeeTickMicros(void)
+{
+	uint32_t ui32Ms;
+	uint32_t ui32Count;
+	uint32_t ui32Period;
+
+	do
+	{
+		ui32Ms = g_ui32TickMs;
+		ui32Count = ROM_SysTickValueGet();
+	}
+	while(ui32Ms != g_ui32TickMs);
+
+	ui32Period = g_ui32TickPeriod;
+
+	return (ui32Ms * 1000) +
+	       (((ui32Period - 1 - ui32Count) * 1000) / ui32Period);
+}
+
+//*****************************************************************************
+//
+// Sleep with the core stopped until the tick count reaches now + ui32Ms or
+// an interrupt comes in, whichever is first, with no SysTick interrupts on
+// the way. SysTick is reloaded to run out on that ms boundary; on wake the
+// ms that went by are added to the tick count and SysTick is put back in
+// step. Call with interrupts masked: WFI still wakes on a pending one, and
+// its handler runs once the caller unmasks. ui32Ms is cut to what the
+// 24-bit counter can reach (1s at 16MHz). Returns the time asleep in us.
+//
+//*****************************************************************************
+uint32_t
+XBeeTickSleep(uint32_t ui32Ms)
+{
+	uint32_t ui32Period;
+	uint32_t ui32Count;
+	uint32_t ui32Reload;
+	uint32_t ui32Current;
+	uint32_t ui32Elapsed;
+	uint32_t ui32Since;
+
+	ui32Period = g_ui32TickPeriod;
+	if(ui32Ms > (((0x00FFFFFF - ui32Period) / ui32Period) + 1))
+	{
+		ui32Ms = ((0x00FFFFFF - ui32Period) / ui32Period) + 1;
+	}
+	if(ui32Ms == 0)
+	{
+		return 0;
+	}
+
+	//
+	// Stop the count, the rest of this ms plus ui32Ms - 1 whole ones
+	//
+	HWREG(NVIC_ST_CTRL) = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN;
+	ui32Count = HWREG(NVIC_ST_CURRENT);
+	ui32Reload = ui32Count + ((ui32Ms - 1) * ui32Period);
+	HWREG(NVIC_ST_RELOAD) = ui32Reload;
+	HWREG(NVIC_ST_CURRENT) = 0;
+	HWREG(NVIC_ST_CTRL) = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN |
+	                      NVIC_ST_CTRL_ENABLE;
+
+	CPUwfi();
+
+	//
+	// Stop without reading CTRL first, reading clears COUNT
+	//
+	HWREG(NVIC_ST_CTRL) = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN;
+	ui32Current = HWREG(NVIC_ST_CURRENT);
+
+	if(HWREG(NVIC_ST_CTRL) & NVIC_ST_CTRL_COUNT)
+	{
+		//
+		// Ran out on the boundary. The pending SysTick interrupt counts
+		// that ms, the counter has since started over from ui32Reload.
+		//
+		ui32Since = ui32Reload - ui32Current;
+		ui32Elapsed = ui32Reload + 1 + ui32Since;
+		g_ui32TickMs += ui32Ms - 1 + (ui32Since / ui32Period);
+	}
+	else
+	{
+		//
+		// Woken early, by how far into the ms the sleep began and how long
+		// it lasted
+		//
+		ui32Elapsed = ui32Reload - ui32Current;
+		ui32Since = (ui32Period - 1 - ui32Count) + ui32Elapsed;
+		g_ui32TickMs += ui32Since / ui32Period;
+	}
+	ui32Since %= ui32Period;
+
+	//
+	// Finish the ms in progress, then full ms again from the next reload
+	//
+	if(ui32Since == (ui32Period - 1))
+	{
+		g_ui32TickMs++;
+		ui32Since = 0;
+	}
+	HWREG(NVIC_ST_RELOAD) = ui32Period - 1 - ui32Since;
+	HWREG(NVIC_ST_CURRENT) = 0;
+	HWREG(NVIC_ST_CTRL) = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN |
+	                      NVIC_ST_CTRL_ENABLE;
+	HWREG(NVIC_ST_RELOAD) = ui32Period - 1;
+
+	return ui32Elapsed / (ui32Period / 1000);
+}
+
+//*****************************************************************************
+//
+// Switch on the DWT cycle counter, it counts core clocks and wraps every
+// 2^32 cycles.
+//
+//*****************************************************************************
+void
+XBeeCycleCountEnable(void)
+{
+	HWREG(DEMCR) |= DEMCR_TRCENA;
+	HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t
+XBeeCycleCountGet(void)
+{
+	return HWREG(DWT_CYCCNT);
+}
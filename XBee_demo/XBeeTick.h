@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// XBeeTick.h - Headers for use with XBeeTick.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEETICK_H__
+#define __XBEETICK_H__
+
+//*****************************************************************************
+//
+// Tick rate of the millisecond time base
+//
+//*****************************************************************************
+#define XBEE_TICKS_PER_SECOND   1000
+
+//*****************************************************************************
+//
+// True once the tick count t has reached deadline d, safe across wrap.
+//
+//*****************************************************************************
+#define XBEE_TICK_REACHED(t, d) ((int32_t)((t) - (d)) >= 0)
+
+//*****************************************************************************
+//
+// Time base functions. SysTickIntHandler must be in the vector table.
+//
+//*****************************************************************************
+extern void XBeeTickInit(void);
+extern void XBeeTickClockUpdate(void);
+extern uint32_t XBeeTickGet(void);
+extern uint32_t XBeeTickMicros(void);
+extern uint32_t XBeeTickSleep(uint32_t ui32Ms);
+extern void XBeeCycleCountEnable(void);
+extern uint32_t XBeeCycleCountGet(void);
+extern void SysTickIntHandler(void);
+
+#endif //__XBEETICK_H__
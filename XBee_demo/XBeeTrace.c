@@ -0,0 +1,566 @@
+//*****************************************************************************
+//
+// XBeeTrace.c - End to end latency tracing between two nodes
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! With tracing on, XBeeLinkSend() puts a trace header (XBeeTrace.h) in
+//! every data class message: a sequence number, when the data was taken
+//! and when the message was queued, in the sender's XBeeTickMicros(). The
+//! receiving link strips it before the handler runs, so handlers never see
+//! it, and times the handler as well.
+//!
+//! The two clocks are tied together by ping / pong in the control class,
+//! the same four time stamps NTP uses:
+//!
+//!   offset = ((t2 - t1) + (t3 - t4)) / 2     remote clock minus ours
+//!   rtt    = (t4 - t1) - (t3 - t2)
+//!
+//! Queueing only ever adds delay, so the sample with the lowest round trip
+//! is the most accurate one; the last XBEE_TRACE_PINGS are kept and that
+//! one is used. Crystal drift (up to 100ppm between two nodes) is a few
+//! hundred us over that span.
+//!
+//! 'trace gen <ms>' on one node sends the state of SW1 (PF4) that often,
+//! and the other prints it, giving pin to console latency.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeLink.h"
+#include "XBeeIdle.h"
+#include "XBeeTrace.h"
+
+//*****************************************************************************
+//
+// Message layouts after the message header
+//
+//*****************************************************************************
+#define TRACE_PING_SIZE         (XBEE_MSG_HDR_SIZE + 4)
+#define TRACE_PONG_SIZE         (XBEE_MSG_HDR_SIZE + 12)
+#define TRACE_DATA_SIZE         (XBEE_MSG_HDR_SIZE + 1)
+
+#define TRACE_GEN_MIN_MS        10
+
+//*****************************************************************************
+//
+// The traced message being handled, between XBeeTraceRxStart() and
+// XBeeTraceRxDone()
+//
+//*****************************************************************************
+typedef struct
+{
+	bool bActive;
+	uint32_t ui32Origin;
+	uint32_t ui32Queued;
+	uint32_t ui32Rx;
+	uint32_t ui32WireLen;
+}
+tXBeeTraceRx;
+
+//*****************************************************************************
+//
+// One clock offset measurement
+//
+//*****************************************************************************
+typedef struct
+{
+	int32_t i32Offset;
+	uint32_t ui32Rtt;
+}
+tXBeeTracePing;
+
+static bool g_bTraceOn;
+static uint16_t g_ui16TraceTxSeq;
+static uint16_t g_ui16TraceRxSeq;
+static bool g_bTraceRxSeqValid;
+static tXBeeTraceRx g_sTraceRx;
+static tXBeeTraceStats g_sTraceStats;
+
+static tXBeeTracePing g_psTracePings[XBEE_TRACE_PINGS];
+static uint32_t g_ui32TracePingCount;
+static bool g_bTraceSynced;
+static int32_t g_i32TraceOffset;
+static uint32_t g_ui32TraceRtt;
+static uint32_t g_ui32TracePingTick;
+
+static uint32_t g_ui32TraceGenMs;
+static uint32_t g_ui32TraceGenTick;
+
+static uint32_t g_ppui32TraceSamples[XBEE_TRACE_STAGES][XBEE_TRACE_SAMPLES];
+static uint32_t g_ui32TraceSampleCount;
+
+static const char * const g_ppcTraceStages[XBEE_TRACE_STAGES] =
+{
+	"sender", "link", "serial", "rf", "receiver", "total"
+};
+
+//*****************************************************************************
+//
+// Turn trace headers on outgoing data messages, and the pings, on or off.
+// Traced messages are always accepted.
+//
+//*****************************************************************************
+void
+XBeeTraceEnable(bool bEnable)
+{
+	g_bTraceOn = bEnable;
+	g_ui32TracePingTick = XBeeTickGet();
+}
+
+bool
+XBeeTraceEnabled(void)
+{
+	return g_bTraceOn;
+}
+
+//*****************************************************************************
+//
+// Fill in a trace header for a message being queued now, with the data
+// taken at ui32Origin.
+//
+//*****************************************************************************
+void
+XBeeTraceHeaderPut(uint8_t *pui8Hdr, uint32_t ui32Origin)
+{
+	XBEE_PUT16(pui8Hdr, g_ui16TraceTxSeq);
+	XBEE_PUT32(&pui8Hdr[2], ui32Origin);
+	XBEE_PUT32(&pui8Hdr[6], XBeeTickMicros());
+	g_ui16TraceTxSeq++;
+	g_sTraceStats.ui32Sent++;
+}
+
+//*****************************************************************************
+//
+// A traced message arrived at ui32RxTime, ui32WireLen bytes as received.
+// Called by the link before the handler.
+//
+//*****************************************************************************
+void
+XBeeTraceRxStart(const uint8_t *pui8Hdr, uint32_t ui32RxTime,
+                 uint32_t ui32WireLen)
+{
+	uint16_t ui16Seq;
+
+	ui16Seq = XBEE_GET16(pui8Hdr);
+	if(g_bTraceRxSeqValid && (ui16Seq != g_ui16TraceRxSeq))
+	{
+		g_sTraceStats.ui32Lost += (uint16_t)(ui16Seq - g_ui16TraceRxSeq);
+	}
+	g_ui16TraceRxSeq = ui16Seq + 1;
+	g_bTraceRxSeqValid = true;
+
+	g_sTraceRx.ui32Origin = XBEE_GET32(&pui8Hdr[2]);
+	g_sTraceRx.ui32Queued = XBEE_GET32(&pui8Hdr[6]);
+	g_sTraceRx.ui32Rx = ui32RxTime;
+	g_sTraceRx.ui32WireLen = ui32WireLen;
+	g_sTraceRx.bActive = true;
+	g_sTraceStats.ui32Received++;
+}
+
+//*****************************************************************************
+//
+// The handler of the traced message has returned, record its stages.
+//
+//*****************************************************************************
+void
+XBeeTraceRxDone(void)
+{
+	uint32_t pui32Stage[XBEE_TRACE_STAGES];
+	uint32_t ui32Index;
+	uint32_t ui32Stage;
+	uint32_t ui32Baud;
+	int32_t i32Link;
+
+	if(!g_sTraceRx.bActive)
+	{
+		return;
+	}
+	g_sTraceRx.bActive = false;
+
+	pui32Stage[XBEE_TRACE_RECEIVER] = XBeeTickMicros() - g_sTraceRx.ui32Rx;
+
+	if(!g_bTraceSynced)
+	{
+		g_sTraceStats.ui32Unsynced++;
+		return;
+	}
+
+	pui32Stage[XBEE_TRACE_SENDER] = g_sTraceRx.ui32Queued -
+	                                g_sTraceRx.ui32Origin;
+
+	//
+	// An offset error larger than the real delay would go negative
+	//
+	i32Link = (int32_t)(g_sTraceRx.ui32Rx -
+	                    (g_sTraceRx.ui32Queued - g_i32TraceOffset));
+	pui32Stage[XBEE_TRACE_LINK] = (i32Link > 0) ? i32Link : 0;
+
+	//
+	// Out of one UART and in at the other, 10 bits a byte plus the frame
+	// delimiter, length and checksum. Both nodes are assumed at our baud.
+	//
+	ui32Baud = XBeeUartBaudGet();
+	pui32Stage[XBEE_TRACE_SERIAL] = ui32Baud ?
+	        (2 * (((g_sTraceRx.ui32WireLen + 4) * 10000000) / ui32Baud)) : 0;
+	if(pui32Stage[XBEE_TRACE_SERIAL] > pui32Stage[XBEE_TRACE_LINK])
+	{
+		pui32Stage[XBEE_TRACE_SERIAL] = pui32Stage[XBEE_TRACE_LINK];
+	}
+	pui32Stage[XBEE_TRACE_RF] = pui32Stage[XBEE_TRACE_LINK] -
+	                            pui32Stage[XBEE_TRACE_SERIAL];
+
+	pui32Stage[XBEE_TRACE_TOTAL] = pui32Stage[XBEE_TRACE_SENDER] +
+	                               pui32Stage[XBEE_TRACE_LINK] +
+	                               pui32Stage[XBEE_TRACE_RECEIVER];
+
+	ui32Index = g_ui32TraceSampleCount % XBEE_TRACE_SAMPLES;
+	for(ui32Stage = 0; ui32Stage < XBEE_TRACE_STAGES; ui32Stage++)
+	{
+		g_ppui32TraceSamples[ui32Stage][ui32Index] = pui32Stage[ui32Stage];
+	}
+	g_ui32TraceSampleCount++;
+}
+
+//*****************************************************************************
+//
+// Remote clock minus ours in us. Returns false until the first pong.
+//
+//*****************************************************************************
+bool
+XBeeTraceOffsetGet(int32_t *pi32Offset)
+{
+	*pi32Offset = g_i32TraceOffset;
+	return g_bTraceSynced;
+}
+
+//*****************************************************************************
+//
+// Send a ping carrying our send time (t1).
+//
+//*****************************************************************************
+static void
+XBeeTracePingSend(void)
+{
+	uint8_t pui8Msg[TRACE_PING_SIZE];
+
+	pui8Msg[0] = XBEE_MSG_TRACE_PING;
+	pui8Msg[1] = 0;
+	XBEE_PUT32(&pui8Msg[2], XBeeTickMicros());
+	XBeeLinkSend(pui8Msg, sizeof(pui8Msg));
+	g_sTraceStats.ui32Pings++;
+}
+
+//*****************************************************************************
+//
+// Add a measurement and take the offset from the best of the last few.
+//
+//*****************************************************************************
+static void
+XBeeTracePong(uint32_t ui32T1, uint32_t ui32T2, uint32_t ui32T3,
+              uint32_t ui32T4)
+{
+	tXBeeTracePing *psPing;
+	tXBeeTracePing *psBest;
+	uint32_t ui32Count;
+
+	psPing = &g_psTracePings[g_ui32TracePingCount % XBEE_TRACE_PINGS];
+	psPing->i32Offset = ((int32_t)(ui32T2 - ui32T1) +
+	                     (int32_t)(ui32T3 - ui32T4)) / 2;
+	psPing->ui32Rtt = (ui32T4 - ui32T1) - (ui32T3 - ui32T2);
+	g_ui32TracePingCount++;
+	g_sTraceStats.ui32Pongs++;
+
+	ui32Count = (g_ui32TracePingCount < XBEE_TRACE_PINGS) ?
+	            g_ui32TracePingCount : XBEE_TRACE_PINGS;
+	psBest = &g_psTracePings[0];
+	for(psPing = g_psTracePings; psPing < &g_psTracePings[ui32Count];
+	    psPing++)
+	{
+		if(psPing->ui32Rtt < psBest->ui32Rtt)
+		{
+			psBest = psPing;
+		}
+	}
+
+	g_i32TraceOffset = psBest->i32Offset;
+	g_ui32TraceRtt = psBest->ui32Rtt;
+	g_bTraceSynced = true;
+}
+
+//*****************************************************************************
+//
+// Link handler for ping, pong and trace data messages.
+//
+//*****************************************************************************
+void
+XBeeTraceMsg(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint8_t pui8Pong[TRACE_PONG_SIZE];
+	uint32_t ui32Now;
+
+	ui32Now = XBeeTickMicros();
+
+	switch(pui8Msg[0])
+	{
+		case XBEE_MSG_TRACE_PING:
+			if(ui32Len < TRACE_PING_SIZE)
+			{
+				break;
+			}
+			pui8Pong[0] = XBEE_MSG_TRACE_PONG;
+			pui8Pong[1] = 0;
+			memcpy(&pui8Pong[2], &pui8Msg[2], 4);
+			XBEE_PUT32(&pui8Pong[6], ui32Now);
+			XBEE_PUT32(&pui8Pong[10], XBeeTickMicros());
+			XBeeLinkSend(pui8Pong, sizeof(pui8Pong));
+			break;
+
+		case XBEE_MSG_TRACE_PONG:
+			if(ui32Len < TRACE_PONG_SIZE)
+			{
+				break;
+			}
+			XBeeTracePong(XBEE_GET32(&pui8Msg[2]), XBEE_GET32(&pui8Msg[6]),
+			              XBEE_GET32(&pui8Msg[10]), ui32Now);
+			break;
+
+		case XBEE_MSG_TRACE_DATA:
+			if(ui32Len < TRACE_DATA_SIZE)
+			{
+				break;
+			}
+			UARTprintf("sw1 %d\n", pui8Msg[2]);
+			break;
+
+		default:
+			break;
+	}
+}
+
+//*****************************************************************************
+//
+// Read SW1 and send it, stamped with the time it was read.
+//
+//*****************************************************************************
+static void
+XBeeTraceGenSend(void)
+{
+	uint8_t pui8Msg[TRACE_DATA_SIZE];
+	uint32_t ui32Origin;
+
+	ui32Origin = XBeeTickMicros();
+	pui8Msg[0] = XBEE_MSG_TRACE_DATA;
+	pui8Msg[1] = 0;
+	pui8Msg[2] = ROM_GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4) ? 0 : 1;
+	XBeeLinkSendStamped(pui8Msg, sizeof(pui8Msg), ui32Origin);
+}
+
+//*****************************************************************************
+//
+// Send pings and generated data when due. Called from XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeTracePoll(void)
+{
+	uint32_t ui32Now;
+
+	if(!g_bTraceOn)
+	{
+		return;
+	}
+
+	ui32Now = XBeeTickGet();
+
+	if(XBEE_TICK_REACHED(ui32Now, g_ui32TracePingTick) &&
+	   XBeeLinkSendReady())
+	{
+		g_ui32TracePingTick = ui32Now + XBEE_TRACE_PING_MS;
+		XBeeTracePingSend();
+	}
+
+	if(g_ui32TraceGenMs && XBEE_TICK_REACHED(ui32Now, g_ui32TraceGenTick) &&
+	   XBeeLinkSendReady())
+	{
+		g_ui32TraceGenTick = ui32Now + g_ui32TraceGenMs;
+		XBeeTraceGenSend();
+	}
+
+	XBeeIdleDeadline(g_ui32TracePingTick);
+	if(g_ui32TraceGenMs)
+	{
+		XBeeIdleDeadline(g_ui32TraceGenTick);
+	}
+}
+
+void
+XBeeTraceStatsGet(tXBeeTraceStats *psStats)
+{
+	*psStats = g_sTraceStats;
+}
+
+//*****************************************************************************
+//
+// p50 / p90 / p99 / max of a stage over the samples kept.
+//
+//*****************************************************************************
+static void
+XBeeTracePercentiles(uint32_t ui32Stage, uint32_t *pui32Out)
+{
+	uint32_t pui32Sorted[XBEE_TRACE_SAMPLES];
+	uint32_t ui32Count;
+	uint32_t ui32Index;
+	uint32_t ui32Hole;
+	uint32_t ui32Value;
+
+	ui32Count = (g_ui32TraceSampleCount < XBEE_TRACE_SAMPLES) ?
+	            g_ui32TraceSampleCount : XBEE_TRACE_SAMPLES;
+
+	//
+	// Insertion sort, 64 entries at most
+	//
+	for(ui32Index = 0; ui32Index < ui32Count; ui32Index++)
+	{
+		ui32Value = g_ppui32TraceSamples[ui32Stage][ui32Index];
+		for(ui32Hole = ui32Index;
+		    (ui32Hole > 0) && (pui32Sorted[ui32Hole - 1] > ui32Value);
+		    ui32Hole--)
+		{
+			pui32Sorted[ui32Hole] = pui32Sorted[ui32Hole - 1];
+		}
+		pui32Sorted[ui32Hole] = ui32Value;
+	}
+
+	pui32Out[0] = pui32Sorted[(ui32Count * 50) / 100];
+	pui32Out[1] = pui32Sorted[(ui32Count * 90) / 100];
+	pui32Out[2] = pui32Sorted[(ui32Count * 99) / 100];
+	pui32Out[3] = pui32Sorted[ui32Count - 1];
+}
+
+//*****************************************************************************
+//
+// Trace Command
+// Input: none / 'clear' / 'on' / 'off' / 'ping' / 'gen <ms, 0=stop>'
+// Response: clock offset to the other node, then p50 / p90 / p99 / max of
+//		each latency stage over the last traced messages received
+// Use: to see where the time goes between a pin on one node and the
+//		console of the other. Turn tracing on at both ends, then run
+//		'trace gen' on the node with the pin.
+//
+//*****************************************************************************
+int
+Cmd_trace(int argc, char *argv[])
+{
+	uint32_t pui32Pct[4];
+	uint32_t ui32Stage;
+	uint32_t ui32Ms;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sTraceStats, 0, sizeof(g_sTraceStats));
+		g_ui32TraceSampleCount = 0;
+		g_bTraceRxSeqValid = false;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "on")))
+	{
+		XBeeTraceEnable(true);
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "off")))
+	{
+		XBeeTraceEnable(false);
+		g_ui32TraceGenMs = 0;
+		return 0;
+	}
+	else if((2 == argc) && (0 == strcmp(argv[1], "ping")))
+	{
+		XBeeTracePingSend();
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "gen")))
+	{
+		ui32Ms = strtoul(argv[2], 0, 10);
+		if(ui32Ms && (ui32Ms < TRACE_GEN_MIN_MS))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+
+		//
+		// SW1 pulls PF4 low when pressed
+		//
+		ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+		ROM_GPIOPinTypeGPIOInput(GPIO_PORTF_BASE, GPIO_PIN_4);
+		ROM_GPIOPadConfigSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA,
+		                     GPIO_PIN_TYPE_STD_WPU);
+
+		g_ui32TraceGenMs = ui32Ms;
+		g_ui32TraceGenTick = XBeeTickGet();
+		if(ui32Ms && !g_bTraceOn)
+		{
+			XBeeTraceEnable(true);
+		}
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	UARTprintf("trace %s", g_bTraceOn ? "on" : "off");
+	if(g_bTraceSynced)
+	{
+		UARTprintf(", offset %d us, rtt %u us\n", g_i32TraceOffset,
+		           g_ui32TraceRtt);
+	}
+	else
+	{
+		UARTprintf(", no clock offset yet\n");
+	}
+	UARTprintf("sent %u, received %u, lost %u, unsynced %u, "
+	           "pings %u/%u\n", g_sTraceStats.ui32Sent,
+	           g_sTraceStats.ui32Received, g_sTraceStats.ui32Lost,
+	           g_sTraceStats.ui32Unsynced, g_sTraceStats.ui32Pongs,
+	           g_sTraceStats.ui32Pings);
+
+	if(g_ui32TraceSampleCount == 0)
+	{
+		return 0;
+	}
+
+	UARTprintf("   stage   p50 us   p90 us   p99 us   max us\n");
+	for(ui32Stage = 0; ui32Stage < XBEE_TRACE_STAGES; ui32Stage++)
+	{
+		XBeeTracePercentiles(ui32Stage, pui32Pct);
+		UARTprintf("%8s %8u %8u %8u %8u\n", g_ppcTraceStages[ui32Stage],
+		           pui32Pct[0], pui32Pct[1], pui32Pct[2], pui32Pct[3]);
+	}
+
+	return 0;
+}
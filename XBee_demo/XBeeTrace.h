@@ -0,0 +1,94 @@
+//*****************************************************************************
+//
+// XBeeTrace.h - Headers for use with XBeeTrace.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEETRACE_H__
+#define __XBEETRACE_H__
+
+//*****************************************************************************
+//
+// Trace header, inserted after the message header of a data class message
+// flagged XBEE_MSG_FLAG_TRACE: sequence number (2), then the sender's
+// XBeeTickMicros() when the data was taken (4) and when the message was
+// queued (4).
+//
+//*****************************************************************************
+#define XBEE_TRACE_HDR_SIZE     10
+
+//*****************************************************************************
+//
+// Latency stages, in us
+//
+//   SENDER    data taken to message queued, on the sender
+//   LINK      queued on the sender to received here, clock offset corrected
+//   SERIAL    part of LINK estimated for the two UARTs at the local baud
+//   RF        the rest of LINK: sender queueing, radio and retries
+//   RECEIVER  received here to the handler done (line on the console)
+//   TOTAL     SENDER + LINK + RECEIVER
+//
+//*****************************************************************************
+#define XBEE_TRACE_SENDER       0
+#define XBEE_TRACE_LINK         1
+#define XBEE_TRACE_SERIAL       2
+#define XBEE_TRACE_RF           3
+#define XBEE_TRACE_RECEIVER     4
+#define XBEE_TRACE_TOTAL        5
+#define XBEE_TRACE_STAGES       6
+
+//*****************************************************************************
+//
+// Percentiles are over the last XBEE_TRACE_SAMPLES traced messages. The
+// clock offset is re-measured every XBEE_TRACE_PING_MS while tracing is on
+// and taken from the lowest round trip of the last XBEE_TRACE_PINGS.
+//
+//*****************************************************************************
+#define XBEE_TRACE_SAMPLES      64
+#define XBEE_TRACE_PING_MS      2000
+#define XBEE_TRACE_PINGS        4
+
+//*****************************************************************************
+//
+// Counters
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Sent;                  // messages sent with a trace header
+	uint32_t ui32Received;
+	uint32_t ui32Lost;                  // gaps in the sequence numbers
+	uint32_t ui32Unsynced;              // received before the first pong
+	uint32_t ui32Pings;
+	uint32_t ui32Pongs;
+}
+tXBeeTraceStats;
+
+//*****************************************************************************
+//
+// Trace functions
+//
+//*****************************************************************************
+extern bool XBeeTraceEnabled(void);
+extern void XBeeTraceEnable(bool bEnable);
+extern void XBeeTraceHeaderPut(uint8_t *pui8Hdr, uint32_t ui32Origin);
+extern void XBeeTraceRxStart(const uint8_t *pui8Hdr, uint32_t ui32RxTime,
+                             uint32_t ui32WireLen);
+extern void XBeeTraceRxDone(void);
+extern bool XBeeTraceOffsetGet(int32_t *pi32Offset);
+extern void XBeeTraceMsg(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeTracePoll(void);
+extern void XBeeTraceStatsGet(tXBeeTraceStats *psStats);
+extern int Cmd_trace(int argc, char *argv[]);
+
+#endif //__XBEETRACE_H__
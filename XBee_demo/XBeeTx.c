@@ -0,0 +1,735 @@
+//*****************************************************************************
+//
+// XBeeTx.c - API mode transmit requests tracked by frame ID
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! Every transmit request (0x00 / 0x01) gets a frame ID from a rolling
+//! counter that skips IDs still in flight, and a slot in g_psTxSlots. The
+//! XBee answers each one with a transmit status (0x89, or 0x8B from ZigBee
+//! firmware, which also carries the retry count); the slot completes on
+//! that, or as XBEE_TX_TIMED_OUT XBEE_TX_TIMEOUT_MS after the scheduler
+//! let the request out. Time spent queued, held for the airtime budget,
+//! does not count: the XBee has not seen the request yet.
+//!
+//! The window is per destination, so requests to different nodes overlap
+//! even at a window of 1 (stop-and-wait towards each node).
+//!
+//! 'tx sim' replaces the radio with a model (serial time at the current
+//! baud rate, then air time by frame length, one frame on air at a time)
+//! so 'tx bench' can compare stop-and-wait with the window without a
+//! second node. Given a byte error rate it also loses frames, each byte on
+//! air failing independently; those take the air time of all the MAC
+//! tries and complete as NO_ACK.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "XBeeUart.h"
+#include "XBeeTick.h"
+#include "XBeeFrame.h"
+#include "XBeeSched.h"
+#include "XBeeLink.h"
+#include "XBeeQual.h"
+#include "XBeeIdle.h"
+#include "XBeeAir.h"
+#include "XBeeChan.h"
+#include "XBeeTx.h"
+
+//*****************************************************************************
+//
+// One request waiting for its status. ui8FrameId 0 marks a free slot.
+// bQueued is set until the scheduler hands the request to UART1, and
+// ui32SentTick is when it did.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint8_t ui8FrameId;
+	bool bQueued;
+	uint64_t ui64Dest;
+	uint32_t ui32SentTick;
+	uint32_t ui32Len;
+	uint32_t ui32SimDue;
+	uint32_t ui32SimResult;
+	tXBeeTxDone pfnDone;
+	void *pvArg;
+}
+tXBeeTxSlot;
+
+static tXBeeTxSlot g_psTxSlots[XBEE_TX_SLOTS];
+static tXBeeTxStats g_sTxStats;
+static uint32_t g_ui32TxWindow = XBEE_TX_WINDOW_DEFAULT;
+static uint8_t g_ui8TxFrameId;
+
+//*****************************************************************************
+//
+// Simulated radio: when its serial side and its transmitter are next free,
+// byte errors per million and the state of its random number generator
+//
+//*****************************************************************************
+static bool g_bTxSim;
+static uint32_t g_ui32TxSimErrorPpm;
+static uint32_t g_ui32TxSimRand = 1;
+static uint32_t g_ui32TxSimSerialFree;
+static uint32_t g_ui32TxSimRadioFree;
+static uint32_t g_ui32TxSimRadioUs;     // part of a ms past RadioFree
+
+//*****************************************************************************
+//
+// Requests in flight to ui64Dest.
+//
+//*****************************************************************************
+static uint32_t
+XBeeTxCount(uint64_t ui64Dest)
+{
+	uint32_t ui32Slot;
+	uint32_t ui32Count;
+
+	ui32Count = 0;
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		if(g_psTxSlots[ui32Slot].ui8FrameId &&
+		   (g_psTxSlots[ui32Slot].ui64Dest == ui64Dest))
+		{
+			ui32Count++;
+		}
+	}
+
+	return ui32Count;
+}
+
+//*****************************************************************************
+//
+// Find a free slot and give it the next frame ID not in use. Returns 0 if
+// the table is full.
+//
+//*****************************************************************************
+static tXBeeTxSlot *
+XBeeTxAlloc(void)
+{
+	tXBeeTxSlot *psFree;
+	uint32_t ui32Slot;
+	bool bInUse;
+
+	psFree = 0;
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		if(g_psTxSlots[ui32Slot].ui8FrameId == 0)
+		{
+			psFree = &g_psTxSlots[ui32Slot];
+			break;
+		}
+	}
+	if(psFree == 0)
+	{
+		return 0;
+	}
+
+	//
+	// At most XBEE_TX_SLOTS IDs are taken, so this ends quickly
+	//
+	do
+	{
+		if(++g_ui8TxFrameId == 0)
+		{
+			g_ui8TxFrameId = 1;
+		}
+		bInUse = false;
+		for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+		{
+			if(g_psTxSlots[ui32Slot].ui8FrameId == g_ui8TxFrameId)
+			{
+				bInUse = true;
+			}
+		}
+	}
+	while(bInUse);
+
+	psFree->ui8FrameId = g_ui8TxFrameId;
+	return psFree;
+}
+
+//*****************************************************************************
+//
+// Free a slot and tell whoever sent the request.
+//
+//*****************************************************************************
+static void
+XBeeTxComplete(tXBeeTxSlot *psSlot, uint32_t ui32Result, uint32_t ui32Retries)
+{
+	tXBeeTxDone pfnDone;
+	uint32_t ui32Rtt;
+	uint8_t ui8FrameId;
+
+	if(ui32Result == XBEE_TX_TIMED_OUT)
+	{
+		g_sTxStats.ui32TimedOut++;
+	}
+	else
+	{
+		g_sTxStats.pui32Result[ui32Result]++;
+		g_sTxStats.ui32Retries += ui32Retries;
+		if(!g_bTxSim && ui32Retries)
+		{
+			XBeeAirRetries(psSlot->ui32Len, ui32Retries);
+		}
+		ui32Rtt = XBeeTickGet() - psSlot->ui32SentTick;
+		g_sTxStats.ui32RttSum += ui32Rtt;
+		if(ui32Rtt > g_sTxStats.ui32RttMax)
+		{
+			g_sTxStats.ui32RttMax = ui32Rtt;
+		}
+	}
+
+	if(ui32Result != XBEE_TX_PURGED)
+	{
+		XBeeQualResult(psSlot->ui64Dest, ui32Result == XBEE_TX_SUCCESS,
+		               psSlot->ui32Len);
+	}
+
+	pfnDone = psSlot->pfnDone;
+	ui8FrameId = psSlot->ui8FrameId;
+	psSlot->ui8FrameId = 0;
+
+	if(pfnDone)
+	{
+		pfnDone(psSlot->pvArg, ui8FrameId, ui32Result, ui32Retries);
+	}
+}
+
+//*****************************************************************************
+//
+// Put a request of ui32FrameLen bytes on the serial line, ui32AirLen on
+// air, to the simulated radio and work out when its status comes back.
+//
+//*****************************************************************************
+static uint32_t
+XBeeTxSimulate(uint32_t ui32FrameLen, uint32_t ui32AirLen,
+               uint32_t ui32Result)
+{
+	uint32_t ui32Now;
+	uint32_t ui32Serial;
+	uint32_t ui32AirUs;
+
+	ui32Now = XBeeTickGet();
+	ui32Serial = ((ui32FrameLen * 10 * 1000) + XBeeUartBaudGet() - 1) /
+	             XBeeUartBaudGet();
+
+	if(XBEE_TICK_REACHED(ui32Now, g_ui32TxSimSerialFree))
+	{
+		g_ui32TxSimSerialFree = ui32Now;
+	}
+	g_ui32TxSimSerialFree += ui32Serial;
+
+	if(XBEE_TICK_REACHED(g_ui32TxSimSerialFree, g_ui32TxSimRadioFree))
+	{
+		g_ui32TxSimRadioFree = g_ui32TxSimSerialFree;
+		g_ui32TxSimRadioUs = 0;
+	}
+	ui32AirUs = XBEE_TX_SIM_AIR_US_FIXED +
+	            (ui32AirLen * XBEE_TX_SIM_AIR_US_PER_BYTE);
+	if(ui32Result != XBEE_TX_SUCCESS)
+	{
+		ui32AirUs *= XBEE_TX_SIM_TRIES;
+	}
+	g_ui32TxSimRadioUs += ui32AirUs;
+	g_ui32TxSimRadioFree += g_ui32TxSimRadioUs / 1000;
+	g_ui32TxSimRadioUs %= 1000;
+
+	return g_ui32TxSimRadioFree + (g_ui32TxSimRadioUs ? 1 : 0);
+}
+
+//*****************************************************************************
+//
+// Whether the simulated radio gets a frame of ui32FrameLen bytes through:
+// the chance that none of its bytes is hit, in 1/65536ths, against a
+// random draw. Noise on the simulated channel (XBeeChan.c) adds to the
+// error rate.
+//
+//*****************************************************************************
+static uint32_t
+XBeeTxSimResult(uint32_t ui32FrameLen)
+{
+	uint32_t ui32Survive;
+	uint32_t ui32Ppm;
+
+	ui32Ppm = g_ui32TxSimErrorPpm + XBeeChanSimErrorPpm();
+	if(ui32Ppm > 999999)
+	{
+		ui32Ppm = 999999;
+	}
+
+	ui32Survive = 65536;
+	while(ui32FrameLen--)
+	{
+		ui32Survive = (uint32_t)(((uint64_t)ui32Survive *
+		                          (1000000 - ui32Ppm)) / 1000000);
+	}
+
+	g_ui32TxSimRand = (g_ui32TxSimRand * 1664525) + 1013904223;
+
+	return ((g_ui32TxSimRand >> 16) < ui32Survive) ? XBEE_TX_SUCCESS :
+	       XBEE_TX_NO_ACK;
+}
+
+//*****************************************************************************
+//
+// Switch the simulated radio in place of the XBee on or off, losing
+// ui32ErrorPpm bytes in a million.
+//
+//*****************************************************************************
+void
+XBeeTxSimSet(bool bEnable, uint32_t ui32ErrorPpm)
+{
+	g_bTxSim = bEnable;
+	g_ui32TxSimErrorPpm = ui32ErrorPpm;
+}
+
+//*****************************************************************************
+//
+// Send ui32Len bytes to ui64Dest (16-bit MY address if it fits, else the
+// 64-bit serial number) in transmit class ui32Class. Returns the frame ID,
+// or 0 if no slot was free, in which case the request still goes out but
+// without a status. Also 0 if the scheduler refused the request (queue
+// full); then nothing is sent and pfnDone is not called. pfnDone, if
+// given, is called when the request completes. Check XBeeTxReady()
+// first to stay within the window.
+//
+//*****************************************************************************
+uint8_t
+XBeeTxSend(uint64_t ui64Dest, uint32_t ui32Class, const uint8_t *pui8Data,
+           uint32_t ui32Len, tXBeeTxDone pfnDone, void *pvArg)
+{
+	uint8_t pui8Frame[11 + XBEE_TX_MAX_PAYLOAD];
+	tXBeeTxSlot *psSlot;
+	uint32_t ui32Hdr;
+	uint32_t ui32InFlight;
+
+	if(ui32Len > XBEE_TX_MAX_PAYLOAD)
+	{
+		g_sTxStats.ui32TooBig++;
+		return 0;
+	}
+
+	psSlot = XBeeTxAlloc();
+	if(psSlot == 0)
+	{
+		g_sTxStats.ui32Untracked++;
+	}
+
+	if(ui64Dest <= 0xFFFF)
+	{
+		pui8Frame[0] = XBEE_API_TX_16;
+		XBEE_PUT16(&pui8Frame[2], (uint16_t)ui64Dest);
+		ui32Hdr = 5;
+	}
+	else
+	{
+		pui8Frame[0] = XBEE_API_TX_64;
+		XBEE_PUT32(&pui8Frame[2], (uint32_t)(ui64Dest >> 32));
+		XBEE_PUT32(&pui8Frame[6], (uint32_t)ui64Dest);
+		ui32Hdr = 11;
+	}
+	pui8Frame[1] = psSlot ? psSlot->ui8FrameId : 0;
+	pui8Frame[ui32Hdr - 1] = 0;
+	memcpy(&pui8Frame[ui32Hdr], pui8Data, ui32Len);
+
+	g_sTxStats.ui32Sent++;
+
+	if(psSlot)
+	{
+		psSlot->ui64Dest = ui64Dest;
+		psSlot->ui32SentTick = XBeeTickGet();
+		psSlot->ui32Len = ui32Len;
+		psSlot->pfnDone = pfnDone;
+		psSlot->pvArg = pvArg;
+
+		ui32InFlight = XBeeTxInFlight();
+		if(ui32InFlight > g_sTxStats.ui32InFlightMax)
+		{
+			g_sTxStats.ui32InFlightMax = ui32InFlight;
+		}
+	}
+
+	if(g_bTxSim)
+	{
+		if(psSlot)
+		{
+			psSlot->bQueued = false;
+			psSlot->ui32SimResult = XBeeTxSimResult(ui32Len +
+			                                        XBEE_QUAL_FRAME_OVERHEAD);
+			psSlot->ui32SimDue = XBeeTxSimulate(ui32Hdr + ui32Len + 4,
+			                                    ui32Len +
+			                                    XBEE_QUAL_FRAME_OVERHEAD,
+			                                    psSlot->ui32SimResult);
+		}
+		return psSlot ? psSlot->ui8FrameId : 0;
+	}
+
+	if(psSlot)
+	{
+		psSlot->bQueued = true;
+	}
+	if(!XBeeFrameQueue(ui32Class, pui8Frame, ui32Hdr + ui32Len))
+	{
+		g_sTxStats.ui32Refused++;
+		if(psSlot)
+		{
+			psSlot->ui8FrameId = 0;
+		}
+		return 0;
+	}
+
+	return psSlot ? psSlot->ui8FrameId : 0;
+}
+
+//*****************************************************************************
+//
+// True if another request to ui64Dest fits in the window.
+//
+//*****************************************************************************
+bool
+XBeeTxReady(uint64_t ui64Dest)
+{
+	return (XBeeTxCount(ui64Dest) < g_ui32TxWindow) &&
+	       (XBeeTxInFlight() < XBEE_TX_SLOTS);
+}
+
+uint32_t
+XBeeTxInFlight(void)
+{
+	uint32_t ui32Slot;
+	uint32_t ui32Count;
+
+	ui32Count = 0;
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		if(g_psTxSlots[ui32Slot].ui8FrameId)
+		{
+			ui32Count++;
+		}
+	}
+
+	return ui32Count;
+}
+
+//*****************************************************************************
+//
+// Called by the scheduler as it hands the transmit request ui8FrameId to
+// UART1. Its timeout starts now.
+//
+//*****************************************************************************
+void
+XBeeTxReleased(uint8_t ui8FrameId)
+{
+	uint32_t ui32Slot;
+
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		if(g_psTxSlots[ui32Slot].ui8FrameId == ui8FrameId)
+		{
+			g_psTxSlots[ui32Slot].bQueued = false;
+			g_psTxSlots[ui32Slot].ui32SentTick = XBeeTickGet();
+			return;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Link handler for transmit status frames.
+//
+//   0x89  [id][status]
+//   0x8B  [id][16-bit dest][retries][delivery status][discovery status]
+//
+//*****************************************************************************
+void
+XBeeTxStatusFrame(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	uint32_t ui32Slot;
+	uint32_t ui32Result;
+	uint32_t ui32Retries;
+
+	if(pui8Msg[0] == XBEE_API_ZB_TX_STATUS)
+	{
+		if(ui32Len < 6)
+		{
+			return;
+		}
+		ui32Retries = pui8Msg[4];
+		ui32Result = pui8Msg[5];
+	}
+	else
+	{
+		if(ui32Len < 3)
+		{
+			return;
+		}
+		ui32Retries = 0;
+		ui32Result = pui8Msg[2];
+	}
+
+	//
+	// ZigBee has many more failure codes, count them as not acknowledged
+	//
+	if(ui32Result > XBEE_TX_PURGED)
+	{
+		ui32Result = XBEE_TX_NO_ACK;
+	}
+
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		if(pui8Msg[1] && (g_psTxSlots[ui32Slot].ui8FrameId == pui8Msg[1]))
+		{
+			XBeeTxComplete(&g_psTxSlots[ui32Slot], ui32Result, ui32Retries);
+			return;
+		}
+	}
+
+	g_sTxStats.ui32Stale++;
+}
+
+//*****************************************************************************
+//
+// Link handler for the messages another node's 'tx bench' sends here.
+//
+//*****************************************************************************
+void
+XBeeTxBenchMsg(const uint8_t *pui8Msg, uint32_t ui32Len)
+{
+	g_sTxStats.ui32BenchRx++;
+}
+
+//*****************************************************************************
+//
+// Time out requests, and complete simulated ones. Called from
+// XBeeLinkPoll().
+//
+//*****************************************************************************
+void
+XBeeTxPoll(void)
+{
+	tXBeeTxSlot *psSlot;
+	uint32_t ui32Now;
+	uint32_t ui32Slot;
+
+	ui32Now = XBeeTickGet();
+	for(ui32Slot = 0; ui32Slot < XBEE_TX_SLOTS; ui32Slot++)
+	{
+		psSlot = &g_psTxSlots[ui32Slot];
+		if(psSlot->ui8FrameId == 0)
+		{
+			continue;
+		}
+
+		if(g_bTxSim && XBEE_TICK_REACHED(ui32Now, psSlot->ui32SimDue))
+		{
+			XBeeTxComplete(psSlot, psSlot->ui32SimResult, 0);
+		}
+		else if(psSlot->bQueued)
+		{
+			//
+			// Still in the scheduler, held for airtime; the scheduler
+			// sets the deadline for when it can go
+			//
+			continue;
+		}
+		else if(XBEE_TICK_REACHED(ui32Now, psSlot->ui32SentTick +
+		                                   XBEE_TX_TIMEOUT_MS))
+		{
+			XBeeTxComplete(psSlot, XBEE_TX_TIMED_OUT, 0);
+		}
+		else
+		{
+			XBeeIdleDeadline(g_bTxSim ? psSlot->ui32SimDue :
+			                 (psSlot->ui32SentTick + XBEE_TX_TIMEOUT_MS));
+		}
+	}
+}
+
+//*****************************************************************************
+//
+// Requests that may be in flight per destination, 1 to XBEE_TX_SLOTS.
+//
+//*****************************************************************************
+void
+XBeeTxWindowSet(uint32_t ui32Window)
+{
+	g_ui32TxWindow = ui32Window;
+}
+
+void
+XBeeTxStatsGet(tXBeeTxStats *psStats)
+{
+	*psStats = g_sTxStats;
+}
+
+//*****************************************************************************
+//
+// Bench completion, counts requests done.
+//
+//*****************************************************************************
+static void
+XBeeTxBenchDone(void *pvArg, uint8_t ui8FrameId, uint32_t ui32Result,
+                uint32_t ui32Retries)
+{
+	(*(uint32_t *)pvArg)++;
+}
+
+//*****************************************************************************
+//
+// Send ui32Count requests of ui32Len bytes to the link destination with the
+// current window and return the time taken in ms.
+//
+//*****************************************************************************
+static uint32_t
+XBeeTxBenchRun(uint32_t ui32Count, uint32_t ui32Len)
+{
+	uint8_t pui8Msg[XBEE_TX_MAX_PAYLOAD];
+	uint32_t ui32Sent;
+	uint32_t ui32Done;
+	uint32_t ui32Start;
+	uint64_t ui64Dest;
+
+	memset(pui8Msg, 0x55, ui32Len);
+	pui8Msg[0] = XBEE_MSG_TX_BENCH;
+	pui8Msg[1] = 0;
+	ui64Dest = XBeeLinkDestGet();
+
+	ui32Sent = 0;
+	ui32Done = 0;
+	ui32Start = XBeeTickGet();
+	while(ui32Done < ui32Count)
+	{
+		if((ui32Sent < ui32Count) && XBeeTxReady(ui64Dest) &&
+		   XBeeTxSend(ui64Dest, XBEE_SCHED_DATA, pui8Msg, ui32Len,
+		              XBeeTxBenchDone, &ui32Done))
+		{
+			ui32Sent++;
+		}
+		XBeeLinkPoll();
+	}
+
+	return XBeeTickGet() - ui32Start;
+}
+
+//*****************************************************************************
+//
+// Tx Command
+// Input: none / 'clear' / 'window <1-16>' /
+//		'sim <1/0> [byte errors per million]' / 'bench <count> [bytes]'
+// Response: requests sent, delivery results, retries and status round trip
+// Use: to see how API mode transmit requests fare, and to compare
+//		stop-and-wait with the window ('bench' runs both). The XBee must be
+//		in API mode 2 unless 'sim 1' is set.
+//
+//*****************************************************************************
+int
+Cmd_tx(int argc, char *argv[])
+{
+	uint32_t ui32Window;
+	uint32_t ui32Count;
+	uint32_t ui32Len;
+	uint32_t ui32Ms;
+	uint32_t ui32Completed;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		memset(&g_sTxStats, 0, sizeof(g_sTxStats));
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "window")))
+	{
+		ui32Window = strtoul(argv[2], 0, 10);
+		if((ui32Window == 0) || (ui32Window > XBEE_TX_SLOTS))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		XBeeTxWindowSet(ui32Window);
+		return 0;
+	}
+	else if(((3 == argc) || (4 == argc)) && (0 == strcmp(argv[1], "sim")))
+	{
+		XBeeTxSimSet(argv[2][0] == '1',
+		             (4 == argc) ? strtoul(argv[3], 0, 10) : 0);
+		if(g_ui32TxSimErrorPpm >= 1000000)
+		{
+			XBeeTxSimSet(false, 0);
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+		return 0;
+	}
+	else if(((3 == argc) || (4 == argc)) && (0 == strcmp(argv[1], "bench")))
+	{
+		ui32Count = strtoul(argv[2], 0, 10);
+		ui32Len = (4 == argc) ? strtoul(argv[3], 0, 10) : 64;
+		if((ui32Count == 0) || (ui32Len < XBEE_MSG_HDR_SIZE) ||
+		   (ui32Len > XBEE_TX_MAX_PAYLOAD))
+		{
+			UARTprintf("Error: invalid input, try again\n");
+			return 1;
+		}
+
+		ui32Window = g_ui32TxWindow;
+		XBeeTxWindowSet(1);
+		ui32Ms = XBeeTxBenchRun(ui32Count, ui32Len);
+		UARTprintf("stop-and-wait: %u x %u bytes in %u ms, %u frames/s\n",
+		           ui32Count, ui32Len, ui32Ms,
+		           ui32Ms ? ((ui32Count * 1000) / ui32Ms) : 0);
+
+		XBeeTxWindowSet(ui32Window);
+		ui32Ms = XBeeTxBenchRun(ui32Count, ui32Len);
+		UARTprintf("window %u:      %u x %u bytes in %u ms, %u frames/s\n",
+		           ui32Window, ui32Count, ui32Len, ui32Ms,
+		           ui32Ms ? ((ui32Count * 1000) / ui32Ms) : 0);
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	ui32Completed = g_sTxStats.pui32Result[XBEE_TX_SUCCESS] +
+	                g_sTxStats.pui32Result[XBEE_TX_NO_ACK] +
+	                g_sTxStats.pui32Result[XBEE_TX_CCA_FAILURE] +
+	                g_sTxStats.pui32Result[XBEE_TX_PURGED];
+	UARTprintf("window %u%s, %u in flight (peak %u)\n", g_ui32TxWindow,
+	           g_bTxSim ? " (simulated radio)" : "", XBeeTxInFlight(),
+	           g_sTxStats.ui32InFlightMax);
+	UARTprintf("sent %u, untracked %u, too big %u, queue full %u\n",
+	           g_sTxStats.ui32Sent, g_sTxStats.ui32Untracked,
+	           g_sTxStats.ui32TooBig, g_sTxStats.ui32Refused);
+	UARTprintf("delivered %u, no ack %u, cca %u, purged %u, timed out %u, "
+	           "stale %u\n", g_sTxStats.pui32Result[XBEE_TX_SUCCESS],
+	           g_sTxStats.pui32Result[XBEE_TX_NO_ACK],
+	           g_sTxStats.pui32Result[XBEE_TX_CCA_FAILURE],
+	           g_sTxStats.pui32Result[XBEE_TX_PURGED],
+	           g_sTxStats.ui32TimedOut, g_sTxStats.ui32Stale);
+	UARTprintf("retries %u, status round trip avg %u ms, max %u ms\n",
+	           g_sTxStats.ui32Retries,
+	           ui32Completed ? (g_sTxStats.ui32RttSum / ui32Completed) : 0,
+	           g_sTxStats.ui32RttMax);
+	UARTprintf("bench messages received %u\n", g_sTxStats.ui32BenchRx);
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+//*****************************************************************************
+//
+// XBeeTx.h - Headers for use with XBeeTx.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEETX_H__
+#define __XBEETX_H__
+
+//*****************************************************************************
+//
+// In flight table size, and the default number of transmit requests that
+// may wait for their status per destination (1 is stop-and-wait).
+//
+//*****************************************************************************
+#define XBEE_TX_SLOTS           16
+#define XBEE_TX_WINDOW_DEFAULT  4
+
+//*****************************************************************************
+//
+// A request whose status has not come back after this long is completed
+// as XBEE_TX_TIMED_OUT. Covers the XBee's own retries and CCA backoff.
+// Counted from when the scheduler hands the request to UART1, so one held
+// in its queue for airtime does not time out.
+//
+//*****************************************************************************
+#define XBEE_TX_TIMEOUT_MS      1000
+
+//*****************************************************************************
+//
+// Largest RF payload of one transmit request (802.15.4 firmware)
+//
+//*****************************************************************************
+#define XBEE_TX_MAX_PAYLOAD     100
+
+//*****************************************************************************
+//
+// Delivery results. 0-3 are the status byte of the transmit status frame.
+//
+//*****************************************************************************
+#define XBEE_TX_SUCCESS         0
+#define XBEE_TX_NO_ACK          1
+#define XBEE_TX_CCA_FAILURE     2
+#define XBEE_TX_PURGED          3
+#define XBEE_TX_TIMED_OUT       0xFF
+
+//*****************************************************************************
+//
+// Simulated radio used by 'tx sim': time on air per byte at 250kbit/s plus
+// CCA and ACK turnaround per frame, on top of the serial time at the
+// current baud rate. A frame that is lost took XBEE_TX_SIM_TRIES tries.
+//
+//*****************************************************************************
+#define XBEE_TX_SIM_AIR_US_FIXED 1500
+#define XBEE_TX_SIM_AIR_US_PER_BYTE 32
+#define XBEE_TX_SIM_TRIES       4
+
+//*****************************************************************************
+//
+// Called when a request completes, from XBeeLinkPoll().
+//
+//*****************************************************************************
+typedef void (*tXBeeTxDone)(void *pvArg, uint8_t ui8FrameId,
+                            uint32_t ui32Result, uint32_t ui32Retries);
+
+//*****************************************************************************
+//
+// Transmit statistics
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32Sent;
+	uint32_t ui32Untracked;             // no slot free, sent with frame ID 0
+	uint32_t ui32TooBig;
+	uint32_t ui32Refused;               // not queued, scheduler queue full
+	uint32_t pui32Result[4];            // by status byte
+	uint32_t ui32TimedOut;
+	uint32_t ui32Stale;                 // status for no request in flight
+	uint32_t ui32Retries;
+	uint32_t ui32RttSum;                // ms, completed with a status
+	uint32_t ui32RttMax;
+	uint32_t ui32InFlightMax;
+	uint32_t ui32BenchRx;               // bench messages from another node
+}
+tXBeeTxStats;
+
+//*****************************************************************************
+//
+// API transmit functions
+//
+//*****************************************************************************
+extern uint8_t XBeeTxSend(uint64_t ui64Dest, uint32_t ui32Class,
+                          const uint8_t *pui8Data, uint32_t ui32Len,
+                          tXBeeTxDone pfnDone, void *pvArg);
+extern bool XBeeTxReady(uint64_t ui64Dest);
+extern uint32_t XBeeTxInFlight(void);
+extern void XBeeTxReleased(uint8_t ui8FrameId);
+extern void XBeeTxStatusFrame(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeTxBenchMsg(const uint8_t *pui8Msg, uint32_t ui32Len);
+extern void XBeeTxPoll(void);
+extern void XBeeTxWindowSet(uint32_t ui32Window);
+extern void XBeeTxSimSet(bool bEnable, uint32_t ui32ErrorPpm);
+extern void XBeeTxStatsGet(tXBeeTxStats *psStats);
+extern int Cmd_tx(int argc, char *argv[]);
+
+#endif //__XBEETX_H__
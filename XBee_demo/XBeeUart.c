@@ -0,0 +1,647 @@
+//*****************************************************************************
+//
+// XBeeUart.c - Buffered, flow controlled UART1 link to the XBee
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//!
+//! All traffic to and from the XBee goes through a pair of ring buffers.
+//! The UART1 interrupt moves bytes between the rings and the hardware FIFOs,
+//! the rest of the firmware only ever touches the rings.
+//!
+//! Whole frames can instead be handed over as pool buffers with
+//! XBeeUartSubmit(). They are sent straight from the buffer, after anything
+//! already in the transmit ring, and the interrupt frees each one once its
+//! last byte is in the FIFO.
+//!
+//! With flow control enabled CTS gates the transmitter in hardware, and the
+//! receive side is throttled by masking the receive interrupt when the ring
+//! is nearly full. The hardware FIFO then fills up and the UART deasserts RTS
+//! so the XBee holds its data instead of overrunning us.
+//!
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "utils/uartstdio.h"
+#include "XBeePool.h"
+#include "XBeeTick.h"
+#include "XBeeUart.h"
+#include "XBeeProf.h"
+
+//*****************************************************************************
+//
+// Ring buffers. Indexes are free running and masked on access, the ISR owns
+// the receive head and the transmit tail, the main loop owns the other two.
+//
+//*****************************************************************************
+static uint8_t g_pui8TxBuf[XBEE_UART_TX_BUF_SIZE];
+static uint8_t g_pui8RxBuf[XBEE_UART_RX_BUF_SIZE];
+static volatile uint32_t g_ui32TxHead;
+static volatile uint32_t g_ui32TxTail;
+static volatile uint32_t g_ui32RxHead;
+static volatile uint32_t g_ui32RxTail;
+
+//*****************************************************************************
+//
+// Submitted buffers. The main loop appends at the tail with the interrupt
+// off, the ISR sends from the head and frees. The byte counts are free
+// running like the ring indexes.
+//
+//*****************************************************************************
+static tXBeeBuf *volatile g_psTxBlockHead;
+static tXBeeBuf *g_psTxBlockTail;
+static uint32_t g_ui32TxBlockPos;
+static volatile uint32_t g_ui32TxBlockIn;
+static volatile uint32_t g_ui32TxBlockOut;
+
+//*****************************************************************************
+//
+// Link state
+//
+//*****************************************************************************
+static volatile bool g_bRxThrottled;
+static bool g_bFlowControl;
+static void (*g_pfnUartIsr)(void);
+static uint32_t g_ui32Baud;
+static tXBeeUartStats g_sStats;
+
+//*****************************************************************************
+//
+// Move as many bytes as will fit from the transmit ring, then from the
+// submitted buffers, into the FIFO. A buffer once started is finished
+// before the ring is looked at again. The transmit interrupt is left
+// enabled only while there is data waiting. Must be called from the ISR or
+// with the UART1 interrupt disabled.
+//
+//*****************************************************************************
+static void
+XBeeUartTxFill(void)
+{
+	tXBeeBuf *psBuf;
+
+	while(ROM_UARTSpaceAvail(UART1_BASE))
+	{
+		if((g_ui32TxBlockPos == 0) && (g_ui32TxTail != g_ui32TxHead))
+		{
+			ROM_UARTCharPutNonBlocking(UART1_BASE,
+			        g_pui8TxBuf[g_ui32TxTail & (XBEE_UART_TX_BUF_SIZE - 1)]);
+			g_ui32TxTail++;
+		}
+		else if(g_psTxBlockHead)
+		{
+			psBuf = g_psTxBlockHead;
+			ROM_UARTCharPutNonBlocking(UART1_BASE,
+			                           psBuf->pui8Data[g_ui32TxBlockPos++]);
+			g_ui32TxBlockOut++;
+			if(g_ui32TxBlockPos == psBuf->ui16Len)
+			{
+				g_psTxBlockHead = psBuf->psNext;
+				if(g_psTxBlockHead == 0)
+				{
+					g_psTxBlockTail = 0;
+				}
+				g_ui32TxBlockPos = 0;
+				XBeePoolFree(psBuf);
+			}
+		}
+		else
+		{
+			break;
+		}
+		g_sStats.ui32TxBytes++;
+	}
+
+	if(XBeeUartTxPending() == 0)
+	{
+		ROM_UARTIntDisable(UART1_BASE, UART_INT_TX);
+	}
+	else
+	{
+		ROM_UARTIntEnable(UART1_BASE, UART_INT_TX);
+	}
+}
+
+//*****************************************************************************
+//
+// Empty the receive FIFO into the receive ring. Throttles the link when the
+// ring crosses the high water mark and flow control is on.
+//
+//*****************************************************************************
+static void
+XBeeUartRxDrain(void)
+{
+	uint32_t ui32Char;
+	uint32_t ui32Used;
+
+	while(ROM_UARTCharsAvail(UART1_BASE))
+	{
+		//
+		// Data register carries the error flags in bits 8-11, overruns are
+		// counted from the interrupt status instead.
+		//
+		ui32Char = ROM_UARTCharGetNonBlocking(UART1_BASE);
+		if(ui32Char & 0x700)
+		{
+			g_sStats.ui32RxErrors++;
+		}
+
+		if((g_ui32RxHead - g_ui32RxTail) >= XBEE_UART_RX_BUF_SIZE)
+		{
+			g_sStats.ui32RxDropped++;
+			continue;
+		}
+
+		g_pui8RxBuf[g_ui32RxHead & (XBEE_UART_RX_BUF_SIZE - 1)] =
+		        (uint8_t)ui32Char;
+		g_ui32RxHead++;
+		g_sStats.ui32RxBytes++;
+	}
+
+	ui32Used = g_ui32RxHead - g_ui32RxTail;
+	if(ui32Used > g_sStats.ui32RxHighWater)
+	{
+		g_sStats.ui32RxHighWater = ui32Used;
+	}
+
+	//
+	// Stop draining the FIFO, the UART will drop RTS once it fills
+	//
+	if(g_bFlowControl && (ui32Used >= XBEE_UART_RX_HIGH_WATER))
+	{
+		ROM_UARTIntDisable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+		g_bRxThrottled = true;
+		g_sStats.ui32RxThrottled++;
+	}
+}
+
+//*****************************************************************************
+//
+// The UART1 interrupt handler.
+// Moves bytes between the XBee (UART1) and the receive / transmit rings.
+//
+//*****************************************************************************
+void
+UART1IntHandler(void)
+{
+	uint32_t ui32Status;
+
+	if(g_pfnUartIsr)
+	{
+		g_pfnUartIsr();
+		return;
+	}
+
+	XBEE_PROF_ENTER(XBEE_PROF_UART1_ISR);
+
+	//
+	// Get and clear the asserted interrupts.
+	//
+	ui32Status = ROM_UARTIntStatus(UART1_BASE, true);
+	ROM_UARTIntClear(UART1_BASE, ui32Status);
+
+	if(ui32Status & UART_INT_OE)
+	{
+		g_sStats.ui32RxOverrun++;
+	}
+
+	//
+	// Always drain unless throttled, this is also how XBeeUartRead() restarts
+	// reception after a throttle by pending this interrupt.
+	//
+	if(!g_bRxThrottled)
+	{
+		XBeeUartRxDrain();
+	}
+
+	XBeeUartTxFill();
+
+	XBEE_PROF_EXIT(XBEE_PROF_UART1_ISR);
+}
+
+//*****************************************************************************
+//
+// Hand the UART1 interrupt to pfnIsr, which then owns the UART, or take it
+// back with 0. The rings are left as they are; reception restarts on
+// return.
+//
+//*****************************************************************************
+void
+XBeeUartIsrSet(void (*pfnIsr)(void))
+{
+	g_pfnUartIsr = pfnIsr;
+
+	if(pfnIsr == 0)
+	{
+		g_bRxThrottled = false;
+		ROM_UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+		IntPendSet(INT_UART1);
+	}
+}
+
+//*****************************************************************************
+//
+// Configure UART1, its pins and its interrupt. Replaces the old
+// UARTStdioConfig(1, ...) set up in main().
+//
+//*****************************************************************************
+void
+XBeeUartInit(uint32_t ui32Baud, bool bFlowControl)
+{
+	//
+	// Setup UART1 on PB0 / PB1
+	//
+	ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+	ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+	GPIOPinConfigure(GPIO_PB0_U1RX);
+	GPIOPinConfigure(GPIO_PB1_U1TX);
+	ROM_GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+	g_ui32TxHead = g_ui32TxTail = 0;
+	g_ui32RxHead = g_ui32RxTail = 0;
+	g_bRxThrottled = false;
+
+	//
+	// Clocked from PIOSC like UART0, so the divisor stays exact whatever the
+	// system clock is switched to
+	//
+	UARTClockSourceSet(UART1_BASE, UART_CLOCK_PIOSC);
+	XBeeUartBaudSet(ui32Baud);
+	XBeeUartFlowControlSet(bFlowControl);
+
+	//
+	// Interrupt when the transmit FIFO is half empty and the receive FIFO is
+	// half full, leaving 8 bytes of slack after RTS drops.
+	//
+	ROM_UARTFIFOLevelSet(UART1_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+
+	ROM_IntEnable(INT_UART1);
+	ROM_UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+}
+
+//*****************************************************************************
+//
+// Throw away everything waiting to be sent, freeing submitted buffers.
+//
+//*****************************************************************************
+static void
+XBeeUartTxFlush(void)
+{
+	tXBeeBuf *psBuf;
+
+	ROM_IntDisable(INT_UART1);
+	g_sStats.ui32TxFlushed += XBeeUartTxPending();
+	g_ui32TxTail = g_ui32TxHead;
+	while(g_psTxBlockHead)
+	{
+		psBuf = g_psTxBlockHead;
+		g_psTxBlockHead = psBuf->psNext;
+		XBeePoolFree(psBuf);
+	}
+	g_psTxBlockTail = 0;
+	g_ui32TxBlockPos = 0;
+	g_ui32TxBlockOut = g_ui32TxBlockIn;
+	ROM_UARTIntDisable(UART1_BASE, UART_INT_TX);
+	ROM_IntEnable(INT_UART1);
+}
+
+//*****************************************************************************
+//
+// Set the UART1 baud rate, from PIOSC (XBEE_UART_CLOCK). Waits for pending
+// transmit data to go out first so no byte is sent at the wrong rate, but
+// only as long as it takes at the old rate plus XBEE_UART_DRAIN_MS: a radio
+// holding CTS off would otherwise hang here. What is left then is dropped,
+// and the few bytes already in the FIFO are let out past CTS, as
+// UARTConfigSetExpClk() waits for the FIFO to empty.
+//
+//*****************************************************************************
+void
+XBeeUartBaudSet(uint32_t ui32Baud)
+{
+	uint32_t ui32Deadline;
+
+	ui32Deadline = XBeeTickGet() + XBEE_UART_DRAIN_MS;
+	if(g_ui32Baud)
+	{
+		ui32Deadline += (XBeeUartTxPending() * 10 * 1000) / g_ui32Baud;
+	}
+
+	while(!XBeeUartTxIdle())
+	{
+		if(XBEE_TICK_REACHED(XBeeTickGet(), ui32Deadline))
+		{
+			XBeeUartTxFlush();
+			if(g_bFlowControl)
+			{
+				UARTFlowControlSet(UART1_BASE, UART_FLOWCONTROL_RX);
+			}
+			break;
+		}
+	}
+
+	g_ui32Baud = ui32Baud;
+	ROM_UARTConfigSetExpClk(UART1_BASE, XBEE_UART_CLOCK, ui32Baud,
+	                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+	                         UART_CONFIG_PAR_NONE));
+	if(g_bFlowControl)
+	{
+		UARTFlowControlSet(UART1_BASE,
+		                   UART_FLOWCONTROL_TX | UART_FLOWCONTROL_RX);
+	}
+}
+
+uint32_t
+XBeeUartBaudGet(void)
+{
+	return g_ui32Baud;
+}
+
+//*****************************************************************************
+//
+// Turn RTS / CTS flow control on or off.
+//
+//*****************************************************************************
+void
+XBeeUartFlowControlSet(bool bFlowControl)
+{
+	if(bFlowControl)
+	{
+		ROM_SysCtlPeripheralEnable(XBEE_UART_FLOW_PERIPH);
+		GPIOPinConfigure(XBEE_UART_RTS_PIN_CFG);
+		GPIOPinConfigure(XBEE_UART_CTS_PIN_CFG);
+		ROM_GPIOPinTypeUART(XBEE_UART_FLOW_PORT, XBEE_UART_FLOW_PINS);
+		UARTFlowControlSet(UART1_BASE,
+		                   UART_FLOWCONTROL_TX | UART_FLOWCONTROL_RX);
+	}
+	else
+	{
+		UARTFlowControlSet(UART1_BASE, UART_FLOWCONTROL_NONE);
+	}
+
+	g_bFlowControl = bFlowControl;
+}
+
+bool
+XBeeUartFlowControlGet(void)
+{
+	return g_bFlowControl;
+}
+
+//*****************************************************************************
+//
+// Queue data for the XBee. Blocks while the transmit ring is full, with CTS
+// flow control this is where the caller waits for the radio to catch up.
+//
+//*****************************************************************************
+void
+XBeeUartWrite(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	uint32_t ui32Space;
+	uint32_t ui32Chunk;
+	uint32_t ui32Index;
+
+	while(ui32Len)
+	{
+		ui32Space = XBeeUartTxSpace();
+		if(0 == ui32Space)
+		{
+			g_sStats.ui32TxStalls++;
+			while(0 == XBeeUartTxSpace())
+			{
+			}
+			continue;
+		}
+
+		//
+		// Copy as much as fits without wrapping
+		//
+		ui32Index = g_ui32TxHead & (XBEE_UART_TX_BUF_SIZE - 1);
+		ui32Chunk = XBEE_UART_TX_BUF_SIZE - ui32Index;
+		if(ui32Chunk > ui32Space)
+		{
+			ui32Chunk = ui32Space;
+		}
+		if(ui32Chunk > ui32Len)
+		{
+			ui32Chunk = ui32Len;
+		}
+		memcpy(&g_pui8TxBuf[ui32Index], pui8Data, ui32Chunk);
+		g_ui32TxHead += ui32Chunk;
+		pui8Data += ui32Chunk;
+		ui32Len -= ui32Chunk;
+
+		//
+		// Prime the transmitter
+		//
+		ROM_IntDisable(INT_UART1);
+		XBeeUartTxFill();
+		ROM_IntEnable(INT_UART1);
+	}
+}
+
+void
+XBeeUartPut(uint8_t ui8Char)
+{
+	XBeeUartWrite(&ui8Char, 1);
+}
+
+//*****************************************************************************
+//
+// Queue a pool buffer for the XBee without copying it. The driver owns
+// psBuf from here and frees it once sent. Never blocks.
+//
+//*****************************************************************************
+void
+XBeeUartSubmit(tXBeeBuf *psBuf)
+{
+	if(psBuf->ui16Len == 0)
+	{
+		XBeePoolFree(psBuf);
+		return;
+	}
+
+	psBuf->psNext = 0;
+
+	ROM_IntDisable(INT_UART1);
+	if(g_psTxBlockTail)
+	{
+		g_psTxBlockTail->psNext = psBuf;
+	}
+	else
+	{
+		g_psTxBlockHead = psBuf;
+	}
+	g_psTxBlockTail = psBuf;
+	g_ui32TxBlockIn += psBuf->ui16Len;
+	XBeeUartTxFill();
+	ROM_IntEnable(INT_UART1);
+}
+
+//*****************************************************************************
+//
+// Copy up to ui32Max received bytes out of the receive ring without blocking.
+// Returns the number of bytes copied. Releases a receive throttle once the
+// ring has drained below the low water mark.
+//
+//*****************************************************************************
+uint32_t
+XBeeUartRead(uint8_t *pui8Data, uint32_t ui32Max)
+{
+	uint32_t ui32Count;
+	uint32_t ui32Index;
+	uint32_t ui32Chunk;
+
+	ui32Count = XBeeUartRxAvail();
+	if(ui32Count > ui32Max)
+	{
+		ui32Count = ui32Max;
+	}
+
+	//
+	// At most two copies, before and after the wrap point
+	//
+	ui32Index = g_ui32RxTail & (XBEE_UART_RX_BUF_SIZE - 1);
+	ui32Chunk = XBEE_UART_RX_BUF_SIZE - ui32Index;
+	if(ui32Chunk > ui32Count)
+	{
+		ui32Chunk = ui32Count;
+	}
+	memcpy(pui8Data, &g_pui8RxBuf[ui32Index], ui32Chunk);
+	memcpy(pui8Data + ui32Chunk, g_pui8RxBuf, ui32Count - ui32Chunk);
+	g_ui32RxTail += ui32Count;
+
+	if(g_bRxThrottled && (XBeeUartRxAvail() <= XBEE_UART_RX_LOW_WATER))
+	{
+		g_bRxThrottled = false;
+		ROM_UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+
+		//
+		// The FIFO may be sitting full with no edge left to interrupt on
+		//
+		IntPendSet(INT_UART1);
+	}
+
+	return ui32Count;
+}
+
+uint32_t
+XBeeUartRxAvail(void)
+{
+	return g_ui32RxHead - g_ui32RxTail;
+}
+
+uint32_t
+XBeeUartTxSpace(void)
+{
+	return XBEE_UART_TX_BUF_SIZE - (g_ui32TxHead - g_ui32TxTail);
+}
+
+//*****************************************************************************
+//
+// Bytes waiting to go into the FIFO, in the ring and submitted buffers.
+//
+//*****************************************************************************
+uint32_t
+XBeeUartTxPending(void)
+{
+	return (g_ui32TxHead - g_ui32TxTail) +
+	       (g_ui32TxBlockIn - g_ui32TxBlockOut);
+}
+
+//*****************************************************************************
+//
+// True once nothing is waiting to be sent and the last bit has left the
+// UART.
+//
+//*****************************************************************************
+bool
+XBeeUartTxIdle(void)
+{
+	return (XBeeUartTxPending() == 0) && !ROM_UARTBusy(UART1_BASE);
+}
+
+void
+XBeeUartStatsGet(tXBeeUartStats *psStats)
+{
+	*psStats = g_sStats;
+}
+
+void
+XBeeUartStatsClear(void)
+{
+	memset(&g_sStats, 0, sizeof(g_sStats));
+}
+
+//*****************************************************************************
+//
+// UART1 Link Command
+// Input: none / 'clear' / 'flow <1=on, 0=off>' / 'baud <rate>'
+// Response: link statistics
+// Use: to check for lost bytes on the radio link, or to change flow control
+//		and baud rate. The XBee must be set to the same rate first (ATBD).
+//
+//*****************************************************************************
+int
+Cmd_uart(int argc, char *argv[])
+{
+	tXBeeUartStats sStats;
+
+	if((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		XBeeUartStatsClear();
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "flow")))
+	{
+		XBeeUartFlowControlSet(argv[2][0] == '1');
+		return 0;
+	}
+	else if((3 == argc) && (0 == strcmp(argv[1], "baud")))
+	{
+		XBeeUartBaudSet(strtoul(argv[2], 0, 10));
+		return 0;
+	}
+	else if(argc != 1)
+	{
+		UARTprintf("Error: invalid input, try again\n");
+		return 1;
+	}
+
+	XBeeUartStatsGet(&sStats);
+	UARTprintf("UART1 %d baud, flow control %s\n", g_ui32Baud,
+	           g_bFlowControl ? "on" : "off");
+	UARTprintf("  rx bytes    %u\n", sStats.ui32RxBytes);
+	UARTprintf("  tx bytes    %u\n", sStats.ui32TxBytes);
+	UARTprintf("  rx overrun  %u\n", sStats.ui32RxOverrun);
+	UARTprintf("  rx dropped  %u\n", sStats.ui32RxDropped);
+	UARTprintf("  rx errors   %u\n", sStats.ui32RxErrors);
+	UARTprintf("  rx throttle %u\n", sStats.ui32RxThrottled);
+	UARTprintf("  tx stalls   %u\n", sStats.ui32TxStalls);
+	UARTprintf("  tx flushed  %u\n", sStats.ui32TxFlushed);
+	UARTprintf("  rx peak     %u/%u\n", sStats.ui32RxHighWater,
+	           XBEE_UART_RX_BUF_SIZE);
+
+	return 0;
+}
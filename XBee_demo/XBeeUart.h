@@ -0,0 +1,113 @@
+//*****************************************************************************
+//
+// XBeeUart.h - Headers for use with XBeeUart.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __XBEEUART_H__
+#define __XBEEUART_H__
+
+//*****************************************************************************
+//
+// UART1 runs from the 16MHz precision internal oscillator, not the system
+// clock, so the system clock can change without touching it.
+//
+//*****************************************************************************
+#define XBEE_UART_CLOCK         16000000
+
+//*****************************************************************************
+//
+// Ring buffer sizes for the UART1 radio link. Both must be a power of 2.
+//
+//*****************************************************************************
+#define XBEE_UART_TX_BUF_SIZE   256
+#define XBEE_UART_RX_BUF_SIZE   512
+
+//*****************************************************************************
+//
+// Receive throttling thresholds (bytes in the receive ring). When flow control
+// is on and the ring fills past the high water mark the receive interrupt is
+// masked, the 16 byte hardware FIFO fills and RTS is deasserted to the XBee.
+// Reception resumes once the reader has drained the ring below the low water
+// mark. The gap above the high water mark must hold at least one full FIFO.
+//
+//*****************************************************************************
+#define XBEE_UART_RX_HIGH_WATER (XBEE_UART_RX_BUF_SIZE - 64)
+#define XBEE_UART_RX_LOW_WATER  (XBEE_UART_RX_BUF_SIZE / 4)
+
+//*****************************************************************************
+//
+// Slack on top of the time pending transmit data needs at the old rate
+// before a baud change gives up waiting for it (CTS held by the radio).
+//
+//*****************************************************************************
+#define XBEE_UART_DRAIN_MS      100
+
+//*****************************************************************************
+//
+// Pins used for RTS / CTS on UART1. The XBee must have ATD6=1 (RTS flow
+// control) and ATD7=1 (CTS flow control, factory default) for these to work.
+//
+//*****************************************************************************
+#define XBEE_UART_FLOW_PERIPH   SYSCTL_PERIPH_GPIOC
+#define XBEE_UART_FLOW_PORT     GPIO_PORTC_BASE
+#define XBEE_UART_FLOW_PINS     (GPIO_PIN_4 | GPIO_PIN_5)
+#define XBEE_UART_RTS_PIN_CFG   GPIO_PC4_U1RTS
+#define XBEE_UART_CTS_PIN_CFG   GPIO_PC5_U1CTS
+
+//*****************************************************************************
+//
+// Link statistics, used to prove that no bytes are lost at high baud rates.
+//
+//*****************************************************************************
+typedef struct
+{
+	uint32_t ui32RxBytes;       // bytes placed in the receive ring
+	uint32_t ui32TxBytes;       // bytes handed to the transmit FIFO
+	uint32_t ui32RxOverrun;     // hardware FIFO overruns (bytes lost)
+	uint32_t ui32RxDropped;     // receive ring full (bytes lost, no flow ctl)
+	uint32_t ui32RxErrors;      // framing / parity / break errors
+	uint32_t ui32RxThrottled;   // times RTS was deasserted to the XBee
+	uint32_t ui32TxStalls;      // times a writer waited for ring space
+	uint32_t ui32TxFlushed;     // bytes dropped, CTS held past a baud change
+	uint32_t ui32RxHighWater;   // peak receive ring occupancy
+}
+tXBeeUartStats;
+
+struct tXBeeBuf;
+
+//*****************************************************************************
+//
+// UART1 radio link functions
+//
+//*****************************************************************************
+extern void XBeeUartInit(uint32_t ui32Baud, bool bFlowControl);
+extern void XBeeUartBaudSet(uint32_t ui32Baud);
+extern uint32_t XBeeUartBaudGet(void);
+extern void XBeeUartFlowControlSet(bool bFlowControl);
+extern bool XBeeUartFlowControlGet(void);
+extern void XBeeUartPut(uint8_t ui8Char);
+extern void XBeeUartWrite(const uint8_t *pui8Data, uint32_t ui32Len);
+extern void XBeeUartSubmit(struct tXBeeBuf *psBuf);
+extern uint32_t XBeeUartRead(uint8_t *pui8Data, uint32_t ui32Max);
+extern uint32_t XBeeUartRxAvail(void);
+extern uint32_t XBeeUartTxSpace(void);
+extern uint32_t XBeeUartTxPending(void);
+extern bool XBeeUartTxIdle(void);
+extern void XBeeUartStatsGet(tXBeeUartStats *psStats);
+extern void XBeeUartStatsClear(void);
+extern void XBeeUartIsrSet(void (*pfnIsr)(void));
+extern void UART1IntHandler(void);
+extern int Cmd_uart(int argc, char *argv[]);
+
+#endif //__XBEEUART_H__
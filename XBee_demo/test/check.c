@@ -0,0 +1,57 @@
+//*****************************************************************************
+//
+// check.c - Test results for the host tests
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "XBeePool.h"
+#include "host.h"
+
+//
+// Failed checks
+//
+static uint32_t g_ui32HostFails;
+
+//*****************************************************************************
+//
+// Print a check and count it if it failed.
+//
+//*****************************************************************************
+void
+HostCheck(bool bCond, const char *pcWhat, const char *pcFile, int iLine)
+{
+	if(bCond)
+	{
+		printf("ok      %s\n", pcWhat);
+	}
+	else
+	{
+		printf("FAILED  %s (%s:%d)\n", pcWhat, pcFile, iLine);
+		g_ui32HostFails++;
+	}
+}
+
+//*****************************************************************************
+//
+// Exit code for main(): 0 if every check passed.
+//
+//*****************************************************************************
+int
+HostResult(void)
+{
+	printf("%s\n", g_ui32HostFails ? "FAIL" : "PASS");
+	return g_ui32HostFails ? 1 : 0;
+}
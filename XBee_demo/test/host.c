@@ -0,0 +1,238 @@
+//*****************************************************************************
+//
+// host.c - XBeeTick and XBeeUart for a PC build of the demo
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Time is simulated: it moves only when a test calls HostAdvance(), when
+//! the link finds UART1 drained (one pass of the main loop, HOST_PASS_US)
+//! or when the idle loop sleeps. Runs are repeatable and as fast as the PC.
+//!
+//! UART1 has no radio behind it. What a test feeds with HostRxFeed() is
+//! read back by the link; frames the scheduler submits go to the test's
+//! hook, if any, and back to the pool.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "XBeePool.h"
+#include "XBeeTick.h"
+#include "XBeeUart.h"
+#include "host.h"
+
+//
+// Simulated time in us, and the CPU clock the cycle counter runs at
+//
+static uint64_t g_ui64HostUs;
+#define HOST_CPU_MHZ            80
+
+//
+// UART1
+//
+static uint32_t g_ui32HostBaud = 115200;
+static uint8_t g_pui8HostRx[4096];
+static uint32_t g_ui32HostRxHead;
+static uint32_t g_ui32HostRxTail;
+static void (*g_pfnHostSubmit)(tXBeeBuf *psBuf);
+
+//*****************************************************************************
+//
+// Move simulated time on.
+//
+//*****************************************************************************
+void
+HostAdvance(uint32_t ui32Us)
+{
+	g_ui64HostUs += ui32Us;
+}
+
+//*****************************************************************************
+//
+// The UART1 baud rate XBeeUartBaudGet() reports, for serial time.
+//
+//*****************************************************************************
+void
+HostBaudSet(uint32_t ui32Baud)
+{
+	g_ui32HostBaud = ui32Baud;
+}
+
+//*****************************************************************************
+//
+// Queue bytes as if the radio had sent them.
+//
+//*****************************************************************************
+void
+HostRxFeed(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	if(ui32Len > (sizeof(g_pui8HostRx) - g_ui32HostRxTail))
+	{
+		memmove(g_pui8HostRx, g_pui8HostRx + g_ui32HostRxHead,
+		        g_ui32HostRxTail - g_ui32HostRxHead);
+		g_ui32HostRxTail -= g_ui32HostRxHead;
+		g_ui32HostRxHead = 0;
+	}
+	if(ui32Len > (sizeof(g_pui8HostRx) - g_ui32HostRxTail))
+	{
+		ui32Len = sizeof(g_pui8HostRx) - g_ui32HostRxTail;
+	}
+	memcpy(g_pui8HostRx + g_ui32HostRxTail, pui8Data, ui32Len);
+	g_ui32HostRxTail += ui32Len;
+}
+
+//*****************************************************************************
+//
+// Have frames handed to UART1 passed to pfnSubmit first; 0 for none.
+//
+//*****************************************************************************
+void
+HostSubmitSet(void (*pfnSubmit)(tXBeeBuf *psBuf))
+{
+	g_pfnHostSubmit = pfnSubmit;
+}
+
+//*****************************************************************************
+//
+// XBeeTick.h
+//
+//*****************************************************************************
+void
+XBeeTickInit(void)
+{
+}
+
+void
+XBeeTickClockUpdate(void)
+{
+}
+
+uint32_t
+XBeeTickGet(void)
+{
+	return (uint32_t)(g_ui64HostUs / 1000);
+}
+
+uint32_t
+XBeeTickMicros(void)
+{
+	return (uint32_t)g_ui64HostUs;
+}
+
+uint32_t
+XBeeTickSleep(uint32_t ui32Ms)
+{
+	g_ui64HostUs += (uint64_t)ui32Ms * 1000;
+	return ui32Ms * 1000;
+}
+
+void
+XBeeCycleCountEnable(void)
+{
+}
+
+uint32_t
+XBeeCycleCountGet(void)
+{
+	return (uint32_t)(g_ui64HostUs * HOST_CPU_MHZ);
+}
+
+void
+SysTickIntHandler(void)
+{
+}
+
+uint32_t
+SysCtlClockGet(void)
+{
+	return HOST_CPU_MHZ * 1000000;
+}
+
+//*****************************************************************************
+//
+// XBeeUart.h, the parts the rest of the demo uses
+//
+//*****************************************************************************
+void
+XBeeUartBaudSet(uint32_t ui32Baud)
+{
+	g_ui32HostBaud = ui32Baud;
+}
+
+uint32_t
+XBeeUartBaudGet(void)
+{
+	return g_ui32HostBaud;
+}
+
+bool
+XBeeUartFlowControlGet(void)
+{
+	return true;
+}
+
+void
+XBeeUartSubmit(tXBeeBuf *psBuf)
+{
+	if(g_pfnHostSubmit)
+	{
+		g_pfnHostSubmit(psBuf);
+	}
+	XBeePoolFree(psBuf);
+}
+
+uint32_t
+XBeeUartRead(uint8_t *pui8Data, uint32_t ui32Max)
+{
+	uint32_t ui32Count;
+
+	ui32Count = g_ui32HostRxTail - g_ui32HostRxHead;
+	if(ui32Count == 0)
+	{
+		g_ui64HostUs += HOST_PASS_US;
+		return 0;
+	}
+	if(ui32Count > ui32Max)
+	{
+		ui32Count = ui32Max;
+	}
+	memcpy(pui8Data, g_pui8HostRx + g_ui32HostRxHead, ui32Count);
+	g_ui32HostRxHead += ui32Count;
+	return ui32Count;
+}
+
+uint32_t
+XBeeUartRxAvail(void)
+{
+	return g_ui32HostRxTail - g_ui32HostRxHead;
+}
+
+uint32_t
+XBeeUartTxPending(void)
+{
+	return 0;
+}
+
+bool
+XBeeUartTxIdle(void)
+{
+	return true;
+}
+
+void
+XBeeUartIsrSet(void (*pfnIsr)(void))
+{
+}
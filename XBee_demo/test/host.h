@@ -0,0 +1,59 @@
+//*****************************************************************************
+//
+// host.h - Headers for use with host.c and check.c
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+//*****************************************************************************
+//
+// Time a pass of the main loop takes, charged each time the link drains
+// UART1 (XBeeUartRead() with nothing left to read).
+//
+//*****************************************************************************
+#define HOST_PASS_US            100
+
+//*****************************************************************************
+//
+// Check an expectation, print it and remember a failure for the exit code.
+//
+//*****************************************************************************
+#define HOST_CHECK(bCond, pcWhat)                                            \
+	HostCheck((bCond), (pcWhat), __FILE__, __LINE__)
+
+//*****************************************************************************
+//
+// Host port functions. The demo is built without XBeeTick.c and
+// XBeeUart.c; host.c puts a simulated clock and a UART1 without a radio
+// behind their interfaces.
+//
+//*****************************************************************************
+extern void HostAdvance(uint32_t ui32Us);
+extern void HostBaudSet(uint32_t ui32Baud);
+extern void HostRxFeed(const uint8_t *pui8Data, uint32_t ui32Len);
+extern void HostSubmitSet(void (*pfnSubmit)(struct tXBeeBuf *psBuf));
+
+//*****************************************************************************
+//
+// Test results (check.c), and console output copied to a buffer as well
+// as stdout, until HostCapture(0, 0) (tiva/tiva.c)
+//
+//*****************************************************************************
+extern void HostCapture(char *pcBuf, uint32_t ui32Size);
+extern void HostCheck(bool bCond, const char *pcWhat, const char *pcFile,
+                      int iLine);
+extern int HostResult(void);
+
+#endif // __HOST_H__
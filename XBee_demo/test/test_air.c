@@ -0,0 +1,157 @@
+//*****************************************************************************
+//
+// test_air.c - Airtime budget: data offered far above the duty cycle stays
+//              inside it over any window
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "XBeePool.h"
+#include "XBeeFrame.h"
+#include "XBeeSched.h"
+#include "XBeeAir.h"
+#include "XBeeTick.h"
+#include "host.h"
+
+//
+// 60 byte data frames every 5 ms for 200 s, about six times what 9% of a
+// 24 kbit/s channel carries, against a 10 s bucket.
+//
+#define TEST_RUN_MS             200000
+#define TEST_OFFER_MS           5
+#define TEST_FRAME_LEN          60
+#define TEST_BUCKET_S           10
+#define TEST_FRAMES             (TEST_RUN_MS / TEST_OFFER_MS)
+
+//
+// When each frame reached UART1, and its air time
+//
+static uint32_t g_pui32SentMs[TEST_FRAMES];
+static uint32_t g_pui32SentAirUs[TEST_FRAMES];
+static uint32_t g_ui32Sent;
+
+//*****************************************************************************
+//
+// Log each frame the scheduler lets through.
+//
+//*****************************************************************************
+static void
+TestSubmit(tXBeeBuf *psBuf)
+{
+	if(psBuf->ui16AirLen && (g_ui32Sent < TEST_FRAMES))
+	{
+		g_pui32SentMs[g_ui32Sent] = XBeeTickGet();
+		g_pui32SentAirUs[g_ui32Sent] = XBeeAirUs(psBuf->ui16AirLen);
+		g_ui32Sent++;
+	}
+}
+
+//*****************************************************************************
+//
+// Most air time, in us, spent in any ui32WindowMs long stretch.
+//
+//*****************************************************************************
+static uint64_t
+TestWorstWindow(uint32_t ui32WindowMs)
+{
+	uint64_t ui64Sum;
+	uint64_t ui64Worst;
+	uint32_t ui32First;
+	uint32_t ui32Idx;
+
+	ui64Sum = 0;
+	ui64Worst = 0;
+	ui32First = 0;
+	for(ui32Idx = 0; ui32Idx < g_ui32Sent; ui32Idx++)
+	{
+		ui64Sum += g_pui32SentAirUs[ui32Idx];
+		while((g_pui32SentMs[ui32Idx] - g_pui32SentMs[ui32First]) >=
+		      ui32WindowMs)
+		{
+			ui64Sum -= g_pui32SentAirUs[ui32First++];
+		}
+		if(ui64Sum > ui64Worst)
+		{
+			ui64Worst = ui64Sum;
+		}
+	}
+	return ui64Worst;
+}
+
+int
+main(void)
+{
+	char *ppcOn[] = { "air", "on" };
+	char *ppcWindow[] = { "air", "window", "10" };
+	uint8_t pui8Msg[TEST_FRAME_LEN];
+	uint32_t ui32Offered;
+	uint32_t ui32Ms;
+	uint32_t ui32WindowMs;
+	uint32_t ui32FrameUs;
+	uint64_t ui64Worst;
+	uint64_t ui64Limit;
+	char pcWhat[80];
+
+	XBeePoolInit();
+	HostSubmitSet(TestSubmit);
+	Cmd_air(2, ppcOn);
+	Cmd_air(3, ppcWindow);
+
+	memset(pui8Msg, 0x11, sizeof(pui8Msg));
+	pui8Msg[0] = 0x41;
+	ui32Offered = 0;
+	for(ui32Ms = 1; ui32Ms < TEST_RUN_MS; ui32Ms++)
+	{
+		HostAdvance(1000);
+		if(((ui32Ms % TEST_OFFER_MS) == 0) &&
+		   (XBeeSchedSpace(XBEE_SCHED_DATA) >= (TEST_FRAME_LEN + 20)))
+		{
+			XBeeFrameQueue(XBEE_SCHED_DATA, pui8Msg, sizeof(pui8Msg));
+			ui32Offered++;
+		}
+		XBeeSchedPoll();
+	}
+	printf("queued %u frames, %u sent\n", ui32Offered, g_ui32Sent);
+	HOST_CHECK(g_ui32Sent != 0, "frames got through");
+
+	//
+	// No window may hold more than the duty cycle of it plus a full
+	// bucket, and one frame that straddles the window's start. A long
+	// window should come close to the duty cycle.
+	//
+	ui32FrameUs = g_ui32Sent ? g_pui32SentAirUs[0] : 0;
+	for(ui32WindowMs = 1000 * TEST_BUCKET_S; ui32WindowMs <= TEST_RUN_MS / 2;
+	    ui32WindowMs *= 10)
+	{
+		ui64Worst = TestWorstWindow(ui32WindowMs);
+		ui64Limit = ((uint64_t)XBEE_AIR_DUTY_DEFAULT *
+		             (ui32WindowMs + (1000 * TEST_BUCKET_S))) + ui32FrameUs;
+		printf("        worst %u s window: %u ms on air, %u.%02u%%\n",
+		       ui32WindowMs / 1000, (uint32_t)(ui64Worst / 1000),
+		       (uint32_t)(ui64Worst / (10 * ui32WindowMs)),
+		       (uint32_t)((ui64Worst / (ui32WindowMs / 10)) % 100));
+		snprintf(pcWhat, sizeof(pcWhat),
+		         "%u s window within duty cycle plus bucket",
+		         ui32WindowMs / 1000);
+		HOST_CHECK(ui64Worst <= ui64Limit, pcWhat);
+	}
+	HOST_CHECK(ui64Worst >= ((uint64_t)(XBEE_AIR_DUTY_DEFAULT - 1) *
+	                         (TEST_RUN_MS / 2)),
+	           "100 s window uses the duty cycle");
+
+	Cmd_air(1, 0);
+	return HostResult();
+}
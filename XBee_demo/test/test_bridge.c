@@ -0,0 +1,434 @@
+//*****************************************************************************
+//
+// test_bridge.c - Bridge soak: random data both ways at full line rate
+//                 through modelled UARTs, then the escape
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Both UARTs run at 115200 baud with 16 byte FIFOs, the FIFO level and
+//! receive timeout interrupts, and on UART1 RTS, which holds the XBee off
+//! when the receive FIFO is four past its level. Time moves in steps of a
+//! tenth of a byte time. The main loop makes one pass every <pace> steps
+//! (argument, default 10: a pass per byte time).
+//!
+//! 2,000,000 random bytes go each way. When both have arrived, the PC is
+//! silent for 1.2 s and sends the escape. With a pass every 10 byte times
+//! or faster everything must arrive byte-exact with nothing dropped or
+//! throttled, and the escape must end the bridge without being passed on.
+//! Slower than that, the XBee side is held off by RTS and loses nothing,
+//! while bytes from the PC, which has no flow control, may be dropped.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "XBeePool.h"
+#include "XBeeBridge.h"
+#include "host.h"
+
+//
+// Model
+//
+#define TEST_STEPS_PER_BYTE     10
+#define TEST_BYTES_PER_S        11520
+#define TEST_FIFO               16
+#define TEST_LEVEL              8
+#define TEST_RTS_MARGIN         4
+#define TEST_RT_BYTES           4           // receive timeout, byte times
+#define TEST_BYTES              2000000
+#define TEST_FAST_PACE          (10 * TEST_STEPS_PER_BYTE)
+
+//
+// One UART: receive and transmit FIFO, interrupt mask and raw status.
+// Index 0 is UART0 (PC), 1 is UART1 (XBee).
+//
+typedef struct
+{
+	uint8_t pui8Rx[TEST_FIFO];
+	uint32_t ui32RxCount;
+	uint8_t pui8Tx[TEST_FIFO];
+	uint32_t ui32TxCount;
+	uint32_t ui32Mask;
+	uint32_t ui32Raw;
+	uint32_t ui32Idle;                  // byte times without a new byte
+	bool bPend;
+	void (*pfnIsr)(void);
+}
+tTestUart;
+
+static tTestUart g_psTestUart[2];
+static uint64_t g_ui64TestStep;
+static bool g_bTestMasked;
+
+//
+// Per UART: what arrives on its receive line, and what left on its
+// transmit line. Source 0 is what the PC sends, 1 what the XBee sends.
+//
+static uint8_t *g_ppui8Src[2];
+static uint8_t *g_ppui8Dst[2];
+static uint32_t g_pui32SrcLen[2];
+static uint32_t g_pui32SrcPos[2];
+static uint32_t g_pui32DstPos[2];
+static uint32_t g_pui32Overrun[2];
+
+//*****************************************************************************
+//
+// driverlib, on the model
+//
+//*****************************************************************************
+static tTestUart *
+TestUart(uint32_t ui32Base)
+{
+	return &g_psTestUart[(ui32Base == UART0_BASE) ? 0 : 1];
+}
+
+void
+UARTIntEnable(uint32_t ui32Base, uint32_t ui32Flags)
+{
+	TestUart(ui32Base)->ui32Mask |= ui32Flags;
+}
+
+void
+UARTIntDisable(uint32_t ui32Base, uint32_t ui32Flags)
+{
+	TestUart(ui32Base)->ui32Mask &= ~ui32Flags;
+}
+
+uint32_t
+UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+	tTestUart *psUart = TestUart(ui32Base);
+
+	return psUart->ui32Raw & (bMasked ? psUart->ui32Mask : 0xFFFFFFFF);
+}
+
+void
+UARTIntClear(uint32_t ui32Base, uint32_t ui32Flags)
+{
+	TestUart(ui32Base)->ui32Raw &= ~ui32Flags;
+}
+
+bool
+UARTCharsAvail(uint32_t ui32Base)
+{
+	return TestUart(ui32Base)->ui32RxCount != 0;
+}
+
+bool
+UARTSpaceAvail(uint32_t ui32Base)
+{
+	return TestUart(ui32Base)->ui32TxCount < TEST_FIFO;
+}
+
+int32_t
+UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+	tTestUart *psUart = TestUart(ui32Base);
+	int32_t i32Char;
+
+	if(psUart->ui32RxCount == 0)
+	{
+		return -1;
+	}
+	i32Char = psUart->pui8Rx[0];
+	memmove(psUart->pui8Rx, psUart->pui8Rx + 1, --psUart->ui32RxCount);
+	return i32Char;
+}
+
+bool
+UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+	tTestUart *psUart = TestUart(ui32Base);
+
+	if(psUart->ui32TxCount >= TEST_FIFO)
+	{
+		return false;
+	}
+	psUart->pui8Tx[psUart->ui32TxCount++] = ucData;
+	return true;
+}
+
+void
+UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+	if(!UARTCharPutNonBlocking(ui32Base, ucData))
+	{
+		printf("FAILED  blocking put into a full FIFO\n");
+		exit(1);
+	}
+}
+
+void
+UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                 uint32_t ui32RxLevel)
+{
+}
+
+bool
+IntMasterDisable(void)
+{
+	g_bTestMasked = true;
+	return false;
+}
+
+bool
+IntMasterEnable(void)
+{
+	g_bTestMasked = false;
+	return false;
+}
+
+void
+IntPendSet(uint32_t ui32Interrupt)
+{
+	g_psTestUart[(ui32Interrupt == INT_UART0) ? 0 : 1].bPend = true;
+}
+
+//*****************************************************************************
+//
+// What the bridge uses of XBeeTick, XBeeUart and XBeeIdle
+//
+//*****************************************************************************
+uint32_t
+XBeeTickGet(void)
+{
+	return (uint32_t)((g_ui64TestStep * 1000) /
+	                  (TEST_BYTES_PER_S * TEST_STEPS_PER_BYTE));
+}
+
+uint32_t
+XBeeUartRead(uint8_t *pui8Data, uint32_t ui32Max)
+{
+	return 0;
+}
+
+bool
+XBeeUartTxIdle(void)
+{
+	return true;
+}
+
+bool
+XBeeUartFlowControlGet(void)
+{
+	return true;
+}
+
+uint32_t
+XBeeUartBaudGet(void)
+{
+	return TEST_BYTES_PER_S * 10;
+}
+
+void
+XBeeUartIsrSet(void (*pfnIsr)(void))
+{
+	g_psTestUart[1].pfnIsr = pfnIsr;
+}
+
+void
+XBeeIdleUart0IsrSet(void (*pfnIsr)(void))
+{
+	g_psTestUart[0].pfnIsr = pfnIsr;
+}
+
+//*****************************************************************************
+//
+// One step of both lines: a byte in and a byte out per byte time, FIFO
+// level, receive timeout and overrun, then the interrupt if it is due.
+//
+//*****************************************************************************
+static void
+TestStep(void)
+{
+	tTestUart *psUart;
+	uint32_t ui32Idx;
+	bool bHeld;
+
+	g_ui64TestStep++;
+	for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+	{
+		psUart = &g_psTestUart[ui32Idx];
+		if((g_ui64TestStep % TEST_STEPS_PER_BYTE) == 0)
+		{
+			bHeld = (ui32Idx == 1) &&
+			        (psUart->ui32RxCount >= (TEST_LEVEL + TEST_RTS_MARGIN));
+			if(!bHeld && (g_pui32SrcPos[ui32Idx] < g_pui32SrcLen[ui32Idx]))
+			{
+				if(psUart->ui32RxCount < TEST_FIFO)
+				{
+					psUart->pui8Rx[psUart->ui32RxCount++] =
+						g_ppui8Src[ui32Idx][g_pui32SrcPos[ui32Idx]];
+					psUart->ui32Idle = 0;
+				}
+				else
+				{
+					g_pui32Overrun[ui32Idx]++;
+					psUart->ui32Raw |= UART_INT_OE;
+				}
+				g_pui32SrcPos[ui32Idx]++;
+			}
+			else if(psUart->ui32RxCount)
+			{
+				psUart->ui32Idle++;
+			}
+
+			if(psUart->ui32TxCount)
+			{
+				g_ppui8Dst[ui32Idx][g_pui32DstPos[ui32Idx]++] =
+					psUart->pui8Tx[0];
+				memmove(psUart->pui8Tx, psUart->pui8Tx + 1,
+				        --psUart->ui32TxCount);
+			}
+		}
+		if(psUart->ui32RxCount >= TEST_LEVEL)
+		{
+			psUart->ui32Raw |= UART_INT_RX;
+		}
+		if(psUart->ui32RxCount && (psUart->ui32Idle >= TEST_RT_BYTES))
+		{
+			psUart->ui32Raw |= UART_INT_RT;
+		}
+		if(!g_bTestMasked && psUart->pfnIsr &&
+		   ((psUart->ui32Raw & psUart->ui32Mask) || psUart->bPend))
+		{
+			psUart->bPend = false;
+			psUart->pfnIsr();
+		}
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	tXBeeBridgeStats psStats[XBEE_BRIDGE_DIRS];
+	char *ppcStats[] = { "bridge", "stats" };
+	uint64_t ui64Silent;
+	uint64_t ui64Limit;
+	uint32_t ui32Pace;
+	uint32_t ui32Idx;
+	uint32_t ui32Step;
+	bool bDone;
+	bool bEscaped;
+	bool bFast;
+
+	ui32Pace = (argc > 1) ? strtoul(argv[1], 0, 10) : TEST_STEPS_PER_BYTE;
+	bFast = ui32Pace <= TEST_FAST_PACE;
+	printf("bridge soak, a loop pass every %u.%u byte times\n",
+	       ui32Pace / TEST_STEPS_PER_BYTE, ui32Pace % TEST_STEPS_PER_BYTE);
+
+	srand(1);
+	for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+	{
+		g_ppui8Src[ui32Idx] = malloc(TEST_BYTES + XBEE_BRIDGE_ESCAPE_COUNT);
+		g_ppui8Dst[ui32Idx] = malloc(TEST_BYTES + XBEE_BRIDGE_ESCAPE_COUNT);
+		for(ui32Step = 0; ui32Step < TEST_BYTES; ui32Step++)
+		{
+			g_ppui8Src[ui32Idx][ui32Step] = (uint8_t)rand();
+		}
+		g_pui32SrcLen[ui32Idx] = TEST_BYTES;
+	}
+
+	//
+	// Run until the bridge ends, the escape going out once all data has
+	// arrived and the guard time has passed in silence
+	//
+	XBeeBridgeStart();
+	bEscaped = false;
+	ui64Silent = 0;
+	ui64Limit = (uint64_t)TEST_BYTES * TEST_STEPS_PER_BYTE * 4;
+	while(g_ui64TestStep < ui64Limit)
+	{
+		for(ui32Step = 0; ui32Step < ui32Pace; ui32Step++)
+		{
+			TestStep();
+		}
+		if(!XBeeBridgePoll())
+		{
+			break;
+		}
+
+		XBeeBridgeStatsGet(XBEE_BRIDGE_TO_XBEE, &psStats[0]);
+		bDone = (g_pui32SrcPos[0] == TEST_BYTES) &&
+		        (g_pui32SrcPos[1] == TEST_BYTES) &&
+		        (g_psTestUart[0].ui32TxCount == 0) &&
+		        (g_psTestUart[1].ui32TxCount == 0) &&
+		        (g_pui32DstPos[0] == TEST_BYTES) &&
+		        ((g_pui32DstPos[1] + psStats[0].ui32Dropped) == TEST_BYTES);
+		if(!bDone || bEscaped)
+		{
+			continue;
+		}
+		if(ui64Silent == 0)
+		{
+			ui64Silent = g_ui64TestStep;
+		}
+		if((g_ui64TestStep - ui64Silent) >
+		   ((TEST_BYTES_PER_S * TEST_STEPS_PER_BYTE * 12) / 10))
+		{
+			memset(g_ppui8Src[0] + TEST_BYTES, XBEE_BRIDGE_ESCAPE_CHAR,
+			       XBEE_BRIDGE_ESCAPE_COUNT);
+			g_pui32SrcLen[0] = TEST_BYTES + XBEE_BRIDGE_ESCAPE_COUNT;
+			bEscaped = true;
+		}
+	}
+	XBeeBridgeStop();
+	for(ui32Step = 0; ui32Step < (20 * TEST_STEPS_PER_BYTE); ui32Step++)
+	{
+		TestStep();
+	}
+
+	XBeeBridgeStatsGet(XBEE_BRIDGE_TO_XBEE, &psStats[0]);
+	XBeeBridgeStatsGet(XBEE_BRIDGE_TO_PC, &psStats[1]);
+	printf("        ended at %u.%02u s, to xbee %u of %u, to pc %u of %u\n",
+	       (uint32_t)(g_ui64TestStep /
+	                  (TEST_BYTES_PER_S * TEST_STEPS_PER_BYTE)),
+	       (uint32_t)(((g_ui64TestStep * 100) /
+	                   (TEST_BYTES_PER_S * TEST_STEPS_PER_BYTE)) % 100),
+	       g_pui32DstPos[1], TEST_BYTES, g_pui32DstPos[0], TEST_BYTES);
+	Cmd_bridge(2, ppcStats);
+
+	HOST_CHECK(bEscaped && (g_ui64TestStep < ui64Limit),
+	           "escape ended the bridge");
+	HOST_CHECK((g_pui32Overrun[0] == 0) && (g_pui32Overrun[1] == 0),
+	           "no hardware FIFO overruns");
+	HOST_CHECK((g_pui32DstPos[0] == TEST_BYTES) &&
+	           (memcmp(g_ppui8Src[1], g_ppui8Dst[0], TEST_BYTES) == 0),
+	           "to pc: every byte, in order");
+	if(bFast)
+	{
+		HOST_CHECK((g_pui32DstPos[1] == TEST_BYTES) &&
+		           (memcmp(g_ppui8Src[0], g_ppui8Dst[1], TEST_BYTES) == 0),
+		           "to xbee: every byte, in order, escape not passed on");
+		HOST_CHECK((psStats[0].ui32Dropped == 0) &&
+		           (psStats[1].ui32Throttled == 0),
+		           "nothing dropped or throttled");
+	}
+	else
+	{
+		HOST_CHECK(psStats[1].ui32Throttled != 0,
+		           "slow loop: xbee held off by RTS");
+		HOST_CHECK((g_pui32DstPos[1] + psStats[0].ui32Dropped) ==
+		           TEST_BYTES,
+		           "slow loop: bytes from the pc passed on or counted");
+	}
+	return HostResult();
+}
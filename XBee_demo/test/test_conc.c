@@ -0,0 +1,129 @@
+//*****************************************************************************
+//
+// test_conc.c - Concentrator: a full table takes over the numbers of gone
+//               nodes, turns new ones away otherwise, and the bench leaves
+//               known nodes alone
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "XBeePool.h"
+#include "XBeeConc.h"
+#include "host.h"
+
+//
+// Addresses of the fleet, spread over the index like serial numbers, and
+// of the newcomers
+//
+#define TEST_NODE(n)            (0x0013A20040000000ULL + ((n) * 40503))
+#define TEST_NEW(n)             (0x0013A20041000000ULL + (n))
+
+//*****************************************************************************
+//
+// True if every node of the fleet but ui32Skip is still found under the
+// number it was given.
+//
+//*****************************************************************************
+static bool
+TestFound(const uint32_t *pui32Node, uint32_t ui32Skip)
+{
+	uint32_t ui32Index;
+
+	for(ui32Index = 0; ui32Index < XBEE_CONC_NODES; ui32Index++)
+	{
+		if((ui32Index != ui32Skip) &&
+		   (XBeeConcNode(TEST_NODE(ui32Index), false) != pui32Node[ui32Index]))
+		{
+			printf("        node %u lost\n", ui32Index);
+			return false;
+		}
+	}
+	return true;
+}
+
+int
+main(void)
+{
+	static uint32_t pui32Node[XBEE_CONC_NODES];
+	char *ppcBench[] = { "conc", "bench", "100" };
+	tXBeeConcStats sBefore;
+	tXBeeConcStats sAfter;
+	uint32_t ui32Index;
+	uint32_t ui32Node;
+
+	XBeePoolInit();
+	XBeeConcClear();
+
+	//
+	// Fill the table, node 7 first so it is the one heard longest ago
+	//
+	pui32Node[7] = XBeeConcFrame(TEST_NODE(7), 50);
+	HostAdvance(1000000);
+	for(ui32Index = 0; ui32Index < XBEE_CONC_NODES; ui32Index++)
+	{
+		if(ui32Index != 7)
+		{
+			pui32Node[ui32Index] = XBeeConcFrame(TEST_NODE(ui32Index), 50);
+		}
+	}
+	HOST_CHECK(XBeeConcCount() == XBEE_CONC_NODES, "fill: every node fits");
+
+	XBeeConcStatsGet(&sBefore);
+	ui32Node = XBeeConcFrame(TEST_NEW(0), 50);
+	XBeeConcFrame(TEST_NEW(0), 50);
+	XBeeConcFrame(TEST_NEW(1), 50);
+	XBeeConcStatsGet(&sAfter);
+	HOST_CHECK((ui32Node == XBEE_CONC_NONE) &&
+	           ((sAfter.ui32Refused - sBefore.ui32Refused) == 3) &&
+	           ((sAfter.ui32Untracked - sBefore.ui32Untracked) == 2),
+	           "full: newcomers turned away, counted once each");
+
+	//
+	// Node 7 goes quiet for XBEE_CONC_QUIET_S, the rest keep sending
+	//
+	HostAdvance((XBEE_CONC_QUIET_S - 1) * 1000000);
+	for(ui32Index = 0; ui32Index < XBEE_CONC_NODES; ui32Index++)
+	{
+		if(ui32Index != 7)
+		{
+			XBeeConcFrame(TEST_NODE(ui32Index), 50);
+		}
+	}
+	HostAdvance(1000000);
+
+	ui32Node = XBeeConcFrame(TEST_NEW(0), 50);
+	XBeeConcStatsGet(&sAfter);
+	HOST_CHECK((ui32Node == pui32Node[7]) &&
+	           ((sAfter.ui32Evicted - sBefore.ui32Evicted) == 1),
+	           "gone: newcomer takes the number of the node gone longest");
+	HOST_CHECK((XBeeConcNode(TEST_NODE(7), false) == XBEE_CONC_NONE) &&
+	           (XBeeConcNode(TEST_NEW(0), false) == pui32Node[7]),
+	           "gone: the old address is out of the index");
+	HOST_CHECK(TestFound(pui32Node, 7), "gone: every other node still found");
+
+	HOST_CHECK(XBeeConcFrame(TEST_NEW(1), 50) == XBEE_CONC_NONE,
+	           "gone: no more gone nodes, next newcomer turned away");
+
+	HOST_CHECK((Cmd_conc(3, ppcBench) == 1) &&
+	           (XBeeConcCount() == XBEE_CONC_NODES) &&
+	           (XBeeConcNode(TEST_NEW(0), false) == pui32Node[7]),
+	           "bench: refused with nodes known, table untouched");
+
+	XBeeConcClear();
+	HOST_CHECK((Cmd_conc(3, ppcBench) == 0) && (XBeeConcCount() == 0),
+	           "bench: runs on an empty table and leaves it empty");
+
+	return HostResult();
+}
@@ -0,0 +1,192 @@
+//*****************************************************************************
+//
+// test_dup.c - Duplicate suppression: the sequence window and the link
+//              round trip
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "XBeePool.h"
+#include "XBeeConc.h"
+#include "XBeeDup.h"
+#include "XBeeLink.h"
+#include "XBeeTrace.h"
+#include "host.h"
+
+//
+// Node number the window tests use as source
+//
+#define TEST_SOURCE             5
+
+//
+// Frames the link hands to UART1
+//
+static uint8_t g_ppui8Sent[8][128];
+static uint32_t g_pui32SentLen[8];
+static uint32_t g_ui32Sent;
+
+//*****************************************************************************
+//
+// Keep a copy of each frame sent.
+//
+//*****************************************************************************
+static void
+TestSubmit(tXBeeBuf *psBuf)
+{
+	if(g_ui32Sent < 8)
+	{
+		memcpy(g_ppui8Sent[g_ui32Sent], psBuf->pui8Data, psBuf->ui16Len);
+		g_pui32SentLen[g_ui32Sent] = psBuf->ui16Len;
+	}
+	g_ui32Sent++;
+}
+
+//*****************************************************************************
+//
+// One sequence number from TEST_SOURCE, and whether it should be accepted.
+//
+//*****************************************************************************
+static bool
+TestSeq(uint16_t ui16Seq, bool bAccept)
+{
+	if(XBeeDupCheck(TEST_SOURCE, ui16Seq) != bAccept)
+	{
+		printf("        seq %u %s\n", ui16Seq,
+		       bAccept ? "dropped, should pass" : "passed, should drop");
+		return false;
+	}
+	return true;
+}
+
+//*****************************************************************************
+//
+// Ahead, behind, repeats, numbers too far behind and the 16-bit wrap.
+//
+//*****************************************************************************
+static void
+TestWindow(void)
+{
+	bool bOk;
+
+	XBeeDupClear();
+	bOk = TestSeq(10, true) & TestSeq(10, false) & TestSeq(11, true);
+	bOk &= TestSeq(9, true) & TestSeq(9, false) & TestSeq(11, false);
+	HOST_CHECK(bOk, "window: new, repeated and late numbers");
+
+	bOk = TestSeq(43, true) & TestSeq(11, false) & TestSeq(12, true);
+	bOk &= TestSeq(12, false) & TestSeq(43, false) & TestSeq(42, true);
+	HOST_CHECK(bOk, "window: 31 behind the highest still remembered");
+
+	bOk = TestSeq(10, false) & TestSeq(10, false) & TestSeq(9, false);
+	HOST_CHECK(bOk, "window: 33 behind dropped");
+
+	bOk = TestSeq(30000, true) & TestSeq(60000, true);
+	bOk &= TestSeq(65535, true) & TestSeq(0, true) & TestSeq(65535, false);
+	bOk &= TestSeq(0, false) & TestSeq(12, true) & TestSeq(13, true);
+	bOk &= TestSeq(13, false);
+	HOST_CHECK(bOk, "window: across the 16-bit wrap");
+}
+
+//*****************************************************************************
+//
+// A repeat after a long gap is still a repeat until the source expires,
+// and so is a number far behind the window: a sender that restarted
+// behind its old window is heard once its source expires.
+//
+//*****************************************************************************
+static void
+TestExpiry(void)
+{
+	bool bOk;
+
+	XBeeDupClear();
+	bOk = TestSeq(100, true);
+	HostAdvance(XBEE_DUP_RETRY_MS * 1000);
+	bOk &= TestSeq(100, false);
+	HOST_CHECK(bOk, "expiry: repeat after the longest retry gap dropped");
+
+	HostAdvance((XBEE_DUP_EXPIRE_MS - XBEE_DUP_RETRY_MS - 1000) * 1000);
+	bOk = TestSeq(100, false);
+	HOST_CHECK(bOk, "expiry: repeat just inside XBEE_DUP_EXPIRE_MS dropped");
+
+	HostAdvance(XBEE_DUP_EXPIRE_MS * 1000);
+	bOk = TestSeq(100, true) & TestSeq(100, false);
+	HOST_CHECK(bOk, "expiry: silent source starts over");
+
+	bOk = TestSeq(0, false);
+	HostAdvance((XBEE_DUP_EXPIRE_MS - 1000) * 1000);
+	bOk &= TestSeq(1, false);
+	HOST_CHECK(bOk, "expiry: far behind dropped, not a sign of life");
+
+	HostAdvance(2000 * 1000);
+	bOk = TestSeq(2, true) & TestSeq(2, false) & TestSeq(3, true);
+	HOST_CHECK(bOk, "expiry: restarted sender heard once the source expires");
+}
+
+//*****************************************************************************
+//
+// Through the link: two pings sent, their frames looped back with the
+// first one three times. One pong each, the two copies suppressed.
+//
+//*****************************************************************************
+static void
+TestLink(void)
+{
+	uint8_t pui8Ping[6] = { XBEE_MSG_TRACE_PING, 0, 1, 2, 3, 4 };
+	uint8_t pui8Frame[2][128];
+	uint32_t pui32Len[2];
+	tXBeeDupStats sBefore;
+	tXBeeDupStats sAfter;
+
+	XBeePoolInit();
+	XBeeLinkInit();
+	HostSubmitSet(TestSubmit);
+
+	g_ui32Sent = 0;
+	XBeeLinkSend(pui8Ping, sizeof(pui8Ping));
+	XBeeLinkSend(pui8Ping, sizeof(pui8Ping));
+	XBeeLinkPoll();
+	HOST_CHECK(g_ui32Sent == 2, "link: two pings on UART1");
+	memcpy(pui8Frame, g_ppui8Sent, sizeof(pui8Frame));
+	memcpy(pui32Len, g_pui32SentLen, sizeof(pui32Len));
+
+	XBeeDupStatsGet(&sBefore);
+	g_ui32Sent = 0;
+	HostRxFeed(pui8Frame[0], pui32Len[0]);
+	HostRxFeed(pui8Frame[0], pui32Len[0]);
+	HostRxFeed(pui8Frame[1], pui32Len[1]);
+	HostRxFeed(pui8Frame[0], pui32Len[0]);
+	XBeeLinkPoll();
+	XBeeLinkPoll();
+	XBeeDupStatsGet(&sAfter);
+
+	printf("        pongs %u, checked %u, suppressed %u\n", g_ui32Sent,
+	       sAfter.ui32Checked - sBefore.ui32Checked,
+	       sAfter.ui32Suppressed - sBefore.ui32Suppressed);
+	HOST_CHECK(g_ui32Sent == 2, "link: one pong per ping");
+	HOST_CHECK((sAfter.ui32Suppressed - sBefore.ui32Suppressed) == 2,
+	           "link: two copies suppressed");
+	HostSubmitSet(0);
+}
+
+int
+main(void)
+{
+	TestWindow();
+	TestExpiry();
+	TestLink();
+	return HostResult();
+}
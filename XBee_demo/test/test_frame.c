@@ -0,0 +1,352 @@
+//*****************************************************************************
+//
+// test_frame.c - API mode 2 escaping: the word at a time engine against a
+//                byte loop, round trips at every offset and cut, and whole
+//                frames through the receiver
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "XBeePool.h"
+#include "XBeeFrame.h"
+#include "host.h"
+
+//
+// Random payloads per length, and frames through the receiver
+//
+#define TEST_RUNS               200
+#define TEST_FRAMES             2000
+
+//
+// Frames the receiver handed out
+//
+static uint8_t g_pui8Got[XBEE_FRAME_MAX_DATA];
+static uint32_t g_ui32GotLen;
+static uint32_t g_ui32Got;
+
+//*****************************************************************************
+//
+// Fill a payload. With bDense about half the bytes need escaping.
+//
+//*****************************************************************************
+static void
+TestFill(uint8_t *pui8Data, uint32_t ui32Len, bool bDense)
+{
+	static const uint8_t pui8Special[4] =
+	{
+		XBEE_FRAME_DELIM, XBEE_FRAME_ESC, XBEE_FRAME_XON, XBEE_FRAME_XOFF
+	};
+	uint32_t ui32Rand;
+
+	while(ui32Len--)
+	{
+		ui32Rand = rand();
+		*pui8Data++ = (bDense && (ui32Rand & 0x100)) ?
+		              pui8Special[ui32Rand & 3] : (uint8_t)ui32Rand;
+	}
+}
+
+//*****************************************************************************
+//
+// Byte at a time escaping, as the XBee manual gives it.
+//
+//*****************************************************************************
+static uint32_t
+TestEscape(uint8_t *pui8Dst, const uint8_t *pui8Src, uint32_t ui32Len)
+{
+	uint32_t ui32Out;
+	uint8_t ui8Byte;
+
+	for(ui32Out = 0; ui32Len--; )
+	{
+		ui8Byte = *pui8Src++;
+		if((ui8Byte == XBEE_FRAME_DELIM) || (ui8Byte == XBEE_FRAME_ESC) ||
+		   (ui8Byte == XBEE_FRAME_XON) || (ui8Byte == XBEE_FRAME_XOFF))
+		{
+			pui8Dst[ui32Out++] = XBEE_FRAME_ESC;
+			ui8Byte ^= XBEE_FRAME_ESC_XOR;
+		}
+		pui8Dst[ui32Out++] = ui8Byte;
+	}
+	return ui32Out;
+}
+
+//*****************************************************************************
+//
+// Keep the frame the receiver hands out.
+//
+//*****************************************************************************
+static void
+TestHandler(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+	memcpy(g_pui8Got, pui8Data, ui32Len);
+	g_ui32GotLen = ui32Len;
+	g_ui32Got++;
+}
+
+//*****************************************************************************
+//
+// Escape every length up to XBEE_FRAME_MAX_DATA from every source and
+// destination alignment, compare with the byte loop, and unescape it again
+// cut into pieces of every size, so an escape pair is split at least once.
+//
+//*****************************************************************************
+static void
+TestRoundTrip(bool bDense)
+{
+	uint8_t pui8In[XBEE_FRAME_MAX_DATA + 4];
+	uint8_t pui8Out[(2 * XBEE_FRAME_MAX_DATA) + 4];
+	uint8_t pui8Ref[2 * XBEE_FRAME_MAX_DATA];
+	uint8_t pui8Back[XBEE_FRAME_MAX_DATA + 4];
+	uint32_t ui32Len;
+	uint32_t ui32Run;
+	uint32_t ui32Enc;
+	uint32_t ui32Pos;
+	uint32_t ui32Piece;
+	uint32_t ui32Got;
+	uint32_t ui32Used;
+	uint32_t ui32SumTx;
+	uint32_t ui32SumRx;
+	uint32_t ui32SumRef;
+	uint32_t ui32Index;
+	uint32_t ui32Bad;
+	bool bEscaped;
+	char pcWhat[80];
+
+	ui32Bad = 0;
+	for(ui32Len = 1; ui32Len <= XBEE_FRAME_MAX_DATA; ui32Len++)
+	{
+		for(ui32Run = 0; ui32Run < TEST_RUNS; ui32Run++)
+		{
+			TestFill(&pui8In[ui32Run & 3], ui32Len, bDense);
+			ui32SumTx = 0;
+			ui32Enc = XBeeFrameEscape(&pui8Out[(ui32Run >> 2) & 3],
+			                          &pui8In[ui32Run & 3], ui32Len,
+			                          &ui32SumTx);
+			memmove(pui8Out, &pui8Out[(ui32Run >> 2) & 3], ui32Enc);
+
+			ui32SumRef = 0;
+			for(ui32Index = 0; ui32Index < ui32Len; ui32Index++)
+			{
+				ui32SumRef += pui8In[(ui32Run & 3) + ui32Index];
+			}
+			if((ui32Enc != TestEscape(pui8Ref, &pui8In[ui32Run & 3],
+			                          ui32Len)) ||
+			   memcmp(pui8Out, pui8Ref, ui32Enc) ||
+			   ((uint8_t)ui32SumTx != (uint8_t)ui32SumRef))
+			{
+				ui32Bad++;
+				continue;
+			}
+
+			ui32Piece = 1 + (ui32Run % (ui32Enc + 1));
+			ui32SumRx = 0;
+			bEscaped = false;
+			ui32Got = 0;
+			for(ui32Pos = 0; ui32Pos < ui32Enc; ui32Pos += ui32Used)
+			{
+				ui32Got += XBeeFrameUnescape(
+				        &pui8Back[(ui32Run & 3) + ui32Got],
+				        ui32Len - ui32Got, &pui8Out[ui32Pos],
+				        ((ui32Enc - ui32Pos) < ui32Piece) ?
+				        (ui32Enc - ui32Pos) : ui32Piece,
+				        &ui32Used, &bEscaped, &ui32SumRx);
+				if(ui32Used == 0)
+				{
+					break;
+				}
+			}
+			if((ui32Got != ui32Len) || bEscaped ||
+			   memcmp(&pui8Back[ui32Run & 3], &pui8In[ui32Run & 3],
+			          ui32Len) ||
+			   ((uint8_t)ui32SumRx != (uint8_t)ui32SumTx))
+			{
+				ui32Bad++;
+			}
+		}
+	}
+
+	printf("        %u payloads, %u wrong\n", XBEE_FRAME_MAX_DATA * TEST_RUNS,
+	       ui32Bad);
+	snprintf(pcWhat, sizeof(pcWhat), "escape: %s payloads match the byte "
+	         "loop and come back whole", bDense ? "dense" : "random");
+	HOST_CHECK(ui32Bad == 0, pcWhat);
+}
+
+//*****************************************************************************
+//
+// Each byte value alone: exactly the four specials grow to two bytes, and
+// no delimiter is left in any output.
+//
+//*****************************************************************************
+static void
+TestEveryByte(void)
+{
+	uint8_t pui8Out[8];
+	uint32_t ui32Value;
+	uint32_t ui32Sum;
+	uint32_t ui32Enc;
+	uint32_t ui32Escaped;
+	uint8_t ui8Byte;
+	bool bOk;
+
+	bOk = true;
+	ui32Escaped = 0;
+	for(ui32Value = 0; ui32Value < 256; ui32Value++)
+	{
+		ui8Byte = (uint8_t)ui32Value;
+		ui32Sum = 0;
+		ui32Enc = XBeeFrameEscape(pui8Out, &ui8Byte, 1, &ui32Sum);
+		ui32Escaped += (ui32Enc == 2);
+		bOk &= (ui32Enc == 2) ? ((pui8Out[0] == XBEE_FRAME_ESC) &&
+		                         (pui8Out[1] != XBEE_FRAME_DELIM)) :
+		                        (pui8Out[0] != XBEE_FRAME_DELIM);
+	}
+	HOST_CHECK(bOk && (ui32Escaped == 4), "escape: only the four specials");
+}
+
+//*****************************************************************************
+//
+// Flip one bit of an encoded frame near its end, in the checksum or the
+// last data byte, so that it still looks like a frame. Returns false if
+// there is no such byte.
+//
+//*****************************************************************************
+static bool
+TestCorrupt(uint8_t *pui8Frame, uint32_t ui32Enc)
+{
+	uint32_t ui32Pos;
+	uint8_t ui8Byte;
+
+	for(ui32Pos = ui32Enc - 1; ui32Pos > 3; ui32Pos--)
+	{
+		ui8Byte = pui8Frame[ui32Pos] ^ 0x01;
+		if((pui8Frame[ui32Pos] != XBEE_FRAME_ESC) &&
+		   (ui8Byte != XBEE_FRAME_DELIM) && (ui8Byte != XBEE_FRAME_ESC) &&
+		   (ui8Byte != XBEE_FRAME_XON) && (ui8Byte != XBEE_FRAME_XOFF))
+		{
+			pui8Frame[ui32Pos] = ui8Byte;
+			return true;
+		}
+	}
+	return false;
+}
+
+//*****************************************************************************
+//
+// Built frames fed to the receiver in random pieces. One in ten has a bit
+// flipped and must be dropped, one in ten is cut short by the next
+// frame's delimiter and must not hold up the frame after it.
+//
+//*****************************************************************************
+static void
+TestReceiver(void)
+{
+	uint8_t pui8Data[XBEE_FRAME_MAX_DATA];
+	uint8_t pui8Frame[XBEE_FRAME_MAX_ENCODED(XBEE_FRAME_MAX_DATA)];
+	tXBeeFrameRx sRx;
+	uint32_t ui32Frame;
+	uint32_t ui32Len;
+	uint32_t ui32Enc;
+	uint32_t ui32Pos;
+	uint32_t ui32Piece;
+	uint32_t ui32Before;
+	uint32_t ui32Good;
+	uint32_t ui32Corrupt;
+	uint32_t ui32Cut;
+	uint32_t ui32Wrong;
+
+	XBeeFrameRxInit(&sRx);
+	g_ui32Got = 0;
+	ui32Good = 0;
+	ui32Corrupt = 0;
+	ui32Cut = 0;
+	ui32Wrong = 0;
+
+	for(ui32Frame = 0; ui32Frame < TEST_FRAMES; ui32Frame++)
+	{
+		ui32Len = 1 + (rand() % XBEE_FRAME_MAX_DATA);
+		TestFill(pui8Data, ui32Len, (ui32Frame & 1) != 0);
+		ui32Enc = XBeeFrameBuild(pui8Frame, pui8Data, ui32Len);
+
+		if(((ui32Frame % 10) == 3) && TestCorrupt(pui8Frame, ui32Enc))
+		{
+			ui32Corrupt++;
+		}
+		else if((ui32Frame % 10) == 7)
+		{
+			ui32Enc = 4 + ((ui32Enc - 4) / 2);
+			ui32Cut++;
+		}
+		else
+		{
+			ui32Good++;
+		}
+
+		ui32Before = g_ui32Got;
+		for(ui32Pos = 0; ui32Pos < ui32Enc; ui32Pos += ui32Piece)
+		{
+			ui32Piece = 1 + (rand() % 40);
+			if(ui32Piece > (ui32Enc - ui32Pos))
+			{
+				ui32Piece = ui32Enc - ui32Pos;
+			}
+			XBeeFrameRxFeed(&sRx, &pui8Frame[ui32Pos], ui32Piece,
+			                TestHandler);
+		}
+
+		switch(ui32Frame % 10)
+		{
+			case 3:
+			case 7:
+			{
+				ui32Wrong += (g_ui32Got != ui32Before);
+				break;
+			}
+
+			default:
+			{
+				ui32Wrong += (g_ui32Got != (ui32Before + 1)) ||
+				             (g_ui32GotLen != ui32Len) ||
+				             memcmp(g_pui8Got, pui8Data, ui32Len);
+				break;
+			}
+		}
+	}
+
+	printf("        %u frames: %u good, %u corrupted, %u cut short; "
+	       "received %u, bad checksum %u, resync %u\n", TEST_FRAMES,
+	       ui32Good, ui32Corrupt, ui32Cut, g_ui32Got, sRx.ui32BadChecksum,
+	       sRx.ui32Resync);
+	HOST_CHECK(ui32Wrong == 0, "receiver: good frames whole, others dropped");
+	HOST_CHECK((sRx.ui32BadChecksum == ui32Corrupt) &&
+	           (sRx.ui32Resync == ui32Cut),
+	           "receiver: corrupted and cut frames counted");
+}
+
+int
+main(void)
+{
+	XBeePoolInit();
+	srand(1);
+
+	TestEveryByte();
+	TestRoundTrip(false);
+	TestRoundTrip(true);
+	TestReceiver();
+	return HostResult();
+}
@@ -0,0 +1,183 @@
+//*****************************************************************************
+//
+// test_qual.c - Link quality: adapted fragment size on the simulated radio,
+//               and RSSI from receive-only nodes not evicting destinations
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "XBeePool.h"
+#include "XBeeBulk.h"
+#include "XBeeConc.h"
+#include "XBeeLink.h"
+#include "XBeeQual.h"
+#include "host.h"
+
+//
+// Addresses: the link destination, nodes sent to, and sensors only heard
+//
+#define TEST_DEST               0x0013A20040001234ULL
+#define TEST_SENT_TO(n)         (0x0013A20040100000ULL + (n))
+#define TEST_HEARD(n)           (0x0013A20040200000ULL + (n))
+
+//*****************************************************************************
+//
+// Throughput of one 'qual bench' line, 0 if it is not in pcOut.
+//
+//*****************************************************************************
+static uint32_t
+TestRate(const char *pcOut, const char *pcName)
+{
+	const char *pcLine;
+	uint32_t ui32Rate;
+
+	pcLine = strstr(pcOut, pcName);
+	if(pcLine)
+	{
+		pcLine = strstr(pcLine, "ms, ");
+	}
+	if(!pcLine || (sscanf(pcLine, "ms, %u", &ui32Rate) != 1))
+	{
+		return 0;
+	}
+	return ui32Rate;
+}
+
+//*****************************************************************************
+//
+// 'qual bench <bytes> <ppm>', its output into pcOut.
+//
+//*****************************************************************************
+static void
+TestBench(const char *pcBytes, const char *pcPpm, char *pcOut,
+          uint32_t ui32Size)
+{
+	char *ppcArgs[] = { "qual", "bench", (char *)pcBytes, (char *)pcPpm };
+
+	printf("qual bench %s %s\n", pcBytes, pcPpm);
+	HostCapture(pcOut, ui32Size);
+	Cmd_qual(4, ppcArgs);
+	HostCapture(0, 0);
+}
+
+//*****************************************************************************
+//
+// The simulated radio draws its errors from one generator, so a run
+// depends on the ones before it. Over 20000 bytes the draw decides as
+// much as the size does: at 5000 ppm after runs at 0 and 1000 ppm the
+// adapted size shows 4860 bytes/s against 4311 for fixed 64, a lead that
+// is gone over 200000 bytes. The checks use the longer runs.
+//
+//*****************************************************************************
+static void
+TestAdapt(void)
+{
+	char pcOut[1024];
+	uint32_t ui32Fixed95;
+	uint32_t ui32Fixed64;
+	uint32_t ui32Fixed16;
+	uint32_t ui32Adapted;
+
+	TestBench("20000", "0", pcOut, sizeof(pcOut));
+	TestBench("20000", "1000", pcOut, sizeof(pcOut));
+	TestBench("20000", "5000", pcOut, sizeof(pcOut));
+
+	TestBench("200000", "0", pcOut, sizeof(pcOut));
+	ui32Fixed95 = TestRate(pcOut, "fixed 95:");
+	ui32Adapted = TestRate(pcOut, "adapted:");
+	HOST_CHECK(ui32Fixed95 && (ui32Adapted == ui32Fixed95),
+	           "bench 0 ppm: adapted is fixed 95");
+
+	TestBench("200000", "5000", pcOut, sizeof(pcOut));
+	ui32Fixed95 = TestRate(pcOut, "fixed 95:");
+	ui32Fixed64 = TestRate(pcOut, "fixed 64:");
+	ui32Fixed16 = TestRate(pcOut, "fixed 16:");
+	ui32Adapted = TestRate(pcOut, "adapted:");
+	HOST_CHECK(((ui32Adapted * 100) >= (ui32Fixed95 * 97)) &&
+	           ((ui32Adapted * 100) >= (ui32Fixed64 * 97)),
+	           "bench 5000 ppm: adapted within 3% of the best fixed size");
+	HOST_CHECK((ui32Adapted * 100) >= (ui32Fixed16 * 120),
+	           "bench 5000 ppm: adapted well ahead of fixed 16");
+}
+
+//*****************************************************************************
+//
+// Learn a lossy link to each of the nodes sent to, then hear many more
+// sensors: what was learnt stays. RSSI still updates a known destination
+// and fills free entries.
+//
+//*****************************************************************************
+static void
+TestEvict(void)
+{
+	char *ppcClear[] = { "qual", "clear" };
+	uint32_t pui32Frag[XBEE_QUAL_DESTS];
+	uint32_t ui32Node;
+	uint32_t ui32Try;
+	bool bOk;
+
+	Cmd_qual(2, ppcClear);
+
+	XBeeQualRssi(TEST_HEARD(0), 95);
+	HOST_CHECK(XBeeQualFragSize(TEST_HEARD(0)) < XBEE_BULK_FRAG_MAX,
+	           "evict: weak sensor takes a free entry");
+	Cmd_qual(2, ppcClear);
+
+	for(ui32Node = 0; ui32Node < XBEE_QUAL_DESTS; ui32Node++)
+	{
+		for(ui32Try = 0; ui32Try < (2 * XBEE_QUAL_WARMUP); ui32Try++)
+		{
+			XBeeQualResult(TEST_SENT_TO(ui32Node), (ui32Try & 1) != 0,
+			               XBEE_BULK_FRAG_MAX);
+		}
+		pui32Frag[ui32Node] = XBeeQualFragSize(TEST_SENT_TO(ui32Node));
+	}
+	HOST_CHECK(pui32Frag[0] < XBEE_BULK_FRAG_MAX,
+	           "evict: 50% loss learnt as a smaller fragment");
+
+	for(ui32Node = 0; ui32Node < 64; ui32Node++)
+	{
+		HostAdvance(1000);
+		XBeeQualRssi(TEST_HEARD(ui32Node), 40);
+	}
+	bOk = true;
+	for(ui32Node = 0; ui32Node < XBEE_QUAL_DESTS; ui32Node++)
+	{
+		bOk &= XBeeQualFragSize(TEST_SENT_TO(ui32Node)) ==
+		       pui32Frag[ui32Node];
+	}
+	HOST_CHECK(bOk, "evict: 64 sensors heard, every destination kept");
+
+	for(ui32Try = 0; ui32Try < 64; ui32Try++)
+	{
+		XBeeQualRssi(TEST_SENT_TO(0), 95);
+	}
+	HOST_CHECK(XBeeQualFragSize(TEST_SENT_TO(0)) == pui32Frag[0],
+	           "evict: RSSI on a warm destination leaves its loss alone");
+	Cmd_qual(1, 0);
+}
+
+int
+main(void)
+{
+	XBeePoolInit();
+	XBeeLinkInit();
+	XBeeLinkDestSet(TEST_DEST);
+
+	TestAdapt();
+	TestEvict();
+	return HostResult();
+}
@@ -0,0 +1,302 @@
+//*****************************************************************************
+//
+// test_resp.c - Response tokenizer: malformed, split and oversized lines,
+//               timeouts, and the parse rate on this machine
+//
+// Copyright Austin Blackstone Engineering 2013
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "XBeePool.h"
+#include "XBeeResp.h"
+#include "host.h"
+
+//
+// Lines handed to the test handler
+//
+#define TEST_LINES              16
+
+typedef struct
+{
+	uint32_t ui32Type;
+	uint64_t ui64Value;
+	uint32_t ui32Len;
+	char pcText[XBEE_RESP_LINE_SIZE + 1];
+}
+tTestLine;
+
+static tTestLine g_psLines[TEST_LINES];
+static uint32_t g_ui32Lines;
+
+//
+// Lines in the parse rate run: a typical mix, fed many times over
+//
+#define TEST_RATE_LOOPS         200000
+
+static const char g_pcRateResp[] =
+	"OK\r0013A200\r40A1B2C3\r1234\rERROR\r3333\rOK\r0\rABCD\rNODE_1\r";
+
+//*****************************************************************************
+//
+// Keep each line; the response is complete after pvArg lines.
+//
+//*****************************************************************************
+static bool
+TestHandler(void *pvArg, const tXBeeResp *psResp)
+{
+	tTestLine *psLine;
+
+	if(g_ui32Lines < TEST_LINES)
+	{
+		psLine = &g_psLines[g_ui32Lines];
+		psLine->ui32Type = psResp->ui32Type;
+		psLine->ui64Value = psResp->ui64Value;
+		psLine->ui32Len = psResp->ui32Len;
+		memcpy(psLine->pcText, psResp->pcText, psResp->ui32Len);
+		psLine->pcText[psResp->ui32Len] = 0;
+	}
+	g_ui32Lines++;
+
+	return g_ui32Lines >= (uint32_t)(uintptr_t)pvArg;
+}
+
+//*****************************************************************************
+//
+// Count lines, never complete.
+//
+//*****************************************************************************
+static bool
+TestCount(void *pvArg, const tXBeeResp *psResp)
+{
+	(*(uint32_t *)pvArg)++;
+	return false;
+}
+
+//*****************************************************************************
+//
+// Expect a response of ui32Lines lines and feed pcData in pieces of
+// ui32Piece bytes.
+//
+//*****************************************************************************
+static void
+TestFeed(uint32_t ui32Lines, const char *pcData, uint32_t ui32Piece)
+{
+	uint32_t ui32Len;
+	uint32_t ui32Run;
+
+	g_ui32Lines = 0;
+	memset(g_psLines, 0, sizeof(g_psLines));
+	XBeeRespExpect(TestHandler, (void *)(uintptr_t)ui32Lines, 1000);
+
+	ui32Len = strlen(pcData);
+	while(ui32Len)
+	{
+		ui32Run = (ui32Len < ui32Piece) ? ui32Len : ui32Piece;
+		XBeeRespFeed((const uint8_t *)pcData, ui32Run);
+		pcData += ui32Run;
+		ui32Len -= ui32Run;
+	}
+}
+
+//*****************************************************************************
+//
+// True if line ui32Index came out as type ui32Type with text pcText.
+//
+//*****************************************************************************
+static bool
+TestLine(uint32_t ui32Index, uint32_t ui32Type, const char *pcText)
+{
+	if((g_psLines[ui32Index].ui32Type != ui32Type) ||
+	   strcmp(g_psLines[ui32Index].pcText, pcText))
+	{
+		printf("        line %u: type %u '%s'\n", ui32Index,
+		       g_psLines[ui32Index].ui32Type, g_psLines[ui32Index].pcText);
+		return false;
+	}
+	return true;
+}
+
+//*****************************************************************************
+//
+// Lines that look almost right are text, not OK, ERROR or numbers.
+//
+//*****************************************************************************
+static void
+TestMalformed(void)
+{
+	bool bOk;
+
+	TestFeed(9, "ok\rOKAY\rERR\r12G4\r0013A2004\r"
+	            "0013A20040A1B2C3D\r 1234\r\r7fFf\r", 64);
+	bOk = (g_ui32Lines == 9) & !XBeeRespPending();
+	bOk &= TestLine(0, XBEE_RESP_TEXT, "ok") &
+	       TestLine(1, XBEE_RESP_TEXT, "OKAY") &
+	       TestLine(2, XBEE_RESP_TEXT, "ERR") &
+	       TestLine(3, XBEE_RESP_TEXT, "12G4") &
+	       TestLine(4, XBEE_RESP_HEX, "0013A2004") &
+	       TestLine(5, XBEE_RESP_TEXT, "0013A20040A1B2C3D") &
+	       TestLine(6, XBEE_RESP_TEXT, " 1234") &
+	       TestLine(7, XBEE_RESP_EMPTY, "") &
+	       TestLine(8, XBEE_RESP_HEX, "7fFf");
+	bOk &= (g_psLines[4].ui64Value == 0x13A2004ULL) &&
+	       (g_psLines[8].ui64Value == 0x7FFF);
+	HOST_CHECK(bOk, "malformed: near misses are text, 17 digits too");
+}
+
+//*****************************************************************************
+//
+// The same lines, whole or a byte at a time, come out the same.
+//
+//*****************************************************************************
+static void
+TestSplit(void)
+{
+	static const char pcResp[] = "0013A200\r40A1B2C3\rOK\r";
+	uint32_t ui32Piece;
+	bool bOk;
+
+	bOk = true;
+	for(ui32Piece = 1; ui32Piece <= sizeof(pcResp); ui32Piece++)
+	{
+		TestFeed(3, pcResp, ui32Piece);
+		bOk &= (g_ui32Lines == 3) &&
+		       (g_psLines[0].ui64Value == 0x0013A200) &&
+		       (g_psLines[1].ui64Value == 0x40A1B2C3) &&
+		       (g_psLines[2].ui32Type == XBEE_RESP_OK);
+	}
+	HOST_CHECK(bOk, "split: every cut gives the same three lines");
+}
+
+//*****************************************************************************
+//
+// A line longer than XBEE_RESP_LINE_SIZE is cut, not overrun, and the next
+// line starts clean.
+//
+//*****************************************************************************
+static void
+TestOversized(void)
+{
+	char pcResp[(3 * XBEE_RESP_LINE_SIZE) + 8];
+	uint32_t ui32Index;
+
+	for(ui32Index = 0; ui32Index < (3 * XBEE_RESP_LINE_SIZE); ui32Index++)
+	{
+		pcResp[ui32Index] = 'A' + (ui32Index % 26);
+	}
+	strcpy(&pcResp[3 * XBEE_RESP_LINE_SIZE], "\rOK\r");
+
+	TestFeed(2, pcResp, 7);
+	HOST_CHECK((g_ui32Lines == 2) &&
+	           (g_psLines[0].ui32Type == XBEE_RESP_TEXT) &&
+	           (g_psLines[0].ui32Len == XBEE_RESP_LINE_SIZE) &&
+	           !memcmp(g_psLines[0].pcText, pcResp, XBEE_RESP_LINE_SIZE) &&
+	           (g_psLines[1].ui32Type == XBEE_RESP_OK),
+	           "oversized: cut at XBEE_RESP_LINE_SIZE, next line intact");
+}
+
+//*****************************************************************************
+//
+// A command that gets no answer times out and the next one in the queue
+// gets the following line.
+//
+//*****************************************************************************
+static void
+TestTimeout(void)
+{
+	TestFeed(1, "", 1);
+	XBeeRespExpect(TestHandler, (void *)2, 2000);
+	HostAdvance(999 * 1000);
+	XBeeRespPoll();
+	HOST_CHECK(g_ui32Lines == 0, "timeout: not before the deadline");
+
+	HostAdvance(1000);
+	XBeeRespPoll();
+	HOST_CHECK((g_ui32Lines == 1) &&
+	           (g_psLines[0].ui32Type == XBEE_RESP_TIMEOUT),
+	           "timeout: handler told at the deadline");
+
+	XBeeRespFeed((const uint8_t *)"OK\r", 3);
+	HOST_CHECK((g_ui32Lines == 2) && (g_psLines[1].ui32Type == XBEE_RESP_OK) &&
+	           !XBeeRespPending(), "timeout: next command gets its line");
+}
+
+//*****************************************************************************
+//
+// Lines and bytes per second through the tokenizer on this machine, by
+// the wall clock. It says nothing about the LM4F120, whose figure comes
+// from 'respbench' on the target.
+//
+//*****************************************************************************
+static void
+TestRate(void)
+{
+	struct timespec sStart;
+	struct timespec sEnd;
+	uint32_t ui32Lines;
+	uint32_t ui32Loop;
+	uint64_t ui64Bytes;
+	uint64_t ui64Ns;
+
+	ui32Lines = 0;
+	XBeeRespExpect(TestCount, &ui32Lines, 10000);
+	ui64Bytes = (uint64_t)(sizeof(g_pcRateResp) - 1) * TEST_RATE_LOOPS;
+
+	clock_gettime(CLOCK_MONOTONIC, &sStart);
+	for(ui32Loop = 0; ui32Loop < TEST_RATE_LOOPS; ui32Loop++)
+	{
+		XBeeRespFeed((const uint8_t *)g_pcRateResp,
+		             sizeof(g_pcRateResp) - 1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &sEnd);
+	ui64Ns = ((uint64_t)(sEnd.tv_sec - sStart.tv_sec) * 1000000000) +
+	         sEnd.tv_nsec - sStart.tv_nsec;
+	if(ui64Ns == 0)
+	{
+		ui64Ns = 1;
+	}
+
+	printf("        %u lines, %llu bytes: %llu lines/s, %llu bytes/s on "
+	       "the host\n", ui32Lines, (unsigned long long)ui64Bytes,
+	       (unsigned long long)((ui32Lines * 1000000000ULL) / ui64Ns),
+	       (unsigned long long)((ui64Bytes * 1000000000ULL) / ui64Ns));
+	HOST_CHECK(ui32Lines == (10 * TEST_RATE_LOOPS),
+	           "rate: every line of the run parsed");
+
+	//
+	// Simulated time stood still; let the counter time out
+	//
+	HostAdvance(10000 * 1000);
+	XBeeRespPoll();
+}
+
+int
+main(void)
+{
+	XBeePoolInit();
+
+	TestMalformed();
+	TestSplit();
+	TestOversized();
+	TestTimeout();
+	TestRate();
+	HOST_CHECK(!XBeeRespPending(), "queue empty at the end");
+
+	//
+	// The simulated cycle counter stands still while it runs
+	//
+	HOST_CHECK(Cmd_respbench(1, 0) == 0, "respbench: no cycles, no fault");
+	return HostResult();
+}
@@ -0,0 +1,164 @@
+//*****************************************************************************
+//
+// tiva.c - No-op driverlib for the host build. Everything is weak so that a
+// test can model the peripherals it exercises.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "tiva.h"
+
+#define STUB __attribute__((weak))
+
+volatile uint32_t SYSCTL_RCGC2_R;
+volatile uint32_t GPIO_PORTF_DATA_R;
+volatile uint32_t GPIO_PORTF_DIR_R;
+volatile uint32_t GPIO_PORTF_DEN_R;
+
+STUB void SysCtlPeripheralEnable(uint32_t a0) { }
+STUB bool SysCtlPeripheralReady(uint32_t a0) { return 0; }
+STUB uint32_t SysCtlClockGet(void) { return 0; }
+STUB void SysCtlClockSet(uint32_t a0) { }
+STUB void SysCtlDelay(uint32_t a0) { }
+STUB void SysCtlSleep(void) { }
+STUB void SysCtlPeripheralSleepEnable(uint32_t a0) { }
+STUB void SysCtlPeripheralClockGating(bool a0) { }
+STUB void SysCtlReset(void) { }
+STUB void GPIOPinConfigure(uint32_t a0) { }
+STUB void GPIOPinTypeUART(uint32_t a0, uint8_t a1) { }
+STUB void GPIOPinTypeGPIOOutput(uint32_t a0, uint8_t a1) { }
+STUB void GPIOPinTypeGPIOInput(uint32_t a0, uint8_t a1) { }
+STUB void GPIOPinWrite(uint32_t a0, uint8_t a1, uint8_t a2) { }
+STUB int32_t GPIOPinRead(uint32_t a0, uint8_t a1) { return 0; }
+STUB void UARTClockSourceSet(uint32_t a0, uint32_t a1) { }
+STUB void UARTIntEnable(uint32_t a0, uint32_t a1) { }
+STUB void UARTIntDisable(uint32_t a0, uint32_t a1) { }
+STUB uint32_t UARTIntStatus(uint32_t a0, bool a1) { return 0; }
+STUB void UARTIntClear(uint32_t a0, uint32_t a1) { }
+STUB bool UARTCharsAvail(uint32_t a0) { return 0; }
+STUB bool UARTSpaceAvail(uint32_t a0) { return 0; }
+STUB int32_t UARTCharGetNonBlocking(uint32_t a0) { return 0; }
+STUB int32_t UARTCharGet(uint32_t a0) { return 0; }
+STUB bool UARTCharPutNonBlocking(uint32_t a0, unsigned char a1) { return 0; }
+STUB void UARTCharPut(uint32_t a0, unsigned char a1) { }
+STUB void UARTFlowControlSet(uint32_t a0, uint32_t a1) { }
+STUB void UARTFIFOLevelSet(uint32_t a0, uint32_t a1, uint32_t a2) { }
+STUB void UARTFIFOEnable(uint32_t a0) { }
+STUB void UARTFIFODisable(uint32_t a0) { }
+STUB void UARTConfigSetExpClk(uint32_t a0, uint32_t a1, uint32_t a2,
+                              uint32_t a3)
+	{ }
+STUB void UARTConfigGetExpClk(uint32_t a0, uint32_t a1, uint32_t *a2,
+                              uint32_t *a3)
+	{ }
+STUB void UARTEnable(uint32_t a0) { }
+STUB void UARTDisable(uint32_t a0) { }
+STUB bool UARTBusy(uint32_t a0) { return 0; }
+STUB void UARTTxIntModeSet(uint32_t a0, uint32_t a1) { }
+STUB uint32_t UARTRxErrorGet(uint32_t a0) { return 0; }
+STUB void UARTRxErrorClear(uint32_t a0) { }
+STUB void IntEnable(uint32_t a0) { }
+STUB void IntDisable(uint32_t a0) { }
+STUB bool IntMasterEnable(void) { return 0; }
+STUB bool IntMasterDisable(void) { return 0; }
+STUB void IntPendSet(uint32_t a0) { }
+STUB void FPUEnable(void) { }
+STUB void FPULazyStackingEnable(void) { }
+STUB void TimerConfigure(uint32_t a0, uint32_t a1) { }
+STUB void TimerLoadSet(uint32_t a0, uint32_t a1, uint32_t a2) { }
+STUB void TimerEnable(uint32_t a0, uint32_t a1) { }
+STUB void TimerDisable(uint32_t a0, uint32_t a1) { }
+STUB void TimerIntEnable(uint32_t a0, uint32_t a1) { }
+STUB void TimerIntDisable(uint32_t a0, uint32_t a1) { }
+STUB void TimerIntClear(uint32_t a0, uint32_t a1) { }
+STUB uint32_t TimerValueGet(uint32_t a0, uint32_t a1) { return 0; }
+STUB uint64_t TimerValueGet64(uint32_t a0) { return 0; }
+STUB uint32_t TimerIntStatus(uint32_t a0, bool a1) { return 0; }
+STUB void SysTickPeriodSet(uint32_t a0) { }
+STUB uint32_t SysTickPeriodGet(void) { return 0; }
+STUB void SysTickEnable(void) { }
+STUB void SysTickDisable(void) { }
+STUB void SysTickIntEnable(void) { }
+STUB void SysTickIntDisable(void) { }
+STUB uint32_t SysTickValueGet(void) { return 0; }
+STUB int32_t FlashErase(uint32_t a0) { return 0; }
+STUB int32_t FlashProgram(uint32_t *a0, uint32_t a1, uint32_t a2)
+	{ return 0; }
+STUB void UARTStdioConfig(uint32_t a0, uint32_t a1, uint32_t a2) { }
+STUB int CmdLineProcess(char * a0) { return 0; }
+STUB uint32_t CPUcpsid(void) { return 0; }
+STUB uint32_t CPUcpsie(void) { return 0; }
+STUB void CPUwfi(void) { }
+STUB void GPIOPadConfigSet(uint32_t a0, uint8_t a1, uint32_t a2, uint32_t a3)
+	{ }
+
+//*****************************************************************************
+//
+// uartstdio and ustdlib on the C library, so the console goes to stdout,
+// and to the buffer given to HostCapture() for a test to look at.
+//
+//*****************************************************************************
+static char *g_pcTivaCapture;
+static uint32_t g_ui32TivaCaptureSize;
+static uint32_t g_ui32TivaCaptureLen;
+
+void
+HostCapture(char *pcBuf, uint32_t ui32Size)
+{
+	g_pcTivaCapture = pcBuf;
+	g_ui32TivaCaptureSize = ui32Size;
+	g_ui32TivaCaptureLen = 0;
+	if(pcBuf)
+	{
+		pcBuf[0] = 0;
+	}
+}
+
+void
+UARTprintf(const char *pcString, ...)
+{
+	char pcLine[256];
+	va_list vaArgP;
+
+	va_start(vaArgP, pcString);
+	vsnprintf(pcLine, sizeof(pcLine), pcString, vaArgP);
+	va_end(vaArgP);
+
+	fputs(pcLine, stdout);
+	if(g_pcTivaCapture)
+	{
+		g_ui32TivaCaptureLen +=
+			snprintf(g_pcTivaCapture + g_ui32TivaCaptureLen,
+			         g_ui32TivaCaptureSize - g_ui32TivaCaptureLen, "%s",
+			         pcLine);
+		if(g_ui32TivaCaptureLen >= g_ui32TivaCaptureSize)
+		{
+			g_ui32TivaCaptureLen = g_ui32TivaCaptureSize - 1;
+		}
+	}
+}
+
+int
+UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+	return (int)fwrite(pcBuf, 1, ui32Len, stdout);
+}
+
+int
+UARTgets(char *pcBuf, uint32_t ui32Len)
+{
+	return 0;
+}
+
+int
+usnprintf(char *pcBuf, uint32_t ui32Size, const char *pcString, ...)
+{
+	va_list vaArgP;
+	int iRet;
+
+	va_start(vaArgP, pcString);
+	iRet = vsnprintf(pcBuf, ui32Size, pcString, vaArgP);
+	va_end(vaArgP);
+	return iRet;
+}
@@ -0,0 +1,263 @@
+//*****************************************************************************
+//
+// tiva.h - Just enough of the TivaWare headers to build the demo on a PC.
+// Every driverlib call is a no-op (tiva.c); a test overrides the ones it
+// models. The values only need to be distinct, not the hardware's.
+//
+//*****************************************************************************
+
+#ifndef __TIVA_H__
+#define __TIVA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HWREG(x)                 (*((volatile uint32_t *)(x)))
+#define UART0_BASE               0x4000C000
+#define UART1_BASE               0x4000D000
+#define GPIO_PORTA_BASE          0x40004000
+#define GPIO_PORTB_BASE          0x40005000
+#define GPIO_PORTC_BASE          0x40006000
+#define GPIO_PORTF_BASE          0x40025000
+#define TIMER0_BASE              0x40030000
+#define TIMER1_BASE              0x40031000
+#define WTIMER5_BASE             0x4004F000
+#define FLASH_BASE               0
+#define INT_UART0                21
+#define INT_UART1                22
+#define INT_TIMER0A              35
+#define INT_TIMER1A              37
+#define FAULT_SYSTICK            15
+#define SYSCTL_PERIPH_GPIOA      1
+#define SYSCTL_PERIPH_GPIOB      2
+#define SYSCTL_PERIPH_GPIOC      3
+#define SYSCTL_PERIPH_GPIOF      4
+#define SYSCTL_PERIPH_UART0      5
+#define SYSCTL_PERIPH_UART1      6
+#define SYSCTL_PERIPH_TIMER0     7
+#define SYSCTL_PERIPH_TIMER1     8
+#define SYSCTL_PERIPH_WTIMER5    9
+#define SYSCTL_SYSDIV_1          0x1
+#define SYSCTL_SYSDIV_2_5        0x2
+#define SYSCTL_USE_OSC           0x4
+#define SYSCTL_USE_PLL           0x8
+#define SYSCTL_OSC_MAIN          0x10
+#define SYSCTL_XTAL_16MHZ        0x20
+#define GPIO_PIN_0               1
+#define GPIO_PIN_1               2
+#define GPIO_PIN_2               4
+#define GPIO_PIN_3               8
+#define GPIO_PIN_4               16
+#define GPIO_PIN_5               32
+#define GPIO_PIN_6               64
+#define GPIO_PIN_7               128
+#define GPIO_PA0_U0RX            1
+#define GPIO_PA1_U0TX            2
+#define GPIO_PB0_U1RX            3
+#define GPIO_PB1_U1TX            4
+#define GPIO_PC4_U1RTS           5
+#define GPIO_PC5_U1CTS           6
+#define GPIO_PF0_U1RTS           7
+#define GPIO_PF1_U1CTS           8
+#define GPIO_DIR_MODE_OUT        1
+#define GPIO_DIR_MODE_IN         0
+#define GPIO_STRENGTH_2MA        1
+#define GPIO_PIN_TYPE_STD        8
+#define UART_CLOCK_PIOSC         5
+#define UART_CLOCK_SYSTEM        0
+#define UART_INT_RX              0x10
+#define UART_INT_TX              0x20
+#define UART_INT_RT              0x40
+#define UART_INT_OE              0x400
+#define UART_INT_BE              0x200
+#define UART_INT_PE              0x100
+#define UART_INT_FE              0x80
+#define UART_INT_CTS             0x2
+#define UART_FLOWCONTROL_TX      0x8000
+#define UART_FLOWCONTROL_RX      0x4000
+#define UART_FLOWCONTROL_NONE    0
+#define UART_FIFO_TX1_8          0
+#define UART_FIFO_TX2_8          1
+#define UART_FIFO_TX4_8          2
+#define UART_FIFO_RX4_8          0x10
+#define UART_FIFO_RX6_8          0x18
+#define UART_FIFO_RX2_8          0x8
+#define UART_FIFO_RX1_8          0x0
+#define UART_CONFIG_WLEN_8       0x60
+#define UART_CONFIG_STOP_ONE     0
+#define UART_CONFIG_PAR_NONE     0
+#define UART_TXINT_MODE_EOT      0x10
+#define UART_TXINT_MODE_FIFO     0
+#define UART_RXERROR_OVERRUN     8
+#define UART_RXERROR_FRAMING     1
+#define UART_RXERROR_PARITY      2
+#define UART_RXERROR_BREAK       4
+#define TIMER_CFG_ONE_SHOT       0x21
+#define TIMER_CFG_PERIODIC       0x22
+#define TIMER_CFG_PERIODIC_UP    0x32
+#define TIMER_CFG_ONE_SHOT_UP    0x31
+#define TIMER_A                  0xff
+#define TIMER_B                  0xff00
+#define TIMER_BOTH               0xffff
+#define TIMER_TIMA_TIMEOUT       1
+#define NVIC_ST_CURRENT          0xE000E018
+#define NVIC_ST_CTRL             0xE000E010
+#define NVIC_ST_RELOAD           0xE000E014
+#define NVIC_DBG_INT             0
+#define CMDLINE_BAD_CMD          (-1)
+#define CMDLINE_TOO_MANY_ARGS    (-2)
+#define CMDLINE_TOO_FEW_ARGS     (-3)
+#define CMDLINE_INVALID_ARG      (-4)
+#define SYSCTL_RCGC2_GPIOF       0x20
+#define GPIO_PIN_TYPE_STD_WPU    0x0000000A
+
+extern volatile uint32_t SYSCTL_RCGC2_R;
+extern volatile uint32_t GPIO_PORTF_DATA_R;
+extern volatile uint32_t GPIO_PORTF_DIR_R;
+extern volatile uint32_t GPIO_PORTF_DEN_R;
+
+extern void SysCtlPeripheralEnable(uint32_t);
+extern bool SysCtlPeripheralReady(uint32_t);
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlClockSet(uint32_t);
+extern void SysCtlDelay(uint32_t);
+extern void SysCtlSleep(void);
+extern void SysCtlPeripheralSleepEnable(uint32_t);
+extern void SysCtlPeripheralClockGating(bool);
+extern void SysCtlReset(void);
+extern void GPIOPinConfigure(uint32_t);
+extern void GPIOPinTypeUART(uint32_t, uint8_t);
+extern void GPIOPinTypeGPIOOutput(uint32_t, uint8_t);
+extern void GPIOPinTypeGPIOInput(uint32_t, uint8_t);
+extern void GPIOPinWrite(uint32_t, uint8_t, uint8_t);
+extern int32_t GPIOPinRead(uint32_t, uint8_t);
+extern void UARTClockSourceSet(uint32_t, uint32_t);
+extern void UARTIntEnable(uint32_t, uint32_t);
+extern void UARTIntDisable(uint32_t, uint32_t);
+extern uint32_t UARTIntStatus(uint32_t, bool);
+extern void UARTIntClear(uint32_t, uint32_t);
+extern bool UARTCharsAvail(uint32_t);
+extern bool UARTSpaceAvail(uint32_t);
+extern int32_t UARTCharGetNonBlocking(uint32_t);
+extern int32_t UARTCharGet(uint32_t);
+extern bool UARTCharPutNonBlocking(uint32_t, unsigned char);
+extern void UARTCharPut(uint32_t, unsigned char);
+extern void UARTFlowControlSet(uint32_t, uint32_t);
+extern void UARTFIFOLevelSet(uint32_t, uint32_t, uint32_t);
+extern void UARTFIFOEnable(uint32_t);
+extern void UARTFIFODisable(uint32_t);
+extern void UARTConfigSetExpClk(uint32_t, uint32_t, uint32_t, uint32_t);
+extern void UARTConfigGetExpClk(uint32_t, uint32_t, uint32_t *, uint32_t *);
+extern void UARTEnable(uint32_t);
+extern void UARTDisable(uint32_t);
+extern bool UARTBusy(uint32_t);
+extern void UARTTxIntModeSet(uint32_t, uint32_t);
+extern uint32_t UARTRxErrorGet(uint32_t);
+extern void UARTRxErrorClear(uint32_t);
+extern void IntEnable(uint32_t);
+extern void IntDisable(uint32_t);
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntPendSet(uint32_t);
+extern void FPUEnable(void);
+extern void FPULazyStackingEnable(void);
+extern void TimerConfigure(uint32_t, uint32_t);
+extern void TimerLoadSet(uint32_t, uint32_t, uint32_t);
+extern void TimerEnable(uint32_t, uint32_t);
+extern void TimerDisable(uint32_t, uint32_t);
+extern void TimerIntEnable(uint32_t, uint32_t);
+extern void TimerIntDisable(uint32_t, uint32_t);
+extern void TimerIntClear(uint32_t, uint32_t);
+extern uint32_t TimerValueGet(uint32_t, uint32_t);
+extern uint64_t TimerValueGet64(uint32_t);
+extern uint32_t TimerIntStatus(uint32_t, bool);
+extern void SysTickPeriodSet(uint32_t);
+extern uint32_t SysTickPeriodGet(void);
+extern void SysTickEnable(void);
+extern void SysTickDisable(void);
+extern void SysTickIntEnable(void);
+extern void SysTickIntDisable(void);
+extern uint32_t SysTickValueGet(void);
+extern int32_t FlashErase(uint32_t);
+extern int32_t FlashProgram(uint32_t *, uint32_t, uint32_t);
+extern void UARTprintf(const char *, ...);
+extern int UARTgets(char *, uint32_t);
+extern void UARTStdioConfig(uint32_t, uint32_t, uint32_t);
+extern int UARTwrite(const char *, uint32_t);
+extern int CmdLineProcess(char *);
+extern uint32_t CPUcpsid(void);
+extern uint32_t CPUcpsie(void);
+extern void CPUwfi(void);
+extern int usnprintf(char *, uint32_t, const char *, ...);
+extern void GPIOPadConfigSet(uint32_t, uint8_t, uint32_t, uint32_t);
+
+typedef int (*pfnCmdLine)(int argc, char *argv[]);
+typedef struct
+{
+	const char *pcCmd;
+	pfnCmdLine pfnCmd;
+	const char *pcHelp;
+}
+tCmdLineEntry;
+extern tCmdLineEntry g_sCmdTable[];
+
+#define ROM_SysCtlPeripheralEnable SysCtlPeripheralEnable
+#define ROM_SysCtlClockSet       SysCtlClockSet
+#define ROM_SysCtlClockGet       SysCtlClockGet
+#define ROM_SysCtlDelay          SysCtlDelay
+#define ROM_SysCtlSleep          SysCtlSleep
+#define ROM_GPIOPinConfigure     GPIOPinConfigure
+#define ROM_GPIOPinTypeUART      GPIOPinTypeUART
+#define ROM_GPIOPinTypeGPIOOutput GPIOPinTypeGPIOOutput
+#define ROM_GPIOPinTypeGPIOInput GPIOPinTypeGPIOInput
+#define ROM_GPIOPinWrite         GPIOPinWrite
+#define ROM_GPIOPinRead          GPIOPinRead
+#define ROM_UARTIntStatus        UARTIntStatus
+#define ROM_UARTIntClear         UARTIntClear
+#define ROM_UARTIntEnable        UARTIntEnable
+#define ROM_UARTIntDisable       UARTIntDisable
+#define ROM_UARTCharsAvail       UARTCharsAvail
+#define ROM_UARTSpaceAvail       UARTSpaceAvail
+#define ROM_UARTCharGetNonBlocking UARTCharGetNonBlocking
+#define ROM_UARTCharPutNonBlocking UARTCharPutNonBlocking
+#define ROM_UARTCharPut          UARTCharPut
+#define ROM_UARTCharGet          UARTCharGet
+#define ROM_UARTFlowControlSet   UARTFlowControlSet
+#define ROM_UARTFIFOLevelSet     UARTFIFOLevelSet
+#define ROM_UARTConfigSetExpClk  UARTConfigSetExpClk
+#define ROM_UARTConfigGetExpClk  UARTConfigGetExpClk
+#define ROM_UARTBusy             UARTBusy
+#define ROM_UARTEnable           UARTEnable
+#define ROM_UARTDisable          UARTDisable
+#define ROM_UARTTxIntModeSet     UARTTxIntModeSet
+#define ROM_UARTRxErrorGet       UARTRxErrorGet
+#define ROM_UARTRxErrorClear     UARTRxErrorClear
+#define ROM_IntEnable            IntEnable
+#define ROM_IntDisable           IntDisable
+#define ROM_IntMasterEnable      IntMasterEnable
+#define ROM_IntMasterDisable     IntMasterDisable
+#define ROM_IntPendSet           IntPendSet
+#define ROM_FPUEnable            FPUEnable
+#define ROM_FPULazyStackingEnable FPULazyStackingEnable
+#define ROM_TimerConfigure       TimerConfigure
+#define ROM_TimerLoadSet         TimerLoadSet
+#define ROM_TimerEnable          TimerEnable
+#define ROM_TimerDisable         TimerDisable
+#define ROM_TimerIntEnable       TimerIntEnable
+#define ROM_TimerIntDisable      TimerIntDisable
+#define ROM_TimerIntClear        TimerIntClear
+#define ROM_TimerValueGet        TimerValueGet
+#define ROM_TimerValueGet64      TimerValueGet64
+#define ROM_SysTickPeriodSet     SysTickPeriodSet
+#define ROM_SysTickEnable        SysTickEnable
+#define ROM_SysTickDisable       SysTickDisable
+#define ROM_SysTickIntEnable     SysTickIntEnable
+#define ROM_SysTickIntDisable    SysTickIntDisable
+#define ROM_SysTickValueGet      SysTickValueGet
+#define ROM_SysTickPeriodGet     SysTickPeriodGet
+#define ROM_FlashErase           FlashErase
+#define ROM_FlashProgram         FlashProgram
+#define ROM_SysCtlReset          SysCtlReset
+#define ROM_GPIOPadConfigSet     GPIOPadConfigSet
+
+#endif // __TIVA_H__